@@ -0,0 +1,80 @@
+#ifndef AFINA_BENCH_PERF_H
+#define AFINA_BENCH_PERF_H
+
+#include <cstdint>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Bench {
+
+/**
+ * # Hardware event counter of the calling thread
+ * Thin wrapper over perf_event_open. Counters are often unavailable in containers or with
+ * restrictive kernel.perf_event_paranoid, check Available() before trusting the numbers
+ */
+class PerfCounter {
+public:
+    PerfCounter(uint32_t type, uint64_t config) {
+        struct perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        _fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    ~PerfCounter() {
+        if (_fd >= 0) {
+            close(_fd);
+        }
+    }
+
+    /**
+     * Data TLB load misses
+     */
+    static PerfCounter DTLBLoadMisses() {
+        return PerfCounter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                                   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    }
+
+    PerfCounter(PerfCounter &&other) : _fd(other._fd) { other._fd = -1; }
+
+    inline bool Available() const { return _fd >= 0; }
+
+    void Start() {
+        if (_fd >= 0) {
+            ioctl(_fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    uint64_t Stop() {
+        uint64_t value = 0;
+        if (_fd >= 0) {
+            ioctl(_fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(_fd, &value, sizeof(value)) != sizeof(value)) {
+                value = 0;
+            }
+        }
+        return value;
+    }
+
+private:
+    PerfCounter(const PerfCounter &) = delete;
+    PerfCounter &operator=(const PerfCounter &) = delete;
+
+    int _fd;
+};
+
+} // namespace Bench
+} // namespace Afina
+
+#endif // AFINA_BENCH_PERF_H
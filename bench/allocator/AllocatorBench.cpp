@@ -0,0 +1,688 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <malloc.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cxxopts.hpp>
+
+#include <afina/allocator/Arena.h>
+#include <afina/allocator/Error.h>
+#include <afina/allocator/Mempool.h>
+#include <afina/allocator/Pointer.h>
+#include <afina/allocator/Simple.h>
+#include <afina/allocator/Stats.h>
+
+#include "Trace.h"
+
+using namespace Afina;
+
+// Replays allocation trace against afina allocators and glibc malloc. Each allocator runs in a
+// forked child, so peak RSS of one run doesn't leak into another
+//
+// Usage: runAllocatorBench --help
+namespace {
+
+/**
+ * Allocated object as seen by the benchmark. Simple hands out movable handles, others raw pointers
+ */
+struct Block {
+    void *ptr;
+    Allocator::Pointer handle;
+    uint32_t size;
+};
+
+/**
+ * Allocator under test. Implementations must be thread safe if constructed for several threads
+ */
+class Heap {
+public:
+    virtual ~Heap() {}
+
+    /**
+     * Fills block on success, returns false if allocator is out of memory
+     */
+    virtual bool Alloc(uint32_t size, Block &block) = 0;
+
+    virtual void Free(Block &block) = 0;
+
+    /**
+     * Called right before replay starts, so that benchmark own memory isn't reported by Usage
+     */
+    virtual void Mark() {}
+
+    /**
+     * Bytes occupied by allocations including allocator overhead and share of free memory that
+     * could not serve the largest request, negative if allocator can't tell
+     */
+    virtual void Usage(double &used, double &external) = 0;
+};
+
+// glibc malloc, thread safe on its own
+class MallocHeap : public Heap {
+public:
+    explicit MallocHeap(bool threaded) : _threaded(threaded), _base(0) {}
+
+    bool Alloc(uint32_t size, Block &block) override {
+        block.ptr = std::malloc(size);
+        return block.ptr != nullptr;
+    }
+
+    void Free(Block &block) override { std::free(block.ptr); }
+
+    void Mark() override {
+        struct mallinfo2 info = mallinfo2();
+        _base = info.uordblks + info.hblkhd;
+    }
+
+    void Usage(double &used, double &external) override {
+        // mallinfo2 covers main arena only, numbers are meaningless once threads get own arenas
+        external = -1;
+        if (_threaded) {
+            used = -1;
+            return;
+        }
+
+        struct mallinfo2 info = mallinfo2();
+        used = double(info.uordblks + info.hblkhd) - _base;
+    }
+
+private:
+    bool _threaded;
+    std::size_t _base;
+};
+
+// Guard that does nothing when heap is used by a single thread
+class MaybeLock {
+public:
+    explicit MaybeLock(std::mutex *mutex) : _mutex(mutex) {
+        if (_mutex != nullptr) {
+            _mutex->lock();
+        }
+    }
+
+    ~MaybeLock() {
+        if (_mutex != nullptr) {
+            _mutex->unlock();
+        }
+    }
+
+private:
+    std::mutex *_mutex;
+};
+
+// Allocator::Simple over anonymous mapping, global lock in multithreaded mode
+class SimpleHeap : public Heap {
+public:
+    SimpleHeap(std::size_t size, bool threaded)
+        : _size(size), _base(Map(size)), _simple(_base, size), _mutex(threaded ? new std::mutex : nullptr) {}
+
+    ~SimpleHeap() { munmap(_base, _size); }
+
+    bool Alloc(uint32_t size, Block &block) override {
+        MaybeLock lock(_mutex.get());
+        try {
+            block.handle = _simple.alloc(size);
+        } catch (Allocator::AllocError &) {
+            return false;
+        }
+        block.ptr = block.handle.get();
+        return true;
+    }
+
+    void Free(Block &block) override {
+        MaybeLock lock(_mutex.get());
+        _simple.free(block.handle);
+    }
+
+    void Usage(double &used, double &external) override {
+        MaybeLock lock(_mutex.get());
+        Allocator::Stats stats = _simple.stats();
+        used = double(stats.used_bytes);
+        external = stats.external_fragmentation;
+    }
+
+private:
+    static void *Map(std::size_t size) {
+        void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (base == MAP_FAILED) {
+            throw std::runtime_error("Failed to map memory for simple allocator");
+        }
+        return base;
+    }
+
+    std::size_t _size;
+    void *_base;
+    Allocator::Simple _simple;
+    std::unique_ptr<std::mutex> _mutex;
+};
+
+// Power of two size classes served by Mempool over a shared Arena, global lock in multithreaded mode
+class SlabHeap : public Heap {
+public:
+    static const uint32_t kMinClass = 16;
+    static const uint32_t kMaxClass = 64 * 1024;
+
+    SlabHeap(std::size_t size, bool threaded) : _arena(size), _mutex(threaded ? new std::mutex : nullptr) {
+        for (uint32_t cls = kMinClass; cls <= kMaxClass; cls <<= 1) {
+            _pools.emplace_back(new Allocator::Mempool(_arena, cls));
+        }
+    }
+
+    bool Alloc(uint32_t size, Block &block) override {
+        if (size > kMaxClass) {
+            return false;
+        }
+
+        MaybeLock lock(_mutex.get());
+        try {
+            block.ptr = _pools[ClassOf(size)]->Alloc();
+        } catch (Allocator::AllocError &) {
+            return false;
+        }
+        return true;
+    }
+
+    void Free(Block &block) override {
+        MaybeLock lock(_mutex.get());
+        _pools[ClassOf(block.size)]->Free(block.ptr);
+    }
+
+    void Usage(double &used, double &external) override {
+        MaybeLock lock(_mutex.get());
+        std::size_t total = 0, free = 0;
+        used = 0;
+        for (auto &pool : _pools) {
+            Allocator::Stats stats = pool->stats();
+            total += stats.total_bytes;
+            free += stats.free_bytes;
+            used += stats.used_bytes;
+        }
+
+        // Memory stuck in partially used slabs, see Mempool::stats
+        external = total > 0 ? double(free) / total : 0;
+    }
+
+private:
+    static std::size_t ClassOf(uint32_t size) {
+        std::size_t index = 0;
+        for (uint32_t cls = kMinClass; cls < size; cls <<= 1) {
+            index++;
+        }
+        return index;
+    }
+
+    Allocator::Arena _arena;
+    std::vector<std::unique_ptr<Allocator::Mempool>> _pools;
+    std::unique_ptr<std::mutex> _mutex;
+};
+
+std::unique_ptr<Heap> MakeHeap(const std::string &name, std::size_t memory, bool threaded) {
+    if (name == "malloc") {
+        return std::unique_ptr<Heap>(new MallocHeap(threaded));
+    } else if (name == "simple") {
+        return std::unique_ptr<Heap>(new SimpleHeap(memory, threaded));
+    } else if (name == "slab") {
+        return std::unique_ptr<Heap>(new SlabHeap(memory, threaded));
+    }
+    throw std::runtime_error("Unknown allocator " + name);
+}
+
+/**
+ * Run outcome, plain data so child could pass it to the parent through a pipe
+ */
+struct Result {
+    static const std::size_t kMaxSamples = 64;
+
+    struct Sample {
+        uint64_t ops;
+        uint64_t live_bytes;
+        uint64_t rss_bytes;
+        double internal;
+        double external;
+    };
+
+    double seconds;
+    uint64_t ops;
+    uint64_t failed;
+    uint64_t alloc_p50, alloc_p99;
+    uint64_t free_p50, free_p99;
+    uint64_t peak_rss;
+
+    std::size_t samples_count;
+    Sample samples[kMaxSamples];
+};
+
+std::size_t CurrentRSS() {
+    long pages = 0, resident = 0;
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (statm != nullptr) {
+        if (fscanf(statm, "%ld %ld", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        fclose(statm);
+    }
+    return std::size_t(resident) * sysconf(_SC_PAGESIZE);
+}
+
+std::size_t PeakRSS() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return std::size_t(usage.ru_maxrss) * 1024;
+}
+
+/**
+ * Appends heap state to the result timeline
+ */
+void Sample(Heap &heap, const std::atomic<int64_t> &live, std::size_t ops, std::size_t base_rss, Result &result) {
+    if (result.samples_count >= Result::kMaxSamples) {
+        return;
+    }
+
+    double used, external;
+    heap.Usage(used, external);
+
+    std::size_t rss = CurrentRSS();
+    Result::Sample &sample = result.samples[result.samples_count++];
+    sample.ops = ops;
+    sample.live_bytes = std::max<int64_t>(0, live.load(std::memory_order_relaxed));
+    sample.rss_bytes = rss - std::min(base_rss, rss);
+    sample.internal = used > 0 ? 1.0 - sample.live_bytes / used : (used < 0 ? -1 : 0);
+    sample.external = external;
+}
+
+// Objects freed by another thread, multithreaded mode only
+struct Inbox {
+    std::mutex mutex;
+    std::vector<Block> blocks;
+};
+
+/**
+ * Replays trace on a single thread. In multithreaded mode each freed object is passed to the next
+ * thread which does actual free, so allocator sees cross-thread frees all the time
+ */
+class Worker {
+public:
+    Worker(const Bench::Trace &trace, Heap &heap, std::atomic<int64_t> &live)
+        : _trace(trace), _heap(heap), _live(live), _objects(trace.max_id), _alloc_ns(trace.ops.size()),
+          _free_ns(trace.ops.size()), _allocs(0), _frees(0), _failed(0), _inbox(nullptr), _peer(nullptr) {}
+
+    void Connect(Inbox *inbox, Inbox *peer) {
+        _inbox = inbox;
+        _peer = peer;
+    }
+
+    void Run(Result *result, std::size_t sample_every, std::size_t threads, std::size_t base_rss) {
+        for (std::size_t i = 0; i < _trace.ops.size(); i++) {
+            if (result != nullptr && i > 0 && i % sample_every == 0) {
+                Sample(_heap, _live, i * threads, base_rss, *result);
+            }
+
+            auto &op = _trace.ops[i];
+            if (op.size > 0) {
+                Alloc(_objects[op.id], op.size);
+            } else if (_objects[op.id].size > 0) {
+                if (_peer == nullptr) {
+                    Free(_objects[op.id]);
+                } else {
+                    std::lock_guard<std::mutex> lock(_peer->mutex);
+                    _peer->blocks.push_back(_objects[op.id]);
+                }
+                _objects[op.id].size = 0;
+            }
+
+            if (_inbox != nullptr && i % 64 == 0) {
+                Drain();
+            }
+        }
+    }
+
+    /**
+     * Frees objects passed by other thread
+     */
+    void Drain() {
+        std::vector<Block> blocks;
+        {
+            std::lock_guard<std::mutex> lock(_inbox->mutex);
+            blocks.swap(_inbox->blocks);
+        }
+
+        for (auto &block : blocks) {
+            Free(block);
+        }
+    }
+
+    /**
+     * Frees objects still alive at the end of trace, not measured
+     */
+    void Cleanup() {
+        for (auto &block : _objects) {
+            if (block.size > 0) {
+                _heap.Free(block);
+                block.size = 0;
+            }
+        }
+    }
+
+    inline std::vector<uint32_t> AllocLatencies() const {
+        return std::vector<uint32_t>(_alloc_ns.begin(), _alloc_ns.begin() + _allocs);
+    }
+    inline std::vector<uint32_t> FreeLatencies() const {
+        return std::vector<uint32_t>(_free_ns.begin(), _free_ns.begin() + _frees);
+    }
+    inline uint64_t Ops() const { return _allocs + _frees; }
+    inline uint64_t Failed() const { return _failed; }
+
+private:
+    void Alloc(Block &block, uint32_t size) {
+        auto start = std::chrono::steady_clock::now();
+        bool ok = _heap.Alloc(size, block);
+        auto end = std::chrono::steady_clock::now();
+
+        if (!ok) {
+            _failed++;
+            return;
+        }
+        _alloc_ns[_allocs++] = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        // Touch each page the way cache would by writing value into it, so RSS is real
+        char *data = static_cast<char *>(block.ptr);
+        for (uint32_t offset = 0; offset < size; offset += 4096) {
+            data[offset] = 1;
+        }
+        data[size - 1] = 1;
+
+        block.size = size;
+        _live.fetch_add(size, std::memory_order_relaxed);
+    }
+
+    void Free(Block &block) {
+        auto start = std::chrono::steady_clock::now();
+        _heap.Free(block);
+        auto end = std::chrono::steady_clock::now();
+        _free_ns[_frees++] = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        _live.fetch_sub(block.size, std::memory_order_relaxed);
+    }
+
+    const Bench::Trace &_trace;
+    Heap &_heap;
+    std::atomic<int64_t> &_live;
+
+    // Live objects by trace id, size is 0 for slots that hold nothing
+    std::vector<Block> _objects;
+
+    // Preallocated and touched before run, so recording doesn't disturb RSS
+    std::vector<uint32_t> _alloc_ns;
+    std::vector<uint32_t> _free_ns;
+    std::size_t _allocs;
+    std::size_t _frees;
+    uint64_t _failed;
+
+    Inbox *_inbox;
+    Inbox *_peer;
+};
+
+uint64_t Percentile(std::vector<uint32_t> &values, double p) {
+    if (values.empty()) {
+        return 0;
+    }
+
+    std::size_t n = std::min(values.size() - 1, std::size_t(values.size() * p));
+    std::nth_element(values.begin(), values.begin() + n, values.end());
+    return values[n];
+}
+
+Result Run(const std::string &name, const std::vector<Bench::Trace> &traces, std::size_t memory,
+           std::size_t samples) {
+    std::size_t threads = traces.size();
+    std::atomic<int64_t> live(0);
+
+    Result result;
+    std::memset(&result, 0, sizeof(result));
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::unique_ptr<Heap> heap = MakeHeap(name, memory, threads > 1);
+    for (auto &trace : traces) {
+        workers.emplace_back(new Worker(trace, *heap, live));
+    }
+
+    std::vector<Inbox> inboxes(threads);
+    if (threads > 1) {
+        for (std::size_t i = 0; i < threads; i++) {
+            workers[i]->Connect(&inboxes[i], &inboxes[(i + 1) % threads]);
+        }
+    }
+
+    // Everything above is allocated already, from now on RSS grows because of the heap only
+    heap->Mark();
+    std::size_t base_rss = CurrentRSS();
+    std::size_t sample_every = std::max<std::size_t>(1, traces[0].ops.size() / samples);
+    std::atomic<std::size_t> finished(0);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (std::size_t i = 0; i < threads; i++) {
+        pool.emplace_back([&, i]() {
+            workers[i]->Run(i == 0 ? &result : nullptr, sample_every, threads, base_rss);
+            if (threads > 1) {
+                // Peers could still send objects until all of them are done
+                finished.fetch_add(1);
+                while (finished.load() < threads) {
+                    workers[i]->Drain();
+                    std::this_thread::yield();
+                }
+                workers[i]->Drain();
+            }
+        });
+    }
+    for (auto &thread : pool) {
+        thread.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    // Final state, before latencies below are merged on the same heap
+    Sample(*heap, live, traces[0].ops.size() * threads, base_rss, result);
+
+    std::vector<uint32_t> alloc_ns, free_ns;
+    for (auto &worker : workers) {
+        auto a = worker->AllocLatencies();
+        auto f = worker->FreeLatencies();
+        alloc_ns.insert(alloc_ns.end(), a.begin(), a.end());
+        free_ns.insert(free_ns.end(), f.begin(), f.end());
+        result.ops += worker->Ops();
+        result.failed += worker->Failed();
+    }
+
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    result.alloc_p50 = Percentile(alloc_ns, 0.50);
+    result.alloc_p99 = Percentile(alloc_ns, 0.99);
+    result.free_p50 = Percentile(free_ns, 0.50);
+    result.free_p99 = Percentile(free_ns, 0.99);
+
+    result.peak_rss = PeakRSS() - std::min(base_rss, PeakRSS());
+
+    for (auto &worker : workers) {
+        worker->Cleanup();
+    }
+    return result;
+}
+
+/**
+ * Runs allocator in a child process, returns false if it has failed
+ */
+bool RunIsolated(const std::string &name, const std::vector<Bench::Trace> &traces, std::size_t memory,
+                 std::size_t samples, Result &result) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        throw std::runtime_error("Failed to create pipe");
+    }
+
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid < 0) {
+        throw std::runtime_error("Failed to fork");
+    }
+
+    if (pid == 0) {
+        close(fds[0]);
+        int code = 0;
+        try {
+            Result r = Run(name, traces, memory, samples);
+            if (write(fds[1], &r, sizeof(r)) != sizeof(r)) {
+                code = 1;
+            }
+        } catch (std::exception &ex) {
+            std::cerr << name << ": " << ex.what() << std::endl;
+            code = 1;
+        }
+        _exit(code);
+    }
+
+    close(fds[1]);
+    std::size_t got = 0;
+    char *out = reinterpret_cast<char *>(&result);
+    for (ssize_t n; got < sizeof(result) && (n = read(fds[0], out + got, sizeof(result) - got)) > 0;) {
+        got += n;
+    }
+    close(fds[0]);
+
+    int status;
+    waitpid(pid, &status, 0);
+    return got == sizeof(result) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+std::string Fraction(double value) {
+    if (value < 0) {
+        return "-";
+    }
+    std::stringstream out;
+    out << std::fixed << std::setprecision(3) << value;
+    return out.str();
+}
+
+void ReportSummary(const std::string &name, const Result &r) {
+    std::cout << std::left << std::setw(10) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << r.ops / r.seconds / 1e6 << std::setw(12) << r.alloc_p50 << std::setw(12)
+              << r.alloc_p99 << std::setw(12) << r.free_p50 << std::setw(12) << r.free_p99 << std::setw(14)
+              << std::setprecision(1) << r.peak_rss / 1048576.0 << std::setw(10) << r.failed << std::endl;
+}
+
+void ReportTimeline(const std::string &name, const Result &r) {
+    std::cout << std::endl << name << ": fragmentation over time" << std::endl;
+    std::cout << std::setw(12) << "ops" << std::setw(12) << "live MB" << std::setw(12) << "RSS MB" << std::setw(10)
+              << "waste" << std::setw(10) << "internal" << std::setw(10) << "external" << std::endl;
+
+    for (std::size_t i = 0; i < r.samples_count; i++) {
+        auto &s = r.samples[i];
+        double waste = s.rss_bytes > 0 ? 1.0 - double(s.live_bytes) / s.rss_bytes : -1;
+        std::cout << std::setw(12) << s.ops << std::fixed << std::setprecision(1) << std::setw(12)
+                  << s.live_bytes / 1048576.0 << std::setw(12) << s.rss_bytes / 1048576.0 << std::setw(10)
+                  << Fraction(std::max(waste, -1.0)) << std::setw(10) << Fraction(s.internal) << std::setw(10)
+                  << Fraction(s.external) << std::endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    cxxopts::Options options("runAllocatorBench", "Replay allocation traces against afina allocators and malloc");
+    try {
+        options.add_options()("a,allocators", "Comma separated list of: malloc, simple, slab",
+                              cxxopts::value<std::string>()->default_value("malloc,simple,slab"));
+        options.add_options()("p,profile", "Object sizes of generated trace: fixed, small, web",
+                              cxxopts::value<std::string>()->default_value("web"));
+        options.add_options()("t,trace", "Replay trace file instead of generated one", cxxopts::value<std::string>());
+        options.add_options()("ops", "Operations per thread in generated trace",
+                              cxxopts::value<uint32_t>()->default_value("1000000"));
+        options.add_options()("live", "Live objects per thread in generated trace",
+                              cxxopts::value<uint32_t>()->default_value("10000"));
+        options.add_options()("churn", "Share of live objects replaced by each eviction wave",
+                              cxxopts::value<double>()->default_value("0.5"));
+        options.add_options()("threads", "Threads replaying the trace, objects are freed by the neighbour thread",
+                              cxxopts::value<uint32_t>()->default_value("1"));
+        options.add_options()("memory", "Memory in MB given to afina allocators",
+                              cxxopts::value<uint32_t>()->default_value("1024"));
+        options.add_options()("samples", "Fragmentation samples over the run",
+                              cxxopts::value<uint32_t>()->default_value("10"));
+        options.add_options()("seed", "Generator seed", cxxopts::value<uint32_t>()->default_value("1"));
+        options.add_options()("h,help", "Print usage info");
+        options.parse(argc, argv);
+
+        if (options.count("help") > 0) {
+            std::cerr << options.help() << std::endl;
+            return 0;
+        }
+    } catch (cxxopts::OptionParseException &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    try {
+        std::size_t threads = std::max<uint32_t>(1, options["threads"].as<uint32_t>());
+        std::string source = options["profile"].as<std::string>();
+
+        std::vector<Bench::Trace> traces;
+        if (options.count("trace") > 0) {
+            source = options["trace"].as<std::string>();
+            traces.assign(threads, Bench::Trace::Load(source));
+        } else {
+            for (std::size_t i = 0; i < threads; i++) {
+                traces.push_back(Bench::Trace::Generate(source, options["ops"].as<uint32_t>(),
+                                                        options["live"].as<uint32_t>(), options["churn"].as<double>(),
+                                                        options["seed"].as<uint32_t>() + i));
+            }
+        }
+
+        std::vector<std::string> names;
+        std::stringstream list(options["allocators"].as<std::string>());
+        for (std::string name; std::getline(list, name, ',');) {
+            names.push_back(name);
+        }
+
+        std::size_t memory = std::size_t(options["memory"].as<uint32_t>()) << 20;
+        std::size_t samples = std::min<std::size_t>(Result::kMaxSamples - 1, options["samples"].as<uint32_t>());
+
+        std::cout << "trace " << source << ", " << traces[0].ops.size() << " ops, " << threads << " thread(s)"
+                  << std::endl;
+        std::cout << std::left << std::setw(10) << "allocator" << std::right << std::setw(10) << "Mops/s"
+                  << std::setw(12) << "alloc p50" << std::setw(12) << "alloc p99" << std::setw(12) << "free p50"
+                  << std::setw(12) << "free p99" << std::setw(14) << "peak RSS MB" << std::setw(10) << "failed"
+                  << std::endl;
+
+        std::vector<std::pair<std::string, Result>> results;
+        for (auto &name : names) {
+            std::unique_ptr<Result> result(new Result);
+            if (RunIsolated(name, traces, memory, samples, *result)) {
+                ReportSummary(name, *result);
+                results.emplace_back(name, *result);
+            } else {
+                std::cout << std::left << std::setw(10) << name << std::right << "  failed" << std::endl;
+            }
+        }
+
+        for (auto &result : results) {
+            ReportTimeline(result.first, result.second);
+        }
+    } catch (std::exception &ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
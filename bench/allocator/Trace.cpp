@@ -0,0 +1,164 @@
+#include "Trace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace Afina {
+namespace Bench {
+
+namespace {
+
+// xorshift64, good enough for workload generation and much cheaper than <random>
+class Random {
+public:
+    explicit Random(uint64_t seed) : _x(seed ? seed : 88172645463325252ull) {}
+
+    uint64_t Next() {
+        _x ^= _x << 13;
+        _x ^= _x >> 7;
+        _x ^= _x << 17;
+        return _x;
+    }
+
+    double Uniform() { return double(Next() >> 11) / double(1ull << 53); }
+
+    // Log-uniform in [lo, hi): small sizes are as likely as large ones on the log scale
+    uint32_t LogUniform(uint32_t lo, uint32_t hi) {
+        double lo_bits = std::log2(lo), hi_bits = std::log2(hi);
+        return uint32_t(std::exp2(lo_bits + (hi_bits - lo_bits) * Uniform()));
+    }
+
+private:
+    uint64_t _x;
+};
+
+uint32_t SizeFixed(Random &) { return 96; }
+
+uint32_t SizeSmall(Random &random) { return random.LogUniform(16, 512); }
+
+uint32_t SizeWeb(Random &random) {
+    double bucket = random.Uniform();
+    if (bucket < 0.60) {
+        return random.LogUniform(16, 128);
+    } else if (bucket < 0.90) {
+        return random.LogUniform(128, 1024);
+    } else if (bucket < 0.99) {
+        return random.LogUniform(1024, 16 * 1024);
+    }
+    return random.LogUniform(16 * 1024, 64 * 1024);
+}
+
+} // namespace
+
+// See Trace.h
+Trace Trace::Generate(const std::string &profile, std::size_t ops, std::size_t live, double churn, uint64_t seed) {
+    uint32_t (*size)(Random &);
+    if (profile == "fixed") {
+        size = SizeFixed;
+    } else if (profile == "small") {
+        size = SizeSmall;
+    } else if (profile == "web") {
+        size = SizeWeb;
+    } else {
+        throw std::runtime_error("Unknown size profile " + profile);
+    }
+
+    Random random(seed);
+    Trace trace;
+    trace.ops.reserve(ops);
+
+    // Ids of freed objects are reused, so ids stay below live bound
+    std::vector<uint32_t> live_ids, free_ids;
+    uint32_t next_id = 0;
+    std::size_t drop = std::max<std::size_t>(1, std::size_t(live * churn));
+
+    while (trace.ops.size() < ops) {
+        while (live_ids.size() < live && trace.ops.size() < ops) {
+            uint32_t id;
+            if (free_ids.empty()) {
+                id = next_id++;
+            } else {
+                id = free_ids.back();
+                free_ids.pop_back();
+            }
+
+            live_ids.push_back(id);
+            trace.ops.push_back(Op{id, size(random)});
+        }
+
+        for (std::size_t i = 0; i < drop && !live_ids.empty() && trace.ops.size() < ops; i++) {
+            std::size_t victim = random.Next() % live_ids.size();
+            uint32_t id = live_ids[victim];
+            live_ids[victim] = live_ids.back();
+            live_ids.pop_back();
+
+            free_ids.push_back(id);
+            trace.ops.push_back(Op{id, 0});
+        }
+    }
+
+    trace.max_id = next_id;
+    return trace;
+}
+
+// See Trace.h
+Trace Trace::Load(const std::string &path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Failed to open trace " + path);
+    }
+
+    Trace trace;
+    std::unordered_map<uint64_t, uint32_t> ids;
+    std::vector<uint32_t> free_ids;
+    uint32_t next_id = 0;
+
+    std::string line;
+    for (std::size_t lineno = 1; std::getline(in, line); lineno++) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream parser(line);
+        char type;
+        uint64_t id;
+        uint32_t size = 0;
+        if (!(parser >> type >> id) || (type == 'a' && !(parser >> size)) || (type != 'a' && type != 'f')) {
+            throw std::runtime_error("Malformed trace line " + std::to_string(lineno));
+        }
+
+        if (type == 'a') {
+            if (size == 0 || ids.count(id) > 0) {
+                throw std::runtime_error("Bad allocation at trace line " + std::to_string(lineno));
+            }
+
+            uint32_t dense;
+            if (free_ids.empty()) {
+                dense = next_id++;
+            } else {
+                dense = free_ids.back();
+                free_ids.pop_back();
+            }
+            ids[id] = dense;
+            trace.ops.push_back(Op{dense, size});
+        } else {
+            auto it = ids.find(id);
+            if (it == ids.end()) {
+                throw std::runtime_error("Free of unknown object at trace line " + std::to_string(lineno));
+            }
+            trace.ops.push_back(Op{it->second, 0});
+            free_ids.push_back(it->second);
+            ids.erase(it);
+        }
+    }
+
+    trace.max_id = next_id;
+    return trace;
+}
+
+} // namespace Bench
+} // namespace Afina
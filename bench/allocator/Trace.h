@@ -0,0 +1,56 @@
+#ifndef AFINA_BENCH_ALLOCATOR_TRACE_H
+#define AFINA_BENCH_ALLOCATOR_TRACE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Afina {
+namespace Bench {
+
+/**
+ * # Allocation trace
+ * Sequence of alloc/free operations over objects identified by dense ids, so replay could keep
+ * live objects in a plain vector indexed by id
+ */
+struct Trace {
+    struct Op {
+        // Object the operation applies to
+        uint32_t id;
+
+        // Requested size for alloc, 0 for free
+        uint32_t size;
+    };
+
+    std::vector<Op> ops;
+
+    // All ids are below that bound
+    uint32_t max_id;
+
+    /**
+     * Synthetic cache workload: live set grows to live objects and then goes through eviction
+     * waves. Each wave frees churn share of live objects picked at random, which punches holes
+     * all over the heap, and allocates them back with fresh sizes.
+     *
+     * Sizes are taken from the given profile:
+     * - fixed: every object is 96 bytes, storage node of short key and value
+     * - small: log-uniform 16B..512B, keys and small values
+     * - web: 60% 16B..128B, 30% 128B..1K, 9% 1K..16K, 1% 16K..64K, mix of counters, sessions and pages
+     *
+     * Throws std::runtime_error on unknown profile
+     */
+    static Trace Generate(const std::string &profile, std::size_t ops, std::size_t live, double churn, uint64_t seed);
+
+    /**
+     * Loads trace recorded as text, one operation per line:
+     * - a <id> <size>: allocate object
+     * - f <id>: free object
+     * Ids could be arbitrary, they are renumbered on load. Throws std::runtime_error on malformed input
+     */
+    static Trace Load(const std::string &path);
+};
+
+} // namespace Bench
+} // namespace Afina
+
+#endif // AFINA_BENCH_ALLOCATOR_TRACE_H
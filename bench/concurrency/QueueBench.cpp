@@ -0,0 +1,151 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/Executor.h>
+#include <afina/concurrency/MPMCQueue.h>
+#include <afina/concurrency/WorkStealingExecutor.h>
+
+using namespace Afina;
+
+// Task queue contention: 1 to 64 producers push tiny items, fixed number of consumers take them.
+// Compares queues alone, mutex protected deque as the old Executor had and the lock-free ring, and
+// whole executors running empty tasks. Total number of items is the same for every producer count.
+//
+// Usage: runQueueBench [items] [consumers]
+namespace {
+
+const std::size_t kCapacity = 1024;
+
+// What Executor used to do: one mutex around std::deque, bounded by size check
+class LockedQueue {
+public:
+    explicit LockedQueue(std::size_t capacity) : _capacity(capacity) {}
+
+    bool TryPush(uint64_t item) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_items.size() >= _capacity) {
+            return false;
+        }
+        _items.push_back(item);
+        return true;
+    }
+
+    bool TryPop(uint64_t &item) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_items.empty()) {
+            return false;
+        }
+        item = _items.front();
+        _items.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex _mutex;
+    std::deque<uint64_t> _items;
+    std::size_t _capacity;
+};
+
+template <typename Queue> double RunQueue(std::size_t producers, std::size_t consumers, std::size_t items) {
+    Queue queue(kCapacity);
+    std::size_t per_producer = items / producers;
+    std::size_t total = per_producer * producers;
+
+    std::atomic<std::size_t> consumed(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> threads;
+
+    for (std::size_t p = 0; p < producers; p++) {
+        threads.emplace_back([&]() {
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            for (std::size_t i = 0; i < per_producer; i++) {
+                while (!queue.TryPush(i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (std::size_t c = 0; c < consumers; c++) {
+        threads.emplace_back([&]() {
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            uint64_t item;
+            while (consumed.load(std::memory_order_relaxed) < total) {
+                if (queue.TryPop(item)) {
+                    consumed.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true);
+    for (auto &t : threads) {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return total / std::chrono::duration<double>(end - start).count() / 1e6;
+}
+
+template <typename Pool> double RunPool(std::size_t producers, std::size_t consumers, std::size_t items) {
+    std::size_t per_producer = items / producers;
+    std::size_t total = per_producer * producers;
+    std::atomic<std::size_t> done(0);
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        Pool pool(consumers, consumers, kCapacity, std::chrono::milliseconds(1000));
+        std::vector<std::thread> threads;
+        for (std::size_t p = 0; p < producers; p++) {
+            threads.emplace_back([&]() {
+                for (std::size_t i = 0; i < per_producer; i++) {
+                    while (!pool.Execute([&done]() { done.fetch_add(1, std::memory_order_relaxed); })) {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+        pool.Stop(true);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    if (done.load() != total) {
+        throw std::runtime_error("Some tasks are lost");
+    }
+    return total / std::chrono::duration<double>(end - start).count() / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::size_t items = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::size_t consumers = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 4;
+
+    std::cout << items << " items, " << consumers << " consumers, capacity " << kCapacity << ", Mops/s" << std::endl;
+    std::cout << std::setw(10) << "producers" << std::setw(12) << "mutex" << std::setw(12) << "mpmc" << std::setw(12)
+              << "executor" << std::setw(12) << "stealing" << std::endl;
+
+    for (std::size_t producers = 1; producers <= 64; producers *= 2) {
+        std::cout << std::setw(10) << producers << std::fixed << std::setprecision(2) << std::setw(12)
+                  << RunQueue<LockedQueue>(producers, consumers, items) << std::setw(12)
+                  << RunQueue<Concurrency::MPMCQueue<uint64_t>>(producers, consumers, items) << std::setw(12)
+                  << RunPool<Concurrency::Executor>(producers, consumers, items) << std::setw(12)
+                  << RunPool<Concurrency::WorkStealingExecutor>(producers, consumers, items) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/Epoch.h>
+#include <afina/concurrency/HazardPointer.h>
+
+using namespace Afina;
+
+// Read side cost of memory reclamation: readers keep dereferencing shared pointer while single
+// writer replaces the object every 50us and retires the old one. Compares plain load that never
+// frees anything, epoch critical section per read and per 64 reads, and hazard pointer per read.
+// Total number of reads is the same for every reader count.
+//
+// Usage: runReclaimBench [reads]
+namespace {
+
+struct Payload {
+    explicit Payload(uint64_t v) : value(v) {}
+    uint64_t value;
+    char pad[56];
+};
+
+enum class Mode { kNone, kEpoch, kEpochBatch, kHazard };
+
+const std::size_t kBatch = 64;
+
+uint64_t ReadLoop(Mode mode, std::atomic<Payload *> &current, std::size_t reads) {
+    uint64_t sum = 0;
+    switch (mode) {
+    case Mode::kNone:
+        for (std::size_t i = 0; i < reads; i++) {
+            sum += current.load(std::memory_order_acquire)->value;
+        }
+        break;
+
+    case Mode::kEpoch:
+        for (std::size_t i = 0; i < reads; i++) {
+            Concurrency::EpochDomain::Guard guard(Concurrency::EpochDomain::Global());
+            sum += current.load(std::memory_order_acquire)->value;
+        }
+        break;
+
+    case Mode::kEpochBatch:
+        for (std::size_t i = 0; i < reads; i += kBatch) {
+            Concurrency::EpochDomain::Guard guard(Concurrency::EpochDomain::Global());
+            for (std::size_t j = 0; j < kBatch; j++) {
+                sum += current.load(std::memory_order_acquire)->value;
+            }
+        }
+        break;
+
+    case Mode::kHazard: {
+        Concurrency::HazardDomain::Holder holder(Concurrency::HazardDomain::Global());
+        for (std::size_t i = 0; i < reads; i++) {
+            sum += holder.Protect(current)->value;
+        }
+        break;
+    }
+    }
+    return sum;
+}
+
+double Run(Mode mode, std::size_t readers, std::size_t reads) {
+    std::size_t per_reader = reads / readers / kBatch * kBatch;
+    std::atomic<Payload *> current(new Payload(0));
+    std::atomic<bool> done(false);
+    std::atomic<uint64_t> sink(0);
+
+    // Without reclamation old objects are kept until the end
+    std::vector<Payload *> leaked;
+    std::thread writer([&]() {
+        for (uint64_t v = 1; !done.load(); v++) {
+            Payload *old = current.exchange(new Payload(v));
+            if (mode == Mode::kNone) {
+                leaked.push_back(old);
+            } else if (mode == Mode::kHazard) {
+                Concurrency::HazardDomain::Global().Retire(old);
+            } else {
+                Concurrency::EpochDomain::Global().Retire(old);
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    });
+
+    std::vector<std::thread> pool;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t r = 0; r < readers; r++) {
+        pool.emplace_back([&]() { sink.fetch_add(ReadLoop(mode, current, per_reader)); });
+    }
+    for (auto &t : pool) {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    done.store(true);
+    writer.join();
+    delete current.load();
+    for (auto p : leaked) {
+        delete p;
+    }
+    return per_reader * readers / std::chrono::duration<double>(end - start).count() / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::size_t reads = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000000;
+
+    std::cout << reads << " reads, writer replaces object every 50us, Mreads/s" << std::endl;
+    std::cout << std::setw(10) << "readers" << std::setw(12) << "none" << std::setw(12) << "epoch" << std::setw(12)
+              << "epoch/64" << std::setw(12) << "hazard" << std::endl;
+
+    for (std::size_t readers = 1; readers <= 16; readers *= 2) {
+        std::cout << std::setw(10) << readers << std::fixed << std::setprecision(2) << std::setw(12)
+                  << Run(Mode::kNone, readers, reads) << std::setw(12) << Run(Mode::kEpoch, readers, reads)
+                  << std::setw(12) << Run(Mode::kEpochBatch, readers, reads) << std::setw(12)
+                  << Run(Mode::kHazard, readers, reads) << std::endl;
+    }
+
+    auto &epoch = Concurrency::EpochDomain::Global();
+    auto &hazard = Concurrency::HazardDomain::Global();
+    std::cout << "epoch: retired " << epoch.Retired() << ", reclaimed " << epoch.Reclaimed() << std::endl;
+    std::cout << "hazard: retired " << hazard.Retired() << ", reclaimed " << hazard.Reclaimed() << std::endl;
+    return 0;
+}
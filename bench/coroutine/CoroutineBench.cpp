@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <afina/coroutine/Channel.h>
+#include <afina/coroutine/Engine.h>
+
+using namespace Afina::Coroutine;
+
+// Costs of the coroutine engine itself, for both stack modes:
+// - creation: run() of an empty routine and the whole life of one, cold and with stacks reused
+// - switch: two routines passing control to each other with sched() and yield(), both sitting some
+//   bytes deep in their stacks. Separate stacks should not care about depth, copying ones pay memcpy
+// - memory: resident bytes per parked routine that went some bytes deep before blocking
+// - ping-pong: messages per second through a pair of Channel<int> between two routines
+//
+// Usage: runCoroutineBench [switches] [coroutines]
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const std::size_t kDepths[] = {0, 1024, 4096, 16384, 65536};
+
+const char *Name(Engine::Mode mode) { return mode == Engine::Mode::kSeparateStack ? "separate" : "copy"; }
+
+double NsPer(Clock::time_point start, Clock::time_point end, std::size_t count) {
+    return std::chrono::duration<double, std::nano>(end - start).count() / count;
+}
+
+std::size_t Resident() {
+    std::size_t size = 0, resident = 0;
+    std::ifstream statm("/proc/self/statm");
+    statm >> size >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+// Takes about bytes of stack in 1K frames and calls body at the bottom
+__attribute__((noinline)) void Descend(std::size_t bytes, void (*body)(void *), void *arg) {
+    volatile char frame[1024];
+    frame[0] = 1;
+    if (bytes > sizeof(frame)) {
+        Descend(bytes - sizeof(frame), body, arg);
+    } else {
+        body(arg);
+    }
+
+    // Keeps the frame alive across the call, no tail call either
+    frame[sizeof(frame) - 1] = frame[0];
+}
+
+// Creation
+
+void _empty(std::size_t &done) { done++; }
+
+struct Creation {
+    std::size_t count;
+    std::size_t done = 0;
+    double run_ns[2];
+};
+
+void _creator(Engine &pe, Creation &creation) {
+    // First batch maps stacks, second one takes them from the pool
+    for (int batch = 0; batch < 2; batch++) {
+        std::size_t expected = creation.done + creation.count;
+        Clock::time_point start = Clock::now();
+        for (std::size_t i = 0; i < creation.count; i++) {
+            pe.run(_empty, creation.done);
+        }
+        creation.run_ns[batch] = NsPer(start, Clock::now(), creation.count);
+
+        while (creation.done < expected) {
+            pe.yield();
+        }
+    }
+}
+
+void RunCreation(Engine::Mode mode, std::size_t count) {
+    Engine engine(mode);
+    Creation creation;
+    creation.count = count;
+
+    Clock::time_point start = Clock::now();
+    engine.start(_creator, engine, creation);
+    double life_ns = NsPer(start, Clock::now(), 2 * count);
+
+    std::cout << std::setw(10) << Name(mode) << std::fixed << std::setprecision(1) << std::setw(12)
+              << creation.run_ns[0] << std::setw(12) << creation.run_ns[1] << std::setw(12) << life_ns << std::endl;
+}
+
+// Switch latency
+
+struct Pair;
+
+struct Side {
+    Pair *pair;
+    int index;
+};
+
+struct Pair {
+    Engine *engine;
+    std::size_t depth;
+    std::size_t rounds;
+    bool use_yield;
+    void *routines[2];
+    Side sides[2];
+    Clock::time_point start, end;
+};
+
+void Switch(void *arg) {
+    Side &side = *static_cast<Side *>(arg);
+    Pair &pair = *side.pair;
+    if (side.index == 0) {
+        pair.start = Clock::now();
+    }
+
+    for (std::size_t i = 0; i < pair.rounds; i++) {
+        if (pair.use_yield) {
+            pair.engine->yield();
+        } else {
+            pair.engine->sched(pair.routines[1 - side.index]);
+        }
+    }
+
+    if (side.index == 0) {
+        pair.end = Clock::now();
+    }
+}
+
+void _switcher(Side &side) { Descend(side.pair->depth, Switch, &side); }
+
+void _pair(Engine &pe, Pair &pair) {
+    for (int i = 0; i < 2; i++) {
+        pair.sides[i].pair = &pair;
+        pair.sides[i].index = i;
+        pair.routines[i] = pe.run(_switcher, pair.sides[i]);
+    }
+}
+
+double RunSwitch(Engine::Mode mode, std::size_t depth, std::size_t rounds, bool use_yield) {
+    Engine engine(mode);
+    Pair pair;
+    pair.engine = &engine;
+    pair.depth = depth;
+    pair.rounds = rounds;
+    pair.use_yield = use_yield;
+    engine.start(_pair, engine, pair);
+
+    // Side 0 is done once it has switched rounds times, other side has switched back as many
+    return NsPer(pair.start, pair.end, 2 * rounds);
+}
+
+// Memory per parked coroutine
+
+struct Park {
+    Engine *engine;
+    std::size_t depth;
+    std::size_t parked = 0;
+};
+
+void Block(void *arg) {
+    Park &park = *static_cast<Park *>(arg);
+    park.parked++;
+    park.engine->block();
+}
+
+void _parked(Park &park) { Descend(park.depth, Block, &park); }
+
+void _parker(Engine &pe, Park &park, std::size_t count, std::size_t &bytes) {
+    std::size_t before = Resident();
+    std::vector<void *> routines;
+    routines.reserve(count);
+    for (std::size_t i = 0; i < count; i++) {
+        routines.push_back(pe.run(_parked, park));
+    }
+    while (park.parked < routines.size()) {
+        pe.yield();
+    }
+
+    std::size_t after = Resident();
+    bytes = after > before ? (after - before) / count : 0;
+    for (void *routine : routines) {
+        pe.unblock(routine);
+    }
+}
+
+std::size_t RunMemory(Engine::Mode mode, std::size_t depth, std::size_t count) {
+    Engine engine(mode);
+    Park park;
+    park.engine = &engine;
+    park.depth = depth;
+    std::size_t bytes = 0;
+    engine.start(_parker, engine, park, count, bytes);
+    return bytes;
+}
+
+// Ping-pong through channels
+
+void _ponger(Channel<int> &in, Channel<int> &out) {
+    int value;
+    while (in.receive(value)) {
+        out.send(value + 1);
+    }
+}
+
+void _pinger(Engine &pe, Channel<int> &ping, Channel<int> &pong, std::size_t rounds, double &rate) {
+    pe.run(_ponger, ping, pong);
+
+    Clock::time_point start = Clock::now();
+    int value = 0;
+    for (std::size_t i = 0; i < rounds; i++) {
+        ping.send(value);
+        pong.receive(value);
+    }
+    rate = 2 * rounds / std::chrono::duration<double>(Clock::now() - start).count() / 1e6;
+    ping.close();
+}
+
+double RunPingPong(Engine::Mode mode, std::size_t rounds) {
+    // Channels stay outside of coroutine stacks, copied stacks are only valid while their owner runs
+    Engine engine(mode);
+    Channel<int> ping(engine, 1), pong(engine, 1);
+    double rate = 0;
+    engine.start(_pinger, engine, ping, pong, rounds, rate);
+    return rate;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::size_t switches = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::size_t coroutines = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000;
+    const Engine::Mode modes[] = {Engine::Mode::kSeparateStack, Engine::Mode::kCopyStack};
+
+    std::cout << "creation of " << coroutines << " empty coroutines, ns per coroutine" << std::endl;
+    std::cout << std::setw(10) << "mode" << std::setw(12) << "run cold" << std::setw(12) << "run warm" << std::setw(12)
+              << "lifetime" << std::endl;
+    for (Engine::Mode mode : modes) {
+        RunCreation(mode, coroutines);
+    }
+
+    // Copying stacks costs memcpy of the whole depth, so there are fewer rounds on deep stacks
+    std::cout << std::endl << "switch latency, ns per switch" << std::endl;
+    std::cout << std::setw(10) << "depth";
+    for (Engine::Mode mode : modes) {
+        std::cout << std::setw(16) << std::string(Name(mode)) + " sched" << std::setw(16)
+                  << std::string(Name(mode)) + " yield";
+    }
+    std::cout << std::endl;
+    for (std::size_t depth : kDepths) {
+        std::cout << std::setw(10) << depth << std::fixed << std::setprecision(1);
+        for (Engine::Mode mode : modes) {
+            std::size_t rounds = switches / 2;
+            if (mode == Engine::Mode::kCopyStack) {
+                rounds = std::max<std::size_t>(1000, rounds / (1 + depth / 1024));
+            }
+            std::cout << std::setw(16) << RunSwitch(mode, depth, rounds, false) << std::setw(16)
+                      << RunSwitch(mode, depth, rounds, true);
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << std::endl
+              << "memory of " << coroutines << " parked coroutines, resident bytes per coroutine" << std::endl;
+    std::cout << std::setw(10) << "depth";
+    for (Engine::Mode mode : modes) {
+        std::cout << std::setw(12) << Name(mode);
+    }
+    std::cout << std::endl;
+    for (std::size_t depth : kDepths) {
+        std::cout << std::setw(10) << depth;
+        for (Engine::Mode mode : modes) {
+            std::cout << std::setw(12) << RunMemory(mode, depth, coroutines);
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << std::endl << "channel ping-pong, million messages/s" << std::endl;
+    for (Engine::Mode mode : modes) {
+        std::cout << std::setw(10) << Name(mode) << std::fixed << std::setprecision(2) << std::setw(12)
+                  << RunPingPong(mode, switches / 2) << std::endl;
+    }
+    return 0;
+}
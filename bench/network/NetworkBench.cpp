@@ -0,0 +1,269 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <malloc.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <afina/concurrency/Histogram.h>
+#include <afina/logging/Config.h>
+#include <afina/network/Server.h>
+
+#include "logging/ServiceImpl.h"
+#ifdef AFINA_HAVE_COROUTINES
+#include "network/mt_await/ServerImpl.h"
+#endif
+#include "network/mt_coroutine/ServerImpl.h"
+#include "network/mt_nonblocking/ServerImpl.h"
+#include "network/mt_reuseport/ServerImpl.h"
+#include "network/mt_uring/ServerImpl.h"
+#include "network/st_coroutine/ServerImpl.h"
+#include "network/st_nonblocking/ServerImpl.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+using namespace Afina;
+
+// Closed loop memcached clients against every epoll based server: each connection sends set or get
+// and waits for the reply before the next one, so throughput is bounded by server round trip and
+// latency shows how long a ready connection waits for its turn. Server runs in process on loopback,
+// clients are threads with blocking sockets. Before the load server gets idle connections that have made
+// one request each, resident memory they add is the memory per connection.
+//
+// Usage: runNetworkBench [connections] [seconds] [workers] [idle connections]
+namespace {
+
+const uint16_t kBasePort = 18080;
+const std::size_t kKeys = 512;
+
+struct Result {
+    std::size_t bytes_per_connection = 0;
+    uint64_t requests = 0;
+    uint64_t errors = 0;
+    Concurrency::Histogram::Snapshot latency;
+};
+
+int Connect(uint16_t port) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) {
+        return -1;
+    }
+
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (int attempt = 0; attempt < 100; attempt++) {
+        if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+            int one = 1;
+            setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            return sock;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    close(sock);
+    return -1;
+}
+
+std::size_t Resident() {
+    std::size_t size = 0, resident = 0;
+    std::ifstream statm("/proc/self/statm");
+    statm >> size >> resident;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+// Reads until reply ends with the terminator, false if connection broke
+bool ReadReply(int sock, const char *terminator, std::string &buffer) {
+    std::size_t length = std::strlen(terminator);
+    buffer.clear();
+    char chunk[1024];
+    while (buffer.size() < length || buffer.compare(buffer.size() - length, length, terminator) != 0) {
+        ssize_t n = read(sock, chunk, sizeof(chunk));
+        if (n <= 0) {
+            return false;
+        }
+        buffer.append(chunk, n);
+    }
+    return true;
+}
+
+void Client(uint16_t port, unsigned seed, const std::atomic<bool> &stop, Concurrency::Histogram &latency,
+            std::atomic<uint64_t> &requests, std::atomic<uint64_t> &errors) {
+    int sock = Connect(port);
+    if (sock < 0) {
+        errors++;
+        return;
+    }
+
+    std::string reply;
+    uint64_t done = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+        seed = seed * 1103515245 + 12345;
+        std::string key = "key" + std::to_string((seed >> 8) % kKeys);
+
+        // One write in four, values are fixed size
+        std::string request;
+        const char *terminator;
+        if (((seed >> 4) & 3) == 0) {
+            request = "set " + key + " 0 0 16\r\n0123456789abcdef\r\n";
+            terminator = "STORED\r\n";
+        } else {
+            request = "get " + key + "\r\n";
+            terminator = "END\r\n";
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        if (write(sock, request.data(), request.size()) != ssize_t(request.size()) ||
+            !ReadReply(sock, terminator, reply)) {
+            errors++;
+            break;
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        latency.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        done++;
+    }
+    requests += done;
+    close(sock);
+}
+
+// Resident bytes server spends on an idle connection that has served one request
+std::size_t MemoryPerConnection(uint16_t port, std::size_t idle) {
+    std::vector<int> socks;
+    std::string reply;
+
+    // Heap left by previous servers would hide the cost otherwise
+    malloc_trim(0);
+    std::size_t before = Resident();
+    for (std::size_t i = 0; i < idle; i++) {
+        int sock = Connect(port);
+        if (sock < 0) {
+            break;
+        }
+        socks.push_back(sock);
+
+        const char request[] = "get idle\r\n";
+        if (write(sock, request, sizeof(request) - 1) != sizeof(request) - 1 || !ReadReply(sock, "END\r\n", reply)) {
+            break;
+        }
+    }
+    std::size_t after = Resident();
+
+    for (int sock : socks) {
+        close(sock);
+    }
+    return socks.empty() || after < before ? 0 : (after - before) / socks.size();
+}
+
+Result Run(std::shared_ptr<Network::Server> server, uint16_t port, std::size_t connections, uint32_t workers,
+           double seconds, std::size_t idle) {
+    server->Start(port, 1, workers);
+    std::size_t bytes_per_connection = MemoryPerConnection(port, idle);
+
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> requests(0), errors(0);
+    Concurrency::Histogram latency;
+
+    std::vector<std::thread> clients;
+    for (std::size_t i = 0; i < connections; i++) {
+        clients.emplace_back(Client, port, unsigned(i * 7919 + 1), std::cref(stop), std::ref(latency),
+                             std::ref(requests), std::ref(errors));
+    }
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    stop = true;
+    for (auto &t : clients) {
+        t.join();
+    }
+
+    server->Stop();
+    server->Join();
+
+    Result result;
+    result.bytes_per_connection = bytes_per_connection;
+    result.requests = requests.load();
+    result.errors = errors.load();
+    result.latency = latency.Take();
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::size_t connections = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+    double seconds = argc > 2 ? std::strtod(argv[2], nullptr) : 3;
+    uint32_t workers = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 2;
+    std::size_t idle = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 1000;
+
+    // Commands print every request to stdout, that would be all the benchmark measures
+    std::ostream out(std::cout.rdbuf());
+    std::cout.rdbuf(nullptr);
+
+    std::shared_ptr<Logging::Config> log_config(new Logging::Config);
+    Logging::Appender &console = log_config->appenders["console"];
+    console.type = Logging::Appender::Type::STDERR;
+    console.color = false;
+    Logging::Logger &logger = log_config->loggers["root"];
+    logger.level = Logging::Logger::Level::ERROR;
+    logger.appenders.push_back("console");
+    logger.format = "[%H:%M:%S %z] [thread %t] [%n] [%l] %v";
+
+    std::shared_ptr<Logging::Service> logging(new Logging::ServiceImpl(log_config));
+    logging->Start();
+
+    out << connections << " connections, " << workers << " workers, " << seconds << " s per server, memory of " << idle
+        << " idle connections" << std::endl;
+    out << std::left << std::setw(14) << "network" << std::right << std::setw(12) << "req/s" << std::setw(10)
+        << "mean us" << std::setw(10) << "p50 us" << std::setw(10) << "p99 us" << std::setw(10) << "max us"
+        << std::setw(8) << "errors" << std::setw(12) << "B/conn" << std::endl;
+
+    std::vector<std::string> names = {"st_nonblock",  "mt_nonblock",  "st_coroutine",
+                                      "mt_coroutine", "mt_reuseport", "uring"};
+#ifdef AFINA_HAVE_COROUTINES
+    names.push_back("mt_await");
+#endif
+    for (std::size_t i = 0; i < names.size(); i++) {
+        auto storage = std::make_shared<Backend::ThreadSafeSimplLRU>(1 << 20);
+        std::shared_ptr<Network::Server> server;
+        if (i == 0) {
+            server = std::make_shared<Network::STnonblock::ServerImpl>(storage, logging);
+        } else if (i == 1) {
+            server = std::make_shared<Network::MTnonblock::ServerImpl>(storage, logging);
+        } else if (i == 2) {
+            server = std::make_shared<Network::STcoroutine::ServerImpl>(storage, logging);
+        } else if (i == 3) {
+            server = std::make_shared<Network::MTcoroutine::ServerImpl>(storage, logging);
+        } else if (i == 4) {
+            server = std::make_shared<Network::MTreuseport::ServerImpl>(storage, logging);
+        } else if (i == 5) {
+            server = std::make_shared<Network::MTuring::ServerImpl>(storage, logging);
+        } else {
+#ifdef AFINA_HAVE_COROUTINES
+            server = std::make_shared<Network::MTawait::ServerImpl>(storage, logging);
+#endif
+        }
+
+        // Fresh port for every server, previous one may linger in TIME_WAIT
+        Result result = Run(server, kBasePort + i, connections, workers, seconds, idle);
+        out << std::left << std::setw(14) << names[i] << std::right << std::fixed << std::setprecision(0)
+            << std::setw(12) << result.requests / seconds << std::setprecision(1) << std::setw(10)
+            << result.latency.Mean() / 1000 << std::setw(10) << result.latency.Percentile(0.5) / 1000.0
+            << std::setw(10) << result.latency.Percentile(0.99) / 1000.0 << std::setw(10)
+            << result.latency.max / 1000.0 << std::setw(8) << result.errors << std::setw(12)
+            << result.bytes_per_connection << std::endl;
+    }
+
+    logging->Stop();
+    return 0;
+}
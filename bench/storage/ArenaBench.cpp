@@ -0,0 +1,124 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <afina/allocator/Arena.h>
+#include <afina/allocator/Error.h>
+
+#include "Perf.h"
+#include "storage/SimpleLRU.h"
+
+using namespace Afina;
+
+// Random Get over the LRU populated with small items. Keys and values fit into std::string
+// inline buffer, so whole node lives in the memory it was allocated from
+//
+// Usage: runArenaBench [keys] [gets]
+namespace {
+
+struct Result {
+    double ns_per_get;
+    uint64_t dtlb_misses;
+    bool dtlb_available;
+};
+
+Result Run(std::shared_ptr<Allocator::Arena> arena, const std::vector<std::string> &keys, std::size_t gets) {
+    Backend::SimpleLRU storage(keys.size() * 64, arena);
+    for (auto &key : keys) {
+        if (!storage.Put(key, key)) {
+            throw std::runtime_error("Failed to populate storage");
+        }
+    }
+
+    // Random order is precomputed, so loop below touches storage only
+    std::vector<uint32_t> order(gets);
+    uint64_t x = 88172645463325252ull;
+    for (auto &i : order) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        i = x % keys.size();
+    }
+
+    auto counter = Bench::PerfCounter::DTLBLoadMisses();
+    std::string value;
+    std::size_t found = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    counter.Start();
+    for (auto i : order) {
+        found += storage.Get(keys[i], value);
+    }
+    uint64_t misses = counter.Stop();
+    auto end = std::chrono::steady_clock::now();
+
+    if (found != gets) {
+        throw std::runtime_error("Some keys are lost");
+    }
+
+    Result r;
+    r.ns_per_get = std::chrono::duration<double, std::nano>(end - start).count() / gets;
+    r.dtlb_misses = misses;
+    r.dtlb_available = counter.Available();
+    return r;
+}
+
+void Report(const std::string &name, const Result &r, std::size_t gets) {
+    std::cout << std::left << std::setw(36) << name << std::right << std::setw(10) << std::fixed
+              << std::setprecision(1) << r.ns_per_get << " ns/get";
+    if (r.dtlb_available) {
+        std::cout << std::setw(12) << std::setprecision(3) << double(r.dtlb_misses) / gets << " dTLB misses/get";
+    } else {
+        std::cout << "        dTLB counters n/a";
+    }
+    std::cout << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::size_t n_keys = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    std::size_t n_gets = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 5000000;
+
+    std::vector<std::string> keys;
+    keys.reserve(n_keys);
+    for (std::size_t i = 0; i < n_keys; i++) {
+        keys.push_back("key" + std::to_string(i));
+    }
+
+    std::cout << "keys: " << n_keys << ", gets: " << n_gets << std::endl;
+    Report("heap", Run(nullptr, keys, n_gets), n_gets);
+
+    // Node is ~100 bytes, leave some space for slab headers
+    std::size_t arena_size = n_keys * 128 + (8 << 20);
+    const Allocator::Arena::HugePages modes[] = {Allocator::Arena::HugePages::None,
+                                                 Allocator::Arena::HugePages::Transparent,
+                                                 Allocator::Arena::HugePages::Explicit};
+    const char *names[] = {"arena", "arena+transparent", "arena+explicit"};
+
+    for (int i = 0; i < 3; i++) {
+        for (int prefault = 0; prefault < 2; prefault++) {
+            try {
+                auto arena = std::make_shared<Allocator::Arena>(arena_size, Allocator::Arena::kHugePageSize,
+                                                                modes[i], prefault);
+                std::string name = names[i];
+                if (arena->EffectiveHugePages() != modes[i]) {
+                    name += "(fallback)";
+                }
+                if (prefault) {
+                    name += "+prefault";
+                }
+                Report(name, Run(arena, keys, n_gets), n_gets);
+            } catch (Allocator::AllocError &) {
+                std::cout << names[i] << ": failed to map arena" << std::endl;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/FlatCombineLRU.h"
+#include "storage/OptimisticCuckoo.h"
+#include "storage/ThreadSafeSimpleLRU.h"
+
+using namespace Afina;
+
+// Shared storage under contention: 1 to 64 threads run the same mix of Get and Put over a common
+// key set. Compares single mutex around SimpleLRU with flat combining and with cuckoo hash whose
+// readers take no locks. Total number of operations is the same for every thread count.
+//
+// Usage: runContentionBench [ops] [keys] [get %]
+namespace {
+
+template <typename Storage>
+double Run(std::size_t threads, std::size_t ops, const std::vector<std::string> &keys, unsigned get_percent) {
+    Storage storage(keys.size() * 256);
+    for (auto &key : keys) {
+        storage.Put(key, key);
+    }
+
+    std::size_t per_thread = ops / threads;
+    std::atomic<bool> go(false);
+    std::vector<std::thread> pool;
+    for (std::size_t t = 0; t < threads; t++) {
+        pool.emplace_back([&, t]() {
+            uint64_t x = 88172645463325252ull + t;
+            std::string value;
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            for (std::size_t i = 0; i < per_thread; i++) {
+                x ^= x << 13;
+                x ^= x >> 7;
+                x ^= x << 17;
+                const std::string &key = keys[x % keys.size()];
+                if ((x >> 32) % 100 < get_percent) {
+                    storage.Get(key, value);
+                } else {
+                    storage.Put(key, key);
+                }
+            }
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true);
+    for (auto &t : pool) {
+        t.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return per_thread * threads / std::chrono::duration<double>(end - start).count() / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::size_t ops = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::size_t count = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000;
+    unsigned get_percent = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 90;
+
+    std::vector<std::string> keys;
+    for (std::size_t i = 0; i < count; i++) {
+        keys.push_back("key" + std::to_string(i));
+    }
+
+    std::cout << ops << " ops, " << count << " keys, " << get_percent << "% gets, Mops/s" << std::endl;
+    std::cout << std::setw(10) << "threads" << std::setw(12) << "mutex" << std::setw(12) << "combining" << std::setw(12)
+              << "cuckoo" << std::endl;
+
+    for (std::size_t threads = 1; threads <= 64; threads *= 2) {
+        std::cout << std::setw(10) << threads << std::fixed << std::setprecision(2) << std::setw(12)
+                  << Run<Backend::ThreadSafeSimplLRU>(threads, ops, keys, get_percent) << std::setw(12)
+                  << Run<Backend::FlatCombineLRU>(threads, ops, keys, get_percent) << std::setw(12)
+                  << Run<Backend::OptimisticCuckoo>(threads, ops, keys, get_percent) << std::endl;
+    }
+    return 0;
+}
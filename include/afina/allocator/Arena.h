@@ -0,0 +1,133 @@
+#ifndef AFINA_ALLOCATOR_ARENA_H
+#define AFINA_ALLOCATOR_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <afina/allocator/Stats.h>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * # Memory region for the cache data
+ * Maps one large anonymous region at construction and hands it out in fixed size, size aligned
+ * slabs. Memory is never returned to the OS with munmap until arena destruction, instead slabs
+ * that are no longer in use get released with madvise(MADV_DONTNEED) so that RSS shrinks together
+ * with the cache while the address range stays reserved.
+ *
+ * Region could be backed by 2MB huge pages to reduce TLB misses on random access:
+ * - Transparent: kernel THP, requested with madvise(MADV_HUGEPAGE)
+ * - Explicit: hugetlbfs pages (MAP_HUGETLB), requires vm.nr_hugepages to be reserved. If there
+ *   are not enough pages arena falls back to transparent mode, see EffectiveHugePages
+ *
+ * Arena is not thread safe, callers must synchronize access by themselves
+ */
+class Arena {
+public:
+    enum class HugePages {
+        // Regular 4K pages
+        None,
+
+        // Transparent huge pages
+        Transparent,
+
+        // hugetlbfs pages
+        Explicit
+    };
+
+    // Size of huge page assumed by arena, also default slab size
+    static constexpr std::size_t kHugePageSize = 2 * 1024 * 1024;
+
+    /**
+     * Maps region of the given size, which is rounded up to the slab size.
+     *
+     * @param size number of bytes to reserve
+     * @param slab_size size of a single slab, must be power of two and multiple of page size
+     * @param huge_pages kind of pages to back region with
+     * @param prefault if true all region memory is faulted in right away, so no page faults happen later
+     * @param nodes NUMA nodes to interleave pages over, so that threads on all of them see the same
+     * average latency and no node's memory bandwidth is the bottleneck. Empty keeps the default policy:
+     * page comes from the node of the thread that touches it first
+     */
+    Arena(std::size_t size, std::size_t slab_size = kHugePageSize, HugePages huge_pages = HugePages::None,
+          bool prefault = false, const std::vector<unsigned> &nodes = {});
+    ~Arena();
+
+    /**
+     * Returns slab of SlabSize() bytes aligned by SlabSize(). Throws AllocError in case if
+     * arena has no free slabs anymore
+     */
+    void *AllocSlab();
+
+    /**
+     * Returns slab back to the arena. Arena keeps a single free slab resident to smooth out
+     * alloc/free on the boundary, memory of other free slabs is released back to the OS
+     */
+    void FreeSlab(void *slab);
+
+    /**
+     * Release memory of all free slabs back to the OS
+     */
+    void Trim();
+
+    inline std::size_t Size() const { return _size; }
+    inline std::size_t SlabSize() const { return _slab_size; }
+    inline HugePages EffectiveHugePages() const { return _huge_pages; }
+
+    /**
+     * Number of slabs currently handed out
+     */
+    inline std::size_t UsedSlabs() const { return _used_slabs; }
+
+    /**
+     * Current arena state, slabs are the allocation unit. See Stats.h
+     */
+    Stats stats() const;
+
+    /**
+     * Human readable arena state, one "name value" pair per line
+     */
+    std::string dump() const;
+
+private:
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void Release(void *slab);
+
+    // Sets interleave policy for the whole region
+    void Interleave(const std::vector<unsigned> &nodes);
+
+    // Start of the mapping as returned by mmap
+    void *_map;
+    std::size_t _map_len;
+
+    // Start of the slab aligned area inside of mapping
+    char *_base;
+    std::size_t _size;
+    std::size_t _slab_size;
+    HugePages _huge_pages;
+
+    // Number of NUMA nodes pages are interleaved over, 0 if policy is default
+    std::size_t _interleaved;
+
+    // Slabs that have never been handed out start at _base + _next_slab
+    std::size_t _next_slab;
+    std::size_t _used_slabs;
+
+    // Returned slabs. Free slabs whose memory is still resident are kept on the top of stack
+    std::vector<char *> _free_slabs;
+    std::size_t _resident_free;
+
+    uint64_t _allocs;
+    uint64_t _frees;
+    mutable RateWindow _rates;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_ARENA_H
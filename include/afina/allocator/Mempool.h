@@ -0,0 +1,90 @@
+#ifndef AFINA_ALLOCATOR_MEMPOOL_H
+#define AFINA_ALLOCATOR_MEMPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <afina/allocator/Stats.h>
+
+namespace Afina {
+namespace Allocator {
+
+// Forward declaration, see Arena.h
+class Arena;
+
+/**
+ * # Pool of fixed size objects
+ * Carves objects of the same size out of arena slabs. Each slab starts with a small header that
+ * keeps list of freed objects, so both alloc and free are O(1). Objects are carved lazily, pages
+ * of a fresh slab are not touched until objects are actually allocated there.
+ *
+ * Once the last object of a slab is freed the slab returns to the arena, which releases memory
+ * back to the OS.
+ *
+ * Pool is not thread safe
+ */
+class Mempool {
+public:
+    /**
+     * @param arena to take slabs from, must outlive pool
+     * @param item_size size of objects, will be rounded up to keep objects aligned
+     */
+    Mempool(Arena &arena, std::size_t item_size);
+    ~Mempool();
+
+    /**
+     * Returns memory for a single object. Throws AllocError if arena has no more slabs
+     */
+    void *Alloc();
+
+    /**
+     * Returns object memory back to the pool
+     */
+    void Free(void *ptr);
+
+    inline std::size_t ItemSize() const { return _item_size; }
+
+    /**
+     * Current pool state, see Stats.h. Pool could serve objects of one size only, so external
+     * fragmentation here is the share of slab memory held by free objects: slabs with free objects
+     * can't be returned to the arena
+     */
+    Stats stats() const;
+
+    /**
+     * Human readable pool state, one "name value" pair per line
+     */
+    std::string dump() const;
+
+private:
+    Mempool(const Mempool &) = delete;
+    Mempool &operator=(const Mempool &) = delete;
+
+    struct slab;
+
+    void Link(slab *s);
+    void Unlink(slab *s);
+
+    Arena &_arena;
+    std::size_t _requested_size;
+    std::size_t _item_size;
+
+    // How many objects fits into a single slab
+    std::size_t _items_per_slab;
+
+    // Slabs that have free objects, full slabs are not tracked
+    slab *_partial;
+
+    std::size_t _slabs;
+    std::size_t _items;
+
+    uint64_t _allocs;
+    uint64_t _frees;
+    mutable RateWindow _rates;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_MEMPOOL_H
@@ -7,6 +7,12 @@ namespace Allocator {
 // to avoid expensive macros calculations and increase compile speed
 class Simple;
 
+/**
+ * # Handle of memory allocated by Simple
+ * Points to allocator descriptor rather than to memory itself, so allocator is free to move
+ * data around during defragmentation. Copies of a pointer share descriptor, so all of them
+ * observe relocation, but only the one passed to free() gets reset
+ */
 class Pointer {
 public:
     Pointer();
@@ -17,7 +23,15 @@ public:
     Pointer &operator=(const Pointer &);
     Pointer &operator=(Pointer &&);
 
-    void *get() const { return 0; }
+    void *get() const { return _slot == nullptr ? nullptr : *_slot; }
+
+private:
+    friend class Simple;
+
+    explicit Pointer(void **slot) : _slot(slot) {}
+
+    // Allocator descriptor that holds actual address
+    void **_slot;
 };
 
 } // namespace Allocator
@@ -1,8 +1,11 @@
 #ifndef AFINA_ALLOCATOR_SIMPLE_H
 #define AFINA_ALLOCATOR_SIMPLE_H
 
-#include <string>
 #include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <afina/allocator/Stats.h>
 
 namespace Afina {
 namespace Allocator {
@@ -18,6 +21,9 @@ class Pointer;
  * Allocator instance doesn't take ownership of wrapped memmory and do not delete it
  * on destruction. So caller must take care of resource cleaup after allocator stop
  * being needs
+ *
+ * Blocks grow from the beginning of the area, each one prefixed with a small header. Table of
+ * descriptors that Pointer refers to grows from the end of the area towards blocks
  */
 // TODO: Implements interface to allow usage as C++ allocators
 class Simple {
@@ -25,37 +31,71 @@ public:
     Simple(void *base, const size_t size);
 
     /**
-     * TODO: semantics
+     * Allocates block of at least N bytes using first fit strategy. Throws AllocError with
+     * NoMemory type if there is no free block big enough, defrag() might help in that case
      * @param N size_t
      */
     Pointer alloc(size_t N);
 
     /**
-     * TODO: semantics
+     * Changes size of the block, content is preserved up to the minimum of old and new sizes.
+     * Block grows in place if possible, otherwise it gets moved and all copies of the pointer
+     * observe new address. Empty pointer gets allocated
      * @param p Pointer
      * @param N size_t
      */
     void realloc(Pointer &p, size_t N);
 
     /**
-     * TODO: semantics
+     * Returns block back to the allocator and resets the pointer. Free of empty pointer is no-op
      * @param p Pointer
      */
     void free(Pointer &p);
 
     /**
-     * TODO: semantics
+     * Moves all live blocks to the beginning of the area, so all free space is merged into
+     * a single block
      */
     void defrag();
 
     /**
-     * TODO: semantics
+     * Current allocator state, see Stats.h
+     */
+    Stats stats() const;
+
+    /**
+     * Human readable allocator state, one "name value" pair per line
      */
     std::string dump() const;
 
 private:
+    struct block;
+
+    block *Next(block *b) const;
+    block *FindFree(size_t size);
+    block *AllocBlock(size_t size);
+    void FreeBlock(block *b);
+    void Split(block *b, size_t size);
+    void Merge(block *b);
+    void **AllocSlot();
+    void FreeSlot(void **slot);
+    size_t Wilderness() const;
+
     void *_base;
     const size_t _base_len;
+
+    // Blocks occupy [_first, _top), descriptors occupy [_slots, _end)
+    char *_first;
+    char *_top;
+    void **_slots;
+    void **_end;
+
+    // Chain of free descriptors
+    void **_free_slot;
+
+    uint64_t _allocs;
+    uint64_t _frees;
+    mutable RateWindow _rates;
 };
 
 } // namespace Allocator
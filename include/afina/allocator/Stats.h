@@ -0,0 +1,97 @@
+#ifndef AFINA_ALLOCATOR_STATS_H
+#define AFINA_ALLOCATOR_STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * # Allocator state snapshot
+ * Common set of numbers every allocator reports, so decisions about resize or defragmentation
+ * could be made the same way regardless of allocator type
+ */
+struct Stats {
+    Stats();
+
+    // Bytes under allocator management
+    std::size_t total_bytes;
+
+    // Bytes requested by callers for allocations that are still alive
+    std::size_t live_bytes;
+
+    // Bytes occupied by live allocations, including headers and alignment
+    std::size_t used_bytes;
+
+    // Bytes that could be handed out without growing the allocator
+    std::size_t free_bytes;
+
+    // Size of the biggest allocation that could be served right now
+    std::size_t largest_free;
+
+    // Free bytes per size class, key is class upper bound (power of two)
+    std::map<std::size_t, std::size_t> free_by_class;
+
+    // Lifetime counters
+    uint64_t allocs;
+    uint64_t frees;
+
+    // Operations per second since the previous snapshot, see RateWindow
+    double alloc_rate;
+    double free_rate;
+
+    // Share of used_bytes lost on headers and alignment: (used - live) / used
+    double internal_fragmentation;
+
+    // Share of free_bytes that couldn't be used for the largest allocation: 1 - largest_free / free_bytes
+    double external_fragmentation;
+
+    /**
+     * Size class of the given block
+     */
+    static std::size_t SizeClass(std::size_t size);
+
+    /**
+     * Account free block of the given size
+     */
+    void AddFree(std::size_t size);
+
+    /**
+     * Calculates fragmentation ratios out of counters above
+     */
+    void Finish();
+
+    /**
+     * Text representation, one "name value" pair per line. Prefix is prepended to each name
+     */
+    std::string dump(const std::string &prefix = "") const;
+};
+
+/**
+ * # Rate of alloc/free operations
+ * Remembers counters of the previous snapshot, so rates reflect recent activity rather than average
+ * over allocator lifetime
+ */
+class RateWindow {
+public:
+    RateWindow();
+
+    /**
+     * Fills stats rates and remembers counters for the next call
+     */
+    void Update(Stats &stats);
+
+private:
+    std::chrono::steady_clock::time_point _last;
+    uint64_t _allocs;
+    uint64_t _frees;
+};
+
+} // namespace Allocator
+} // namespace Afina
+
+#endif // AFINA_ALLOCATOR_STATS_H
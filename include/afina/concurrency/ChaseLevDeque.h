@@ -0,0 +1,141 @@
+#ifndef AFINA_CONCURRENCY_CHASE_LEV_DEQUE_H
+#define AFINA_CONCURRENCY_CHASE_LEV_DEQUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Work stealing deque
+ * Chase-Lev deque with memory orders from "Correct and Efficient Work-Stealing for Weak Memory
+ * Models" (Le et al, PPoPP'13). Single owner thread pushes and pops items at the bottom end, any
+ * number of thieves steal from the top end concurrently. Owner operations are wait free and touch
+ * shared state only when deque is about to become empty.
+ *
+ * Buffer grows when full. Old buffers could still be read by a late thief, so they are kept until
+ * deque destruction; with doubling that costs no more than the current buffer size.
+ *
+ * T must be trivially copyable, usually a pointer
+ */
+template <typename T> class ChaseLevDeque {
+public:
+    explicit ChaseLevDeque(std::size_t capacity = 256) : _top(0), _bottom(0) {
+        std::size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        _buffers.emplace_back(new Buffer(size));
+        _buffer.store(_buffers.back().get(), std::memory_order_relaxed);
+    }
+
+    /**
+     * Owner only: place item at the bottom
+     */
+    void Push(T item) {
+        int64_t bottom = _bottom.load(std::memory_order_relaxed);
+        int64_t top = _top.load(std::memory_order_acquire);
+        Buffer *buffer = _buffer.load(std::memory_order_relaxed);
+
+        if (bottom - top > int64_t(buffer->mask)) {
+            buffer = Grow(buffer, top, bottom);
+        }
+
+        buffer->Put(bottom, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        _bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Owner only: take the most recently pushed item, returns false if deque is empty
+     */
+    bool Pop(T &item) {
+        int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+        Buffer *buffer = _buffer.load(std::memory_order_relaxed);
+        _bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = _top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        item = buffer->Get(bottom);
+        if (top == bottom) {
+            // Last item, race with thieves for it
+            bool won = _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    /**
+     * Any thread: take the oldest item. Returns false if deque is empty or another thread won the
+     * race for the same item
+     */
+    bool Steal(T &item) {
+        int64_t top = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = _bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom) {
+            return false;
+        }
+
+        Buffer *buffer = _buffer.load(std::memory_order_acquire);
+        item = buffer->Get(top);
+        return _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+    /**
+     * Approximate, exact only when called by owner with no thieves around
+     */
+    bool Empty() const { return _bottom.load(std::memory_order_relaxed) <= _top.load(std::memory_order_relaxed); }
+
+private:
+    ChaseLevDeque(const ChaseLevDeque &) = delete;
+    ChaseLevDeque &operator=(const ChaseLevDeque &) = delete;
+
+    struct Buffer {
+        explicit Buffer(std::size_t size) : mask(size - 1), items(new std::atomic<T>[size]) {}
+
+        inline T Get(int64_t i) const { return items[i & mask].load(std::memory_order_relaxed); }
+        inline void Put(int64_t i, T item) { items[i & mask].store(item, std::memory_order_relaxed); }
+
+        std::size_t mask;
+        std::unique_ptr<std::atomic<T>[]> items;
+    };
+
+    Buffer *Grow(Buffer *old, int64_t top, int64_t bottom) {
+        _buffers.emplace_back(new Buffer(2 * (old->mask + 1)));
+        Buffer *buffer = _buffers.back().get();
+        for (int64_t i = top; i < bottom; i++) {
+            buffer->Put(i, old->Get(i));
+        }
+
+        _buffer.store(buffer, std::memory_order_release);
+        return buffer;
+    }
+
+    // Thieves side and owner side are written by different threads, keep them apart
+    std::atomic<int64_t> _top;
+    char _pad_top[64 - sizeof(std::atomic<int64_t>)];
+
+    std::atomic<int64_t> _bottom;
+    std::atomic<Buffer *> _buffer;
+    char _pad_bottom[64 - sizeof(std::atomic<int64_t>) - sizeof(std::atomic<Buffer *>)];
+
+    // Current buffer is the last one, owner only
+    std::vector<std::unique_ptr<Buffer>> _buffers;
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_CHASE_LEV_DEQUE_H
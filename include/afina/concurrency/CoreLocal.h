@@ -1,10 +1,156 @@
 #ifndef AFINA_CONCURRENCY_CORE_LOCAL_H
 #define AFINA_CONCURRENCY_CORE_LOCAL_H
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <sched.h>
+#include <unistd.h>
+#include <utility>
+
+// glibc >= 2.35 registers rseq area for every thread and publishes where it is
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__)) && defined(__has_include)
+#if __has_include(<sys/rseq.h>)
+#include <sys/rseq.h>
+#define AFINA_HAVE_RSEQ 1
+#endif
+#endif
+
 namespace Afina {
 namespace Concurrency {
 
-template <typename T> class CoreLocal {};
+namespace detail {
+
+/**
+ * CPU the calling thread runs on. Kernel keeps cpu_id field of the thread rseq area up to date on
+ * every migration, so reading it is a plain load from TLS. Without rseq registration falls back to
+ * sched_getcpu. Result is only a hint: thread could be moved to another CPU right after the call
+ */
+inline unsigned CurrentCpu() {
+#ifdef AFINA_HAVE_RSEQ
+    if (__rseq_size > 0) {
+        auto area = reinterpret_cast<const volatile struct rseq *>(static_cast<char *>(__builtin_thread_pointer()) +
+                                                                   __rseq_offset);
+        int32_t cpu = static_cast<int32_t>(area->cpu_id);
+        if (cpu >= 0) {
+            return static_cast<unsigned>(cpu);
+        }
+    }
+#endif
+    int cpu = sched_getcpu();
+    return cpu >= 0 ? static_cast<unsigned>(cpu) : 0;
+}
+
+} // namespace detail
+
+/**
+ * # Per-CPU instances of T
+ * One instance for every CPU of the machine, each on its own cache lines. Writers touch instance
+ * of the CPU they run on, so as long as threads are not migrating no cache line is shared between
+ * cores and no lock is needed to make it cheap. Readers walk over all instances to aggregate them.
+ *
+ * Since thread could be preempted and moved in the middle of an update, two threads could end up
+ * with the same instance: T must tolerate concurrent access, i.e. be an atomic updated with
+ * relaxed ordering, that is uncontended most of the time
+ */
+template <typename T> class CoreLocal {
+public:
+    static constexpr std::size_t kCacheLine = 64;
+
+    /**
+     * Every instance is constructed from the same args
+     */
+    template <typename... Args> explicit CoreLocal(const Args &... args) : _count(Cpus()) {
+        // operator new only guarantees alignment of max_align_t, align slots by hand
+        _raw = ::operator new(sizeof(Slot) * _count + kCacheLine);
+        std::uintptr_t aligned = (reinterpret_cast<std::uintptr_t>(_raw) + kCacheLine - 1) & ~(kCacheLine - 1);
+        _slots = reinterpret_cast<Slot *>(aligned);
+
+        for (std::size_t i = 0; i < _count; i++) {
+            new (&_slots[i]) Slot(args...);
+        }
+    }
+
+    ~CoreLocal() {
+        for (std::size_t i = 0; i < _count; i++) {
+            _slots[i].~Slot();
+        }
+        ::operator delete(_raw);
+    }
+
+    /**
+     * Instance of the current CPU
+     */
+    T &Local() { return _slots[detail::CurrentCpu() % _count].value; }
+
+    T &At(std::size_t cpu) { return _slots[cpu].value; }
+    const T &At(std::size_t cpu) const { return _slots[cpu].value; }
+
+    /**
+     * Number of instances, equals to the number of configured CPUs
+     */
+    inline std::size_t Size() const { return _count; }
+
+    /**
+     * Calls f(const T &) for every instance
+     */
+    template <typename F> void ForEach(F f) const {
+        for (std::size_t i = 0; i < _count; i++) {
+            f(_slots[i].value);
+        }
+    }
+
+    /**
+     * Folds all instances with f(R, const T &) -> R starting from init
+     */
+    template <typename R, typename F> R Aggregate(R init, F f) const {
+        for (std::size_t i = 0; i < _count; i++) {
+            init = f(init, _slots[i].value);
+        }
+        return init;
+    }
+
+private:
+    CoreLocal(const CoreLocal &) = delete;
+    CoreLocal &operator=(const CoreLocal &) = delete;
+
+    // alignas rounds slot size up to whole number of cache lines
+    struct alignas(kCacheLine) Slot {
+        template <typename... Args> explicit Slot(const Args &... args) : value(args...) {}
+        T value;
+    };
+
+    static std::size_t Cpus() {
+        long cpus = sysconf(_SC_NPROCESSORS_CONF);
+        return cpus > 0 ? static_cast<std::size_t>(cpus) : 1;
+    }
+
+    const std::size_t _count;
+    void *_raw;
+    Slot *_slots;
+};
+
+/**
+ * # Statistics counter spread over CPUs
+ * Add is a relaxed increment of the current CPU slot, Sum walks over all of them and is exact
+ * once writers are quiescent
+ */
+class CoreCounter {
+public:
+    CoreCounter() : _slots(0) {}
+
+    void Add(uint64_t n = 1) { _slots.Local().fetch_add(n, std::memory_order_relaxed); }
+
+    uint64_t Sum() const {
+        return _slots.Aggregate(uint64_t(0), [](uint64_t sum, const std::atomic<uint64_t> &slot) {
+            return sum + slot.load(std::memory_order_relaxed);
+        });
+    }
+
+private:
+    CoreLocal<std::atomic<uint64_t>> _slots;
+};
 
 } // namespace Concurrency
 } // namespace Afina
@@ -0,0 +1,171 @@
+#ifndef AFINA_CONCURRENCY_EPOCH_H
+#define AFINA_CONCURRENCY_EPOCH_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <afina/concurrency/ThreadLocal.h>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Epoch based memory reclamation
+ * Lets lock-free structures free nodes that other threads could still be reading. Readers wrap
+ * every access into a critical section (Guard), writers unlink node first and then Retire it
+ * instead of deleting. Node is freed once every thread that was inside critical section at the
+ * moment of retire has left it.
+ *
+ * Domain keeps global epoch counter, every thread announces epoch it has observed on entering
+ * critical section. Epoch moves forward only when all threads inside critical sections have seen
+ * the current one, so whatever was retired in epoch e is unreachable once global epoch is e + 2.
+ * Retired nodes wait in per-thread lists, no synchronization is needed to retire.
+ *
+ * Reading is just two stores and a fence, but single stalled reader blocks all reclamation, see
+ * HazardDomain for readers that hold references for long.
+ *
+ * Threads that loop forever, like network workers, report Quiescent at iteration boundaries,
+ * which is what drives reclamation for them. Retired nodes of exited threads are taken over by
+ * the domain and freed by whoever reclaims next
+ */
+class EpochDomain {
+    struct Record;
+
+public:
+    using Deleter = void (*)(void *ptr);
+
+    EpochDomain();
+
+    /**
+     * Frees everything retired, no thread must be in critical section
+     */
+    ~EpochDomain();
+
+    /**
+     * Domain shared by all lock-free structures of the process, never destroyed
+     */
+    static EpochDomain &Global();
+
+    /**
+     * Enters critical section, could be nested
+     */
+    void Enter();
+
+    /**
+     * Leaves critical section, pointers read inside are not safe to use anymore
+     */
+    void Leave();
+
+    /**
+     * Critical section for the scope
+     */
+    class Guard {
+    public:
+        explicit Guard(EpochDomain &domain) : _domain(domain), _record(domain.Pin()) {}
+        ~Guard() { _domain.Unpin(_record); }
+
+    private:
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+
+        EpochDomain &_domain;
+        Record *_record;
+    };
+
+    /**
+     * Schedules ptr to be freed by deleter once no reader could see it. Object must be
+     * unreachable for new readers already
+     */
+    void Retire(void *ptr, Deleter deleter);
+
+    template <typename T> void Retire(T *ptr) { Retire(ptr, &DeleteObject<T>); }
+
+    /**
+     * Calling thread holds no pointers obtained in critical sections. Thread staying inside
+     * critical section is moved to the current epoch. Frees whatever is safe to free
+     */
+    void Quiescent();
+
+    /**
+     * Waits until everything the calling thread has retired so far is freed. Spins while other
+     * threads stay in critical sections, must not be called from one
+     */
+    void Synchronize();
+
+    uint64_t Epoch() const { return _epoch.load(std::memory_order_relaxed); }
+
+    /**
+     * Number of objects retired and freed so far
+     */
+    uint64_t Retired() const { return _retired.load(std::memory_order_relaxed); }
+    uint64_t Reclaimed() const { return _reclaimed.load(std::memory_order_relaxed); }
+
+private:
+    EpochDomain(const EpochDomain &) = delete;
+    EpochDomain &operator=(const EpochDomain &) = delete;
+
+    // Retire tries to advance epoch after this number of objects
+    static constexpr unsigned kCollectThreshold = 64;
+
+    struct Garbage {
+        void *ptr;
+        Deleter deleter;
+        uint64_t epoch;
+    };
+
+    // Thread state, lives until thread exits or domain is destroyed
+    struct Record {
+        Record() : state(0), nesting(0), domain(nullptr), since_collect(0) {}
+        ~Record();
+
+        // (epoch << 1) | 1 inside of critical section, 0 outside
+        std::atomic<uint64_t> state;
+        unsigned nesting;
+
+        EpochDomain *domain;
+
+        // Retired by this thread, epochs are non decreasing
+        std::vector<Garbage> limbo;
+        unsigned since_collect;
+    };
+
+    template <typename T> static void DeleteObject(void *ptr) { delete static_cast<T *>(ptr); }
+
+    Record &Local();
+
+    // Enter and Leave for the known record, saves thread local lookup
+    Record *Pin();
+    void Unpin(Record *record);
+
+    // Moves epoch forward if every thread in critical section has seen the current one
+    void TryAdvance();
+
+    // Frees objects that are two epochs behind from the given list
+    void Collect(std::vector<Garbage> &limbo);
+    void CollectOrphans();
+
+    // Announces current epoch for thread in critical section
+    void Announce(Record &record);
+
+    std::atomic<uint64_t> _epoch;
+    std::atomic<uint64_t> _retired;
+    std::atomic<uint64_t> _reclaimed;
+
+    // Left by exited threads
+    std::mutex _orphans_lock;
+    std::vector<Garbage> _orphans;
+    std::atomic<bool> _has_orphans;
+
+    // Set once destructor started, records free their lists right away
+    bool _closing;
+
+    // Must be the last one: records use fields above while being destroyed
+    ThreadLocal<Record> _records;
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_EPOCH_H
@@ -0,0 +1,71 @@
+#ifndef AFINA_CONCURRENCY_EVENT_COUNT_H
+#define AFINA_CONCURRENCY_EVENT_COUNT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Event count
+ * Lets threads sleep until some lock-free condition becomes true, without a mutex on the producer
+ * path. Waiter registers itself, re-checks condition and only then sleeps:
+ *
+ *   auto key = events.PrepareWait();
+ *   if (condition()) { events.CancelWait(); ... } else { events.Wait(key); }
+ *
+ * Producer makes condition true and calls Notify, which costs a single load when nobody waits.
+ * Sleeping is done with futex on the epoch counter, so notification between PrepareWait and Wait
+ * is never lost: Wait returns immediately once epoch has moved.
+ */
+class EventCount {
+public:
+    using Key = uint32_t;
+
+    EventCount() : _epoch(0), _waiters(0) {}
+
+    /**
+     * Registers caller as a waiter, returned key must be passed to Wait or CancelWait
+     */
+    Key PrepareWait();
+
+    /**
+     * Unregisters waiter that found condition true after PrepareWait
+     */
+    void CancelWait();
+
+    /**
+     * Sleeps until notification that happened after PrepareWait or timeout, negative timeout
+     * means no limit. Unregisters waiter, returns false on timeout
+     */
+    bool Wait(Key key, std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
+
+    /**
+     * Wakes up to count waiters if any, with a single syscall
+     */
+    void Notify(int count = 1);
+
+    /**
+     * Wakes up all waiters
+     */
+    void NotifyAll();
+
+private:
+    EventCount(const EventCount &) = delete;
+    EventCount &operator=(const EventCount &) = delete;
+
+    void Bump(int count);
+
+    // Futex word, changes on every notification that found waiters
+    std::atomic<uint32_t> _epoch;
+
+    // Registered waiters, lets Notify skip the syscall
+    std::atomic<uint32_t> _waiters;
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_EVENT_COUNT_H
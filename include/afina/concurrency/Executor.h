@@ -1,13 +1,26 @@
 #ifndef AFINA_CONCURRENCY_EXECUTOR_H
 #define AFINA_CONCURRENCY_EXECUTOR_H
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <condition_variable>
 #include <functional>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <string>
 #include <thread>
+#include <vector>
+
+#include <afina/concurrency/CoreLocal.h>
+#include <afina/concurrency/EventCount.h>
+#include <afina/concurrency/Future.h>
+#include <afina/concurrency/Histogram.h>
+#include <afina/concurrency/MPMCQueue.h>
+#include <afina/concurrency/Task.h>
+#include <afina/concurrency/ThreadLocal.h>
+#include <afina/concurrency/Topology.h>
 
 namespace Afina {
 namespace Concurrency {
@@ -18,8 +31,59 @@ void perform(Executor *executor);
 
 /**
  * # Thread pool
+ * Tasks of the same priority are executed in the order they were submitted. Every priority has its
+ * own queue, a bounded lock-free ring, and idle workers sleep on an event count, so neither
+ * submission nor task execution takes a lock. Queues together hold at most max_queue_size tasks:
+ * submitter reserves room in the shared count before it pushes.
+ *
+ * Workers pick queues by weighted round robin: while all queues have tasks, priority p gets
+ * weights[p] out of every sum(weights) tasks taken. Queue that is empty on its turn passes it to
+ * others in priority order, so workers never idle while there is work and low priority tasks keep
+ * their share under any load of high priority ones.
+ *
+ * Task could have a deadline: if it hasn't started by then it is dropped and its on_expired
+ * callback runs instead
  */
 class Executor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Priority {
+        // Latency critical work, i.e. client requests
+        kHigh,
+
+        // Everything submitted without options
+        kNormal,
+
+        // Background jobs: expiration sweeps, snapshots, defragmentation
+        kLow
+    };
+
+    static constexpr std::size_t kPriorities = 3;
+
+    /**
+     * How task gets scheduled
+     */
+    struct Options {
+        explicit Options(Priority p = Priority::kNormal) : priority(p), deadline(Clock::time_point::max()) {}
+        Options(Priority p, Clock::time_point d, Task expired = nullptr)
+            : priority(p), deadline(d), on_expired(std::move(expired)) {}
+
+        Priority priority;
+
+        // Task that hasn't started by then is dropped, never by default
+        Clock::time_point deadline;
+
+        // Runs on worker thread in place of dropped task, could be empty
+        Task on_expired;
+    };
+
+private:
+    struct Job;
+
+    // Lets Execute and Submit without options tell options from the function
+    template <typename T> struct IsOptions : std::is_same<typename std::decay<T>::type, Options> {};
+
 public:
     enum class State {
         // Threadpool is fully operational, tasks could be added and get executed
@@ -33,7 +97,13 @@ public:
         kStopped
     };
 
-    Executor(int low_watermark, int high_watermark, int max_queue_size, std::chrono::milliseconds idle_time);
+    /**
+     * Zero weight counts as one, so every priority makes progress. Threads are restricted to cpus if
+     * not empty, see Placement. Throws std::invalid_argument unless max_queue_size is positive
+     */
+    Executor(int low_watermark, int high_watermark, int max_queue_size, std::chrono::milliseconds idle_time,
+             const std::array<unsigned, kPriorities> &weights = {{8, 4, 1}},
+             const std::vector<unsigned> &cpus = {});
     ~Executor() { Stop(true); }
 
     /**
@@ -42,24 +112,75 @@ public:
      *
      * That function doesn't wait for function result. Function could always be written in a way to notify caller about
      * execution finished by itself
+     *
+     * Function and arguments are moved into the queue slot, small tasks are placed there without any allocation,
+     * see Task.h. Task gets normal priority and no deadline
      */
-    template <typename F, typename... Types> bool Execute(F &&func, Types... args) {
-        // Prepare "task"
-        auto exec = std::bind(std::forward<F>(func), std::forward<Types>(args)...);
+    template <typename F, typename... Types, typename = typename std::enable_if<!IsOptions<F>::value>::type>
+    bool Execute(F &&func, Types &&... args) {
+        return Post(Options(), MakeTask(std::forward<F>(func), std::forward<Types>(args)...));
+    }
+
+    /**
+     * Same as above with the given priority and deadline
+     */
+    template <typename F, typename... Types> bool Execute(Options options, F &&func, Types &&... args) {
+        return Post(std::move(options), MakeTask(std::forward<F>(func), std::forward<Types>(args)...));
+    }
 
-        std::unique_lock<std::mutex> lock(this->_mutex);
-        if ((_state != State::kRun) || (_tasks.size() >= _max_queue_size)) {
-            return false;
+    /**
+     * Same as Execute, but result of the function or exception it has thrown is delivered through
+     * the returned future. Future is not valid if task wasn't accepted
+     */
+    template <typename F, typename... Types, typename = typename std::enable_if<!IsOptions<F>::value>::type>
+    Future<typename detail::BoundCall<typename std::decay<F>::type, typename std::decay<Types>::type...>::Result>
+    Submit(F &&func, Types &&... args) {
+        return Submit(Options(), std::forward<F>(func), std::forward<Types>(args)...);
+    }
+
+    /**
+     * Same as above with the given priority and deadline, future of expired task is broken with
+     * std::future_errc::broken_promise
+     */
+    template <typename F, typename... Types>
+    Future<typename detail::BoundCall<typename std::decay<F>::type, typename std::decay<Types>::type...>::Result>
+    Submit(Options options, F &&func, Types &&... args) {
+        auto call = MakeTask(std::forward<F>(func), std::forward<Types>(args)...);
+        using Result = typename decltype(call)::Result;
+
+        Promise<Result> promise;
+        Future<Result> future = promise.GetFuture();
+        if (!Post(std::move(options), detail::Fulfil<Result, decltype(call)>(std::move(promise), std::move(call)))) {
+            return Future<Result>();
+        }
+        return future;
+    }
+
+    /**
+     * Runs func(0), ..., func(count - 1) on the pool, e.g. one task per shard. Tasks get into the
+     * queue with a single operation and idle workers are woken up at once. Either all of tasks are
+     * accepted or none, in the latter case result is empty. See WhenAll to wait for all of them
+     */
+    template <typename F>
+    std::vector<Future<typename std::result_of<F &(std::size_t)>::type>>
+    SubmitBatch(std::size_t count, F func, Priority priority = Priority::kNormal) {
+        using Result = typename std::result_of<F &(std::size_t)>::type;
+        using Call = detail::BoundCall<F, std::size_t>;
+
+        std::vector<Future<Result>> futures;
+        std::vector<Task> tasks;
+        futures.reserve(count);
+        tasks.reserve(count);
+        for (std::size_t i = 0; i < count; i++) {
+            Promise<Result> promise;
+            futures.push_back(promise.GetFuture());
+            tasks.emplace_back(detail::Fulfil<Result, Call>(std::move(promise), Call(func, i)));
         }
 
-        // Enqueue new task
-        _tasks.push_back(exec);
-        if ((_active_workers < _high_watermark) && (_free_workers == 0)) {
-            std::thread(&perform, this).detach();
-            _active_workers += 1;
+        if (!ExecuteBatch(priority, tasks.data(), count)) {
+            futures.clear();
         }
-        _empty_condition.notify_one();
-        return true;
+        return futures;
     }
 
     /**
@@ -70,6 +191,32 @@ public:
      */
     void Stop(bool await = false);
 
+    /**
+     * Number of tasks executed so far. Exact once pool is stopped, otherwise could miss tasks of
+     * the thread that is exiting right now
+     */
+    uint64_t Completed() const;
+
+    /**
+     * Number of tasks executed by each running thread
+     */
+    std::vector<uint64_t> CompletedPerThread() const;
+
+    /**
+     * Pool load, one "name value" pair per line, each name starts with prefix:
+     * - threads, threads_active, threads_free: workers now, running task and waiting for one
+     * - threads_spawned, threads_retired: threads started and exited after idle_time so far
+     * - active_avg: run time of finished tasks over pool lifetime, i.e. how many threads are busy
+     *   on average; tasks still running are not there yet
+     * - tasks_completed, tasks_rejected: executed and refused because queue was full
+     * - tasks_expired: dropped because of deadline
+     * - queued_high, queued_normal, queued_low: tasks waiting in each queue
+     * - queue_wait_us_*, run_us_*: time tasks spent in queue and running, mean and percentiles
+     *
+     * Safe to call from any thread while pool is alive
+     */
+    std::string DumpStats(const std::string &prefix = "") const;
+
 private:
     // No copy/move/assign allowed
     Executor(const Executor &);            // = delete;
@@ -83,39 +230,118 @@ private:
     friend void perform(Executor *executor);
 
     /**
-     * Mutex to protect state below from concurrent modification
+     * Starts one more thread unless there are high_watermark already
      */
-    std::mutex _mutex;
+    void Spawn();
 
     /**
-     * Conditional variable to await new data in case of empty queue
+     * Queues task with given options, wakes up or starts a worker
      */
-    std::condition_variable _empty_condition;
+    bool Post(Options &&options, Task task);
 
-    std::condition_variable _stop_condition;
+    /**
+     * Queues all of tasks or none of them
+     */
+    bool ExecuteBatch(Priority priority, Task *tasks, std::size_t count);
+
+    /**
+     * Takes task from the queue whose turn it is, or from any other, turn is the worker cursor in
+     * _schedule
+     */
+    bool Pop(Job &job, std::size_t &turn);
+
+    /**
+     * Claims room for count tasks in the shared bound, false if they don't fit
+     */
+    bool Reserve(int count);
+
+    /**
+     * All queues are empty
+     */
+    bool Empty() const;
+
+    /**
+     * Called by exiting thread
+     */
+    void Finish();
+
+    // Task waiting in queue
+    struct Job {
+        Job() = default;
+        Job(Task t, Clock::time_point q, Clock::time_point d, Task e)
+            : task(std::move(t)), queued(q), deadline(d), on_expired(std::move(e)) {}
+
+        Task task;
+        Clock::time_point queued;
+        Clock::time_point deadline;
+        Task on_expired;
+    };
 
     /**
-     * Vector of actual threads that perorm execution
+     * Task queue of every priority
      */
-    std::vector<std::thread> _threads;
+    std::unique_ptr<MPMCQueue<Job>> _tasks[kPriorities];
 
     /**
-     * Task queue
+     * Weighted round robin order of queues, smoothed so that turns of every queue are spread evenly
      */
-    std::deque<std::function<void()>> _tasks;
+    std::vector<std::size_t> _schedule;
+
+    /**
+     * Idle workers wait there for new tasks
+     */
+    EventCount _empty_condition;
+
+    /**
+     * Slow path only: waiting for threads to exit on stop
+     */
+    std::mutex _mutex;
+    std::condition_variable _stop_condition;
 
     /**
      * Flag to stop bg threads
      */
-    State _state;
+    std::atomic<State> _state;
 
     int _low_watermark;
     int _high_watermark;
     int _max_queue_size;
     std::chrono::milliseconds _idle_time;
 
-    int _active_workers;
-    int _free_workers;
+    // Every thread pins itself to these CPUs on start
+    std::vector<unsigned> _cpus;
+
+    // Threads that are going to process tasks, i.e not about to exit
+    std::atomic<int> _workers;
+
+    // Threads running task at the moment and threads looking for a task
+    std::atomic<int> _active_workers;
+    std::atomic<int> _free_workers;
+
+    // Threads that still could touch the pool, decremented under _mutex on thread exit
+    std::atomic<int> _threads;
+
+    // Execute calls on the way to the queue
+    std::atomic<int> _submitting;
+
+    // Tasks in all queues plus room reserved by submitters, never above _max_queue_size
+    std::atomic<int> _queued;
+
+    // Tasks executed by running threads, updated only by owner
+    ThreadLocal<std::atomic<uint64_t>> _completed;
+
+    // Tasks executed by threads that have exited
+    std::atomic<uint64_t> _retired_completed;
+
+    // Instrumentation, written without locks by submitters and workers
+    Clock::time_point _created;
+    Histogram _queue_wait;
+    Histogram _run_time;
+    CoreCounter _busy_ns;
+    CoreCounter _rejected;
+    CoreCounter _expired;
+    std::atomic<uint64_t> _spawned;
+    std::atomic<uint64_t> _retired;
 };
 } // namespace Concurrency
 } // namespace Afina
@@ -1,10 +1,162 @@
 #ifndef AFINA_CONCURRENCY_FLAT_COMBINE_H
 #define AFINA_CONCURRENCY_FLAT_COMBINE_H
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
 namespace Afina {
 namespace Concurrency {
 
-template <typename Op> class FlatCombine {};
+/**
+ * # Flat combining
+ * Serializes operations over a sequential data structure without making every thread fight for
+ * its lock (Hendler et al, "Flat Combining and the Synchronization-Parallelism Tradeoff"). Thread
+ * publishes its operation into a slot and waits. Whoever manages to take the combiner role scans
+ * all slots and passes every pending operation to the combiner function in one batch, so the data
+ * structure stays hot in a single core cache and the lock changes hands once per batch instead of
+ * once per operation.
+ *
+ * Slots are not bound to threads: operation takes any free slot, starting from the one picked by
+ * thread id, and releases it as soon as result is ready. So threads could come and go freely and
+ * the number of slots only limits the batch size.
+ *
+ * Combiner function runs with the combiner role held and must not throw, it is supposed to store
+ * results into operations themselves
+ */
+template <typename Op> class FlatCombine {
+public:
+    using Combiner = std::function<void(Op *const *ops, std::size_t count)>;
+
+    /**
+     * @param combiner applies batch of operations to the underlying structure
+     * @param slots maximum number of operations published at once
+     */
+    explicit FlatCombine(Combiner combiner, std::size_t slots = 64)
+        : _combiner(std::move(combiner)), _slots(new Slot[slots > 0 ? slots : 1]), _count(slots > 0 ? slots : 1),
+          _lock(false), _batches(0), _combined(0) {
+        for (std::size_t i = 0; i < _count; i++) {
+            _slots[i].state.store(0, std::memory_order_relaxed);
+        }
+        _batch.reserve(_count);
+        _batch_slots.reserve(_count);
+    }
+
+    /**
+     * Blocks until op is executed by the combiner, which could be the calling thread itself
+     */
+    void Apply(Op &op) {
+        static_assert(alignof(Op) > 1, "lowest bit of operation address marks completion");
+        const uintptr_t pending = reinterpret_cast<uintptr_t>(&op);
+        const uintptr_t done = pending | 1;
+
+        Slot &slot = Publish(pending);
+
+        unsigned spins = 0;
+        while (slot.state.load(std::memory_order_acquire) != done) {
+            if (!_lock.load(std::memory_order_relaxed) && !_lock.exchange(true, std::memory_order_acquire)) {
+                Combine();
+                _lock.store(false, std::memory_order_release);
+                continue;
+            }
+
+            if (++spins > kSpins) {
+                std::this_thread::yield();
+            }
+        }
+
+        slot.state.store(0, std::memory_order_release);
+    }
+
+    /**
+     * Number of combining passes that found some work
+     */
+    uint64_t Batches() const { return _batches.load(std::memory_order_relaxed); }
+
+    /**
+     * Number of operations executed, Combined() / Batches() gives average batch size
+     */
+    uint64_t Combined() const { return _combined.load(std::memory_order_relaxed); }
+
+private:
+    FlatCombine(const FlatCombine &) = delete;
+    FlatCombine &operator=(const FlatCombine &) = delete;
+
+    // Busy waiting before yielding CPU to others
+    static constexpr unsigned kSpins = 64;
+
+    // Combiner rescans slots a few times to pick up operations published during the pass
+    static constexpr unsigned kPasses = 3;
+
+    // Free slot is 0, published operation is its address, completed is address | 1
+    struct Slot {
+        std::atomic<uintptr_t> state;
+        char pad[64 - sizeof(std::atomic<uintptr_t>)];
+    };
+
+    Slot &Publish(uintptr_t pending) {
+        static thread_local std::size_t home = std::hash<std::thread::id>()(std::this_thread::get_id());
+
+        for (std::size_t i = home % _count;; i = (i + 1) % _count) {
+            uintptr_t expected = 0;
+            if (_slots[i].state.load(std::memory_order_relaxed) == 0 &&
+                _slots[i].state.compare_exchange_strong(expected, pending, std::memory_order_release,
+                                                        std::memory_order_relaxed)) {
+                return _slots[i];
+            }
+
+            // All slots are busy, give their owners a chance
+            if ((i + 1) % _count == home % _count) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void Combine() {
+        for (unsigned pass = 0; pass < kPasses; pass++) {
+            _batch.clear();
+            _batch_slots.clear();
+            for (std::size_t i = 0; i < _count; i++) {
+                uintptr_t state = _slots[i].state.load(std::memory_order_acquire);
+                if (state != 0 && (state & 1) == 0) {
+                    _batch.push_back(reinterpret_cast<Op *>(state));
+                    _batch_slots.push_back(i);
+                }
+            }
+
+            if (_batch.empty()) {
+                return;
+            }
+
+            _combiner(_batch.data(), _batch.size());
+            for (std::size_t i = 0; i < _batch.size(); i++) {
+                _slots[_batch_slots[i]].state.store(reinterpret_cast<uintptr_t>(_batch[i]) | 1,
+                                                    std::memory_order_release);
+            }
+
+            _batches.fetch_add(1, std::memory_order_relaxed);
+            _combined.fetch_add(_batch.size(), std::memory_order_relaxed);
+        }
+    }
+
+    Combiner _combiner;
+
+    std::unique_ptr<Slot[]> _slots;
+    const std::size_t _count;
+
+    // Combiner role
+    std::atomic<bool> _lock;
+
+    // Combiner only, preallocated to slots count
+    std::vector<Op *> _batch;
+    std::vector<std::size_t> _batch_slots;
+
+    std::atomic<uint64_t> _batches;
+    std::atomic<uint64_t> _combined;
+};
 
 } // namespace Concurrency
 } // namespace Afina
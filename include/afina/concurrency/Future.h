@@ -0,0 +1,353 @@
+#ifndef AFINA_CONCURRENCY_FUTURE_H
+#define AFINA_CONCURRENCY_FUTURE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <afina/concurrency/EventCount.h>
+#include <afina/concurrency/Task.h>
+
+namespace Afina {
+namespace Concurrency {
+
+namespace detail {
+
+/**
+ * State shared by promise and future. Completion is a single atomic flag word, waiters sleep on
+ * event count, and the only continuation is kept in a Task, so there is no mutex per result
+ */
+class FutureStateBase {
+public:
+    FutureStateBase() : _flags(0) {}
+
+    bool Ready() const { return (_flags.load(std::memory_order_acquire) & kReady) != 0; }
+
+    void Wait() {
+        while (!Ready()) {
+            auto key = _done.PrepareWait();
+            if (Ready()) {
+                _done.CancelWait();
+                return;
+            }
+            _done.Wait(key);
+        }
+    }
+
+    bool WaitFor(std::chrono::milliseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!Ready()) {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) {
+                return false;
+            }
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now);
+            if (left.count() == 0) {
+                left = std::chrono::milliseconds(1);
+            }
+
+            auto key = _done.PrepareWait();
+            if (Ready()) {
+                _done.CancelWait();
+                return true;
+            }
+            _done.Wait(key, left);
+        }
+        return true;
+    }
+
+    void SetException(std::exception_ptr error) {
+        _error = std::move(error);
+        Complete();
+    }
+
+    // Runs callback once result is set, right away if it is set already. Only one per state
+    void OnReady(Task callback) {
+        _callback = std::move(callback);
+        if ((_flags.fetch_or(kCallback, std::memory_order_acq_rel) & kReady) != 0) {
+            RunCallback();
+        }
+    }
+
+protected:
+    // Result must be stored before
+    void Complete() {
+        uint32_t flags = _flags.fetch_or(kReady, std::memory_order_acq_rel);
+        _done.NotifyAll();
+        if ((flags & kCallback) != 0) {
+            RunCallback();
+        }
+    }
+
+    void Rethrow() {
+        if (_error) {
+            std::rethrow_exception(_error);
+        }
+    }
+
+private:
+    static constexpr uint32_t kReady = 1;
+    static constexpr uint32_t kCallback = 2;
+
+    void RunCallback() {
+        // Callback could hold the last references to other states, they are released right here
+        Task callback = std::move(_callback);
+        callback();
+    }
+
+    std::atomic<uint32_t> _flags;
+    EventCount _done;
+    std::exception_ptr _error;
+    Task _callback;
+};
+
+template <typename T> class FutureState : public FutureStateBase {
+public:
+    FutureState() : _has_value(false) {}
+    ~FutureState() {
+        if (_has_value) {
+            Value()->~T();
+        }
+    }
+
+    template <typename... Args> void SetValue(Args &&... args) {
+        new (&_storage) T(std::forward<Args>(args)...);
+        _has_value = true;
+        Complete();
+    }
+
+    T Take() {
+        Rethrow();
+        return std::move(*Value());
+    }
+
+private:
+    T *Value() { return reinterpret_cast<T *>(&_storage); }
+
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type _storage;
+    bool _has_value;
+};
+
+template <> class FutureState<void> : public FutureStateBase {
+public:
+    void SetValue() { Complete(); }
+
+    void Take() { Rethrow(); }
+};
+
+} // namespace detail
+
+template <typename T> class Promise;
+
+/**
+ * # Result of asynchronous call
+ * Move-only handle to the result of Promise. Get waits for the result and takes it out, so it
+ * could be called once. Future made by default constructor is not valid and must not be waited for
+ */
+template <typename T> class Future {
+public:
+    Future() = default;
+    Future(Future &&) = default;
+    Future &operator=(Future &&) = default;
+
+    bool Valid() const { return _state != nullptr; }
+
+    /**
+     * True once result or exception is set
+     */
+    bool Ready() const { return _state->Ready(); }
+
+    void Wait() const { _state->Wait(); }
+
+    /**
+     * Returns false if result is not ready after timeout
+     */
+    bool WaitFor(std::chrono::milliseconds timeout) const { return _state->WaitFor(timeout); }
+
+    /**
+     * Waits for result and moves it out, rethrows exception the promise was broken with
+     */
+    T Get() {
+        _state->Wait();
+        std::shared_ptr<detail::FutureState<T>> state = std::move(_state);
+        return state->Take();
+    }
+
+    /**
+     * Runs callback on the thread that sets result, or right now if result is ready already. Could
+     * be called once per future, callback must not throw
+     */
+    void OnReady(Task callback) { _state->OnReady(std::move(callback)); }
+
+private:
+    Future(const Future &) = delete;
+    Future &operator=(const Future &) = delete;
+
+    friend class Promise<T>;
+
+    explicit Future(std::shared_ptr<detail::FutureState<T>> state) : _state(std::move(state)) {}
+
+    std::shared_ptr<detail::FutureState<T>> _state;
+};
+
+/**
+ * # Producer side of Future
+ * Result is set once, by SetValue or SetException. Promise destroyed without result breaks its
+ * future with std::future_errc::broken_promise
+ */
+template <typename T> class Promise {
+public:
+    Promise() : _state(std::make_shared<detail::FutureState<T>>()), _retrieved(false) {}
+    Promise(Promise &&) = default;
+    Promise &operator=(Promise &&) = default;
+
+    ~Promise() {
+        if (_state != nullptr) {
+            _state->SetException(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+        }
+    }
+
+    /**
+     * Future for this promise, could be taken once
+     */
+    Future<T> GetFuture() {
+        if (_retrieved) {
+            throw std::future_error(std::future_errc::future_already_retrieved);
+        }
+        _retrieved = true;
+        return Future<T>(_state);
+    }
+
+    /**
+     * Constructs result from arguments, nothing for Promise<void>, and wakes up the future
+     */
+    template <typename... Args> void SetValue(Args &&... args) {
+        std::shared_ptr<detail::FutureState<T>> state = std::move(_state);
+        state->SetValue(std::forward<Args>(args)...);
+    }
+
+    void SetException(std::exception_ptr error) {
+        std::shared_ptr<detail::FutureState<T>> state = std::move(_state);
+        state->SetException(std::move(error));
+    }
+
+private:
+    Promise(const Promise &) = delete;
+    Promise &operator=(const Promise &) = delete;
+
+    std::shared_ptr<detail::FutureState<T>> _state;
+    bool _retrieved;
+};
+
+namespace detail {
+
+/**
+ * Runs call and passes its result or exception into promise, what executors put into the queue
+ */
+template <typename R, typename F> class Fulfil {
+public:
+    Fulfil(Promise<R> promise, F call) : _promise(std::move(promise)), _call(std::move(call)) {}
+    Fulfil(Fulfil &&) = default;
+
+    void operator()() {
+        try {
+            Set(std::is_void<R>());
+        } catch (...) {
+            _promise.SetException(std::current_exception());
+        }
+    }
+
+private:
+    void Set(std::false_type) { _promise.SetValue(_call()); }
+
+    void Set(std::true_type) {
+        _call();
+        _promise.SetValue();
+    }
+
+    Promise<R> _promise;
+    F _call;
+};
+
+// Results of all futures, or first exception in their order
+template <typename T> struct Join {
+    using Result = std::vector<T>;
+
+    explicit Join(std::vector<Future<T>> &&all) : futures(std::move(all)), pending(futures.size()) {}
+
+    void Finish() {
+        try {
+            Result result;
+            result.reserve(futures.size());
+            for (auto &future : futures) {
+                result.push_back(future.Get());
+            }
+            promise.SetValue(std::move(result));
+        } catch (...) {
+            promise.SetException(std::current_exception());
+        }
+    }
+
+    std::vector<Future<T>> futures;
+    std::atomic<std::size_t> pending;
+    Promise<Result> promise;
+};
+
+template <> struct Join<void> {
+    using Result = void;
+
+    explicit Join(std::vector<Future<void>> &&all) : futures(std::move(all)), pending(futures.size()) {}
+
+    void Finish() {
+        try {
+            for (auto &future : futures) {
+                future.Get();
+            }
+            promise.SetValue();
+        } catch (...) {
+            promise.SetException(std::current_exception());
+        }
+    }
+
+    std::vector<Future<void>> futures;
+    std::atomic<std::size_t> pending;
+    Promise<void> promise;
+};
+
+} // namespace detail
+
+/**
+ * Future that becomes ready once all of given ones are. Holds vector of results in the same order,
+ * or nothing for void futures, or the exception of the first failed future in that order. Nobody
+ * waits while futures are pending: the last one to complete assembles the result
+ */
+template <typename T>
+Future<typename detail::Join<T>::Result> WhenAll(std::vector<Future<T>> futures) {
+    auto join = std::make_shared<detail::Join<T>>(std::move(futures));
+    auto result = join->promise.GetFuture();
+    if (join->futures.empty()) {
+        join->Finish();
+        return result;
+    }
+
+    for (auto &future : join->futures) {
+        future.OnReady([join]() {
+            if (join->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                join->Finish();
+            }
+        });
+    }
+    return result;
+}
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_FUTURE_H
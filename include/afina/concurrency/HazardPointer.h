@@ -0,0 +1,161 @@
+#ifndef AFINA_CONCURRENCY_HAZARD_POINTER_H
+#define AFINA_CONCURRENCY_HAZARD_POINTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <afina/concurrency/ThreadLocal.h>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Hazard pointers
+ * Memory reclamation for readers that hold references for long or could stall, where a single
+ * slow reader must not stop reclamation as it does with EpochDomain (Michael, "Hazard Pointers:
+ * Safe Memory Reclamation for Lock-Free Objects").
+ *
+ * Reader publishes pointer it is going to dereference in one of its hazard slots (Holder) and
+ * re-checks that it is still reachable. Writer retires unlinked object, which is freed once no
+ * slot of any thread points to it. Retired objects are kept in per-thread lists and scanned
+ * against all slots when list grows large, so every reader can block at most a bounded number
+ * of objects.
+ *
+ * Protection costs a store and a full fence per pointer, more than epochs, and each thread has
+ * only kSlots slots
+ */
+class HazardDomain {
+public:
+    using Deleter = void (*)(void *ptr);
+
+    // Hazard slots per thread
+    static constexpr std::size_t kSlots = 4;
+
+    HazardDomain();
+
+    /**
+     * Frees everything retired, no thread must hold protected pointers
+     */
+    ~HazardDomain();
+
+    /**
+     * Domain shared by all lock-free structures of the process, never destroyed
+     */
+    static HazardDomain &Global();
+
+    /**
+     * Owns one hazard slot of the calling thread for its lifetime, must not be passed to other
+     * threads
+     */
+    class Holder {
+    public:
+        /**
+         * Throws std::runtime_error if thread already uses all its slots
+         */
+        explicit Holder(HazardDomain &domain);
+        ~Holder();
+
+        /**
+         * Loads pointer from source and keeps it from being freed until Reset or another Protect
+         */
+        template <typename T> T *Protect(const std::atomic<T *> &source) {
+            T *ptr = source.load(std::memory_order_relaxed);
+            for (;;) {
+                _slot->store(ptr, std::memory_order_seq_cst);
+
+                // Object could have been retired before slot became visible to scanners
+                T *current = source.load(std::memory_order_seq_cst);
+                if (current == ptr) {
+                    return ptr;
+                }
+                ptr = current;
+            }
+        }
+
+        void Reset() { _slot->store(nullptr, std::memory_order_release); }
+
+    private:
+        Holder(const Holder &) = delete;
+        Holder &operator=(const Holder &) = delete;
+
+        std::atomic<void *> *_slot;
+        unsigned *_used;
+        unsigned _index;
+    };
+
+    /**
+     * Schedules ptr to be freed by deleter once no hazard slot points to it. Object must be
+     * unreachable for new readers already
+     */
+    void Retire(void *ptr, Deleter deleter);
+
+    template <typename T> void Retire(T *ptr) { Retire(ptr, &DeleteObject<T>); }
+
+    /**
+     * Frees every object retired by the calling thread or by exited threads that is not
+     * protected at the moment
+     */
+    void Scan();
+
+    /**
+     * Number of objects retired and freed so far
+     */
+    uint64_t Retired() const { return _retired.load(std::memory_order_relaxed); }
+    uint64_t Reclaimed() const { return _reclaimed.load(std::memory_order_relaxed); }
+
+private:
+    HazardDomain(const HazardDomain &) = delete;
+    HazardDomain &operator=(const HazardDomain &) = delete;
+
+    // Retire scans once list is that long or twice the number of all slots, whatever is bigger
+    static constexpr std::size_t kScanThreshold = 64;
+
+    struct Garbage {
+        void *ptr;
+        Deleter deleter;
+    };
+
+    // Thread state, lives until thread exits or domain is destroyed
+    struct Record {
+        Record() : used(0), domain(nullptr) {
+            for (auto &slot : hazards) {
+                slot.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+        ~Record();
+
+        std::atomic<void *> hazards[kSlots];
+
+        // Bit per slot taken by Holder
+        unsigned used;
+
+        HazardDomain *domain;
+        std::vector<Garbage> retired;
+    };
+
+    template <typename T> static void DeleteObject(void *ptr) { delete static_cast<T *>(ptr); }
+
+    Record &Local();
+
+    std::atomic<uint64_t> _retired;
+    std::atomic<uint64_t> _reclaimed;
+
+    // Left by exited threads
+    std::mutex _orphans_lock;
+    std::vector<Garbage> _orphans;
+    std::atomic<bool> _has_orphans;
+
+    // Set once destructor started, records free their lists right away
+    bool _closing;
+
+    // Must be the last one: records use fields above while being destroyed
+    ThreadLocal<Record> _records;
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_HAZARD_POINTER_H
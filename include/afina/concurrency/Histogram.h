@@ -0,0 +1,137 @@
+#ifndef AFINA_CONCURRENCY_HISTOGRAM_H
+#define AFINA_CONCURRENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <afina/concurrency/CoreLocal.h>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Lock-free histogram of non negative values
+ * Log-linear buckets: values below kLinear have a bucket each, every power of two above is split
+ * into kSubBuckets equal parts, so bucket bound overestimates value by less than 1 / kSubBuckets.
+ * Whole uint64_t range fits in kBuckets.
+ *
+ * Record is a few relaxed increments of the current CPU cells, see CoreLocal. Snapshot sums cells
+ * of all CPUs and is exact once writers are quiescent
+ */
+class Histogram {
+public:
+    static constexpr std::size_t kSubBits = 2;
+    static constexpr std::size_t kSubBuckets = std::size_t(1) << kSubBits;
+    static constexpr std::size_t kLinear = 2 * kSubBuckets;
+    static constexpr std::size_t kBuckets = kLinear + (64 - kSubBits - 1) * kSubBuckets;
+
+    /**
+     * Merged cells of all CPUs
+     */
+    struct Snapshot {
+        Snapshot() : count(0), sum(0), max(0), buckets(kBuckets, 0) {}
+
+        uint64_t count;
+        uint64_t sum;
+        uint64_t max;
+        std::vector<uint64_t> buckets;
+
+        double Mean() const { return count > 0 ? double(sum) / count : 0; }
+
+        /**
+         * Upper bound of the bucket holding q-th quantile, q in [0, 1]. Never above max
+         */
+        uint64_t Percentile(double q) const {
+            if (count == 0) {
+                return 0;
+            }
+
+            uint64_t rank = uint64_t(q * count);
+            if (rank >= count) {
+                rank = count - 1;
+            }
+            uint64_t seen = 0;
+            for (std::size_t i = 0; i < kBuckets; i++) {
+                seen += buckets[i];
+                if (seen > rank) {
+                    uint64_t bound = UpperBound(i);
+                    return bound < max ? bound : max;
+                }
+            }
+            return max;
+        }
+    };
+
+    void Record(uint64_t value) {
+        Cells &cells = _cells.Local();
+        cells.buckets[BucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+        cells.count.fetch_add(1, std::memory_order_relaxed);
+        cells.sum.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t max = cells.max.load(std::memory_order_relaxed);
+        while (value > max && !cells.max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    Snapshot Take() const {
+        Snapshot result;
+        _cells.ForEach([&result](const Cells &cells) {
+            result.count += cells.count.load(std::memory_order_relaxed);
+            result.sum += cells.sum.load(std::memory_order_relaxed);
+
+            uint64_t max = cells.max.load(std::memory_order_relaxed);
+            result.max = max > result.max ? max : result.max;
+            for (std::size_t i = 0; i < kBuckets; i++) {
+                result.buckets[i] += cells.buckets[i].load(std::memory_order_relaxed);
+            }
+        });
+        return result;
+    }
+
+    static std::size_t BucketOf(uint64_t value) {
+        if (value < kLinear) {
+            return std::size_t(value);
+        }
+
+        std::size_t exponent = 63 - __builtin_clzll(value);
+        std::size_t sub = std::size_t(value >> (exponent - kSubBits)) & (kSubBuckets - 1);
+        return kLinear + (exponent - kSubBits - 1) * kSubBuckets + sub;
+    }
+
+    /**
+     * Largest value that falls into bucket
+     */
+    static uint64_t UpperBound(std::size_t bucket) {
+        if (bucket < kLinear) {
+            return bucket;
+        }
+
+        std::size_t exponent = (bucket - kLinear) / kSubBuckets + kSubBits + 1;
+        uint64_t sub = (bucket - kLinear) % kSubBuckets;
+        uint64_t step = uint64_t(1) << (exponent - kSubBits);
+        return (uint64_t(1) << exponent) + (sub + 1) * step - 1;
+    }
+
+private:
+    struct Cells {
+        Cells() : count(0), sum(0), max(0) {
+            for (auto &bucket : buckets) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        std::atomic<uint64_t> buckets[kBuckets];
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sum;
+        std::atomic<uint64_t> max;
+    };
+
+    CoreLocal<Cells> _cells;
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_HISTOGRAM_H
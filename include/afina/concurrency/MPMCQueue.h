@@ -0,0 +1,200 @@
+#ifndef AFINA_CONCURRENCY_MPMC_QUEUE_H
+#define AFINA_CONCURRENCY_MPMC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Bounded lock-free MPMC queue
+ * Dmitry Vyukov's array based queue: every slot carries a sequence number that tells whether the
+ * slot is ready for the producer or the consumer of the given lap. Producers and consumers
+ * contend only on their own position counter with a single CAS per operation, and elements are
+ * taken strictly in the order their positions were claimed.
+ *
+ * Slots and both counters sit on separate cache lines, so producers filling adjacent slots don't
+ * invalidate each other's lines. Capacity is fixed at construction, operations never allocate
+ */
+template <typename T> class MPMCQueue {
+public:
+    static constexpr std::size_t kCacheLine = 64;
+
+    /**
+     * @param capacity maximum number of elements, at least one
+     */
+    explicit MPMCQueue(std::size_t capacity) : _capacity(capacity > 0 ? capacity : 1), _head(0), _tail(0) {
+        // operator new only guarantees alignment of max_align_t, align slots by hand
+        _raw = ::operator new(sizeof(Slot) * _capacity + kCacheLine);
+        std::uintptr_t aligned = (reinterpret_cast<std::uintptr_t>(_raw) + kCacheLine - 1) & ~(kCacheLine - 1);
+        _slots = reinterpret_cast<Slot *>(aligned);
+
+        for (std::size_t i = 0; i < _capacity; i++) {
+            new (&_slots[i]) Slot();
+            _slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MPMCQueue() {
+        std::size_t tail = _tail.load(std::memory_order_relaxed);
+        for (std::size_t pos = _head.load(std::memory_order_relaxed); pos != tail; pos++) {
+            _slots[pos % _capacity].Item()->~T();
+        }
+
+        for (std::size_t i = 0; i < _capacity; i++) {
+            _slots[i].~Slot();
+        }
+        ::operator delete(_raw);
+    }
+
+    /**
+     * Constructs element at the tail, returns false if queue is full
+     */
+    template <typename... Args> bool TryEmplace(Args &&... args) {
+        std::size_t pos = _tail.load(std::memory_order_relaxed);
+        Slot *slot;
+        for (;;) {
+            slot = &_slots[pos % _capacity];
+            std::size_t seq = slot->seq.load(std::memory_order_acquire);
+            std::intptr_t diff = std::intptr_t(seq) - std::intptr_t(pos);
+            if (diff == 0) {
+                if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // Consumer of the previous lap hasn't freed the slot yet
+                return false;
+            } else {
+                pos = _tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (slot->Item()) T(std::forward<Args>(args)...);
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPush(T &&item) { return TryEmplace(std::move(item)); }
+    bool TryPush(const T &item) { return TryEmplace(item); }
+
+    /**
+     * Moves count items to the tail as a whole: positions are claimed with a single CAS, so items
+     * end up next to each other in order. Returns false and moves nothing if there is no room for
+     * all of them. Moving T must not throw
+     */
+    bool TryPushBulk(T *items, std::size_t count) {
+        if (count == 0) {
+            return true;
+        }
+        if (count > _capacity) {
+            return false;
+        }
+
+        std::size_t pos = _tail.load(std::memory_order_relaxed);
+        for (;;) {
+            // Consumers free slots in any order, so every one of them has to be checked. Slot that
+            // is free for this lap stays free until somebody moves tail over it
+            std::size_t i = 0;
+            bool stale = false;
+            for (; i < count; i++) {
+                std::size_t seq = _slots[(pos + i) % _capacity].seq.load(std::memory_order_acquire);
+                std::intptr_t diff = std::intptr_t(seq) - std::intptr_t(pos + i);
+                if (diff < 0) {
+                    return false;
+                }
+                if (diff > 0) {
+                    stale = true;
+                    break;
+                }
+            }
+
+            if (stale) {
+                pos = _tail.load(std::memory_order_relaxed);
+            } else if (_tail.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        for (std::size_t i = 0; i < count; i++) {
+            Slot *slot = &_slots[(pos + i) % _capacity];
+            new (slot->Item()) T(std::move(items[i]));
+            slot->seq.store(pos + i + 1, std::memory_order_release);
+        }
+        return true;
+    }
+
+    /**
+     * Moves element from the head into item, returns false if queue is empty
+     */
+    bool TryPop(T &item) {
+        std::size_t pos = _head.load(std::memory_order_relaxed);
+        Slot *slot;
+        for (;;) {
+            slot = &_slots[pos % _capacity];
+            std::size_t seq = slot->seq.load(std::memory_order_acquire);
+            std::intptr_t diff = std::intptr_t(seq) - std::intptr_t(pos + 1);
+            if (diff == 0) {
+                if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // Producer of this lap hasn't filled the slot yet
+                return false;
+            } else {
+                pos = _head.load(std::memory_order_relaxed);
+            }
+        }
+
+        T *stored = slot->Item();
+        item = std::move(*stored);
+        stored->~T();
+        slot->seq.store(pos + _capacity, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Approximate number of elements, exact only when queue is quiescent
+     */
+    std::size_t SizeApprox() const {
+        std::size_t head = _head.load(std::memory_order_relaxed);
+        std::size_t tail = _tail.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    bool Empty() const { return SizeApprox() == 0; }
+
+    inline std::size_t Capacity() const { return _capacity; }
+
+private:
+    MPMCQueue(const MPMCQueue &) = delete;
+    MPMCQueue &operator=(const MPMCQueue &) = delete;
+
+    // alignas rounds slot size up to whole number of cache lines, padding inside included
+    struct alignas(kCacheLine) Slot {
+        std::atomic<std::size_t> seq;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+
+        inline T *Item() { return reinterpret_cast<T *>(&storage); }
+    };
+    static_assert(sizeof(Slot) % kCacheLine == 0, "Slot must take whole cache lines");
+
+    const std::size_t _capacity;
+    void *_raw;
+    Slot *_slots;
+
+    char _pad0[kCacheLine];
+    std::atomic<std::size_t> _head;
+    char _pad1[kCacheLine - sizeof(std::atomic<std::size_t>)];
+    std::atomic<std::size_t> _tail;
+    char _pad2[kCacheLine - sizeof(std::atomic<std::size_t>)];
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_MPMC_QUEUE_H
@@ -0,0 +1,193 @@
+#ifndef AFINA_CONCURRENCY_TASK_H
+#define AFINA_CONCURRENCY_TASK_H
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Unit of work for thread pools
+ * Move-only replacement of std::function<void()>. Callables up to kInlineSize bytes that could be
+ * moved without exceptions are stored right inside of the task, larger ones go to the heap. Type
+ * erasure is a static table of three function pointers per callable type, no RTTI involved.
+ *
+ * Task is invoked at most once by executors, so MakeTask passes bound arguments as rvalues, the
+ * same way std::thread does
+ */
+class Task {
+public:
+    static constexpr std::size_t kInlineSize = 64;
+
+    Task() noexcept : _ops(nullptr) {}
+    Task(std::nullptr_t) noexcept : _ops(nullptr) {}
+
+    template <typename F, typename = typename std::enable_if<
+                              !std::is_same<typename std::decay<F>::type, Task>::value>::type>
+    Task(F &&func) : _ops(nullptr) {
+        using Func = typename std::decay<F>::type;
+        using Ops = typename std::conditional<FitsInline<Func>::value, InlineOps<Func>, HeapOps<Func>>::type;
+        Ops::Create(&_storage, std::forward<F>(func));
+        _ops = &Ops::table;
+    }
+
+    Task(Task &&other) noexcept : _ops(other._ops) {
+        if (_ops != nullptr) {
+            _ops->move(&other._storage, &_storage);
+            other._ops = nullptr;
+        }
+    }
+
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            Reset();
+            if (other._ops != nullptr) {
+                other._ops->move(&other._storage, &_storage);
+                _ops = other._ops;
+                other._ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    Task &operator=(std::nullptr_t) noexcept {
+        Reset();
+        return *this;
+    }
+
+    ~Task() { Reset(); }
+
+    /**
+     * Runs the callable, task must not be empty
+     */
+    void operator()() { _ops->invoke(&_storage); }
+
+    explicit operator bool() const noexcept { return _ops != nullptr; }
+
+private:
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    using Storage = typename std::aligned_storage<kInlineSize, alignof(std::max_align_t)>::type;
+
+    struct Ops {
+        void (*invoke)(void *storage);
+
+        // Moves callable to the empty storage and destroys the source
+        void (*move)(void *from, void *to) noexcept;
+        void (*destroy)(void *storage) noexcept;
+    };
+
+    template <typename F>
+    struct FitsInline
+        : std::integral_constant<bool, sizeof(F) <= kInlineSize && alignof(F) <= alignof(std::max_align_t) &&
+                                           std::is_nothrow_move_constructible<F>::value> {};
+
+    template <typename F> struct InlineOps {
+        template <typename Arg> static void Create(void *storage, Arg &&func) {
+            new (storage) F(std::forward<Arg>(func));
+        }
+
+        static void Invoke(void *storage) { (*static_cast<F *>(storage))(); }
+
+        static void Move(void *from, void *to) noexcept {
+            F *source = static_cast<F *>(from);
+            new (to) F(std::move(*source));
+            source->~F();
+        }
+
+        static void Destroy(void *storage) noexcept { static_cast<F *>(storage)->~F(); }
+
+        static const Ops table;
+    };
+
+    template <typename F> struct HeapOps {
+        template <typename Arg> static void Create(void *storage, Arg &&func) {
+            *static_cast<F **>(storage) = new F(std::forward<Arg>(func));
+        }
+
+        static void Invoke(void *storage) { (**static_cast<F **>(storage))(); }
+
+        static void Move(void *from, void *to) noexcept { *static_cast<F **>(to) = *static_cast<F **>(from); }
+
+        static void Destroy(void *storage) noexcept { delete *static_cast<F **>(storage); }
+
+        static const Ops table;
+    };
+
+    void Reset() noexcept {
+        if (_ops != nullptr) {
+            _ops->destroy(&_storage);
+            _ops = nullptr;
+        }
+    }
+
+    Storage _storage;
+    const Ops *_ops;
+};
+
+template <typename F> const Task::Ops Task::InlineOps<F>::table = {&Invoke, &Move, &Destroy};
+template <typename F> const Task::Ops Task::HeapOps<F>::table = {&Invoke, &Move, &Destroy};
+
+namespace detail {
+
+template <std::size_t... I> struct IndexSequence {};
+
+template <std::size_t N, std::size_t... I> struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, I...> {};
+template <std::size_t... I> struct MakeIndexSequence<0, I...> { using type = IndexSequence<I...>; };
+
+// Plain callables are called directly, pointers to members go through std::mem_fn
+template <typename F, typename... Args>
+inline auto Call(std::false_type, F &func, Args &&... args) -> decltype(func(std::forward<Args>(args)...)) {
+    return func(std::forward<Args>(args)...);
+}
+
+template <typename F, typename... Args>
+inline auto Call(std::true_type, F &func, Args &&... args) -> decltype(std::mem_fn(func)(std::forward<Args>(args)...)) {
+    return std::mem_fn(func)(std::forward<Args>(args)...);
+}
+
+/**
+ * Callable together with its arguments, what std::bind does without placeholders and copies
+ */
+template <typename F, typename... Args> class BoundCall {
+public:
+    // What the call returns, Executor::Submit passes it to the future
+    using Result = typename std::result_of<F &(Args &&...)>::type;
+
+    template <typename G, typename... A>
+    explicit BoundCall(G &&func, A &&... args) : _func(std::forward<G>(func)), _args(std::forward<A>(args)...) {}
+
+    Result operator()() { return Apply(typename MakeIndexSequence<sizeof...(Args)>::type()); }
+
+private:
+    template <std::size_t... I> Result Apply(IndexSequence<I...>) {
+        return Call(std::is_member_pointer<F>(), _func, std::move(std::get<I>(_args))...);
+    }
+
+    F _func;
+    std::tuple<Args...> _args;
+};
+
+} // namespace detail
+
+/**
+ * Binds function and its arguments into a callable suitable for Task. Arguments are copied or
+ * moved into it
+ */
+template <typename F, typename... Args>
+detail::BoundCall<typename std::decay<F>::type, typename std::decay<Args>::type...> MakeTask(F &&func,
+                                                                                              Args &&... args) {
+    return detail::BoundCall<typename std::decay<F>::type, typename std::decay<Args>::type...>(
+        std::forward<F>(func), std::forward<Args>(args)...);
+}
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_TASK_H
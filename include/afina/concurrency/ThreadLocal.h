@@ -1,10 +1,116 @@
 #ifndef AFINA_CONCURRENCY_THREAD_LOCAL_H
 #define AFINA_CONCURRENCY_THREAD_LOCAL_H
 
+#include <cstddef>
+#include <functional>
+#include <memory>
+
 namespace Afina {
 namespace Concurrency {
 
-template <typename T> class ThreadLocal {};
+namespace detail {
+
+struct ThreadLocalMeta;
+struct ThreadLocalEntry;
+
+/**
+ * Type independent part of ThreadLocal, keeps registry of per-thread instances as void *
+ */
+class ThreadLocalBase {
+public:
+    using Destroy = void (*)(void *value);
+
+protected:
+    explicit ThreadLocalBase(Destroy destroy);
+    ~ThreadLocalBase();
+
+    /**
+     * Instance of the calling thread, nullptr if thread has none yet
+     */
+    void *Find() const;
+
+    /**
+     * Makes value the instance of the calling thread, takes ownership of it
+     */
+    void Insert(void *value);
+
+    /**
+     * Calls visitor for every live instance, holding registry lock
+     */
+    void Visit(const std::function<void(void *)> &visitor) const;
+
+    std::size_t Count() const;
+
+private:
+    ThreadLocalBase(const ThreadLocalBase &) = delete;
+    ThreadLocalBase &operator=(const ThreadLocalBase &) = delete;
+
+    // Shared with entries, so exiting thread could safely find out that owner is gone
+    std::shared_ptr<ThreadLocalMeta> _meta;
+
+    // Index in per-thread tables, reused once instance is destroyed
+    std::size_t _id;
+};
+
+} // namespace detail
+
+/**
+ * # Per-thread instances of T that could be enumerated
+ * Each thread calling Get receives its own default constructed T, created on the first call. Unlike
+ * plain thread_local, instances belong to the object: readers could walk over all of them, i.e to
+ * sum per-thread counters for stats, and they are destroyed either when their thread exits or when
+ * ThreadLocal itself is destroyed, whichever comes first.
+ *
+ * Get after the first call costs a table lookup without any lock. ForEach takes a lock that only
+ * threads creating or releasing their instances contend for. Instances could be read by ForEach
+ * while owners update them, so for shared data T must take care of that, i.e be an atomic
+ */
+template <typename T> class ThreadLocal : private detail::ThreadLocalBase {
+public:
+    ThreadLocal() : ThreadLocalBase(&DestroyValue) {}
+    ~ThreadLocal() = default;
+
+    /**
+     * Instance of the calling thread
+     */
+    T &Get() {
+        void *value = Find();
+        if (value != nullptr) {
+            return *static_cast<T *>(value);
+        }
+
+        std::unique_ptr<T> created(new T());
+        Insert(created.get());
+        return *created.release();
+    }
+
+    T &operator*() { return Get(); }
+    T *operator->() { return &Get(); }
+
+    /**
+     * Calls f(const T &) for every live instance. Threads can't start or exit meanwhile, so f must
+     * be short
+     */
+    template <typename F> void ForEach(F f) const {
+        Visit([&f](void *value) { f(*static_cast<const T *>(value)); });
+    }
+
+    /**
+     * Folds all live instances with f(R, const T &) -> R starting from init
+     */
+    template <typename R, typename F> R Aggregate(R init, F f) const {
+        Visit([&init, &f](void *value) { init = f(init, *static_cast<const T *>(value)); });
+        return init;
+    }
+
+    /**
+     * Number of live instances
+     */
+    std::size_t Size() const { return Count(); }
+
+private:
+    static void DestroyValue(void *value) { delete static_cast<T *>(value); }
+};
 
 } // namespace Concurrency
 } // namespace Afina
@@ -0,0 +1,138 @@
+#ifndef AFINA_CONCURRENCY_TOPOLOGY_H
+#define AFINA_CONCURRENCY_TOPOLOGY_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # CPUs and NUMA nodes of the machine
+ * Layout as the kernel reports it in sysfs: every logical CPU belongs to a physical core, hyperthreads
+ * of the same core are siblings sharing its execution units and caches, and every CPU belongs to a NUMA
+ * node whose memory is the closest one.
+ *
+ * Only CPUs the process is allowed to run on are kept, so layout follows taskset and cgroup cpusets.
+ * Whatever sysfs lacks gets the most conservative answer: a CPU without topology files is a core on its
+ * own, a CPU missing from every node belongs to node 0
+ */
+class Topology {
+public:
+    struct Cpu {
+        // Logical CPU number, as sched_setaffinity takes it
+        unsigned id;
+
+        // Physical core, numbered from zero over the whole machine
+        unsigned core;
+
+        // Socket the core is on
+        unsigned package;
+
+        // NUMA node
+        unsigned node;
+    };
+
+    /**
+     * Reads layout of the allowed CPUs from sysfs mounted at root
+     */
+    static Topology Detect(const std::string &root = "/sys/devices/system");
+
+    /**
+     * Same as above for the given set of CPUs instead of the process affinity mask
+     */
+    static Topology Detect(const std::string &root, const std::vector<unsigned> &allowed);
+
+    /**
+     * Parses kernel cpu list format, i.e. "0-3,8,10-11", into sorted CPU numbers
+     */
+    static std::vector<unsigned> ParseList(const std::string &list);
+
+    /**
+     * CPUs ordered by id
+     */
+    const std::vector<Cpu> &Cpus() const { return _cpus; }
+
+    /**
+     * Number of physical cores
+     */
+    std::size_t Cores() const { return _cores; }
+
+    /**
+     * Nodes that have at least one allowed CPU, ordered by id
+     */
+    std::vector<unsigned> Nodes() const;
+
+    /**
+     * Logical CPUs of the core, the first one is considered primary and the rest its siblings
+     */
+    std::vector<unsigned> CoreCpus(unsigned core) const;
+
+private:
+    std::vector<Cpu> _cpus;
+    std::size_t _cores = 0;
+};
+
+/**
+ * # Where server threads run
+ * Maps threads of the network layer onto the topology. Network workers keep the hot state of their
+ * connections in caches, so they get a physical core each and are never moved. Cores are taken node
+ * by node, so a few workers share last level cache and local memory, while many workers spread over
+ * all nodes. Helper threads (acceptors, executor pools) don't own connections and run on the spare
+ * hyperthreads of worker cores, where they don't steal cycles from a worker's own core.
+ *
+ * Empty set of CPUs means thread is not pinned
+ */
+class Placement {
+public:
+    enum class Policy {
+        // Scheduler places threads
+        kNone,
+
+        // Worker per physical core, helpers on siblings
+        kCores
+    };
+
+    Placement() : _policy(Policy::kNone) {}
+    Placement(const Topology &topology, Policy policy);
+
+    Policy policy() const { return _policy; }
+
+    /**
+     * CPUs for the i-th network worker. Workers beyond the number of cores wrap around
+     */
+    std::vector<unsigned> Worker(std::size_t i) const;
+
+    /**
+     * CPUs shared by helper threads once given number of workers is placed: siblings of worker cores,
+     * otherwise cores left unused on worker nodes, otherwise nothing
+     */
+    std::vector<unsigned> Helpers(std::size_t workers) const;
+
+    /**
+     * NUMA nodes given number of workers run on, where memory they all share should come from
+     */
+    std::vector<unsigned> Nodes(std::size_t workers) const;
+
+private:
+    Policy _policy;
+
+    // Cores in placement order, each with its CPUs primary first
+    struct Core {
+        unsigned node;
+        std::vector<unsigned> cpus;
+    };
+    std::vector<Core> _cores;
+};
+
+/**
+ * Restricts calling thread to the given CPUs. Returns false if kernel refused, i.e. CPUs are outside
+ * of the process cpuset. Empty set is a no-op
+ */
+bool PinCurrentThread(const std::vector<unsigned> &cpus);
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_TOPOLOGY_H
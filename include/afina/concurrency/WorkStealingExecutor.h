@@ -0,0 +1,160 @@
+#ifndef AFINA_CONCURRENCY_WORK_STEALING_EXECUTOR_H
+#define AFINA_CONCURRENCY_WORK_STEALING_EXECUTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include <afina/concurrency/ChaseLevDeque.h>
+#include <afina/concurrency/EventCount.h>
+#include <afina/concurrency/Task.h>
+
+namespace Afina {
+namespace Concurrency {
+
+/**
+ * # Work stealing thread pool
+ * Drop-in replacement of Executor for loads where a single task queue lock is the bottleneck:
+ * - each worker owns a Chase-Lev deque, tasks submitted from inside of a task go there
+ * - tasks submitted from outside go to the injection queue split into shards with own locks, so
+ *   concurrent submitters rarely meet each other
+ * - worker that runs out of own tasks takes from injection queue and then steals from others
+ * - idle workers sleep on an event count, so submitter doesn't take any lock to wake them up
+ *
+ * Watermarks and idle time work the same way as in Executor: pool starts low_watermark threads,
+ * spawns more up to high_watermark when there are no idle workers, and threads above
+ * low_watermark exit after idle_time without work. At most max_queue_size tasks could wait for
+ * execution.
+ *
+ * Ordering between tasks is not guaranteed
+ */
+class WorkStealingExecutor {
+public:
+    enum class State {
+        // Threadpool is fully operational, tasks could be added and get executed
+        kRun,
+
+        // Threadpool is on the way to be shutdown, no new task could be added, but existing will be
+        // completed as requested
+        kStopping,
+
+        // Threadpool is stopped
+        kStopped
+    };
+
+    WorkStealingExecutor(int low_watermark, int high_watermark, int max_queue_size,
+                         std::chrono::milliseconds idle_time);
+    ~WorkStealingExecutor();
+
+    /**
+     * Add function to be executed on the threadpool. Method returns true in case if task has been placed
+     * onto execution queue, i.e scheduled for execution and false otherwise.
+     *
+     * That function doesn't wait for function result. Function could always be written in a way to notify caller about
+     * execution finished by itself
+     */
+    template <typename F, typename... Types> bool Execute(F &&func, Types &&... args) {
+        std::unique_ptr<Task> task(new Task(MakeTask(std::forward<F>(func), std::forward<Types>(args)...)));
+        if (!Submit(task.get())) {
+            return false;
+        }
+
+        task.release();
+        return true;
+    }
+
+    /**
+     * Signal thread pool to stop, it will stop accepting new jobs and close threads just after each become
+     * free. All enqueued jobs will be complete.
+     *
+     * In case if await flag is true, call won't return until all background jobs are done and all threads are stopped
+     */
+    void Stop(bool await = false);
+
+    inline State GetState() const { return _state.load(); }
+
+private:
+    WorkStealingExecutor(const WorkStealingExecutor &) = delete;
+    WorkStealingExecutor &operator=(const WorkStealingExecutor &) = delete;
+
+    // Place for a single thread, exists during whole pool lifetime so thieves could look into it anytime
+    struct Worker {
+        ChaseLevDeque<Task *> tasks;
+
+        // Slot is taken by a running thread
+        std::atomic<bool> busy;
+
+        char pad[64];
+    };
+
+    // Part of injection queue
+    struct Shard {
+        std::mutex mutex;
+        std::deque<Task *> tasks;
+
+        // Lets workers skip empty shards without taking the lock
+        std::atomic<std::size_t> size;
+
+        char pad[64];
+    };
+
+    /**
+     * Enqueues task, takes ownership on success
+     */
+    bool Submit(Task *task);
+
+    /**
+     * Starts one more thread unless there are high_watermark already
+     */
+    bool Spawn();
+
+    /**
+     * Main function of pool threads
+     */
+    void Run(std::size_t slot);
+
+    /**
+     * Own deque first, then injection queue, then other workers
+     */
+    bool FindTask(std::size_t slot, uint64_t &seed, Task *&task);
+
+    /**
+     * Called by exiting thread that has been already removed from _workers count
+     */
+    void Finish(std::size_t slot);
+
+    std::atomic<State> _state;
+
+    const int _low_watermark;
+    const int _high_watermark;
+    const int _max_queue_size;
+    const std::chrono::milliseconds _idle_time;
+
+    std::unique_ptr<Worker[]> _slots;
+    std::unique_ptr<Shard[]> _shards;
+    std::size_t _shards_count;
+
+    // Tasks submitted but not yet taken for execution
+    std::atomic<int> _queued;
+
+    // Threads that are going to process tasks, including the ones sleeping in _events
+    std::atomic<int> _workers;
+    std::atomic<int> _idle;
+
+    // Threads that still could touch the pool, decremented under _mutex on thread exit
+    std::atomic<int> _threads;
+
+    EventCount _events;
+
+    // Slow path only: waiting for threads on stop
+    std::mutex _mutex;
+    std::condition_variable _stop_condition;
+};
+
+} // namespace Concurrency
+} // namespace Afina
+
+#endif // AFINA_CONCURRENCY_WORK_STEALING_EXECUTOR_H
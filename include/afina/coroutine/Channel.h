@@ -0,0 +1,148 @@
+#ifndef AFINA_COROUTINE_CHANNEL_H
+#define AFINA_COROUTINE_CHANNEL_H
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <stdexcept>
+#include <utility>
+
+#include <afina/coroutine/Engine.h>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * # Bounded channel between coroutines of one engine
+ * Sender blocks in the engine while channel is full, receiver while it is empty. Every send wakes the
+ * longest waiting receiver and every receive the longest waiting sender, woken coroutine checks again
+ * because somebody else could have run first.
+ *
+ * Close wakes everybody: senders fail from then on, receivers get what is left and then fail. Timed
+ * variants also fail once deadline passes. Not thread safe, blocking calls must come from coroutines of
+ * the engine
+ */
+template <typename T> class Channel {
+public:
+    Channel(Engine &engine, std::size_t capacity) : _engine(engine), _capacity(capacity), _closed(false) {
+        if (capacity == 0) {
+            throw std::invalid_argument("Channel capacity must be positive");
+        }
+    }
+
+    /**
+     * Blocks while channel is full, false if it is closed
+     */
+    bool send(T value) { return send_until(std::move(value), Engine::Clock::time_point::max()); }
+
+    /**
+     * Blocks while channel is full but no longer than until deadline, false if it is closed or still full
+     */
+    bool send_until(T value, Engine::Clock::time_point deadline) {
+        while (!_closed && _items.size() >= _capacity) {
+            if (!Wait(_senders, deadline)) {
+                // Space could have appeared after the timer has fired
+                break;
+            }
+        }
+        return try_send(std::move(value));
+    }
+
+    template <typename Rep, typename Period>
+    bool send_for(T value, const std::chrono::duration<Rep, Period> &duration) {
+        return send_until(std::move(value),
+                          Engine::Clock::now() + std::chrono::duration_cast<Engine::Clock::duration>(duration));
+    }
+
+    /**
+     * Doesn't block, false if channel is full or closed
+     */
+    bool try_send(T value) {
+        if (_closed || _items.size() >= _capacity) {
+            return false;
+        }
+
+        _items.push_back(std::move(value));
+        _engine.unblock(_receivers);
+        return true;
+    }
+
+    /**
+     * Blocks while channel is empty, false once it is closed and drained
+     */
+    bool receive(T &value) { return receive_until(value, Engine::Clock::time_point::max()); }
+
+    /**
+     * Blocks while channel is empty but no longer than until deadline, false if nothing came by then
+     */
+    bool receive_until(T &value, Engine::Clock::time_point deadline) {
+        while (!_closed && _items.empty()) {
+            if (!Wait(_receivers, deadline)) {
+                break;
+            }
+        }
+        return try_receive(value);
+    }
+
+    template <typename Rep, typename Period>
+    bool receive_for(T &value, const std::chrono::duration<Rep, Period> &duration) {
+        return receive_until(value,
+                             Engine::Clock::now() + std::chrono::duration_cast<Engine::Clock::duration>(duration));
+    }
+
+    /**
+     * Doesn't block, false if channel is empty
+     */
+    bool try_receive(T &value) {
+        if (_items.empty()) {
+            return false;
+        }
+
+        value = std::move(_items.front());
+        _items.pop_front();
+        _engine.unblock(_senders);
+        return true;
+    }
+
+    /**
+     * No more sends, wakes everybody waiting
+     */
+    void close() {
+        _closed = true;
+        while (_engine.unblock(_senders) != nullptr) {
+        }
+        while (_engine.unblock(_receivers) != nullptr) {
+        }
+    }
+
+    inline bool closed() const { return _closed; }
+
+    inline std::size_t size() const { return _items.size(); }
+
+    inline std::size_t capacity() const { return _capacity; }
+
+private:
+    Channel(const Channel &) = delete;
+    Channel &operator=(const Channel &) = delete;
+
+    // False on timeout
+    bool Wait(Engine::WaitList &list, Engine::Clock::time_point deadline) {
+        if (_engine.current() == nullptr) {
+            throw std::logic_error("Channel would block outside of coroutine");
+        }
+        return _engine.block_until(list, deadline);
+    }
+
+    Engine &_engine;
+    const std::size_t _capacity;
+    bool _closed;
+
+    std::deque<T> _items;
+    Engine::WaitList _senders;
+    Engine::WaitList _receivers;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_CHANNEL_H
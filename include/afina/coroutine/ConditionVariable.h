@@ -0,0 +1,75 @@
+#ifndef AFINA_COROUTINE_CONDITION_VARIABLE_H
+#define AFINA_COROUTINE_CONDITION_VARIABLE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include <afina/coroutine/Engine.h>
+#include <afina/coroutine/Mutex.h>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * # Condition variable for coroutines of one engine
+ * Waiting coroutine releases the mutex and blocks in the engine until notified, then takes the mutex
+ * back. Notified coroutines wake in the order they started waiting. There are no spurious wakeups, but
+ * condition could change again before woken coroutine gets the mutex, so check it in a loop or use the
+ * predicate overload. Not thread safe
+ */
+class ConditionVariable {
+public:
+    explicit ConditionVariable(Engine &engine) : _engine(engine) {}
+
+    void wait(std::unique_lock<Mutex> &lock);
+
+    template <typename Predicate> void wait(std::unique_lock<Mutex> &lock, Predicate pred) {
+        while (!pred()) {
+            wait(lock);
+        }
+    }
+
+    /**
+     * Waits for notification no longer than until deadline. Mutex is locked again on return either way,
+     * that may take longer than the deadline
+     */
+    std::cv_status wait_until(std::unique_lock<Mutex> &lock, Engine::Clock::time_point deadline);
+
+    template <typename Predicate>
+    bool wait_until(std::unique_lock<Mutex> &lock, Engine::Clock::time_point deadline, Predicate pred) {
+        while (!pred()) {
+            if (wait_until(lock, deadline) == std::cv_status::timeout) {
+                return pred();
+            }
+        }
+        return true;
+    }
+
+    template <typename Rep, typename Period>
+    std::cv_status wait_for(std::unique_lock<Mutex> &lock, const std::chrono::duration<Rep, Period> &duration) {
+        return wait_until(lock, Engine::Clock::now() + std::chrono::duration_cast<Engine::Clock::duration>(duration));
+    }
+
+    template <typename Rep, typename Period, typename Predicate>
+    bool wait_for(std::unique_lock<Mutex> &lock, const std::chrono::duration<Rep, Period> &duration, Predicate pred) {
+        return wait_until(lock, Engine::Clock::now() + std::chrono::duration_cast<Engine::Clock::duration>(duration),
+                          pred);
+    }
+
+    void notify_one();
+
+    void notify_all();
+
+private:
+    ConditionVariable(const ConditionVariable &) = delete;
+    ConditionVariable &operator=(const ConditionVariable &) = delete;
+
+    Engine &_engine;
+    Engine::WaitList _waiters;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_CONDITION_VARIABLE_H
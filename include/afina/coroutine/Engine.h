@@ -1,21 +1,131 @@
 #ifndef AFINA_COROUTINE_ENGINE_H
 #define AFINA_COROUTINE_ENGINE_H
 
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <iostream>
 #include <map>
+#include <new>
 #include <setjmp.h>
+#include <string>
 #include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <afina/concurrency/Task.h>
+#include <afina/coroutine/StackPool.h>
+
+// Context switch is a few lines of assembly on x86-64, anything else goes through ucontext. Define
+// AFINA_COROUTINE_UCONTEXT to force the fallback
+#if defined(__x86_64__) && !defined(AFINA_COROUTINE_UCONTEXT)
+#define AFINA_COROUTINE_ASM 1
+#else
+#include <ucontext.h>
+#endif
 
 namespace Afina {
 namespace Coroutine {
 
+namespace detail {
+
+/**
+ * Coroutine body with its arguments, kept while coroutine runs on its own stack
+ */
+class Closure {
+public:
+    virtual ~Closure() {}
+    virtual void Call() = 0;
+};
+
+/**
+ * How closure keeps argument A for parameter P. Lvalue reference parameter given an object of its type
+ * keeps referring to it, as with a plain call, everything else is a decayed copy: temporaries are gone
+ * before the coroutine first runs
+ */
+template <typename P, typename A> struct Argument {
+    using type = typename std::conditional<
+        std::is_lvalue_reference<P>::value && std::is_lvalue_reference<A>::value &&
+            std::is_convertible<typename std::remove_reference<A>::type *,
+                                typename std::remove_reference<P>::type *>::value,
+        P, typename std::decay<P>::type>::type;
+};
+
+template <typename F, typename... Stored> class BoundClosure : public Closure {
+public:
+    template <typename... A>
+    explicit BoundClosure(F func, A &&... args) : _func(func), _args(std::forward<A>(args)...) {}
+
+    void Call() override { Apply(typename Concurrency::detail::MakeIndexSequence<sizeof...(Stored)>::type()); }
+
+private:
+    // Copies are moved into the call, references passed as they are
+    template <std::size_t... I> void Apply(Concurrency::detail::IndexSequence<I...>) {
+        _func(std::forward<Stored>(std::get<I>(_args))...);
+    }
+
+    F _func;
+    std::tuple<Stored...> _args;
+};
+
+/**
+ * Binds func and its arguments, nullptr if there is no memory for that
+ */
+template <typename... Ta, typename... Args> Closure *Bind(void (*func)(Ta...), Args &&... args) {
+    try {
+        return new BoundClosure<void (*)(Ta...), typename Argument<Ta, Args>::type...>(func,
+                                                                                       std::forward<Args>(args)...);
+    } catch (std::bad_alloc &) {
+        return nullptr;
+    }
+}
+
+} // namespace detail
+
 /**
  * # Entry point of coroutine library
  * Allows to run coroutine and schedule its execution. Not threadsafe
+ *
+ * Engine works in one of two modes:
+ * - kSeparateStack: every coroutine owns a stack of fixed size, switch saves callee-saved registers
+ *   on the current stack and loads stack pointer of the other coroutine. Cost doesn't depend on how
+ *   deep the stacks are, it is a few dozen nanoseconds. Stacks come from StackPool, so memory is
+ *   committed only as deep as coroutine actually goes
+ * - kCopyStack: all coroutines run on the stack of start() caller, switch copies the used part of
+ *   it aside and copies stack of the other coroutine back. Needs no memory up front, but switch
+ *   costs memcpy of the whole live stack and pointers to stack variables are only valid while the
+ *   owner coroutine runs
+ *
+ * Blocked routine could have a deadline, see block_until. Deadlines are kept in a 4-ary min-heap, index
+ * of routine in it lives in the routine context, so adding and cancelling a timer is O(log n) with no
+ * allocation once the heap has grown. Expired timers are checked on yield and whenever engine runs
+ * out of ready routines, idle function is expected to sleep no longer than until next_timer()
  */
 class Engine final {
+public:
+    enum class Mode {
+        // Stack is copied on every switch
+        kCopyStack,
+
+        // Coroutine owns a stack
+        kSeparateStack
+    };
+
+    // Stack of every coroutine in kSeparateStack mode
+    static constexpr std::size_t kDefaultStackSize = 128 * 1024;
+
+    // Clock of all deadlines
+    typedef std::chrono::steady_clock Clock;
+
+    // Queue of routines blocked on the same condition, see block(WaitList &)
+    class WaitList;
+
 private:
+    // TimerIndex of routine without a deadline
+    static constexpr std::size_t kNoTimer = SIZE_MAX;
+
     /**
      * A single coroutine instance which could be scheduled for execution
      * should be allocated on heap
@@ -34,6 +144,38 @@ private:
         // Saved coroutine context (registers)
         jmp_buf Environment;
 
+        // Own stack in kSeparateStack mode, empty for the context of start() caller
+        StackPool::Stack OwnStack;
+
+#ifdef AFINA_COROUTINE_ASM
+        // Top of the saved registers on the own stack
+        void *StackPointer = nullptr;
+#else
+        ucontext_t Machine;
+#endif
+
+        // Function to run in kSeparateStack mode, owned by context
+        detail::Closure *Body = nullptr;
+        Engine *Owner = nullptr;
+
+        // Routine is in the blocked list and can't be scheduled until unblocked
+        bool Blocked = false;
+
+        // Wait list blocked routine is queued in, if any, with its neighbours there
+        WaitList *Waiting = nullptr;
+        struct context *wait_prev = nullptr;
+        struct context *wait_next = nullptr;
+
+        // Deadline of blocked routine, position in the timer heap and order among equal deadlines
+        Clock::time_point Deadline;
+        std::size_t TimerIndex = kNoTimer;
+        uint64_t TimerSeq = 0;
+
+        // Set once timer fires, hook to call on the engine thread before routine gets ready
+        bool TimedOut = false;
+        void (*OnTimeout)(void *) = nullptr;
+        void *TimeoutArg = nullptr;
+
         // To include routine in the different lists, such as "alive", "blocked", e.t.c
         struct context *prev = nullptr;
         struct context *next = nullptr;
@@ -54,11 +196,40 @@ private:
      */
     context *alive;
 
+    /**
+     * List of routines waiting for somebody to unblock them
+     */
+    context *blocked;
+
     /**
      * Context to be returned finally
      */
     context *idle_ctx;
 
+    const Mode mode;
+
+    /**
+     * Stacks of routines in kSeparateStack mode
+     */
+    StackPool stacks;
+
+    /**
+     * Coroutine that has completed on its own stack, so it is freed by the next one to run
+     */
+    context *finished;
+
+    /**
+     * Called by start() when no routine is ready, supposed to unblock or adopt some. start() returns once
+     * it reports there is nothing more to wait for
+     */
+    std::function<bool()> idle_func;
+
+    /**
+     * Blocked routines with deadlines, 4-ary min-heap by deadline and then by TimerSeq
+     */
+    std::vector<context *> timers;
+    uint64_t timer_seq;
+
 protected:
     /**
      * Save stack of the current coroutine in the given context
@@ -75,8 +246,82 @@ protected:
      */
     void Enter(context& ctx);
 
+    /**
+     * kSeparateStack: allocates stack for the new routine and arranges for Entry to run on it. Returns
+     * false if there is no memory for the stack
+     */
+    bool Prepare(context &ctx);
+
+    /**
+     * kSeparateStack: saves registers of from and resumes to. Returns once somebody switches to from
+     */
+    void Switch(context &from, context &to);
+
+    /**
+     * kSeparateStack: frees coroutine that has completed
+     */
+    void Reap();
+
+    /**
+     * Removes routine from the list it belongs to
+     */
+    void Unlink(context &ctx, context *&list);
+
+    /**
+     * Takes blocked routine out of the wait list it is queued in, if any
+     */
+    void Dequeue(context &ctx);
+
+    /**
+     * Adds routine to the head of the list
+     */
+    void Link(context &ctx, context *&list);
+
+    /**
+     * Puts current routine to the tail of the wait list
+     */
+    void Enqueue(context &ctx, WaitList &list);
+
+    /**
+     * Timer heap: add, remove and restore order around position
+     */
+    void TimerPush(context &ctx);
+    void TimerRemove(context &ctx);
+    void TimerSiftUp(std::size_t index);
+    void TimerSiftDown(std::size_t index);
+    void TimerPlace(context &ctx, std::size_t index);
+
+    /**
+     * Runs routines until none is ready and idle function, if any, has nothing to wait for
+     */
+    void Loop();
+
+    /**
+     * Frees routines that are still blocked once engine stops, their frames are not unwound
+     */
+    void Drop();
+
+    /**
+     * kSeparateStack: first function on the coroutine stack, runs body and passes control away for good
+     */
+    static void Entry(context *ctx);
+
+#ifndef AFINA_COROUTINE_ASM
+    // makecontext passes int arguments only, so pointer to context comes in two halves
+    static void EntryParts(unsigned high, unsigned low);
+#endif
+
 public:
-    Engine() : StackBottom(0), cur_routine(nullptr), alive(nullptr) {}
+    /**
+     * @param idle called on the caller stack of start() whenever no routine is ready to run, for example
+     * to wait for I/O and unblock routines that can proceed. Returns false when there is nothing left to
+     * wait for, then start() returns once nothing is ready. Without it start() returns as soon as nothing
+     * is ready to run
+     */
+    explicit Engine(Mode m = Mode::kSeparateStack, std::size_t stack = kDefaultStackSize,
+                    std::function<bool()> idle = nullptr)
+        : StackBottom(0), cur_routine(nullptr), alive(nullptr), blocked(nullptr), idle_ctx(nullptr), mode(m),
+          stacks(stack), finished(nullptr), idle_func(std::move(idle)), timer_seq(0) {}
     Engine(Engine &&) = delete;
     Engine(const Engine &) = delete;
 
@@ -95,107 +340,236 @@ public:
      * when it has been suspended previously.
      *
      * If routine to pass execution to is not specified runtime will try to transfer execution back to caller
-     * of the current routine, if there is no caller then this method has same semantics as yield
+     * of the current routine, if there is no caller then this method has same semantics as yield.
+     *
+     * Blocked routine can't get control this way, for it the method works as yield
      */
     void sched(void *routine);
 
+    /**
+     * Moves routine to the blocked list, so it doesn't get control until unblock. If routine is not
+     * specified the current one is blocked and control passes to another routine ready to run, or to
+     * the idle function if there is none
+     */
+    void block(void *routine = nullptr);
+
+    /**
+     * Blocks current routine and puts it to the tail of the wait list. Must be called from a coroutine
+     */
+    void block(WaitList &list);
+
+    /**
+     * Blocks current routine until somebody unblocks it or deadline passes, whichever comes first.
+     * Returns false on timeout, as well as outside of coroutines.
+     *
+     * If given, on_timeout(arg) runs on the thread of this engine when timer fires, before routine is
+     * ready to run, e.g. to take routine out of a structure of this thread: once ready, routine could be
+     * detached and continue anywhere
+     */
+    bool block_until(Clock::time_point deadline, void (*on_timeout)(void *) = nullptr, void *arg = nullptr);
+
+    /**
+     * Blocks current routine in the wait list until unblocked from there or deadline passes. On timeout
+     * routine leaves the list and false is returned
+     */
+    bool block_until(WaitList &list, Clock::time_point deadline);
+
+    /**
+     * Blocks current routine until deadline. Returns true once it is reached, false if routine has been
+     * unblocked earlier, which is the way to cancel a sleep, or if called outside of coroutines
+     */
+    bool sleep_until(Clock::time_point deadline);
+
+    template <typename Rep, typename Period> bool sleep_for(const std::chrono::duration<Rep, Period> &duration) {
+        return sleep_until(Clock::now() + std::chrono::duration_cast<Clock::duration>(duration));
+    }
+
+    /**
+     * Makes routines whose deadline is not after now ready to run, in deadline order. Engine does this
+     * itself, idle function calls it with time_point::max() to cut all waits short, e.g. on shutdown
+     */
+    void expire_timers(Clock::time_point now);
+
+    void expire_timers() { expire_timers(Clock::now()); }
+
+    /**
+     * Earliest deadline of blocked routines, time_point::max() if there is none
+     */
+    Clock::time_point next_timer() const {
+        return timers.empty() ? Clock::time_point::max() : timers.front()->Deadline;
+    }
+
+    /**
+     * Moves blocked routine back to the list of routines ready to run, taking it out of the wait list it
+     * is queued in and cancelling its deadline. Doesn't pass control to it
+     */
+    void unblock(void *routine);
+
+    /**
+     * Unblocks routine at the head of the wait list, returns it or nullptr if the list is empty
+     */
+    void *unblock(WaitList &list);
+
+    /**
+     * kSeparateStack: takes a routine ready to run out of the engine, so that another engine could adopt
+     * it, possibly on another thread. If routine is not specified any ready one but the current is taken.
+     * Returns the routine, or nullptr if there is none to take or engine works in kCopyStack mode, those
+     * routines live on the stack of start() caller.
+     *
+     * Routine resumes wherever it is adopted, code that runs in it must not keep pointers to objects of
+     * the thread it has left, Engine and WaitList included
+     */
+    void *detach(void *routine = nullptr);
+
+    /**
+     * kSeparateStack: makes routine detached from another engine ready to run in this one. Engines must
+     * have the same stack size, otherwise std::invalid_argument is thrown and routine stays detached
+     */
+    void adopt(void *routine);
+
+    /**
+     * Routine being executed, nullptr outside of coroutines
+     */
+    void *current() const { return cur_routine == idle_ctx ? nullptr : cur_routine; }
+
+    /**
+     * Stack pool usage, see StackPool::Dump
+     */
+    std::string DumpStacks(const std::string &prefix = "") const { return stacks.Dump(prefix); }
+
+    StackPool::Stats StackStats() const { return stacks.stats(); }
+
     /**
      * Entry point into the engine. Prepare all internal mechanics and starts given function which is
      * considered as main.
      *
      * Once control returns back to caller of start all coroutines are done execution, in other words,
-     * this function doesn't return control until all coroutines are done.
+     * this function doesn't return control until all coroutines are done. The exception is routines
+     * left blocked when there is no idle function to unblock them: they are freed without returning
+     * from their functions.
      *
      * @param pointer to the main coroutine
      * @param arguments to be passed to the main coroutine
      */
-    template <typename... Ta> void start(void (*main)(Ta...), Ta &&... args) {
+    template <typename... Ta, typename... Args> void start(void (*main)(Ta...), Args &&... args) {
         // To acquire stack begin, create variable on stack and remember its address
         char StackStartsHere;
         this->StackBottom = &StackStartsHere;
 
         // Start routine execution
-        void *pc = run(main, std::forward<Ta>(args)...);
+        void *pc = run(main, std::forward<Args>(args)...);
         idle_ctx = new context();
+        idle_ctx->Owner = this;
 
-        if (setjmp(idle_ctx->Environment) > 0) {
-            // Here: correct finish of the coroutine section
-            yield();
+        if (mode == Mode::kSeparateStack) {
+            // Caller stack becomes idle context, every completed routine comes back here
+            cur_routine = idle_ctx;
+            if (pc != nullptr) {
+                sched(pc);
+            }
+            Loop();
+        } else if (setjmp(idle_ctx->Environment) > 0) {
+            // Here: some routine has finished or blocked, and nobody else was ready to run
+            Loop();
         } else if (pc != nullptr) {
             Store(*idle_ctx);
             sched(pc);
         }
 
         // Shutdown runtime
+        Drop();
+        cur_routine = nullptr;
         delete idle_ctx;
+        idle_ctx = nullptr;
         this->StackBottom = 0;
     }
 
     /**
      * Register new coroutine. It won't receive control until scheduled explicitely or implicitly. In case of some
-     * errors function returns -1
+     * errors, i.e. no memory for the stack, function returns nullptr
+     *
+     * kSeparateStack: arguments are copied unless function takes lvalue reference to them, those must outlive
+     * the routine
      */
-    template <typename... Ta> void *run(void (*func)(Ta...), Ta &&... args) {
+    template <typename... Ta, typename... Args> void *run(void (*func)(Ta...), Args &&... args) {
         if (this->StackBottom == 0) {
             // Engine wasn't initialized yet
             return nullptr;
         }
 
+        if (mode == Mode::kSeparateStack) {
+            // Arguments move to the heap, routine starts on a fresh stack and never sees this frame
+            return run(detail::Bind(func, std::forward<Args>(args)...));
+        }
+
         // New coroutine context that carries around all information enough to call function
         context *pc = new context();
 
-        // Store current state right here, i.e just before enter new coroutine, later, once it gets scheduled
-        // execution starts here. Note that we have to acquire stack of the current function call to ensure
-        // that function parameters will be passed along
         if (setjmp(pc->Environment) > 0) {
+            // Store current state right here, i.e just before enter new coroutine, later, once it gets scheduled
+            // execution starts here. Note that we have to acquire stack of the current function call to ensure
+            // that function parameters will be passed along
+
             // Created routine got control in order to start execution. Note that all variables, such as
             // context pointer, arguments and a pointer to the function comes from restored stack
 
             // invoke routine
-            func(std::forward<Ta>(args)...);
+            func(std::forward<Args>(args)...);
 
             // Routine has completed its execution, time to delete it. Note that we should be extremely careful in where
             // to pass control after that. We never want to go backward by stack as that would mean to go backward in
             // time. Function run() has already return once (when setjmp returns 0), so return second return from run
             // would looks a bit awkward
-            if (pc->prev != nullptr) {
-                pc->prev->next = pc->next;
-            }
-
-            if (pc->next != nullptr) {
-                pc->next->prev = pc->prev;
-            }
-
-            if (alive == cur_routine) {
-                alive = alive->next;
-            }
+            Unlink(*pc, alive);
 
             // current coroutine finished, and the pointer is not relevant now
             cur_routine = nullptr;
-            pc->prev = pc->next = nullptr;
-            delete std::get<0>(pc->Stack);
+            delete[] std::get<0>(pc->Stack);
             delete pc;
 
             // We cannot return here, as this function "returned" once already, so here we must select some other
             // coroutine to run. As current coroutine is completed and can't be scheduled anymore, it is safe to
             // just give up and ask scheduler code to select someone else, control will never returns to this one
             Restore(*idle_ctx);
+        } else {
+            // setjmp remembers position from which routine could starts execution, but to make it correctly
+            // it is neccessary to save arguments, pointer to body function, pointer to context, e.t.c - i.e
+            // save stack.
+            Store(*pc);
         }
 
-        // setjmp remembers position from which routine could starts execution, but to make it correctly
-        // it is neccessary to save arguments, pointer to body function, pointer to context, e.t.c - i.e
-        // save stack.
-        Store(*pc);
-
         // Add routine as alive double-linked list
-        pc->next = alive;
-        alive = pc;
-        if (pc->next != nullptr) {
-            pc->next->prev = pc;
-        }
-
+        Link(*pc, alive);
         return pc;
     }
+
+    /**
+     * kSeparateStack: registers new coroutine running the body, which engine takes ownership of. Closure
+     * could be bound on any thread, this way coroutine gets created for another one. Returns nullptr and
+     * deletes the body on errors, as the template above does, nullptr body is one of them
+     */
+    void *run(detail::Closure *body);
+};
+
+/**
+ * # FIFO of blocked routines
+ * Intrusive, links live in routine contexts, so queueing and waking are O(1) with no allocation. Routines
+ * stay in the blocked list of the engine as well, list must outlive them or be empty
+ */
+class Engine::WaitList {
+public:
+    WaitList() : head(nullptr), tail(nullptr) {}
+
+    inline bool empty() const { return head == nullptr; }
+
+private:
+    friend class Engine;
+
+    WaitList(const WaitList &) = delete;
+    WaitList &operator=(const WaitList &) = delete;
+
+    context *head;
+    context *tail;
 };
 
 } // namespace Coroutine
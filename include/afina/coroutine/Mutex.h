@@ -0,0 +1,52 @@
+#ifndef AFINA_COROUTINE_MUTEX_H
+#define AFINA_COROUTINE_MUTEX_H
+
+#include <chrono>
+
+#include <afina/coroutine/Engine.h>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * # Mutex for coroutines of one engine
+ * Coroutine that finds mutex locked blocks in the engine instead of spinning, others run meanwhile.
+ * Unlock hands ownership straight to the longest waiting coroutine, so nobody can barge in between and
+ * waiters are served in FIFO order.
+ *
+ * Meets TimedLockable for the steady clock, works with std::lock_guard and std::unique_lock. Not thread
+ * safe, lock must be called from a coroutine of the engine
+ */
+class Mutex {
+public:
+    explicit Mutex(Engine &engine) : _engine(engine), _locked(false) {}
+
+    void lock();
+
+    bool try_lock();
+
+    /**
+     * Waits for the mutex no longer than until deadline, false if it is not locked by then
+     */
+    bool try_lock_until(Engine::Clock::time_point deadline);
+
+    template <typename Rep, typename Period> bool try_lock_for(const std::chrono::duration<Rep, Period> &duration) {
+        return try_lock_until(Engine::Clock::now() + std::chrono::duration_cast<Engine::Clock::duration>(duration));
+    }
+
+    void unlock();
+
+private:
+    Mutex(const Mutex &) = delete;
+    Mutex &operator=(const Mutex &) = delete;
+
+    Engine &_engine;
+    bool _locked;
+
+    Engine::WaitList _waiters;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_MUTEX_H
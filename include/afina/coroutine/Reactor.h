@@ -0,0 +1,188 @@
+#ifndef AFINA_COROUTINE_REACTOR_H
+#define AFINA_COROUTINE_REACTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <afina/coroutine/Engine.h>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * # Coroutines doing blocking-style I/O over epoll
+ * Owns an Engine and an epoll instance. Read/Write/Accept look like their blocking counterparts to
+ * the calling coroutine: syscall is tried first, and if descriptor isn't ready the coroutine registers
+ * interest with epoll and blocks in the engine, so others run meanwhile. Once every coroutine waits,
+ * engine's idle function sleeps in epoll_wait and unblocks those whose descriptors became ready.
+ *
+ * Descriptors must be non-blocking, each one is waited on by at most one coroutine at a time. Every
+ * wait is EPOLLONESHOT, descriptor stays registered but disarmed in between and leaves epoll on close.
+ *
+ * Every wait takes an optional deadline, timers are those of the engine. Idle function sleeps in epoll
+ * until the earliest deadline with nanosecond precision (epoll_pwait2, milliseconds rounded up on older
+ * kernels), so a sleeping coroutine wakes neither early nor a tick late.
+ *
+ * I/O functions are static and work with the reactor running on the calling thread, see Current, so a
+ * coroutine that migrates between reactors (see Scheduler) waits wherever it runs at the moment.
+ *
+ * Engine runs in kSeparateStack mode, waiters keep their state on own stacks. All methods but Stop and
+ * Wake must be called from the thread running the reactor
+ */
+class Reactor {
+public:
+    explicit Reactor(std::size_t stack_size = Engine::kDefaultStackSize);
+
+    /**
+     * @param idle engine idle function instead of the default one, that polls until no coroutine waits for
+     * descriptors or a deadline. It is expected to call Poll
+     */
+    Reactor(std::size_t stack_size, std::function<bool()> idle);
+    ~Reactor();
+
+    /**
+     * Runs main as the first coroutine, returns once all coroutines are done
+     */
+    template <typename... Ta, typename... Args> void Run(void (*main)(Ta...), Args &&... args) {
+        Reactor *previous = _current;
+        _current = this;
+        _engine.start(main, std::forward<Args>(args)...);
+        _current = previous;
+    }
+
+    /**
+     * Reactor running on the calling thread, nullptr if there is none
+     */
+    static Reactor *Current();
+
+    /**
+     * Starts another coroutine, false if there is no memory for it
+     */
+    template <typename... Ta, typename... Args> bool Spawn(void (*func)(Ta...), Args &&... args) {
+        return _engine.run(func, std::forward<Args>(args)...) != nullptr;
+    }
+
+    /**
+     * Blocks calling coroutine until descriptor reports any of events, EPOLLERR and EPOLLHUP included
+     * always. Returns false with errno ETIMEDOUT once deadline passes, ECANCELED if reactor stops first,
+     * EINVAL outside of coroutines, or with errno of epoll_ctl if descriptor can't be waited on
+     */
+    static bool Wait(int fd, uint32_t events, Engine::Clock::time_point deadline = Engine::Clock::time_point::max());
+
+    /**
+     * Like read(2) on blocking descriptor: returns as soon as some data is available, 0 on end of stream.
+     * On stop returns -1 with errno ECANCELED, after deadline with ETIMEDOUT
+     */
+    static ssize_t Read(int fd, void *buf, std::size_t count,
+                        Engine::Clock::time_point deadline = Engine::Clock::time_point::max());
+
+    /**
+     * Like write(2) on blocking stream socket: returns once everything is written, or -1 on error. On stop
+     * returns -1 with errno ECANCELED, after deadline with ETIMEDOUT, bytes already written are lost for
+     * the caller
+     */
+    static ssize_t Write(int fd, const void *buf, std::size_t count,
+                         Engine::Clock::time_point deadline = Engine::Clock::time_point::max());
+
+    /**
+     * Like accept4(2) on blocking socket. On stop returns -1 with errno ECANCELED, after deadline with
+     * ETIMEDOUT
+     */
+    static int Accept(int fd, struct sockaddr *addr, socklen_t *len, int flags,
+                      Engine::Clock::time_point deadline = Engine::Clock::time_point::max());
+
+    /**
+     * Suspends calling coroutine until deadline, see Engine::sleep_until. Stop cuts the sleep short,
+     * returns false then
+     */
+    static bool SleepUntil(Engine::Clock::time_point deadline);
+
+    template <typename Rep, typename Period> static bool SleepFor(const std::chrono::duration<Rep, Period> &duration) {
+        return SleepUntil(Engine::Clock::now() + std::chrono::duration_cast<Engine::Clock::duration>(duration));
+    }
+
+    /**
+     * Waits for descriptors up to timeout, negative one means no limit, and unblocks waiters of the
+     * ready ones. Once reactor is stopped unblocks all waiters and expires all timers. Returns false
+     * once no coroutine waits for a descriptor anymore
+     */
+    bool Poll(std::chrono::nanoseconds timeout);
+
+    /**
+     * Timeout to poll with to wake up by the deadline, negative if there is none
+     */
+    static std::chrono::nanoseconds Until(Engine::Clock::time_point deadline);
+
+    /**
+     * Interrupts Poll sleeping on another thread, or makes the next one return at once. Safe to call from
+     * any thread
+     */
+    void Wake();
+
+    /**
+     * Makes every current and future wait fail, so coroutines notice the stop and finish. Safe to call
+     * from any thread
+     */
+    void Stop();
+
+    inline bool Stopped() const { return _stopped.load(std::memory_order_relaxed); }
+
+    inline Engine &engine() { return _engine; }
+
+private:
+    Reactor(const Reactor &) = delete;
+    Reactor &operator=(const Reactor &) = delete;
+
+    // Lives on the stack of the waiting coroutine, Poll fills it in before unblocking, so the coroutine
+    // doesn't have to touch the reactor once it resumes: it may be on another one by then
+    struct Waiter {
+        void *routine;
+        bool ready;
+        Reactor *reactor;
+        int fd;
+    };
+
+    /**
+     * Arms descriptor for the current coroutine and blocks it
+     */
+    bool Arm(int fd, uint32_t events, Engine::Clock::time_point deadline);
+
+    /**
+     * Engine timeout hook: forgets the waiter on the reactor thread
+     */
+    static void Forget(void *waiter);
+
+    /**
+     * epoll_wait with nanosecond timeout where kernel supports it
+     */
+    int Select(struct epoll_event *events, int max_events, std::chrono::nanoseconds timeout);
+
+    static thread_local Reactor *_current;
+
+    Engine _engine;
+
+    int _epoll_fd;
+
+    // Written by Wake to get the reactor thread out of epoll_wait
+    int _event_fd;
+
+    std::atomic<bool> _stopped;
+
+    // Coroutine waiting on every armed descriptor
+    std::unordered_map<int, Waiter *> _waiters;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_REACTOR_H
@@ -0,0 +1,166 @@
+#ifndef AFINA_COROUTINE_SCHEDULER_H
+#define AFINA_COROUTINE_SCHEDULER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <afina/coroutine/Engine.h>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * # M:N coroutine runtime
+ * Runs coroutines on a fixed number of threads. Every thread is a worker with its own Reactor and a
+ * Chase-Lev deque of routines ready to run:
+ * - routine spawned by a coroutine and routine whose descriptor became ready go to the deque of the
+ *   worker where it happened
+ * - worker that has nothing to run takes from its deque, then polls its epoll without sleeping, then
+ *   steals from the deques of others in random order
+ * - worker that found nothing anywhere sleeps in epoll_wait, whoever publishes work wakes one sleeper
+ *   through its eventfd
+ *
+ * So a routine runs wherever there is a free thread, it migrates together with its stack: stacks of all
+ * workers have the same size. Reactor I/O functions follow the routine, descriptor is waited on in epoll
+ * of the worker that runs the routine at the moment. Sleeping routine and routine waiting with a deadline
+ * stay on their worker until woken up, worker sleeps in epoll no longer than till the first deadline.
+ *
+ * Engine based primitives (Mutex, Channel and friends) are bound to one engine and must not be used by
+ * routines of a scheduler, neither should routine keep pointers to thread local data across a wait.
+ * errno is one: compiler may reuse its address, so routine should copy it right after the call that
+ * failed, as Reactor functions do.
+ *
+ * Stop cancels every wait, so routines doing I/O finish, Join waits until all threads are done. Routines
+ * left blocked otherwise are dropped without unwinding, as Engine does
+ */
+class Scheduler {
+public:
+    /**
+     * @param threads number of workers, at least one
+     * @param stack_size stack of every routine
+     */
+    explicit Scheduler(std::size_t threads, std::size_t stack_size = Engine::kDefaultStackSize);
+
+    // Stops and joins workers that are still running
+    ~Scheduler();
+
+    /**
+     * Starts worker threads. Every worker calls init with its index first, for example to pin itself
+     */
+    void Start(std::function<void(std::size_t)> init = nullptr);
+
+    /**
+     * Starts a new routine. Coroutine of this scheduler puts it to the deque of its worker, any other
+     * thread passes it to a worker round robin. Returns false if there is no memory for the routine or
+     * scheduler is stopped and routine is spawned from outside.
+     *
+     * Arguments are copied unless function takes lvalue reference to them, those must outlive the routine
+     */
+    template <typename... Ta, typename... Args> bool Spawn(void (*func)(Ta...), Args &&... args) {
+        detail::Closure *body = detail::Bind(func, std::forward<Args>(args)...);
+        return body != nullptr && Submit(body);
+    }
+
+    /**
+     * Lets another routine ready on the calling worker run, calling routine continues later on this or
+     * another worker. Noop outside of scheduler routines
+     */
+    static void Yield();
+
+    /**
+     * Cancels every current and future wait on descriptors, wakes sleepers up and makes workers exit once
+     * they have nothing to run. Safe to call from any thread
+     */
+    void Stop();
+
+    /**
+     * Waits until all workers are done
+     */
+    void Join();
+
+    inline bool Stopped() const { return _stopped.load(std::memory_order_relaxed); }
+
+    inline std::size_t Threads() const { return _workers.size(); }
+
+    /**
+     * Routines started, stolen by idle workers and times workers went to sleep, one "name value" pair
+     * per line with the prefix. Safe to call from any thread
+     */
+    std::string Dump(const std::string &prefix = "") const;
+
+private:
+    Scheduler(const Scheduler &) = delete;
+    Scheduler &operator=(const Scheduler &) = delete;
+
+    struct Worker;
+
+    /**
+     * Takes ownership of the body and starts it on the current or some worker
+     */
+    bool Submit(detail::Closure *body);
+
+    /**
+     * Worker thread body
+     */
+    void Run(Worker &worker, const std::function<void(std::size_t)> &init);
+
+    /**
+     * First routine of every worker, the work arrives through the idle function
+     */
+    static void Begin() {}
+
+    /**
+     * Engine idle function of worker: finds routine to run and adopts it, sleeps if there is none. False
+     * once scheduler is stopped and worker has nothing to wait for
+     */
+    bool Idle(Worker &worker);
+
+    /**
+     * Routine to run next: from own deque, from own epoll without sleeping, or stolen from another worker
+     */
+    bool Find(Worker &worker, void *&routine);
+
+    /**
+     * Routine from the deque of another worker, victims are tried in random order
+     */
+    bool Steal(Worker &worker, void *&routine);
+
+    /**
+     * Starts routines passed by other threads and moves every ready routine of the engine to the deque
+     */
+    void Publish(Worker &worker);
+
+    /**
+     * Wakes up one sleeping worker other than the given one, if any
+     */
+    void WakeOne(const Worker &worker);
+
+    /**
+     * True if there is something to run for the given worker
+     */
+    bool HasWork(const Worker &worker) const;
+
+    // Worker of the calling thread, nullptr on other threads
+    static thread_local Worker *_current;
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    std::vector<std::thread> _threads;
+
+    std::atomic<bool> _stopped;
+
+    // Worker to pass the next routine spawned from outside to
+    std::atomic<std::size_t> _next;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_SCHEDULER_H
@@ -0,0 +1,52 @@
+#ifndef AFINA_COROUTINE_SEMAPHORE_H
+#define AFINA_COROUTINE_SEMAPHORE_H
+
+#include <chrono>
+#include <cstddef>
+
+#include <afina/coroutine/Engine.h>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * # Counting semaphore for coroutines of one engine
+ * Acquire blocks coroutine in the engine while there are no permits. Release gives permit directly to
+ * the longest waiting coroutine if there is one. Not thread safe
+ */
+class Semaphore {
+public:
+    Semaphore(Engine &engine, std::size_t permits) : _engine(engine), _permits(permits) {}
+
+    void acquire();
+
+    bool try_acquire();
+
+    /**
+     * Waits for a permit no longer than until deadline, false if there is none by then
+     */
+    bool try_acquire_until(Engine::Clock::time_point deadline);
+
+    template <typename Rep, typename Period>
+    bool try_acquire_for(const std::chrono::duration<Rep, Period> &duration) {
+        return try_acquire_until(Engine::Clock::now() +
+                                 std::chrono::duration_cast<Engine::Clock::duration>(duration));
+    }
+
+    void release(std::size_t permits = 1);
+
+    inline std::size_t available() const { return _permits; }
+
+private:
+    Semaphore(const Semaphore &) = delete;
+    Semaphore &operator=(const Semaphore &) = delete;
+
+    Engine &_engine;
+    std::size_t _permits;
+    Engine::WaitList _waiters;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_SEMAPHORE_H
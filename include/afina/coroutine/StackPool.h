@@ -0,0 +1,114 @@
+#ifndef AFINA_COROUTINE_STACK_POOL_H
+#define AFINA_COROUTINE_STACK_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Afina {
+namespace Coroutine {
+
+/**
+ * # Coroutine stacks
+ * Every stack is a separate anonymous mapping with a PROT_NONE guard page right below it, so a
+ * coroutine that runs out of stack dies with SIGSEGV instead of overwriting a neighbour.
+ *
+ * Mappings are reserved, not committed: kernel gives a page memory when coroutine first touches it, so
+ * idle coroutine costs the few pages its frames occupy no matter how large the stack is.
+ *
+ * Released stacks go to a free list and are handed out again without any syscall. Pages below the
+ * keep_resident top bytes are returned to the OS with MADV_DONTNEED on release, so one deep call chain
+ * doesn't pin its memory for the lifetime of the pool while the hot top of the stack stays resident.
+ *
+ * Not thread safe, every Engine owns one. Stack of a coroutine migrating between engines moves from one
+ * pool to the other, see Disown and Adopt
+ */
+class StackPool {
+public:
+    struct Stack {
+        // Lowest usable address, guard page is right below
+        char *base = nullptr;
+
+        // Usable bytes, stack grows down from base + size
+        std::size_t size = 0;
+    };
+
+    struct Stats {
+        // Stacks mapped: in use plus free
+        std::size_t mapped = 0;
+        std::size_t in_use = 0;
+        std::size_t peak_in_use = 0;
+
+        // Deepest stack usage seen on release
+        std::size_t peak_used_bytes = 0;
+
+        // Memory returned with MADV_DONTNEED
+        uint64_t trimmed_bytes = 0;
+
+        uint64_t allocs = 0;
+        uint64_t reuses = 0;
+    };
+
+    /**
+     * @param stack_size usable bytes of every stack, rounded up to pages
+     * @param max_free free stacks kept mapped, the rest are unmapped on release
+     * @param keep_resident bytes at the top of released stack that stay committed
+     */
+    explicit StackPool(std::size_t stack_size, std::size_t max_free = 1024, std::size_t keep_resident = 16 * 1024);
+    ~StackPool();
+
+    /**
+     * Stack from free list or a new mapping. Throws std::bad_alloc if kernel refuses to map one
+     */
+    Stack Allocate();
+
+    /**
+     * Takes stack back, must not be in use anymore
+     */
+    void Release(const Stack &stack);
+
+    /**
+     * Takes over stack of a coroutine that moved here from another pool, it is released here later. Throws
+     * std::invalid_argument if stack size differs
+     */
+    void Adopt(const Stack &stack);
+
+    /**
+     * Forgets stack in use that moves to another pool along with its coroutine. Throws
+     * std::invalid_argument if stack size differs, so it can't be one of this pool
+     */
+    void Disown(const Stack &stack);
+
+    inline std::size_t StackSize() const { return _stack_size; }
+
+    inline Stats stats() const { return _stats; }
+
+    /**
+     * One "name value" pair per line, names start with the prefix
+     */
+    std::string Dump(const std::string &prefix = "") const;
+
+private:
+    StackPool(const StackPool &) = delete;
+    StackPool &operator=(const StackPool &) = delete;
+
+    void Unmap(char *base);
+
+    const std::size_t _page_size;
+    const std::size_t _stack_size;
+    const std::size_t _max_free;
+    const std::size_t _keep_resident;
+
+    std::vector<char *> _free;
+
+    // Residency of pages of the stack being released, kept to avoid allocation on every release
+    std::vector<unsigned char> _residency;
+
+    Stats _stats;
+};
+
+} // namespace Coroutine
+} // namespace Afina
+
+#endif // AFINA_COROUTINE_STACK_POOL_H
@@ -1,18 +1,56 @@
 #ifndef AFINA_EXECUTE_STATS_H
 #define AFINA_EXECUTE_STATS_H
 
+#include <functional>
 #include <string>
+#include <vector>
 
 #include "Command.h"
 
 namespace Afina {
 namespace Execute {
 
+/**
+ * # Report server statistics
+ * Statistics is organized in groups, each provided by some server component that has registered
+ * itself with Register. Command prints all groups if no arguments given, otherwise only requested
+ * ones, i.e "stats slabs" reports allocator state.
+ *
+ * Each line is sent as:
+ * STAT <name> <value>\r\n
+ * and the list is terminated by
+ * END
+ *
+ * If some of requested groups is unknown command reports ERROR
+ */
 class Stats : public Command {
 public:
+    /**
+     * Returns "name value" pairs, one per line
+     */
+    using Provider = std::function<std::string()>;
+
     Stats() {}
+    Stats(const std::vector<std::string> &groups) : _groups(groups) {}
     ~Stats() {}
+
+    inline const std::vector<std::string> &groups() const { return _groups; }
+
     void Execute(Storage &storage, const std::string &args, std::string &out) override;
+
+    /**
+     * Makes group available for the command, replaces previous provider of the same group.
+     * Provider could be called from any thread, it must take care of synchronization by itself
+     */
+    static void Register(const std::string &group, Provider provider);
+
+    /**
+     * Removes group, must be called before provider owner gets destroyed
+     */
+    static void Unregister(const std::string &group);
+
+private:
+    std::vector<std::string> _groups;
 };
 
 } // namespace Execute
@@ -2,8 +2,12 @@
 #define AFINA_NETWORK_SERVER_H
 
 #include <memory>
+#include <string>
 #include <vector>
 
+#include <afina/concurrency/CoreLocal.h>
+#include <afina/concurrency/Topology.h>
+
 namespace Afina {
 class Storage;
 namespace Logging {
@@ -11,6 +15,25 @@ class Service;
 }
 namespace Network {
 
+/**
+ * # Network activity counters
+ * Updated by every worker on every connection and command, so each one is spread over CPUs to
+ * keep workers from bouncing the same cache line
+ */
+struct Counters {
+    Concurrency::CoreCounter connections;
+    Concurrency::CoreCounter requests;
+    Concurrency::CoreCounter errors;
+
+    /**
+     * One "name value" pair per line
+     */
+    std::string Dump() const {
+        return "connections " + std::to_string(connections.Sum()) + "\nrequests " + std::to_string(requests.Sum()) +
+               "\nerrors " + std::to_string(errors.Sum());
+    }
+};
+
 /**
  * # Network processors coordinator
  * Configure resources for the network processors and coordinates all work
@@ -44,6 +67,18 @@ public:
      */
     virtual void Join() = 0;
 
+    /**
+     * Connections accepted, commands executed and connections failed so far, one "name value"
+     * pair per line. Implementations could append their own lines. Safe to call from any thread
+     */
+    virtual std::string DumpCounters() const { return _counters.Dump(); }
+
+    /**
+     * CPUs to run server threads on, must be set before Start. Implementations that don't support
+     * placement ignore it, by default threads are not pinned
+     */
+    void SetPlacement(const Concurrency::Placement &placement) { _placement = placement; }
+
 protected:
     /**
      * Instance of backing storeage on which current server should execute
@@ -55,6 +90,16 @@ protected:
      * Logging service to be used in order to report application progress
      */
     std::shared_ptr<Afina::Logging::Service> pLogging;
+
+    /**
+     * Activity of the network processors, see Counters
+     */
+    Counters _counters;
+
+    /**
+     * Where worker and helper threads run, see Concurrency::Placement
+     */
+    Concurrency::Placement _placement;
 };
 
 } // namespace Network
@@ -0,0 +1,218 @@
+#include <afina/allocator/Arena.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <afina/allocator/Error.h>
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
+namespace Afina {
+namespace Allocator {
+
+namespace {
+
+const char *HugePagesName(Arena::HugePages mode) {
+    switch (mode) {
+    case Arena::HugePages::Transparent:
+        return "transparent";
+    case Arena::HugePages::Explicit:
+        return "explicit";
+    default:
+        return "none";
+    }
+}
+
+} // namespace
+
+constexpr std::size_t Arena::kHugePageSize;
+
+// See Arena.h
+Arena::Arena(std::size_t size, std::size_t slab_size, HugePages huge_pages, bool prefault,
+             const std::vector<unsigned> &nodes)
+    : _map(MAP_FAILED), _map_len(0), _base(nullptr), _size(0), _slab_size(slab_size), _huge_pages(huge_pages),
+      _interleaved(0), _next_slab(0), _used_slabs(0), _resident_free(0), _allocs(0), _frees(0) {
+    const std::size_t page_size = sysconf(_SC_PAGESIZE);
+    if ((slab_size < page_size) || (slab_size & (slab_size - 1)) != 0) {
+        throw std::invalid_argument("Slab size must be power of two and not less than page size");
+    }
+
+    _size = (size + slab_size - 1) & ~(slab_size - 1);
+    if (_size == 0) {
+        throw std::invalid_argument("Arena size must be positive");
+    }
+
+    // Slabs are aligned by its size, so the slab owning any address could be found with a mask. Explicit
+    // huge pages are aligned by the kernel, for others reserve a bit more and skip unaligned head
+    std::size_t alignment = std::max(slab_size, kHugePageSize);
+
+    // Memory policy applies to pages faulted after it is set, so with NUMA nodes given prefault waits
+    bool populate_on_map = prefault && nodes.empty();
+    if (_huge_pages == HugePages::Explicit) {
+        _map_len = (_size + kHugePageSize - 1) & ~(kHugePageSize - 1);
+        _map = mmap(nullptr, _map_len, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (populate_on_map ? MAP_POPULATE : 0), -1, 0);
+        if (_map == MAP_FAILED || (reinterpret_cast<std::uintptr_t>(_map) & (alignment - 1)) != 0) {
+            if (_map != MAP_FAILED) {
+                munmap(_map, _map_len);
+            }
+            // No reserved huge pages, there is still a chance to get them from THP
+            _huge_pages = HugePages::Transparent;
+        }
+    }
+
+    if (_map == MAP_FAILED) {
+        // MAP_POPULATE faults memory before MADV_HUGEPAGE gets applied, so transparent mode populates later
+        int populate = (populate_on_map && _huge_pages == HugePages::None) ? MAP_POPULATE : 0;
+        _map_len = _size + alignment;
+        _map = mmap(nullptr, _map_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | populate,
+                    -1, 0);
+        if (_map == MAP_FAILED) {
+            throw AllocError(AllocErrorType::NoMemory, "Failed to map arena: " + std::string(strerror(errno)));
+        }
+    }
+
+    std::uintptr_t start = reinterpret_cast<std::uintptr_t>(_map);
+    _base = reinterpret_cast<char *>((start + alignment - 1) & ~(alignment - 1));
+
+    if (!nodes.empty()) {
+        Interleave(nodes);
+    }
+
+    bool populate_late = !populate_on_map && prefault;
+    if (_huge_pages == HugePages::Transparent) {
+        if (madvise(_base, _size, MADV_HUGEPAGE) != 0) {
+            _huge_pages = HugePages::None;
+        }
+
+        // Touch memory only after THP has been requested, so it gets faulted by huge pages
+        populate_late = prefault;
+    }
+
+    if (populate_late && madvise(_base, _size, MADV_POPULATE_WRITE) != 0) {
+        for (std::size_t off = 0; off < _size; off += page_size) {
+            _base[off] = 0;
+        }
+    }
+}
+
+// See Arena.h
+void Arena::Interleave(const std::vector<unsigned> &nodes) {
+    // Node mask as the kernel takes it: array of longs, maxnode is one more than the highest bit
+    const std::size_t bits = 8 * sizeof(unsigned long);
+    unsigned max_node = *std::max_element(nodes.begin(), nodes.end());
+    std::vector<unsigned long> mask(max_node / bits + 1, 0);
+    for (unsigned node : nodes) {
+        mask[node / bits] |= 1UL << (node % bits);
+    }
+
+    // Failure is not fatal: kernel without NUMA support or nodes outside of cpuset keep the
+    // default local policy
+    if (syscall(SYS_mbind, _base, _size, MPOL_INTERLEAVE, mask.data(), max_node + 2, 0) == 0) {
+        _interleaved = nodes.size();
+    }
+}
+
+// See Arena.h
+Arena::~Arena() {
+    if (_map != MAP_FAILED) {
+        munmap(_map, _map_len);
+    }
+}
+
+// See Arena.h
+void *Arena::AllocSlab() {
+    char *slab = nullptr;
+    if (!_free_slabs.empty()) {
+        slab = _free_slabs.back();
+        _free_slabs.pop_back();
+        _resident_free = 0;
+    } else if (_next_slab < _size) {
+        slab = _base + _next_slab;
+        _next_slab += _slab_size;
+    } else {
+        throw AllocError(AllocErrorType::NoMemory, "Arena has no free slabs");
+    }
+
+    _used_slabs++;
+    _allocs++;
+    return slab;
+}
+
+// See Arena.h
+void Arena::FreeSlab(void *slab) {
+    char *p = static_cast<char *>(slab);
+    if (p < _base || p >= _base + _next_slab || ((p - _base) & (_slab_size - 1)) != 0) {
+        throw AllocError(AllocErrorType::InvalidFree, "Pointer is not a slab of this arena");
+    }
+
+    // Only the top of free stack is resident, previous spare gets released
+    Trim();
+    _free_slabs.push_back(p);
+    _resident_free = 1;
+    _used_slabs--;
+    _frees++;
+}
+
+// See Arena.h
+void Arena::Trim() {
+    if (_resident_free > 0) {
+        Release(_free_slabs.back());
+        _resident_free = 0;
+    }
+}
+
+// See Arena.h
+void Arena::Release(void *slab) {
+    // Failure is not fatal, memory just stays resident
+    madvise(slab, _slab_size, MADV_DONTNEED);
+}
+
+// See Arena.h
+Stats Arena::stats() const {
+    Stats result;
+    result.total_bytes = _size;
+    result.live_bytes = result.used_bytes = _used_slabs * _slab_size;
+    result.allocs = _allocs;
+    result.frees = _frees;
+
+    // All slabs are the same, so any free one is as good as the largest
+    std::size_t free_slabs = _size / _slab_size - _used_slabs;
+    if (free_slabs > 0) {
+        result.free_bytes = free_slabs * _slab_size;
+        result.free_by_class[Stats::SizeClass(_slab_size)] = result.free_bytes;
+        result.largest_free = _slab_size;
+    }
+
+    result.Finish();
+    result.external_fragmentation = 0;
+    _rates.Update(result);
+    return result;
+}
+
+// See Arena.h
+std::string Arena::dump() const {
+    std::stringstream out;
+    out << "arena_slab_size " << _slab_size << "\n";
+    out << "arena_hugepages " << HugePagesName(_huge_pages) << "\n";
+    out << "arena_numa_interleave " << _interleaved << "\n";
+    out << "arena_slabs_total " << (_size / _slab_size) << "\n";
+    out << "arena_slabs_used " << _used_slabs << "\n";
+    out << "arena_slabs_resident_free " << _resident_free << "\n";
+    out << stats().dump("arena_");
+    return out.str();
+}
+
+} // namespace Allocator
+} // namespace Afina
@@ -0,0 +1,180 @@
+#include <afina/allocator/Mempool.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+
+#include <afina/allocator/Arena.h>
+#include <afina/allocator/Error.h>
+
+namespace Afina {
+namespace Allocator {
+
+/**
+ * Header placed at the beginning of each slab
+ */
+struct Mempool::slab {
+    // Links in the list of partially filled slabs
+    slab *prev;
+    slab *next;
+
+    // Objects freed in this slab, linked through its first word
+    void *free_list;
+
+    // Offset of the first object that has never been handed out
+    std::size_t untouched;
+
+    // Number of objects currently in use
+    std::size_t used;
+};
+
+namespace {
+
+const std::size_t kItemAlign = alignof(std::max_align_t);
+
+inline std::size_t AlignUp(std::size_t v, std::size_t a) { return (v + a - 1) & ~(a - 1); }
+
+} // namespace
+
+// See Mempool.h
+Mempool::Mempool(Arena &arena, std::size_t item_size)
+    : _arena(arena), _requested_size(item_size), _item_size(AlignUp(std::max(item_size, sizeof(void *)), kItemAlign)),
+      _partial(nullptr), _slabs(0), _items(0), _allocs(0), _frees(0) {
+    std::size_t header = AlignUp(sizeof(slab), kItemAlign);
+    if (header + _item_size > _arena.SlabSize()) {
+        throw std::invalid_argument("Object doesn't fit into arena slab");
+    }
+    _items_per_slab = (_arena.SlabSize() - header) / _item_size;
+}
+
+// See Mempool.h
+Mempool::~Mempool() {
+    // Full slabs are not linked anywhere, so objects left in the pool leak their slabs. That is
+    // intentional: memory belongs to arena and will be unmapped together with it
+    while (_partial != nullptr) {
+        slab *s = _partial;
+        Unlink(s);
+        if (s->used == 0) {
+            _arena.FreeSlab(s);
+        }
+    }
+}
+
+// See Mempool.h
+void *Mempool::Alloc() {
+    slab *s = _partial;
+    if (s == nullptr) {
+        s = static_cast<slab *>(_arena.AllocSlab());
+        s->prev = s->next = nullptr;
+        s->free_list = nullptr;
+        s->untouched = AlignUp(sizeof(slab), kItemAlign);
+        s->used = 0;
+
+        Link(s);
+        _slabs++;
+    }
+
+    void *result;
+    if (s->free_list != nullptr) {
+        result = s->free_list;
+        s->free_list = *static_cast<void **>(result);
+    } else {
+        result = reinterpret_cast<char *>(s) + s->untouched;
+        s->untouched += _item_size;
+    }
+
+    s->used++;
+    _items++;
+    _allocs++;
+    if (s->used == _items_per_slab) {
+        Unlink(s);
+    }
+    return result;
+}
+
+// See Mempool.h
+void Mempool::Free(void *ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+
+    std::uintptr_t mask = ~(static_cast<std::uintptr_t>(_arena.SlabSize()) - 1);
+    slab *s = reinterpret_cast<slab *>(reinterpret_cast<std::uintptr_t>(ptr) & mask);
+    if (s->used == 0) {
+        throw AllocError(AllocErrorType::InvalidFree, "Object doesn't belong to the pool");
+    }
+
+    if (s->used == _items_per_slab) {
+        Link(s);
+    }
+
+    *static_cast<void **>(ptr) = s->free_list;
+    s->free_list = ptr;
+    s->used--;
+    _items--;
+    _frees++;
+
+    if (s->used == 0) {
+        Unlink(s);
+        _arena.FreeSlab(s);
+        _slabs--;
+    }
+}
+
+// See Mempool.h
+Stats Mempool::stats() const {
+    Stats result;
+    result.total_bytes = _slabs * _arena.SlabSize();
+    result.live_bytes = _items * _requested_size;
+    result.allocs = _allocs;
+    result.frees = _frees;
+
+    std::size_t free_items = _slabs * _items_per_slab - _items;
+    result.used_bytes = result.total_bytes - free_items * _item_size;
+    if (free_items > 0) {
+        result.free_bytes = free_items * _item_size;
+        result.free_by_class[Stats::SizeClass(_item_size)] = result.free_bytes;
+        result.largest_free = _item_size;
+    }
+
+    result.Finish();
+    result.external_fragmentation = result.total_bytes > 0 ? double(result.free_bytes) / result.total_bytes : 0;
+    _rates.Update(result);
+    return result;
+}
+
+// See Mempool.h
+std::string Mempool::dump() const {
+    std::stringstream out;
+    out << "pool_item_size " << _item_size << "\n";
+    out << "pool_items_per_slab " << _items_per_slab << "\n";
+    out << "pool_slabs " << _slabs << "\n";
+    out << stats().dump("pool_");
+    return out.str();
+}
+
+void Mempool::Link(slab *s) {
+    s->prev = nullptr;
+    s->next = _partial;
+    if (_partial != nullptr) {
+        _partial->prev = s;
+    }
+    _partial = s;
+}
+
+void Mempool::Unlink(slab *s) {
+    if (s->prev != nullptr) {
+        s->prev->next = s->next;
+    } else {
+        _partial = s->next;
+    }
+    if (s->next != nullptr) {
+        s->next->prev = s->prev;
+    }
+    s->prev = s->next = nullptr;
+}
+
+} // namespace Allocator
+} // namespace Afina
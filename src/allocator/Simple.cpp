@@ -1,40 +1,294 @@
 #include <afina/allocator/Simple.h>
 
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include <afina/allocator/Error.h>
 #include <afina/allocator/Pointer.h>
 
 namespace Afina {
 namespace Allocator {
 
-Simple::Simple(void *base, size_t size) : _base(base), _base_len(size) {}
-
 /**
- * TODO: semantics
- * @param N size_t
+ * Header of each block, payload follows right after it
  */
-Pointer Simple::alloc(size_t N) { return Pointer(); }
+struct Simple::block {
+    // Payload size
+    size_t size;
+
+    // Size caller asked for, to account internal fragmentation
+    size_t requested;
+
+    // Descriptor pointing to the payload, nullptr for free blocks
+    void **slot;
+};
+
+namespace {
+
+const size_t kAlign = sizeof(void *);
+
+inline size_t AlignUp(size_t v) { return (v + kAlign - 1) & ~(kAlign - 1); }
+
+} // namespace
+
+Simple::Simple(void *base, size_t size)
+    : _base(base), _base_len(size), _free_slot(nullptr), _allocs(0), _frees(0) {
+    std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(base);
+    std::uintptr_t end = begin + size;
+
+    _first = reinterpret_cast<char *>(AlignUp(begin));
+    _top = _first;
+    _end = reinterpret_cast<void **>(end & ~(kAlign - 1));
+    _slots = _end;
+}
+
+// See Simple.h
+Pointer Simple::alloc(size_t N) {
+    void **slot = AllocSlot();
+
+    block *b;
+    try {
+        b = AllocBlock(AlignUp(std::max<size_t>(N, 1)));
+    } catch (AllocError &) {
+        FreeSlot(slot);
+        throw;
+    }
+
+    b->slot = slot;
+    b->requested = N;
+    *slot = b + 1;
+
+    _allocs++;
+    return Pointer(slot);
+}
+
+// See Simple.h
+void Simple::realloc(Pointer &p, size_t N) {
+    if (p._slot == nullptr) {
+        p = alloc(N);
+        return;
+    }
+
+    void **slot = p._slot;
+    if (slot < _slots || slot >= _end || *slot < _first || *slot >= _top) {
+        throw AllocError(AllocErrorType::InvalidFree, "Pointer doesn't belong to allocator");
+    }
+
+    size_t size = AlignUp(std::max<size_t>(N, 1));
+    block *b = static_cast<block *>(*slot) - 1;
+
+    // Swallow free neighbours, trailing free space goes back to wilderness
+    block *next = Next(b);
+    if (reinterpret_cast<char *>(next) < _top && next->slot == nullptr) {
+        Merge(next);
+        if (reinterpret_cast<char *>(Next(next)) == _top) {
+            _top = reinterpret_cast<char *>(next);
+        } else if (b->size + sizeof(block) + next->size >= size) {
+            b->size += sizeof(block) + next->size;
+        }
+    }
+
+    if (reinterpret_cast<char *>(Next(b)) == _top && b->size < size && size - b->size <= Wilderness()) {
+        b->size = size;
+        _top = reinterpret_cast<char *>(Next(b));
+    }
+
+    if (b->size >= size) {
+        Split(b, size);
+        b->requested = N;
+        return;
+    }
+
+    // Doesn't fit in place, move data somewhere else. Allocation failure leaves block untouched
+    block *nb = AllocBlock(size);
+    std::memcpy(nb + 1, b + 1, b->size);
+    nb->slot = slot;
+    nb->requested = N;
+    *slot = nb + 1;
+    FreeBlock(b);
+
+    _allocs++;
+    _frees++;
+}
+
+// See Simple.h
+void Simple::free(Pointer &p) {
+    void **slot = p._slot;
+    if (slot == nullptr) {
+        return;
+    }
+
+    if (slot < _slots || slot >= _end || *slot < _first || *slot >= _top) {
+        throw AllocError(AllocErrorType::InvalidFree, "Pointer doesn't belong to allocator");
+    }
+
+    block *b = static_cast<block *>(*slot) - 1;
+    if (b->slot != slot) {
+        throw AllocError(AllocErrorType::InvalidFree, "Pointer has been already freed");
+    }
+
+    FreeBlock(b);
+    FreeSlot(slot);
+    p._slot = nullptr;
+    _frees++;
+}
+
+// See Simple.h
+void Simple::defrag() {
+    char *write = _first;
+    for (char *cur = _first; cur < _top;) {
+        block *b = reinterpret_cast<block *>(cur);
+        size_t len = sizeof(block) + b->size;
+
+        if (b->slot != nullptr) {
+            if (cur != write) {
+                std::memmove(write, cur, len);
+            }
+
+            block *nb = reinterpret_cast<block *>(write);
+            *nb->slot = nb + 1;
+            write += len;
+        }
+        cur += len;
+    }
+
+    _top = write;
+}
+
+// See Simple.h
+Stats Simple::stats() const {
+    Stats result;
+    result.total_bytes = _base_len;
+    result.allocs = _allocs;
+    result.frees = _frees;
+
+    // Descriptors table is pure overhead
+    result.used_bytes = (_end - _slots) * sizeof(void *);
+
+    for (block *b = reinterpret_cast<block *>(_first); reinterpret_cast<char *>(b) < _top; b = Next(b)) {
+        if (b->slot != nullptr) {
+            result.used_bytes += sizeof(block) + b->size;
+            result.live_bytes += b->requested;
+        } else {
+            result.AddFree(b->size);
+        }
+    }
+
+    // Wilderness could serve one more block, if there is a space for header and descriptor
+    size_t overhead = sizeof(block) + (_free_slot == nullptr ? sizeof(void *) : 0);
+    if (Wilderness() > overhead) {
+        result.AddFree(Wilderness() - overhead);
+    }
+
+    result.Finish();
+    _rates.Update(result);
+    return result;
+}
+
+// See Simple.h
+std::string Simple::dump() const { return stats().dump(); }
+
+Simple::block *Simple::Next(block *b) const {
+    return reinterpret_cast<block *>(reinterpret_cast<char *>(b + 1) + b->size);
+}
 
 /**
- * TODO: semantics
- * @param p Pointer
- * @param N size_t
+ * First fit search over blocks, merges adjacent free blocks along the way
  */
-void Simple::realloc(Pointer &p, size_t N) {}
+Simple::block *Simple::FindFree(size_t size) {
+    for (block *b = reinterpret_cast<block *>(_first); reinterpret_cast<char *>(b) < _top; b = Next(b)) {
+        if (b->slot != nullptr) {
+            continue;
+        }
+
+        Merge(b);
+        if (reinterpret_cast<char *>(Next(b)) == _top) {
+            _top = reinterpret_cast<char *>(b);
+            break;
+        }
+
+        if (b->size >= size) {
+            return b;
+        }
+    }
+    return nullptr;
+}
 
 /**
- * TODO: semantics
- * @param p Pointer
+ * Returns block of exactly size bytes either reusing free one or cutting it from the wilderness
  */
-void Simple::free(Pointer &p) {}
+Simple::block *Simple::AllocBlock(size_t size) {
+    block *b = FindFree(size);
+    if (b != nullptr) {
+        Split(b, size);
+        return b;
+    }
+
+    if (sizeof(block) + size > Wilderness()) {
+        throw AllocError(AllocErrorType::NoMemory, "No free block of requested size");
+    }
+
+    b = reinterpret_cast<block *>(_top);
+    b->size = size;
+    b->requested = 0;
+    b->slot = nullptr;
+    _top = reinterpret_cast<char *>(Next(b));
+    return b;
+}
+
+void Simple::FreeBlock(block *b) {
+    b->slot = nullptr;
+    b->requested = 0;
+
+    Merge(b);
+    if (reinterpret_cast<char *>(Next(b)) == _top) {
+        _top = reinterpret_cast<char *>(b);
+    }
+}
 
 /**
- * TODO: semantics
+ * Cut tail of the block into a separate free block if there is enough space for it
  */
-void Simple::defrag() {}
+void Simple::Split(block *b, size_t size) {
+    if (b->size < size + sizeof(block) + kAlign) {
+        return;
+    }
+
+    block *rest = reinterpret_cast<block *>(reinterpret_cast<char *>(b + 1) + size);
+    rest->size = b->size - size - sizeof(block);
+    b->size = size;
+    FreeBlock(rest);
+}
 
 /**
- * TODO: semantics
+ * Merge all free blocks following the given free one into it
  */
-std::string Simple::dump() const { return ""; }
+void Simple::Merge(block *b) {
+    for (block *next = Next(b); reinterpret_cast<char *>(next) < _top && next->slot == nullptr; next = Next(b)) {
+        b->size += sizeof(block) + next->size;
+    }
+}
+
+void **Simple::AllocSlot() {
+    if (_free_slot != nullptr) {
+        void **slot = _free_slot;
+        _free_slot = static_cast<void **>(*slot);
+        return slot;
+    }
+
+    if (Wilderness() < sizeof(void *)) {
+        throw AllocError(AllocErrorType::NoMemory, "No space for descriptor");
+    }
+    return --_slots;
+}
+
+void Simple::FreeSlot(void **slot) {
+    *slot = _free_slot;
+    _free_slot = slot;
+}
+
+size_t Simple::Wilderness() const { return reinterpret_cast<char *>(_slots) - _top; }
 
 } // namespace Allocator
 } // namespace Afina
@@ -0,0 +1,79 @@
+#include <afina/allocator/Stats.h>
+
+#include <sstream>
+
+namespace Afina {
+namespace Allocator {
+
+// See Stats.h
+Stats::Stats()
+    : total_bytes(0), live_bytes(0), used_bytes(0), free_bytes(0), largest_free(0), allocs(0), frees(0),
+      alloc_rate(0), free_rate(0), internal_fragmentation(0), external_fragmentation(0) {}
+
+// See Stats.h
+std::size_t Stats::SizeClass(std::size_t size) {
+    std::size_t cls = 8;
+    while (cls < size) {
+        cls <<= 1;
+    }
+    return cls;
+}
+
+// See Stats.h
+void Stats::AddFree(std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+
+    free_bytes += size;
+    free_by_class[SizeClass(size)] += size;
+    if (size > largest_free) {
+        largest_free = size;
+    }
+}
+
+// See Stats.h
+void Stats::Finish() {
+    internal_fragmentation = used_bytes > 0 ? double(used_bytes - live_bytes) / used_bytes : 0;
+    external_fragmentation = free_bytes > 0 ? 1.0 - double(largest_free) / free_bytes : 0;
+}
+
+// See Stats.h
+std::string Stats::dump(const std::string &prefix) const {
+    std::stringstream out;
+    out << prefix << "total_bytes " << total_bytes << "\n";
+    out << prefix << "live_bytes " << live_bytes << "\n";
+    out << prefix << "used_bytes " << used_bytes << "\n";
+    out << prefix << "free_bytes " << free_bytes << "\n";
+    out << prefix << "largest_free " << largest_free << "\n";
+    for (auto &cls : free_by_class) {
+        out << prefix << "free_class_" << cls.first << " " << cls.second << "\n";
+    }
+    out << prefix << "allocs " << allocs << "\n";
+    out << prefix << "frees " << frees << "\n";
+    out << prefix << "alloc_rate " << alloc_rate << "\n";
+    out << prefix << "free_rate " << free_rate << "\n";
+    out << prefix << "internal_fragmentation " << internal_fragmentation << "\n";
+    out << prefix << "external_fragmentation " << external_fragmentation;
+    return out.str();
+}
+
+// See Stats.h
+RateWindow::RateWindow() : _last(std::chrono::steady_clock::now()), _allocs(0), _frees(0) {}
+
+// See Stats.h
+void RateWindow::Update(Stats &stats) {
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - _last).count();
+    if (seconds > 0) {
+        stats.alloc_rate = (stats.allocs - _allocs) / seconds;
+        stats.free_rate = (stats.frees - _frees) / seconds;
+    }
+
+    _last = now;
+    _allocs = stats.allocs;
+    _frees = stats.frees;
+}
+
+} // namespace Allocator
+} // namespace Afina
@@ -0,0 +1,189 @@
+#include <afina/concurrency/Epoch.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace Afina {
+namespace Concurrency {
+
+// See Epoch.h
+EpochDomain::EpochDomain() : _epoch(1), _retired(0), _reclaimed(0), _has_orphans(false), _closing(false) {}
+
+// See Epoch.h
+EpochDomain::~EpochDomain() {
+    std::lock_guard<std::mutex> lock(_orphans_lock);
+    _closing = true;
+    for (auto &item : _orphans) {
+        item.deleter(item.ptr);
+    }
+    _orphans.clear();
+
+    // Records of live threads are destroyed with _records and free their lists by themselves
+}
+
+// See Epoch.h
+EpochDomain &EpochDomain::Global() {
+    // Detached threads could still use it while static objects are being destroyed
+    static EpochDomain *instance = new EpochDomain();
+    return *instance;
+}
+
+EpochDomain::Record::~Record() {
+    if (domain == nullptr || limbo.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(domain->_orphans_lock);
+    if (domain->_closing) {
+        for (auto &item : limbo) {
+            item.deleter(item.ptr);
+        }
+    } else {
+        domain->_orphans.insert(domain->_orphans.end(), limbo.begin(), limbo.end());
+        domain->_has_orphans.store(true, std::memory_order_release);
+    }
+}
+
+EpochDomain::Record &EpochDomain::Local() {
+    Record &record = _records.Get();
+    if (record.domain == nullptr) {
+        record.domain = this;
+    }
+    return record;
+}
+
+// See Epoch.h
+void EpochDomain::Enter() { Pin(); }
+
+// See Epoch.h
+void EpochDomain::Leave() { Unpin(&Local()); }
+
+EpochDomain::Record *EpochDomain::Pin() {
+    Record &record = Local();
+    if (record.nesting++ == 0) {
+        Announce(record);
+    }
+    return &record;
+}
+
+void EpochDomain::Unpin(Record *record) {
+    if (--record->nesting == 0) {
+        record->state.store(0, std::memory_order_release);
+    }
+}
+
+void EpochDomain::Announce(Record &record) {
+    record.state.store((_epoch.load(std::memory_order_relaxed) << 1) | 1, std::memory_order_relaxed);
+
+    // Announcement must be visible before any pointer is read, otherwise epoch could move on
+    // without noticing the reader
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+// See Epoch.h
+void EpochDomain::Retire(void *ptr, Deleter deleter) {
+    Record &record = Local();
+
+    // Unlink of ptr must be ordered before the epoch it is tagged with
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    record.limbo.push_back(Garbage{ptr, deleter, _epoch.load(std::memory_order_relaxed)});
+    _retired.fetch_add(1, std::memory_order_relaxed);
+
+    if (++record.since_collect >= kCollectThreshold) {
+        record.since_collect = 0;
+        TryAdvance();
+        Collect(record.limbo);
+    }
+}
+
+// See Epoch.h
+void EpochDomain::Quiescent() {
+    Record &record = Local();
+    if (record.nesting > 0) {
+        Announce(record);
+    }
+
+    if (!record.limbo.empty() || _has_orphans.load(std::memory_order_relaxed)) {
+        TryAdvance();
+        Collect(record.limbo);
+        CollectOrphans();
+    }
+}
+
+// See Epoch.h
+void EpochDomain::Synchronize() {
+    Record &record = Local();
+    uint64_t target = _epoch.load() + 2;
+    while (_epoch.load() < target) {
+        uint64_t before = _epoch.load();
+        TryAdvance();
+        if (_epoch.load() == before) {
+            std::this_thread::yield();
+        }
+    }
+
+    Collect(record.limbo);
+    CollectOrphans();
+}
+
+void EpochDomain::TryAdvance() {
+    // Pairs with the fence in Announce: either reader is seen here or it sees unlinked structure
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    uint64_t epoch = _epoch.load(std::memory_order_acquire);
+    bool lagging = false;
+    _records.ForEach([epoch, &lagging](const Record &record) {
+        uint64_t state = record.state.load(std::memory_order_acquire);
+        if ((state & 1) != 0 && (state >> 1) != epoch) {
+            lagging = true;
+        }
+    });
+
+    if (!lagging) {
+        _epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel);
+    }
+}
+
+void EpochDomain::Collect(std::vector<Garbage> &limbo) {
+    uint64_t epoch = _epoch.load(std::memory_order_acquire);
+    auto safe =
+        std::find_if(limbo.begin(), limbo.end(), [epoch](const Garbage &item) { return item.epoch + 2 > epoch; });
+    if (safe == limbo.begin()) {
+        return;
+    }
+
+    // Deleter could retire something too, so list must be consistent before calling it
+    std::vector<Garbage> freed(limbo.begin(), safe);
+    limbo.erase(limbo.begin(), safe);
+    for (auto &item : freed) {
+        item.deleter(item.ptr);
+    }
+    _reclaimed.fetch_add(freed.size(), std::memory_order_relaxed);
+}
+
+void EpochDomain::CollectOrphans() {
+    if (!_has_orphans.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    // Orphans come from different threads, so they are not ordered by epoch
+    std::vector<Garbage> orphans;
+    {
+        std::lock_guard<std::mutex> lock(_orphans_lock);
+        orphans.swap(_orphans);
+        _has_orphans.store(false, std::memory_order_relaxed);
+    }
+
+    std::stable_sort(orphans.begin(), orphans.end(),
+                     [](const Garbage &a, const Garbage &b) { return a.epoch < b.epoch; });
+    Collect(orphans);
+
+    if (!orphans.empty()) {
+        std::lock_guard<std::mutex> lock(_orphans_lock);
+        _orphans.insert(_orphans.end(), orphans.begin(), orphans.end());
+        _has_orphans.store(true, std::memory_order_release);
+    }
+}
+
+} // namespace Concurrency
+} // namespace Afina
@@ -0,0 +1,77 @@
+#include <afina/concurrency/EventCount.h>
+
+#include <cerrno>
+#include <climits>
+#include <ctime>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Concurrency {
+
+namespace {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex needs plain 32 bit word");
+
+inline uint32_t *Word(std::atomic<uint32_t> &word) { return reinterpret_cast<uint32_t *>(&word); }
+
+} // namespace
+
+// See EventCount.h
+EventCount::Key EventCount::PrepareWait() {
+    _waiters.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return _epoch.load(std::memory_order_acquire);
+}
+
+// See EventCount.h
+void EventCount::CancelWait() { _waiters.fetch_sub(1, std::memory_order_seq_cst); }
+
+// See EventCount.h
+bool EventCount::Wait(Key key, std::chrono::milliseconds timeout) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    bool woken = true;
+    while (_epoch.load(std::memory_order_acquire) == key) {
+        struct timespec ts, *pts = nullptr;
+        if (timeout.count() >= 0) {
+            auto left =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now());
+            if (left.count() <= 0) {
+                woken = false;
+                break;
+            }
+            ts.tv_sec = left.count() / 1000000000;
+            ts.tv_nsec = left.count() % 1000000000;
+            pts = &ts;
+        }
+
+        // EAGAIN means epoch has moved already, EINTR and spurious wakeups are handled by the loop
+        syscall(SYS_futex, Word(_epoch), FUTEX_WAIT_PRIVATE, key, pts, nullptr, 0);
+    }
+
+    _waiters.fetch_sub(1, std::memory_order_seq_cst);
+    return woken;
+}
+
+// See EventCount.h
+void EventCount::Notify(int count) { Bump(count); }
+
+// See EventCount.h
+void EventCount::NotifyAll() { Bump(INT_MAX); }
+
+void EventCount::Bump(int count) {
+    // Pairs with fence in PrepareWait: either waiter sees the new condition or we see the waiter
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_waiters.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    _epoch.fetch_add(1, std::memory_order_release);
+    syscall(SYS_futex, Word(_epoch), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+} // namespace Concurrency
+} // namespace Afina
@@ -1,74 +1,330 @@
 #include <afina/concurrency/Executor.h>
 
+#include <climits>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
 namespace Afina {
 namespace Concurrency {
 
-Executor::Executor(int low_watermark, int high_watermark, int max_queue_size, std::chrono::milliseconds idle_time)
-    : _low_watermark(low_watermark), _high_watermark(high_watermark), _max_queue_size(max_queue_size),
-      _idle_time(idle_time), _active_workers(0), _free_workers(0), _state(Executor::State::kRun) {
-    std::unique_lock<std::mutex> lock(_mutex);
+Executor::Executor(int low_watermark, int high_watermark, int max_queue_size, std::chrono::milliseconds idle_time,
+                   const std::array<unsigned, kPriorities> &weights, const std::vector<unsigned> &cpus)
+    : _state(Executor::State::kRun), _low_watermark(low_watermark), _high_watermark(high_watermark),
+      _max_queue_size(max_queue_size), _idle_time(idle_time), _cpus(cpus), _workers(0), _active_workers(0),
+      _free_workers(0), _threads(0), _submitting(0), _queued(0), _retired_completed(0), _created(Clock::now()), _spawned(0),
+      _retired(0) {
+    // Queue is a ring of at least one slot, so an empty one can't be built and would otherwise turn
+    // into a queue of one
+    if (max_queue_size <= 0) {
+        throw std::invalid_argument("Queue size must be positive, got " + std::to_string(max_queue_size));
+    }
+
+    for (auto &queue : _tasks) {
+        queue.reset(new MPMCQueue<Job>(max_queue_size));
+    }
+
+    // Smooth weighted round robin: every turn each queue gains its weight and the richest one
+    // pays the total, so turns of a queue come at even intervals instead of in a row
+    unsigned total = 0;
+    long credit[kPriorities] = {0};
+    for (auto weight : weights) {
+        total += weight > 0 ? weight : 1;
+    }
+    for (unsigned turn = 0; turn < total; turn++) {
+        std::size_t best = 0;
+        for (std::size_t p = 0; p < kPriorities; p++) {
+            credit[p] += weights[p] > 0 ? weights[p] : 1;
+            if (credit[p] > credit[best]) {
+                best = p;
+            }
+        }
+        credit[best] -= total;
+        _schedule.push_back(best);
+    }
+
     for (int i = 0; i < low_watermark; ++i) {
-        std::thread(&perform, this).detach();
-        ++_free_workers;
+        Spawn();
     }
 }
 
 void Executor::Stop(bool await) {
     std::unique_lock<std::mutex> lock(_mutex);
-    _state = Executor::State::kStopping;
-    _empty_condition.notify_all();
+    if (_state.load() == Executor::State::kRun) {
+        _state.store(Executor::State::kStopping);
+    }
+    _empty_condition.NotifyAll();
 
-    if (_tasks.size() == 0) {
-        _state = Executor::State::kStopped;
+    if (_threads.load() == 0) {
+        _state.store(Executor::State::kStopped);
         return;
     }
 
     if (await) {
-        _stop_condition.wait(lock, [this]() { return _active_workers + _free_workers == 0; });
-        _state = Executor::State::kStopped;
+        _stop_condition.wait(lock, [this]() { return _threads.load() == 0; });
+        _state.store(Executor::State::kStopped);
+    }
+}
+
+uint64_t Executor::Completed() const {
+    return _retired_completed.load() +
+           _completed.Aggregate(uint64_t(0), [](uint64_t sum, const std::atomic<uint64_t> &completed) {
+               return sum + completed.load(std::memory_order_relaxed);
+           });
+}
+
+std::vector<uint64_t> Executor::CompletedPerThread() const {
+    std::vector<uint64_t> result;
+    _completed.ForEach([&result](const std::atomic<uint64_t> &completed) {
+        result.push_back(completed.load(std::memory_order_relaxed));
+    });
+    return result;
+}
+
+bool Executor::Post(Options &&options, Task task) {
+    auto &queue = *_tasks[static_cast<std::size_t>(options.priority)];
+
+    // Submitter is announced before state check, so workers that have seen stop won't leave
+    // while the task is on the way to the queue
+    _submitting.fetch_add(1);
+    bool running = _state.load() == State::kRun;
+    bool accepted = false;
+    if (running && Reserve(1)) {
+        accepted = queue.TryEmplace(std::move(task), Clock::now(), options.deadline, std::move(options.on_expired));
+        if (!accepted) {
+            _queued.fetch_sub(1);
+        }
+    }
+    _submitting.fetch_sub(1);
+    if (!accepted) {
+        if (running) {
+            _rejected.Add();
+        }
+        return false;
+    }
+
+    _empty_condition.Notify();
+    if (_free_workers.load() == 0) {
+        Spawn();
+    }
+    return true;
+}
+
+bool Executor::ExecuteBatch(Priority priority, Task *tasks, std::size_t count) {
+    if (count == 0) {
+        return true;
+    }
+
+    std::vector<Job> jobs;
+    jobs.reserve(count);
+    auto now = Clock::now();
+    for (std::size_t i = 0; i < count; i++) {
+        jobs.emplace_back(std::move(tasks[i]), now, Clock::time_point::max(), nullptr);
+    }
+
+    // See Post
+    _submitting.fetch_add(1);
+    bool running = _state.load() == State::kRun;
+    bool accepted = false;
+    if (running && count <= std::size_t(_max_queue_size) && Reserve(int(count))) {
+        accepted = _tasks[static_cast<std::size_t>(priority)]->TryPushBulk(jobs.data(), count);
+        if (!accepted) {
+            _queued.fetch_sub(int(count));
+        }
+    }
+    _submitting.fetch_sub(1);
+    if (!accepted) {
+        if (running) {
+            _rejected.Add(count);
+        }
+        return false;
+    }
+
+    _empty_condition.Notify(count > INT_MAX ? INT_MAX : int(count));
+    for (std::size_t free = _free_workers.load(); free < count && _workers.load() < _high_watermark; free++) {
+        Spawn();
+    }
+    return true;
+}
+
+bool Executor::Pop(Job &job, std::size_t &turn) {
+    std::size_t preferred = _schedule[turn++ % _schedule.size()];
+    if (_tasks[preferred]->TryPop(job)) {
+        _queued.fetch_sub(1);
+        return true;
+    }
+
+    for (std::size_t p = 0; p < kPriorities; p++) {
+        if (p != preferred && _tasks[p]->TryPop(job)) {
+            _queued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Executor::Reserve(int count) {
+    int queued = _queued.load(std::memory_order_relaxed);
+    do {
+        if (queued > _max_queue_size - count) {
+            return false;
+        }
+    } while (!_queued.compare_exchange_weak(queued, queued + count));
+    return true;
+}
+
+bool Executor::Empty() const {
+    for (auto &queue : _tasks) {
+        if (!queue->Empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string Executor::DumpStats(const std::string &prefix) const {
+    std::stringstream out;
+    out << prefix << "threads " << _workers.load() << "\n";
+    out << prefix << "threads_active " << _active_workers.load() << "\n";
+    out << prefix << "threads_free " << _free_workers.load() << "\n";
+    out << prefix << "threads_spawned " << _spawned.load() << "\n";
+    out << prefix << "threads_retired " << _retired.load() << "\n";
+
+    double lifetime = std::chrono::duration<double, std::nano>(Clock::now() - _created).count();
+    out << prefix << "active_avg " << std::fixed << std::setprecision(3)
+        << (lifetime > 0 ? _busy_ns.Sum() / lifetime : 0.0) << "\n";
+
+    out << prefix << "tasks_completed " << Completed() << "\n";
+    out << prefix << "tasks_rejected " << _rejected.Sum() << "\n";
+    out << prefix << "tasks_expired " << _expired.Sum() << "\n";
+    out << prefix << "queued_high " << _tasks[0]->SizeApprox() << "\n";
+    out << prefix << "queued_normal " << _tasks[1]->SizeApprox() << "\n";
+    out << prefix << "queued_low " << _tasks[2]->SizeApprox();
+
+    const char *names[] = {"queue_wait_us_", "run_us_"};
+    Histogram::Snapshot snapshots[] = {_queue_wait.Take(), _run_time.Take()};
+    for (int i = 0; i < 2; i++) {
+        auto &snapshot = snapshots[i];
+        out << "\n" << prefix << names[i] << "mean " << snapshot.Mean() / 1000;
+        out << "\n" << prefix << names[i] << "p50 " << snapshot.Percentile(0.5) / 1000.0;
+        out << "\n" << prefix << names[i] << "p99 " << snapshot.Percentile(0.99) / 1000.0;
+        out << "\n" << prefix << names[i] << "max " << snapshot.max / 1000.0;
+    }
+    return out.str();
+}
+
+void Executor::Spawn() {
+    int workers = _workers.load();
+    do {
+        if (workers >= _high_watermark) {
+            return;
+        }
+    } while (!_workers.compare_exchange_weak(workers, workers + 1));
+
+    ++_free_workers;
+    ++_threads;
+    _spawned.fetch_add(1, std::memory_order_relaxed);
+    std::thread(&perform, this).detach();
+}
+
+void Executor::Finish() {
+    --_free_workers;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (--_threads == 0) {
+        if (_state.load() == Executor::State::kStopping) {
+            _state.store(Executor::State::kStopped);
+        }
+        _stop_condition.notify_all();
     }
 }
 
 void perform(Executor *executor) {
-    while (executor->_state == Executor::State::kRun || !executor->_tasks.empty()) {
-        std::function<void()> task;
-        auto now = std::chrono::system_clock::now();
-        {
-            std::unique_lock<std::mutex> lock(executor->_mutex);
-            while ((executor->_tasks.empty()) && (executor->_state == Executor::State::kRun)) {
-                if (executor->_empty_condition.wait_until(lock, now + executor->_idle_time) ==
-                    std::cv_status::timeout) {
-                    if (executor->_active_workers + executor->_free_workers <= executor->_low_watermark) {
-                        executor->_empty_condition.wait(lock);
-                    } else {
+    bool timed_out = false;
+    Executor::Job job;
+    std::size_t turn = 0;
+    std::atomic<uint64_t> &completed = executor->_completed.Get();
+
+    // Affinity is a placement hint, pool works the same if cpuset doesn't allow it
+    PinCurrentThread(executor->_cpus);
+    for (;;) {
+        if (!executor->Pop(job, turn)) {
+            auto key = executor->_empty_condition.PrepareWait();
+            if (executor->Pop(job, turn)) {
+                executor->_empty_condition.CancelWait();
+            } else if (executor->_state.load() != Executor::State::kRun) {
+                executor->_empty_condition.CancelWait();
+                if (executor->_submitting.load() == 0 && executor->Empty()) {
+                    --executor->_workers;
+                    break;
+                }
+
+                // Some Execute is in the middle of push, it is going to be there in a moment
+                std::this_thread::yield();
+                continue;
+            } else {
+                if (timed_out) {
+                    // Thread above low watermark exits after idle time without work
+                    int workers = executor->_workers.load();
+                    bool retired = false;
+                    while (workers > executor->_low_watermark && !retired) {
+                        retired = executor->_workers.compare_exchange_weak(workers, workers - 1);
+                    }
+
+                    if (retired) {
+                        executor->_empty_condition.CancelWait();
+                        executor->_retired.fetch_add(1, std::memory_order_relaxed);
+
+                        // Task submitted right after our last look could have counted on us
+                        if (!executor->Empty()) {
+                            executor->Spawn();
+                        }
                         break;
                     }
                 }
+
+                bool limited = executor->_workers.load() > executor->_low_watermark;
+                timed_out = !executor->_empty_condition.Wait(key, limited ? executor->_idle_time
+                                                                          : std::chrono::milliseconds(-1));
+                continue;
             }
-            if (executor->_tasks.empty()) {
-                --executor->_free_workers;
-                return;
+        }
+
+        timed_out = false;
+        --executor->_free_workers;
+        ++executor->_active_workers;
+        auto start = Executor::Clock::now();
+        executor->_queue_wait.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(start - job.queued).count());
+        if (start > job.deadline) {
+            // Dropped task goes first, so future of Submit is broken by the time callback runs
+            job.task = nullptr;
+            executor->_expired.Add();
+            if (job.on_expired) {
+                job.on_expired();
+                job.on_expired = nullptr;
             }
-            --executor->_free_workers;
-            ++executor->_active_workers;
 
-            task = executor->_tasks.back();
-            executor->_tasks.pop_back();
-        }
-        task();
-        {
-            std::unique_lock<std::mutex> lock(executor->_mutex);
             --executor->_active_workers;
             ++executor->_free_workers;
+            continue;
         }
+
+        job.task();
+        job.task = nullptr;
+        job.on_expired = nullptr;
+
+        uint64_t run = std::chrono::duration_cast<std::chrono::nanoseconds>(Executor::Clock::now() - start).count();
+        executor->_run_time.Record(run);
+        executor->_busy_ns.Add(run);
+        completed.store(completed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        --executor->_active_workers;
+        ++executor->_free_workers;
     }
-    {
-        std::unique_lock<std::mutex> lock(executor->_mutex);
-        --executor->_free_workers;
-        if ((executor->_tasks.size() == 0) && (executor->_state == Executor::State::kStopping)) {
-            executor->_stop_condition.notify_all();
-        }
-    }
+
+    // Instance goes away with the thread, so its count is moved before pool could be seen stopped
+    executor->_retired_completed.fetch_add(completed.exchange(0));
+    executor->Finish();
 }
 
 } // namespace Concurrency
@@ -0,0 +1,129 @@
+#include <afina/concurrency/HazardPointer.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Afina {
+namespace Concurrency {
+
+// See HazardPointer.h
+HazardDomain::HazardDomain() : _retired(0), _reclaimed(0), _has_orphans(false), _closing(false) {}
+
+// See HazardPointer.h
+HazardDomain::~HazardDomain() {
+    std::lock_guard<std::mutex> lock(_orphans_lock);
+    _closing = true;
+    for (auto &item : _orphans) {
+        item.deleter(item.ptr);
+    }
+    _orphans.clear();
+
+    // Records of live threads are destroyed with _records and free their lists by themselves
+}
+
+// See HazardPointer.h
+HazardDomain &HazardDomain::Global() {
+    // Detached threads could still use it while static objects are being destroyed
+    static HazardDomain *instance = new HazardDomain();
+    return *instance;
+}
+
+HazardDomain::Record::~Record() {
+    if (domain == nullptr || retired.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(domain->_orphans_lock);
+    if (domain->_closing) {
+        for (auto &item : retired) {
+            item.deleter(item.ptr);
+        }
+    } else {
+        domain->_orphans.insert(domain->_orphans.end(), retired.begin(), retired.end());
+        domain->_has_orphans.store(true, std::memory_order_release);
+    }
+}
+
+HazardDomain::Record &HazardDomain::Local() {
+    Record &record = _records.Get();
+    if (record.domain == nullptr) {
+        record.domain = this;
+    }
+    return record;
+}
+
+// See HazardPointer.h
+HazardDomain::Holder::Holder(HazardDomain &domain) {
+    Record &record = domain.Local();
+    for (_index = 0; _index < kSlots; _index++) {
+        if ((record.used & (1u << _index)) == 0) {
+            break;
+        }
+    }
+    if (_index == kSlots) {
+        throw std::runtime_error("All hazard pointers of the thread are in use");
+    }
+
+    record.used |= 1u << _index;
+    _used = &record.used;
+    _slot = &record.hazards[_index];
+}
+
+// See HazardPointer.h
+HazardDomain::Holder::~Holder() {
+    Reset();
+    *_used &= ~(1u << _index);
+}
+
+// See HazardPointer.h
+void HazardDomain::Retire(void *ptr, Deleter deleter) {
+    Record &record = Local();
+    record.retired.push_back(Garbage{ptr, deleter});
+    _retired.fetch_add(1, std::memory_order_relaxed);
+
+    if (record.retired.size() >= kScanThreshold &&
+        record.retired.size() >= 2 * kSlots * _records.Size()) {
+        Scan();
+    }
+}
+
+// See HazardPointer.h
+void HazardDomain::Scan() {
+    Record &record = Local();
+    if (_has_orphans.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(_orphans_lock);
+        record.retired.insert(record.retired.end(), _orphans.begin(), _orphans.end());
+        _orphans.clear();
+        _has_orphans.store(false, std::memory_order_relaxed);
+    }
+
+    // Pairs with the store in Protect: either reader's slot is seen here or reader sees that
+    // object is unlinked and doesn't use it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    std::vector<void *> hazards;
+    _records.ForEach([&hazards](const Record &other) {
+        for (auto &slot : other.hazards) {
+            void *ptr = slot.load(std::memory_order_acquire);
+            if (ptr != nullptr) {
+                hazards.push_back(ptr);
+            }
+        }
+    });
+    std::sort(hazards.begin(), hazards.end());
+
+    auto kept = std::partition(record.retired.begin(), record.retired.end(), [&hazards](const Garbage &item) {
+        return std::binary_search(hazards.begin(), hazards.end(), item.ptr);
+    });
+
+    // Deleter could retire something too, so list must be consistent before calling it
+    std::vector<Garbage> freed(kept, record.retired.end());
+    record.retired.erase(kept, record.retired.end());
+    for (auto &item : freed) {
+        item.deleter(item.ptr);
+    }
+    _reclaimed.fetch_add(freed.size(), std::memory_order_relaxed);
+}
+
+} // namespace Concurrency
+} // namespace Afina
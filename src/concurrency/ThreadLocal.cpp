@@ -0,0 +1,166 @@
+#include <afina/concurrency/ThreadLocal.h>
+
+#include <mutex>
+#include <vector>
+
+namespace Afina {
+namespace Concurrency {
+namespace detail {
+
+// State of the ThreadLocal object, outlives it while some thread still has an entry
+struct ThreadLocalMeta {
+    explicit ThreadLocalMeta(ThreadLocalBase::Destroy d) : head(nullptr), count(0), destroy(d) {}
+
+    std::mutex lock;
+
+    // Live instances, guarded by lock
+    ThreadLocalEntry *head;
+    std::size_t count;
+
+    ThreadLocalBase::Destroy destroy;
+};
+
+// Instance of one thread, entry itself is owned by that thread. Value is reset to nullptr once
+// destroyed by ThreadLocal object
+struct ThreadLocalEntry {
+    std::shared_ptr<ThreadLocalMeta> meta;
+    void *value;
+    ThreadLocalEntry *prev;
+    ThreadLocalEntry *next;
+};
+
+namespace {
+
+// Ids of destroyed objects are given out again, so per-thread tables stay as large as the
+// number of live objects
+std::mutex ids_lock;
+std::size_t next_id = 0;
+
+std::vector<std::size_t> &free_ids() {
+    static std::vector<std::size_t> instance;
+    return instance;
+}
+
+void Unlink(ThreadLocalMeta &meta, ThreadLocalEntry *entry) {
+    if (entry->prev != nullptr) {
+        entry->prev->next = entry->next;
+    } else {
+        meta.head = entry->next;
+    }
+    if (entry->next != nullptr) {
+        entry->next->prev = entry->prev;
+    }
+    meta.count--;
+}
+
+// Drops entry of the calling thread, destroying the value unless owner already did
+void Release(ThreadLocalEntry *entry) {
+    {
+        std::lock_guard<std::mutex> lock(entry->meta->lock);
+        if (entry->value != nullptr) {
+            Unlink(*entry->meta, entry);
+            entry->meta->destroy(entry->value);
+            entry->value = nullptr;
+        }
+    }
+    delete entry;
+}
+
+// Entries of the current thread indexed by object id, released at thread exit
+struct ThreadEntries {
+    ~ThreadEntries() {
+        for (auto entry : entries) {
+            if (entry != nullptr) {
+                Release(entry);
+            }
+        }
+    }
+
+    std::vector<ThreadLocalEntry *> entries;
+};
+
+thread_local ThreadEntries current;
+
+} // namespace
+
+// See ThreadLocal.h
+ThreadLocalBase::ThreadLocalBase(Destroy destroy) : _meta(std::make_shared<ThreadLocalMeta>(destroy)) {
+    std::lock_guard<std::mutex> lock(ids_lock);
+    if (free_ids().empty()) {
+        _id = next_id++;
+    } else {
+        _id = free_ids().back();
+        free_ids().pop_back();
+    }
+}
+
+// See ThreadLocal.h
+ThreadLocalBase::~ThreadLocalBase() {
+    {
+        std::lock_guard<std::mutex> lock(_meta->lock);
+        for (auto entry = _meta->head; entry != nullptr; entry = entry->next) {
+            _meta->destroy(entry->value);
+            entry->value = nullptr;
+        }
+        _meta->head = nullptr;
+        _meta->count = 0;
+    }
+
+    std::lock_guard<std::mutex> lock(ids_lock);
+    free_ids().push_back(_id);
+}
+
+// See ThreadLocal.h
+void *ThreadLocalBase::Find() const {
+    if (_id >= current.entries.size()) {
+        return nullptr;
+    }
+
+    // Entry could be left by destroyed object that had the same id
+    ThreadLocalEntry *entry = current.entries[_id];
+    if (entry == nullptr || entry->meta != _meta) {
+        return nullptr;
+    }
+    return entry->value;
+}
+
+// See ThreadLocal.h
+void ThreadLocalBase::Insert(void *value) {
+    if (_id >= current.entries.size()) {
+        current.entries.resize(_id + 1, nullptr);
+    }
+
+    ThreadLocalEntry *&slot = current.entries[_id];
+    if (slot != nullptr) {
+        Release(slot);
+        slot = nullptr;
+    }
+
+    ThreadLocalEntry *entry = new ThreadLocalEntry{_meta, value, nullptr, nullptr};
+    std::lock_guard<std::mutex> lock(_meta->lock);
+    entry->next = _meta->head;
+    if (_meta->head != nullptr) {
+        _meta->head->prev = entry;
+    }
+    _meta->head = entry;
+    _meta->count++;
+    slot = entry;
+}
+
+// See ThreadLocal.h
+void ThreadLocalBase::Visit(const std::function<void(void *)> &visitor) const {
+    std::lock_guard<std::mutex> lock(_meta->lock);
+    for (auto entry = _meta->head; entry != nullptr; entry = entry->next) {
+        visitor(entry->value);
+    }
+}
+
+// See ThreadLocal.h
+std::size_t ThreadLocalBase::Count() const {
+    std::lock_guard<std::mutex> lock(_meta->lock);
+    return _meta->count;
+}
+
+} // namespace detail
+} // namespace Concurrency
+} // namespace Afina
@@ -0,0 +1,257 @@
+#include <afina/concurrency/Topology.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <utility>
+
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Concurrency {
+
+namespace {
+
+// First line of the sysfs attribute, empty if there is no such file
+std::string ReadLine(const std::string &path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+// Numeric attribute, fallback if it is missing or malformed (i.e. -1 for unknown package)
+unsigned ReadNumber(const std::string &path, unsigned fallback) {
+    std::string line = ReadLine(path);
+    char *end = nullptr;
+    long value = std::strtol(line.c_str(), &end, 10);
+    if (end == line.c_str() || value < 0) {
+        return fallback;
+    }
+    return static_cast<unsigned>(value);
+}
+
+std::vector<unsigned> AllowedCpus() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    std::vector<unsigned> result;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (unsigned cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) {
+                result.push_back(cpu);
+            }
+        }
+    }
+    if (result.empty()) {
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        for (long cpu = 0; cpu < std::max(count, 1L); cpu++) {
+            result.push_back(static_cast<unsigned>(cpu));
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+// See Topology.h
+Topology Topology::Detect(const std::string &root) { return Detect(root, AllowedCpus()); }
+
+// See Topology.h
+Topology Topology::Detect(const std::string &root, const std::vector<unsigned> &allowed) {
+    Topology result;
+
+    // Offline CPUs keep their directories but can't run anything
+    std::string online = ReadLine(root + "/cpu/online");
+    std::vector<unsigned> present = online.empty() ? allowed : ParseList(online);
+    std::sort(present.begin(), present.end());
+
+    std::map<unsigned, unsigned> node_of;
+    DIR *nodes = opendir((root + "/node").c_str());
+    if (nodes != nullptr) {
+        while (struct dirent *entry = readdir(nodes)) {
+            std::string name = entry->d_name;
+            if (name.compare(0, 4, "node") != 0 || name.size() == 4 ||
+                name.find_first_not_of("0123456789", 4) != std::string::npos) {
+                continue;
+            }
+
+            unsigned node = static_cast<unsigned>(std::strtoul(name.c_str() + 4, nullptr, 10));
+            for (unsigned cpu : ParseList(ReadLine(root + "/node/" + name + "/cpulist"))) {
+                node_of[cpu] = node;
+            }
+        }
+        closedir(nodes);
+    }
+
+    // core_id is unique only inside of package
+    std::map<std::pair<unsigned, unsigned>, unsigned> cores;
+    for (unsigned id : allowed) {
+        if (!std::binary_search(present.begin(), present.end(), id)) {
+            continue;
+        }
+
+        std::string topology = root + "/cpu/cpu" + std::to_string(id) + "/topology/";
+        Cpu cpu;
+        cpu.id = id;
+        cpu.package = ReadNumber(topology + "physical_package_id", 0);
+
+        // Without topology every CPU is a core of its own, id can't clash with real core ids then
+        unsigned core_id = ReadNumber(topology + "core_id", ~0u - id);
+        auto core = cores.insert(std::make_pair(std::make_pair(cpu.package, core_id), unsigned(cores.size())));
+        cpu.core = core.first->second;
+
+        auto node = node_of.find(id);
+        cpu.node = node != node_of.end() ? node->second : 0;
+        result._cpus.push_back(cpu);
+    }
+
+    std::sort(result._cpus.begin(), result._cpus.end(), [](const Cpu &a, const Cpu &b) { return a.id < b.id; });
+    result._cores = cores.size();
+    return result;
+}
+
+// See Topology.h
+std::vector<unsigned> Topology::ParseList(const std::string &list) {
+    std::vector<unsigned> result;
+    const char *p = list.c_str();
+    while (*p != '\0') {
+        char *end = nullptr;
+        unsigned long first = std::strtoul(p, &end, 10);
+        if (end == p) {
+            break;
+        }
+
+        unsigned long last = first;
+        p = end;
+        if (*p == '-') {
+            last = std::strtoul(p + 1, &end, 10);
+            if (end == p + 1) {
+                break;
+            }
+            p = end;
+        }
+
+        for (unsigned long cpu = first; cpu <= last; cpu++) {
+            result.push_back(static_cast<unsigned>(cpu));
+        }
+        if (*p != ',') {
+            break;
+        }
+        p++;
+    }
+
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+// See Topology.h
+std::vector<unsigned> Topology::Nodes() const {
+    std::vector<unsigned> result;
+    for (const Cpu &cpu : _cpus) {
+        result.push_back(cpu.node);
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+// See Topology.h
+std::vector<unsigned> Topology::CoreCpus(unsigned core) const {
+    std::vector<unsigned> result;
+    for (const Cpu &cpu : _cpus) {
+        if (cpu.core == core) {
+            result.push_back(cpu.id);
+        }
+    }
+    return result;
+}
+
+// See Topology.h
+Placement::Placement(const Topology &topology, Policy policy) : _policy(policy) {
+    if (_policy == Policy::kNone) {
+        return;
+    }
+
+    for (unsigned core = 0; core < topology.Cores(); core++) {
+        Core entry;
+        entry.cpus = topology.CoreCpus(core);
+        if (entry.cpus.empty()) {
+            continue;
+        }
+        for (const Topology::Cpu &cpu : topology.Cpus()) {
+            if (cpu.id == entry.cpus.front()) {
+                entry.node = cpu.node;
+            }
+        }
+        _cores.push_back(std::move(entry));
+    }
+
+    // Node by node, cores of the node in order of their first CPU
+    std::stable_sort(_cores.begin(), _cores.end(), [](const Core &a, const Core &b) {
+        return a.node != b.node ? a.node < b.node : a.cpus.front() < b.cpus.front();
+    });
+}
+
+// See Topology.h
+std::vector<unsigned> Placement::Worker(std::size_t i) const {
+    if (_cores.empty()) {
+        return {};
+    }
+    return {_cores[i % _cores.size()].cpus.front()};
+}
+
+// See Topology.h
+std::vector<unsigned> Placement::Helpers(std::size_t workers) const {
+    std::size_t used = std::min(workers, _cores.size());
+    std::vector<unsigned> result;
+    for (std::size_t i = 0; i < used; i++) {
+        result.insert(result.end(), _cores[i].cpus.begin() + 1, _cores[i].cpus.end());
+    }
+
+    if (result.empty()) {
+        std::vector<unsigned> nodes = Nodes(workers);
+        for (std::size_t i = used; i < _cores.size(); i++) {
+            if (std::binary_search(nodes.begin(), nodes.end(), _cores[i].node)) {
+                result.insert(result.end(), _cores[i].cpus.begin(), _cores[i].cpus.end());
+            }
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// See Topology.h
+std::vector<unsigned> Placement::Nodes(std::size_t workers) const {
+    std::vector<unsigned> result;
+    for (std::size_t i = 0; i < std::min(workers, _cores.size()); i++) {
+        result.push_back(_cores[i].node);
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+// See Topology.h
+bool PinCurrentThread(const std::vector<unsigned> &cpus) {
+    if (cpus.empty()) {
+        return true;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+} // namespace Concurrency
+} // namespace Afina
@@ -0,0 +1,241 @@
+#include <afina/concurrency/WorkStealingExecutor.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace Afina {
+namespace Concurrency {
+
+namespace {
+
+// Pool and slot of the calling thread, lets tasks push nested tasks into own deque
+thread_local const void *current_pool = nullptr;
+thread_local std::size_t current_slot = 0;
+
+inline uint64_t NextRandom(uint64_t &x) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return x;
+}
+
+} // namespace
+
+WorkStealingExecutor::WorkStealingExecutor(int low_watermark, int high_watermark, int max_queue_size,
+                                           std::chrono::milliseconds idle_time)
+    : _state(State::kRun), _low_watermark(low_watermark), _high_watermark(std::max(1, high_watermark)),
+      _max_queue_size(max_queue_size), _idle_time(idle_time), _slots(new Worker[_high_watermark]),
+      _queued(0), _workers(0), _idle(0), _threads(0) {
+    _shards_count =
+        std::max<std::size_t>(1, std::min<std::size_t>(_high_watermark, std::thread::hardware_concurrency()));
+    _shards.reset(new Shard[_shards_count]);
+    for (std::size_t i = 0; i < _shards_count; i++) {
+        _shards[i].size.store(0);
+    }
+    for (int i = 0; i < _high_watermark; i++) {
+        _slots[i].busy.store(false);
+    }
+
+    for (int i = 0; i < low_watermark; ++i) {
+        Spawn();
+    }
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+    Stop(true);
+
+    // Tasks submitted after stop by still running tasks are rejected, so nothing should be left
+    Task *task;
+    for (int i = 0; i < _high_watermark; i++) {
+        while (_slots[i].tasks.Pop(task)) {
+            delete task;
+        }
+    }
+    for (std::size_t i = 0; i < _shards_count; i++) {
+        for (auto t : _shards[i].tasks) {
+            delete t;
+        }
+    }
+}
+
+// See WorkStealingExecutor.h
+void WorkStealingExecutor::Stop(bool await) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_state.load() == State::kRun) {
+        _state.store(State::kStopping);
+    }
+    _events.NotifyAll();
+
+    if (_threads.load() == 0) {
+        _state.store(State::kStopped);
+        return;
+    }
+
+    if (await) {
+        _stop_condition.wait(lock, [this]() { return _threads.load() == 0; });
+        _state.store(State::kStopped);
+    }
+}
+
+bool WorkStealingExecutor::Submit(Task *task) {
+    // Stopped pool doesn't need the counter touched at all
+    if (_state.load() != State::kRun) {
+        return false;
+    }
+
+    // Counter goes first: worker that has seen stop and empty queue won't miss this task, as we
+    // will see the stop too
+    if (_queued.fetch_add(1) >= _max_queue_size || _state.load() != State::kRun) {
+        // Worker that checked for stop in between saw our increment and went to sleep, nobody
+        // else will wake it up
+        if (_queued.fetch_sub(1) == 1 && _state.load() != State::kRun) {
+            _events.NotifyAll();
+        }
+        return false;
+    }
+
+    if (current_pool == this) {
+        _slots[current_slot].tasks.Push(task);
+    } else {
+        static thread_local std::size_t submitter = std::hash<std::thread::id>()(std::this_thread::get_id());
+        Shard &shard = _shards[submitter % _shards_count];
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.tasks.push_back(task);
+        shard.size.fetch_add(1, std::memory_order_release);
+    }
+
+    _events.Notify();
+    if (_idle.load() == 0) {
+        Spawn();
+    }
+    return true;
+}
+
+bool WorkStealingExecutor::Spawn() {
+    int workers = _workers.load();
+    do {
+        if (workers >= _high_watermark) {
+            return false;
+        }
+    } while (!_workers.compare_exchange_weak(workers, workers + 1));
+
+    // Count above guarantees there is a free slot, but the thread that released it could still be
+    // on the way out
+    for (;;) {
+        for (int i = 0; i < _high_watermark; i++) {
+            bool expected = false;
+            if (_slots[i].busy.compare_exchange_strong(expected, true)) {
+                _threads.fetch_add(1);
+                std::thread(&WorkStealingExecutor::Run, this, std::size_t(i)).detach();
+                return true;
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+bool WorkStealingExecutor::FindTask(std::size_t slot, uint64_t &seed, Task *&task) {
+    if (_slots[slot].tasks.Pop(task)) {
+        return true;
+    }
+
+    for (std::size_t i = 0; i < _shards_count; i++) {
+        Shard &shard = _shards[(slot + i) % _shards_count];
+        if (shard.size.load(std::memory_order_acquire) == 0) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.tasks.empty()) {
+            task = shard.tasks.front();
+            shard.tasks.pop_front();
+            shard.size.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Random victim order spreads thieves over the pool
+    std::size_t start = NextRandom(seed) % _high_watermark;
+    for (int i = 0; i < _high_watermark; i++) {
+        std::size_t victim = (start + i) % _high_watermark;
+        if (victim != slot && _slots[victim].tasks.Steal(task)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingExecutor::Run(std::size_t slot) {
+    current_pool = this;
+    current_slot = slot;
+    uint64_t seed = 0x9E3779B97F4A7C15ull * (slot + 1);
+
+    Task *task = nullptr;
+    bool timed_out = false;
+    for (;;) {
+        bool found = FindTask(slot, seed, task);
+        if (!found) {
+            auto key = _events.PrepareWait();
+            found = FindTask(slot, seed, task);
+            if (found) {
+                _events.CancelWait();
+            } else if (_state.load() != State::kRun && _queued.load() == 0) {
+                _events.CancelWait();
+                _workers.fetch_sub(1);
+                break;
+            } else if (timed_out) {
+                // Retire thread above low watermark after idle time without work
+                int workers = _workers.load();
+                bool retired = false;
+                while (workers > _low_watermark && !retired) {
+                    retired = _workers.compare_exchange_weak(workers, workers - 1);
+                }
+
+                if (retired) {
+                    _events.CancelWait();
+
+                    // Task submitted right after our last look could have counted on us
+                    if (_queued.load() > 0) {
+                        Spawn();
+                    }
+                    break;
+                }
+            }
+
+            if (!found) {
+                bool limited = _workers.load() > _low_watermark;
+                _idle.fetch_add(1);
+                timed_out = !_events.Wait(key, limited ? _idle_time : std::chrono::milliseconds(-1));
+                _idle.fetch_sub(1);
+                continue;
+            }
+        }
+
+        timed_out = false;
+        if (_queued.fetch_sub(1) == 1 && _state.load() != State::kRun) {
+            // Workers waiting for the last tasks to finish stop could go now
+            _events.NotifyAll();
+        }
+        (*task)();
+        delete task;
+    }
+
+    Finish(slot);
+}
+
+void WorkStealingExecutor::Finish(std::size_t slot) {
+    current_pool = nullptr;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _slots[slot].busy.store(false);
+    if (_threads.fetch_sub(1) == 1) {
+        if (_state.load() == State::kStopping) {
+            _state.store(State::kStopped);
+        }
+        _stop_condition.notify_all();
+    }
+}
+
+} // namespace Concurrency
+} // namespace Afina
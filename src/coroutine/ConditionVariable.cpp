@@ -0,0 +1,42 @@
+#include <afina/coroutine/ConditionVariable.h>
+
+#include <stdexcept>
+
+namespace Afina {
+namespace Coroutine {
+
+// See ConditionVariable.h
+void ConditionVariable::wait(std::unique_lock<Mutex> &lock) {
+    if (_engine.current() == nullptr) {
+        throw std::logic_error("ConditionVariable can't wait outside of coroutine");
+    }
+
+    // Nothing switches between unlock and block, so a notification can't slip in between
+    lock.unlock();
+    _engine.block(_waiters);
+    lock.lock();
+}
+
+// See ConditionVariable.h
+std::cv_status ConditionVariable::wait_until(std::unique_lock<Mutex> &lock, Engine::Clock::time_point deadline) {
+    if (_engine.current() == nullptr) {
+        throw std::logic_error("ConditionVariable can't wait outside of coroutine");
+    }
+
+    lock.unlock();
+    bool notified = _engine.block_until(_waiters, deadline);
+    lock.lock();
+    return notified ? std::cv_status::no_timeout : std::cv_status::timeout;
+}
+
+// See ConditionVariable.h
+void ConditionVariable::notify_one() { _engine.unblock(_waiters); }
+
+// See ConditionVariable.h
+void ConditionVariable::notify_all() {
+    while (_engine.unblock(_waiters) != nullptr) {
+    }
+}
+
+} // namespace Coroutine
+} // namespace Afina
@@ -1,14 +1,84 @@
 #include <afina/coroutine/Engine.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <cstring>
+#include <exception>
+#include <new>
 #include <setjmp.h>
+#include <thread>
 #include <stdio.h>
 #include <string.h>
 
+#ifdef AFINA_COROUTINE_ASM
+// Context switch for x86-64 System V ABI. Only callee-saved state needs to survive the call: rbx, rbp,
+// r12-r15 and control words of SSE and x87, everything else the caller of switch has spilled already.
+// State is pushed onto the current stack, so context is just the stack pointer.
+//
+// afina_coroutine_entry is where a new coroutine "returns" to from its first switch: Prepare puts the
+// function into r13 and its argument into r12
+extern "C" void afina_coroutine_switch(void **save, void *load);
+extern "C" void afina_coroutine_entry();
+
+asm(R"(
+    .text
+    .globl afina_coroutine_switch
+    .hidden afina_coroutine_switch
+    .type afina_coroutine_switch, @function
+afina_coroutine_switch:
+    pushq %rbp
+    pushq %rbx
+    pushq %r12
+    pushq %r13
+    pushq %r14
+    pushq %r15
+    subq $8, %rsp
+    stmxcsr (%rsp)
+    fnstcw 4(%rsp)
+    movq %rsp, (%rdi)
+    movq %rsi, %rsp
+    ldmxcsr (%rsp)
+    fldcw 4(%rsp)
+    addq $8, %rsp
+    popq %r15
+    popq %r14
+    popq %r13
+    popq %r12
+    popq %rbx
+    popq %rbp
+    ret
+    .size afina_coroutine_switch, .-afina_coroutine_switch
+
+    .globl afina_coroutine_entry
+    .hidden afina_coroutine_entry
+    .type afina_coroutine_entry, @function
+afina_coroutine_entry:
+    movq %r12, %rdi
+    callq *%r13
+    ud2
+    .size afina_coroutine_entry, .-afina_coroutine_entry
+)");
+#endif
+
 namespace Afina {
 namespace Coroutine {
 
+constexpr std::size_t Engine::kDefaultStackSize;
+constexpr std::size_t Engine::kNoTimer;
+
+namespace {
+
+// Timer heap arity: shallower than binary, and the four children share a cache line
+const std::size_t kTimerArity = 4;
+
+// Equal deadlines fire in the order they were set
+inline bool Earlier(const Engine::Clock::time_point &a, uint64_t a_seq, const Engine::Clock::time_point &b,
+                    uint64_t b_seq) {
+    return a < b || (a == b && a_seq < b_seq);
+}
+
+} // namespace
+
 /**
  * Save stack of the current coroutine in the given context
  */
@@ -25,9 +95,9 @@ void Engine::Store(context &ctx) {
     if (allocated_size < required_size) {
         delete[] stack;
         stack = new char[required_size];
-        std::memcpy(stack, ctx.Low, required_size);
-        ctx.Stack = std::make_tuple(stack, required_size);
+        allocated_size = required_size;
     }
+    std::memcpy(stack, ctx.Low, required_size);
 }
 
 /**
@@ -40,7 +110,7 @@ void Engine::Restore(context &ctx) {
         Restore(ctx);
     }
 
-    memcpy(ctx.Low, std::get<0>(ctx.Stack), std::get<1>(ctx.Stack));
+    memcpy(ctx.Low, std::get<0>(ctx.Stack), ctx.High - ctx.Low);
     cur_routine = &ctx;
     longjmp(ctx.Environment, 1);
 }
@@ -54,6 +124,11 @@ void Engine::Restore(context &ctx) {
  * any other which is ready to run
  */
 void Engine::yield() {
+    // Routines that keep yielding to each other would never let the engine run out of work otherwise
+    if (!timers.empty()) {
+        expire_timers();
+    }
+
     context *new_routine = alive;
 
     if (new_routine && (new_routine == cur_routine)) {
@@ -69,6 +144,13 @@ void Engine::yield() {
  * Suspend current coroutine execution and execute given context
  */
 void Engine::Enter(context &ctx) {
+    if (mode == Mode::kSeparateStack) {
+        context *from = cur_routine;
+        cur_routine = &ctx;
+        Switch(*from, ctx);
+        return;
+    }
+
     if (cur_routine && (cur_routine != idle_ctx)) {
         if (setjmp(cur_routine->Environment) > 0) {
             return;
@@ -92,12 +174,431 @@ void Engine::sched(void *routine_) {
         return;
     }
 
-    if (routine_) {
+    if (routine_ && !static_cast<context *>(routine_)->Blocked) {
         Enter(*(static_cast<context *>(routine_)));
     } else {
         yield();
     }
 }
 
+// See Engine.h
+void Engine::block(void *routine_) {
+    context *ctx = routine_ ? static_cast<context *>(routine_) : cur_routine;
+    if (ctx == nullptr || ctx == idle_ctx || ctx->Blocked) {
+        return;
+    }
+
+    Unlink(*ctx, alive);
+    Link(*ctx, blocked);
+    ctx->Blocked = true;
+
+    // Current routine can't go on, somebody else runs until it gets unblocked
+    if (ctx == cur_routine) {
+        Enter(alive != nullptr ? *alive : *idle_ctx);
+    }
+}
+
+// See Engine.h
+void Engine::block(WaitList &list) {
+    context *ctx = cur_routine;
+    if (ctx == nullptr || ctx == idle_ctx) {
+        return;
+    }
+
+    Enqueue(*ctx, list);
+    block();
+}
+
+// See Engine.h
+bool Engine::block_until(Clock::time_point deadline, void (*on_timeout)(void *), void *arg) {
+    context *ctx = cur_routine;
+    if (ctx == nullptr || ctx == idle_ctx) {
+        return false;
+    }
+
+    ctx->TimedOut = false;
+    ctx->OnTimeout = on_timeout;
+    ctx->TimeoutArg = arg;
+    if (deadline != Clock::time_point::max()) {
+        ctx->Deadline = deadline;
+        TimerPush(*ctx);
+    }
+    block();
+
+    // Routine could be in another engine by now, only its context is still the same
+    return !ctx->TimedOut;
+}
+
+// See Engine.h
+bool Engine::block_until(WaitList &list, Clock::time_point deadline) {
+    context *ctx = cur_routine;
+    if (ctx == nullptr || ctx == idle_ctx) {
+        return false;
+    }
+
+    Enqueue(*ctx, list);
+    return block_until(deadline);
+}
+
+// See Engine.h
+bool Engine::sleep_until(Clock::time_point deadline) { return current() != nullptr && !block_until(deadline); }
+
+// See Engine.h
+void Engine::expire_timers(Clock::time_point now) {
+    while (!timers.empty() && timers.front()->Deadline <= now) {
+        context *ctx = timers.front();
+        TimerRemove(*ctx);
+
+        ctx->TimedOut = true;
+        Dequeue(*ctx);
+        if (ctx->OnTimeout != nullptr) {
+            ctx->OnTimeout(ctx->TimeoutArg);
+        }
+        unblock(ctx);
+    }
+}
+
+// See Engine.h
+void *Engine::unblock(WaitList &list) {
+    context *ctx = list.head;
+    unblock(ctx);
+    return ctx;
+}
+
+// See Engine.h
+void Engine::unblock(void *routine_) {
+    context *ctx = static_cast<context *>(routine_);
+    if (ctx == nullptr || !ctx->Blocked) {
+        return;
+    }
+
+    if (ctx->TimerIndex != kNoTimer) {
+        TimerRemove(*ctx);
+    }
+    Dequeue(*ctx);
+    Unlink(*ctx, blocked);
+    Link(*ctx, alive);
+    ctx->Blocked = false;
+}
+
+// See Engine.h
+void Engine::Loop() {
+    for (;;) {
+        if (!timers.empty()) {
+            expire_timers();
+        }
+
+        if (alive != nullptr) {
+            yield();
+        } else if ((idle_func && idle_func()) || alive != nullptr) {
+            // Idle function could make some ready before giving up
+            continue;
+        } else if (!timers.empty()) {
+            // Nobody else could wake routines up, only time does
+            std::this_thread::sleep_until(timers.front()->Deadline);
+        } else {
+            return;
+        }
+    }
+}
+
+// See Engine.h
+void *Engine::detach(void *routine_) {
+    if (mode != Mode::kSeparateStack) {
+        return nullptr;
+    }
+
+    context *ctx = static_cast<context *>(routine_);
+    if (ctx == nullptr) {
+        ctx = alive;
+        if (ctx != nullptr && ctx == cur_routine) {
+            ctx = ctx->next;
+        }
+    }
+    if (ctx == nullptr || ctx == cur_routine || ctx == idle_ctx || ctx->Blocked) {
+        return nullptr;
+    }
+
+    stacks.Disown(ctx->OwnStack);
+    Unlink(*ctx, alive);
+    ctx->Owner = nullptr;
+    return ctx;
+}
+
+// See Engine.h
+void Engine::adopt(void *routine_) {
+    context *ctx = static_cast<context *>(routine_);
+    stacks.Adopt(ctx->OwnStack);
+    ctx->Owner = this;
+    Link(*ctx, alive);
+}
+
+// See Engine.h
+void *Engine::run(detail::Closure *body) {
+    if (body == nullptr || this->StackBottom == 0 || mode != Mode::kSeparateStack) {
+        delete body;
+        return nullptr;
+    }
+
+    context *pc = new (std::nothrow) context();
+    if (pc == nullptr) {
+        delete body;
+        return nullptr;
+    }
+    pc->Body = body;
+    if (!Prepare(*pc)) {
+        delete pc->Body;
+        delete pc;
+        return nullptr;
+    }
+
+    Link(*pc, alive);
+    return pc;
+}
+
+// See Engine.h
+void Engine::Drop() {
+    timers.clear();
+    while (blocked != nullptr) {
+        context *ctx = blocked;
+        Dequeue(*ctx);
+        Unlink(*ctx, blocked);
+        if (mode == Mode::kSeparateStack) {
+            delete ctx->Body;
+            stacks.Release(ctx->OwnStack);
+        } else {
+            delete[] std::get<0>(ctx->Stack);
+        }
+        delete ctx;
+    }
+}
+
+// See Engine.h
+bool Engine::Prepare(context &ctx) {
+    ctx.Owner = this;
+    try {
+        ctx.OwnStack = stacks.Allocate();
+    } catch (std::bad_alloc &) {
+        return false;
+    }
+
+    // ABI wants stack aligned by 16 at every call
+    std::uintptr_t base = reinterpret_cast<std::uintptr_t>(ctx.OwnStack.base);
+    std::uintptr_t top = (base + ctx.OwnStack.size) & ~std::uintptr_t(15);
+
+#ifdef AFINA_COROUTINE_ASM
+    // Frame as afina_coroutine_switch leaves it: control words, r15, r14, r13, r12, rbx, rbp and
+    // return address. Once it returns into entry stack is 16 aligned again, two slots above are spare
+    void **frame = reinterpret_cast<void **>(top) - 10;
+    std::memset(frame, 0, 10 * sizeof(void *));
+
+    uint32_t mxcsr;
+    uint16_t fpucw;
+    asm volatile("stmxcsr %0\n\tfnstcw %1" : "=m"(mxcsr), "=m"(fpucw));
+    std::memcpy(&frame[0], &mxcsr, sizeof(mxcsr));
+    std::memcpy(reinterpret_cast<char *>(&frame[0]) + 4, &fpucw, sizeof(fpucw));
+
+    frame[3] = reinterpret_cast<void *>(&Engine::Entry);
+    frame[4] = &ctx;
+    frame[7] = reinterpret_cast<void *>(&afina_coroutine_entry);
+    ctx.StackPointer = frame;
+#else
+    getcontext(&ctx.Machine);
+    ctx.Machine.uc_stack.ss_sp = ctx.OwnStack.base;
+    ctx.Machine.uc_stack.ss_size = top - base;
+    ctx.Machine.uc_link = nullptr;
+
+    std::uintptr_t pointer = reinterpret_cast<std::uintptr_t>(&ctx);
+    makecontext(&ctx.Machine, reinterpret_cast<void (*)()>(&Engine::EntryParts), 2, unsigned(uint64_t(pointer) >> 32),
+                unsigned(pointer & 0xffffffffu));
+#endif
+    return true;
+}
+
+// See Engine.h
+void Engine::Switch(context &from, context &to) {
+#ifdef AFINA_COROUTINE_ASM
+    afina_coroutine_switch(&from.StackPointer, to.StackPointer);
+#else
+    swapcontext(&from.Machine, &to.Machine);
+#endif
+
+    // Back on this stack, routine that finished before switching here isn't running anymore. Routine
+    // could have been adopted meanwhile, then this is not its engine anymore
+    from.Owner->Reap();
+}
+
+// See Engine.h
+void Engine::Reap() {
+    if (finished != nullptr) {
+        stacks.Release(finished->OwnStack);
+        delete finished;
+        finished = nullptr;
+    }
+}
+
+// See Engine.h
+void Engine::Unlink(context &ctx, context *&list) {
+    if (ctx.prev != nullptr) {
+        ctx.prev->next = ctx.next;
+    } else if (list == &ctx) {
+        list = ctx.next;
+    }
+
+    if (ctx.next != nullptr) {
+        ctx.next->prev = ctx.prev;
+    }
+    ctx.prev = ctx.next = nullptr;
+}
+
+// See Engine.h
+void Engine::Dequeue(context &ctx) {
+    if (ctx.Waiting == nullptr) {
+        return;
+    }
+
+    WaitList &list = *ctx.Waiting;
+    if (ctx.wait_prev != nullptr) {
+        ctx.wait_prev->wait_next = ctx.wait_next;
+    } else {
+        list.head = ctx.wait_next;
+    }
+    if (ctx.wait_next != nullptr) {
+        ctx.wait_next->wait_prev = ctx.wait_prev;
+    } else {
+        list.tail = ctx.wait_prev;
+    }
+    ctx.Waiting = nullptr;
+    ctx.wait_prev = ctx.wait_next = nullptr;
+}
+
+// See Engine.h
+void Engine::Link(context &ctx, context *&list) {
+    ctx.prev = nullptr;
+    ctx.next = list;
+    if (list != nullptr) {
+        list->prev = &ctx;
+    }
+    list = &ctx;
+}
+
+// See Engine.h
+void Engine::Enqueue(context &ctx, WaitList &list) {
+    ctx.Waiting = &list;
+    ctx.wait_prev = list.tail;
+    ctx.wait_next = nullptr;
+    if (list.tail != nullptr) {
+        list.tail->wait_next = &ctx;
+    } else {
+        list.head = &ctx;
+    }
+    list.tail = &ctx;
+}
+
+// See Engine.h
+void Engine::TimerPush(context &ctx) {
+    ctx.TimerSeq = timer_seq++;
+    timers.push_back(&ctx);
+    ctx.TimerIndex = timers.size() - 1;
+    TimerSiftUp(ctx.TimerIndex);
+}
+
+// See Engine.h
+void Engine::TimerRemove(context &ctx) {
+    std::size_t index = ctx.TimerIndex;
+    context *last = timers.back();
+    timers.pop_back();
+    ctx.TimerIndex = kNoTimer;
+    if (last == &ctx) {
+        return;
+    }
+
+    // Last one takes the hole and moves whichever way restores the order
+    TimerPlace(*last, index);
+    TimerSiftUp(index);
+    TimerSiftDown(last->TimerIndex);
+}
+
+// See Engine.h
+void Engine::TimerSiftUp(std::size_t index) {
+    context *ctx = timers[index];
+    while (index > 0) {
+        std::size_t parent = (index - 1) / kTimerArity;
+        context *up = timers[parent];
+        if (!Earlier(ctx->Deadline, ctx->TimerSeq, up->Deadline, up->TimerSeq)) {
+            break;
+        }
+        TimerPlace(*up, index);
+        index = parent;
+    }
+    TimerPlace(*ctx, index);
+}
+
+// See Engine.h
+void Engine::TimerSiftDown(std::size_t index) {
+    context *ctx = timers[index];
+    std::size_t size = timers.size();
+    for (;;) {
+        std::size_t first = index * kTimerArity + 1;
+        if (first >= size) {
+            break;
+        }
+
+        std::size_t best = first;
+        std::size_t end = std::min(first + kTimerArity, size);
+        for (std::size_t child = first + 1; child < end; child++) {
+            if (Earlier(timers[child]->Deadline, timers[child]->TimerSeq, timers[best]->Deadline,
+                        timers[best]->TimerSeq)) {
+                best = child;
+            }
+        }
+
+        context *down = timers[best];
+        if (!Earlier(down->Deadline, down->TimerSeq, ctx->Deadline, ctx->TimerSeq)) {
+            break;
+        }
+        TimerPlace(*down, index);
+        index = best;
+    }
+    TimerPlace(*ctx, index);
+}
+
+// See Engine.h
+void Engine::TimerPlace(context &ctx, std::size_t index) {
+    timers[index] = &ctx;
+    ctx.TimerIndex = index;
+}
+
+// See Engine.h
+void Engine::Entry(context *ctx) {
+    Engine &engine = *ctx->Owner;
+    engine.Reap();
+
+    // There is no frame to unwind into below, exception escaping the body terminates the process the same
+    // way it does for std::thread
+    try {
+        ctx->Body->Call();
+    } catch (...) {
+        std::terminate();
+    }
+    delete ctx->Body;
+    ctx->Body = nullptr;
+
+    // Own stack can't be freed while running on it, so whoever runs next does that. Body could have
+    // moved to another engine
+    Engine &owner = *ctx->Owner;
+    owner.Unlink(*ctx, owner.alive);
+    owner.finished = ctx;
+    owner.cur_routine = owner.idle_ctx;
+    owner.Switch(*ctx, *owner.idle_ctx);
+}
+
+#ifndef AFINA_COROUTINE_ASM
+// See Engine.h
+void Engine::EntryParts(unsigned high, unsigned low) {
+    Entry(reinterpret_cast<context *>((uint64_t(high) << 32) | low));
+}
+#endif
+
 } // namespace Coroutine
 } // namespace Afina
@@ -0,0 +1,54 @@
+#include <afina/coroutine/Mutex.h>
+
+#include <stdexcept>
+
+namespace Afina {
+namespace Coroutine {
+
+// See Mutex.h
+void Mutex::lock() {
+    if (try_lock()) {
+        return;
+    }
+
+    if (_engine.current() == nullptr) {
+        throw std::logic_error("Mutex would block outside of coroutine");
+    }
+
+    // Unlock leaves mutex locked for the routine it wakes
+    _engine.block(_waiters);
+}
+
+// See Mutex.h
+bool Mutex::try_lock() {
+    if (_locked) {
+        return false;
+    }
+
+    _locked = true;
+    return true;
+}
+
+// See Mutex.h
+bool Mutex::try_lock_until(Engine::Clock::time_point deadline) {
+    if (try_lock()) {
+        return true;
+    }
+
+    if (_engine.current() == nullptr) {
+        throw std::logic_error("Mutex would block outside of coroutine");
+    }
+
+    // Timer takes routine out of the queue before unlock could hand the mutex over
+    return _engine.block_until(_waiters, deadline);
+}
+
+// See Mutex.h
+void Mutex::unlock() {
+    if (_engine.unblock(_waiters) == nullptr) {
+        _locked = false;
+    }
+}
+
+} // namespace Coroutine
+} // namespace Afina
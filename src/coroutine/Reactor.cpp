@@ -0,0 +1,282 @@
+#include <afina/coroutine/Reactor.h>
+
+#include <array>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Coroutine {
+
+namespace {
+
+// Routine could resume on another thread after any wait, and compiler is free to reuse address of a
+// thread local computed before: __errno_location is declared const. Call that has side effects as far
+// as compiler knows gets the address of the thread it runs on
+__attribute__((noinline)) int &ThreadErrno() {
+    asm volatile("");
+    return errno;
+}
+
+#ifdef SYS_epoll_pwait2
+// Cleared once kernel turns out to be older than 5.11
+std::atomic<bool> precise_wait(true);
+#endif
+
+} // namespace
+
+thread_local Reactor *Reactor::_current = nullptr;
+
+// See Reactor.h
+Reactor::Reactor(std::size_t stack_size)
+    : Reactor(stack_size, [this]() {
+          // Nobody waits for I/O or time, the rest are blocked for good
+          Engine::Clock::time_point next = _engine.next_timer();
+          if (_waiters.empty() && next == Engine::Clock::time_point::max()) {
+              return false;
+          }
+          Poll(Until(next));
+          return true;
+      }) {}
+
+// See Reactor.h
+Reactor::Reactor(std::size_t stack_size, std::function<bool()> idle)
+    : _engine(Engine::Mode::kSeparateStack, stack_size, std::move(idle)), _stopped(false) {
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll_fd == -1) {
+        throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
+    }
+
+    _event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_event_fd == -1) {
+        close(_epoll_fd);
+        throw std::runtime_error("Failed to create eventfd: " + std::string(strerror(errno)));
+    }
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = _event_fd;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _event_fd, &event)) {
+        close(_event_fd);
+        close(_epoll_fd);
+        throw std::runtime_error("Failed to add eventfd descriptor to epoll");
+    }
+}
+
+// See Reactor.h
+Reactor::~Reactor() {
+    close(_event_fd);
+    close(_epoll_fd);
+}
+
+// See Reactor.h
+// Not inlined for the same reason as ThreadErrno
+__attribute__((noinline)) Reactor *Reactor::Current() {
+    asm volatile("");
+    return _current;
+}
+
+// See Reactor.h
+bool Reactor::Wait(int fd, uint32_t events, Engine::Clock::time_point deadline) {
+    Reactor *reactor = Current();
+    if (reactor == nullptr) {
+        ThreadErrno() = EINVAL;
+        return false;
+    }
+    return reactor->Arm(fd, events, deadline);
+}
+
+// See Reactor.h
+bool Reactor::SleepUntil(Engine::Clock::time_point deadline) {
+    Reactor *reactor = Current();
+    if (reactor == nullptr || reactor->Stopped() || !reactor->_engine.sleep_until(deadline)) {
+        return false;
+    }
+
+    // Stop expires every timer, routine could have moved to another worker meanwhile
+    return !Current()->Stopped();
+}
+
+// See Reactor.h
+bool Reactor::Arm(int fd, uint32_t events, Engine::Clock::time_point deadline) {
+    Waiter waiter{_engine.current(), false, this, fd};
+    if (waiter.routine == nullptr) {
+        ThreadErrno() = EINVAL;
+        return false;
+    } else if (Stopped()) {
+        ThreadErrno() = ECANCELED;
+        return false;
+    }
+
+    // Descriptor that has been waited on before is still registered, just disarmed
+    struct epoll_event event;
+    event.events = events | EPOLLONESHOT;
+    event.data.fd = fd;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, fd, &event) != 0) {
+        if (errno != ENOENT || epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            return false;
+        }
+    }
+
+    _waiters[fd] = &waiter;
+    bool woken = _engine.block_until(deadline, &Reactor::Forget, &waiter);
+
+    // Poll or timer has taken the waiter out, stop leaves it not ready. Neither this reactor nor thread
+    // are necessarily ours anymore
+    if (!woken) {
+        ThreadErrno() = ETIMEDOUT;
+        return false;
+    } else if (!waiter.ready) {
+        ThreadErrno() = ECANCELED;
+        return false;
+    }
+    return true;
+}
+
+// See Reactor.h
+ssize_t Reactor::Read(int fd, void *buf, std::size_t count, Engine::Clock::time_point deadline) {
+    for (;;) {
+        ssize_t result = read(fd, buf, count);
+        int error = result < 0 ? ThreadErrno() : 0;
+        if (result >= 0 || (error != EAGAIN && error != EWOULDBLOCK && error != EINTR)) {
+            return result;
+        }
+
+        if (error != EINTR && !Wait(fd, EPOLLIN | EPOLLRDHUP, deadline)) {
+            return -1;
+        }
+    }
+}
+
+// See Reactor.h
+ssize_t Reactor::Write(int fd, const void *buf, std::size_t count, Engine::Clock::time_point deadline) {
+    const char *data = static_cast<const char *>(buf);
+    std::size_t written = 0;
+    while (written < count) {
+        ssize_t result = write(fd, data + written, count - written);
+        if (result >= 0) {
+            written += result;
+            continue;
+        }
+
+        int error = ThreadErrno();
+        if (error == EAGAIN || error == EWOULDBLOCK) {
+            if (!Wait(fd, EPOLLOUT, deadline)) {
+                return -1;
+            }
+        } else if (error != EINTR) {
+            return -1;
+        }
+    }
+    return written;
+}
+
+// See Reactor.h
+int Reactor::Accept(int fd, struct sockaddr *addr, socklen_t *len, int flags, Engine::Clock::time_point deadline) {
+    for (;;) {
+        int result = accept4(fd, addr, len, flags);
+        int error = result < 0 ? ThreadErrno() : 0;
+        if (result >= 0 || (error != EAGAIN && error != EWOULDBLOCK && error != EINTR)) {
+            return result;
+        }
+
+        if (error != EINTR && !Wait(fd, EPOLLIN, deadline)) {
+            return -1;
+        }
+    }
+}
+
+// See Reactor.h
+void Reactor::Wake() {
+    if (eventfd_write(_event_fd, 1)) {
+        throw std::runtime_error("Failed to wakeup reactor");
+    }
+}
+
+// See Reactor.h
+void Reactor::Stop() {
+    _stopped.store(true, std::memory_order_relaxed);
+    Wake();
+}
+
+// See Reactor.h
+bool Reactor::Poll(std::chrono::nanoseconds timeout) {
+    std::array<struct epoll_event, 64> ready;
+    int n = Select(ready.data(), ready.size(), timeout);
+    for (int i = 0; i < n; i++) {
+        int fd = ready[i].data.fd;
+        if (fd == _event_fd) {
+            eventfd_t value;
+            eventfd_read(_event_fd, &value);
+            continue;
+        }
+
+        auto it = _waiters.find(fd);
+        if (it != _waiters.end()) {
+            it->second->ready = true;
+            _engine.unblock(it->second->routine);
+            _waiters.erase(it);
+        }
+    }
+
+    // Everybody still waiting learns about the stop from Wait result, sleepers wake up as if time has come
+    if (Stopped()) {
+        for (auto &waiter : _waiters) {
+            _engine.unblock(waiter.second->routine);
+        }
+        _waiters.clear();
+        _engine.expire_timers(Engine::Clock::time_point::max());
+    }
+    return !_waiters.empty();
+}
+
+// See Reactor.h
+std::chrono::nanoseconds Reactor::Until(Engine::Clock::time_point deadline) {
+    if (deadline == Engine::Clock::time_point::max()) {
+        return std::chrono::nanoseconds(-1);
+    }
+    return std::max(std::chrono::nanoseconds(0),
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - Engine::Clock::now()));
+}
+
+// See Reactor.h
+void Reactor::Forget(void *waiter) {
+    Waiter *w = static_cast<Waiter *>(waiter);
+    w->reactor->_waiters.erase(w->fd);
+}
+
+// See Reactor.h
+int Reactor::Select(struct epoll_event *events, int max_events, std::chrono::nanoseconds timeout) {
+    if (timeout.count() <= 0) {
+        return epoll_wait(_epoll_fd, events, max_events, timeout.count() < 0 ? -1 : 0);
+    }
+
+#ifdef SYS_epoll_pwait2
+    if (precise_wait.load(std::memory_order_relaxed)) {
+        struct timespec ts;
+        ts.tv_sec = timeout.count() / 1000000000;
+        ts.tv_nsec = timeout.count() % 1000000000;
+        int n = syscall(SYS_epoll_pwait2, _epoll_fd, events, max_events, &ts, nullptr, 0);
+        if (n >= 0 || errno != ENOSYS) {
+            return n;
+        }
+        precise_wait.store(false, std::memory_order_relaxed);
+    }
+#endif
+
+    // Rounded up, waking before the deadline would only cost another round
+    int64_t ms = (timeout.count() + 999999) / 1000000;
+    return epoll_wait(_epoll_fd, events, max_events, int(std::min<int64_t>(ms, INT_MAX)));
+}
+
+} // namespace Coroutine
+} // namespace Afina
@@ -0,0 +1,319 @@
+#include <afina/coroutine/Scheduler.h>
+
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+
+#include <afina/concurrency/ChaseLevDeque.h>
+#include <afina/coroutine/Reactor.h>
+
+namespace Afina {
+namespace Coroutine {
+
+namespace {
+
+inline uint64_t NextRandom(uint64_t &x) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return x;
+}
+
+// Counters have a single writer, no need for a locked increment
+inline void Bump(std::atomic<uint64_t> &counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+struct Scheduler::Worker {
+    Worker(Scheduler &scheduler, std::size_t i, std::size_t stack_size)
+        : owner(scheduler), index(i), reactor(stack_size, [this]() { return owner.Idle(*this); }),
+          inbox_size(0), sleeping(false), waiting(false), seed(i * 0x9e3779b97f4a7c15ull + 1), spawned(0), stolen(0),
+          sleeps(0) {}
+
+    Scheduler &owner;
+    const std::size_t index;
+    Reactor reactor;
+
+    // Routines ready to run: this worker pushes and pops, others steal
+    Concurrency::ChaseLevDeque<void *> ready;
+
+    // Routines spawned by other threads, not started yet
+    std::mutex inbox_mutex;
+    std::vector<detail::Closure *> inbox;
+    std::atomic<std::size_t> inbox_size;
+
+    // Worker is going to sleep or sleeps in epoll_wait, whoever clears it has to wake the worker up
+    std::atomic<bool> sleeping;
+
+    // Some routine of the worker waits for a descriptor
+    bool waiting;
+
+    uint64_t seed;
+
+    std::atomic<uint64_t> spawned;
+    std::atomic<uint64_t> stolen;
+    std::atomic<uint64_t> sleeps;
+};
+
+thread_local Scheduler::Worker *Scheduler::_current = nullptr;
+
+// See Scheduler.h
+Scheduler::Scheduler(std::size_t threads, std::size_t stack_size) : _stopped(false), _next(0) {
+    threads = std::max<std::size_t>(1, threads);
+    _workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; i++) {
+        _workers.emplace_back(new Worker(*this, i, stack_size));
+    }
+}
+
+// See Scheduler.h
+Scheduler::~Scheduler() {
+    if (!_threads.empty()) {
+        Stop();
+        Join();
+    }
+}
+
+// See Scheduler.h
+void Scheduler::Start(std::function<void(std::size_t)> init) {
+    _threads.reserve(_workers.size());
+    for (auto &worker : _workers) {
+        _threads.emplace_back(&Scheduler::Run, this, std::ref(*worker), init);
+    }
+}
+
+// See Scheduler.h
+void Scheduler::Yield() {
+    Worker *worker = _current;
+    if (worker == nullptr || worker->reactor.engine().current() == nullptr) {
+        return;
+    }
+
+    // Calling routine stays in the engine, so it runs again once the one found blocks
+    void *routine;
+    if (worker->owner.Find(*worker, routine)) {
+        Engine &engine = worker->reactor.engine();
+        engine.adopt(routine);
+        engine.yield();
+    }
+}
+
+// See Scheduler.h
+void Scheduler::Stop() {
+    _stopped.store(true, std::memory_order_relaxed);
+    for (auto &worker : _workers) {
+        worker->reactor.Stop();
+    }
+}
+
+// See Scheduler.h
+void Scheduler::Join() {
+    for (auto &thread : _threads) {
+        thread.join();
+    }
+    _threads.clear();
+
+    // Spawned from outside while workers were exiting
+    for (auto &worker : _workers) {
+        for (detail::Closure *body : worker->inbox) {
+            delete body;
+        }
+        worker->inbox.clear();
+        worker->inbox_size.store(0, std::memory_order_relaxed);
+    }
+}
+
+// See Scheduler.h
+std::string Scheduler::Dump(const std::string &prefix) const {
+    uint64_t spawned = 0, stolen = 0, sleeps = 0;
+    for (auto &worker : _workers) {
+        spawned += worker->spawned.load(std::memory_order_relaxed);
+        stolen += worker->stolen.load(std::memory_order_relaxed);
+        sleeps += worker->sleeps.load(std::memory_order_relaxed);
+    }
+
+    std::stringstream out;
+    out << prefix << "threads " << _workers.size() << "\n";
+    out << prefix << "spawned " << spawned << "\n";
+    out << prefix << "stolen " << stolen << "\n";
+    out << prefix << "sleeps " << sleeps;
+    return out.str();
+}
+
+// See Scheduler.h
+bool Scheduler::Submit(detail::Closure *body) {
+    Worker *worker = _current;
+    if (worker != nullptr && &worker->owner == this) {
+        Engine &engine = worker->reactor.engine();
+        void *routine = engine.run(body);
+        if (routine == nullptr) {
+            return false;
+        }
+
+        Bump(worker->spawned);
+        worker->ready.Push(engine.detach(routine));
+        WakeOne(*worker);
+        return true;
+    }
+
+    if (Stopped()) {
+        delete body;
+        return false;
+    }
+
+    Worker &target = *_workers[_next.fetch_add(1, std::memory_order_relaxed) % _workers.size()];
+    {
+        std::lock_guard<std::mutex> lock(target.inbox_mutex);
+        target.inbox.push_back(body);
+        target.inbox_size.store(target.inbox.size(), std::memory_order_relaxed);
+    }
+
+    // Pairs with the fence of the worker going to sleep: either it sees the inbox or we see it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (target.sleeping.load(std::memory_order_relaxed) && target.sleeping.exchange(false)) {
+        target.reactor.Wake();
+    }
+    return true;
+}
+
+// See Scheduler.h
+void Scheduler::Run(Worker &worker, const std::function<void(std::size_t)> &init) {
+    if (init) {
+        init(worker.index);
+    }
+
+    _current = &worker;
+    worker.reactor.Run(&Scheduler::Begin);
+    _current = nullptr;
+}
+
+// See Scheduler.h
+bool Scheduler::Idle(Worker &worker) {
+    Engine &engine = worker.reactor.engine();
+    for (;;) {
+        void *routine;
+        if (Find(worker, routine)) {
+            engine.adopt(routine);
+            return true;
+        }
+
+        // Publisher pushes first and checks sleeping next, here it goes the other way round, so with
+        // fences in between one of the two sees the other
+        worker.sleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (HasWork(worker)) {
+            worker.sleeping.store(false, std::memory_order_relaxed);
+            continue;
+        } else if (Stopped() && !worker.waiting && engine.next_timer() == Engine::Clock::time_point::max()) {
+            worker.sleeping.store(false, std::memory_order_relaxed);
+            return false;
+        }
+
+        // Sleepers stay on the worker that put them to sleep, so it wakes up no later than the first of them
+        Bump(worker.sleeps);
+        worker.waiting = worker.reactor.Poll(Reactor::Until(engine.next_timer()));
+        worker.sleeping.store(false, std::memory_order_relaxed);
+        engine.expire_timers();
+        Publish(worker);
+    }
+}
+
+// See Scheduler.h
+bool Scheduler::Find(Worker &worker, void *&routine) {
+    Publish(worker);
+    if (worker.ready.Pop(routine)) {
+        return true;
+    }
+
+    // Descriptors are polled only once local work runs out, so a busy worker makes one epoll_wait per
+    // batch of ready routines rather than one per routine
+    worker.waiting = worker.reactor.Poll(std::chrono::nanoseconds(0));
+    worker.reactor.engine().expire_timers();
+    Publish(worker);
+    if (worker.ready.Pop(routine)) {
+        return true;
+    }
+    return Steal(worker, routine);
+}
+
+// See Scheduler.h
+bool Scheduler::Steal(Worker &worker, void *&routine) {
+    std::size_t count = _workers.size();
+    std::size_t start = NextRandom(worker.seed) % count;
+    for (std::size_t i = 0; i < count; i++) {
+        Worker &victim = *_workers[(start + i) % count];
+        if (&victim != &worker && victim.ready.Steal(routine)) {
+            Bump(worker.stolen);
+
+            // Victim has more than it could run, let one more thief in
+            if (!victim.ready.Empty()) {
+                WakeOne(worker);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+// See Scheduler.h
+void Scheduler::Publish(Worker &worker) {
+    Engine &engine = worker.reactor.engine();
+    if (worker.inbox_size.load(std::memory_order_relaxed) != 0) {
+        std::vector<detail::Closure *> bodies;
+        {
+            std::lock_guard<std::mutex> lock(worker.inbox_mutex);
+            bodies.swap(worker.inbox);
+            worker.inbox_size.store(0, std::memory_order_relaxed);
+        }
+
+        for (detail::Closure *body : bodies) {
+            if (engine.run(body) != nullptr) {
+                Bump(worker.spawned);
+            }
+        }
+    }
+
+    bool published = false;
+    while (void *routine = engine.detach()) {
+        worker.ready.Push(routine);
+        published = true;
+    }
+
+    if (published) {
+        WakeOne(worker);
+    }
+}
+
+// See Scheduler.h
+void Scheduler::WakeOne(const Worker &worker) {
+    // Pairs with the fence of the worker going to sleep, see Idle
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    std::size_t count = _workers.size();
+    for (std::size_t i = 1; i < count; i++) {
+        Worker &other = *_workers[(worker.index + i) % count];
+        if (other.sleeping.load(std::memory_order_relaxed) && other.sleeping.exchange(false)) {
+            other.reactor.Wake();
+            return;
+        }
+    }
+}
+
+// See Scheduler.h
+bool Scheduler::HasWork(const Worker &worker) const {
+    if (worker.inbox_size.load(std::memory_order_relaxed) != 0) {
+        return true;
+    }
+
+    for (auto &other : _workers) {
+        if (!other->ready.Empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace Coroutine
+} // namespace Afina
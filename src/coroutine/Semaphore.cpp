@@ -0,0 +1,55 @@
+#include <afina/coroutine/Semaphore.h>
+
+#include <stdexcept>
+
+namespace Afina {
+namespace Coroutine {
+
+// See Semaphore.h
+void Semaphore::acquire() {
+    if (try_acquire()) {
+        return;
+    }
+
+    if (_engine.current() == nullptr) {
+        throw std::logic_error("Semaphore would block outside of coroutine");
+    }
+
+    // Release passes its permit to this routine before waking it
+    _engine.block(_waiters);
+}
+
+// See Semaphore.h
+bool Semaphore::try_acquire() {
+    if (_permits == 0) {
+        return false;
+    }
+
+    _permits--;
+    return true;
+}
+
+// See Semaphore.h
+bool Semaphore::try_acquire_until(Engine::Clock::time_point deadline) {
+    if (try_acquire()) {
+        return true;
+    }
+
+    if (_engine.current() == nullptr) {
+        throw std::logic_error("Semaphore would block outside of coroutine");
+    }
+
+    // Permit is passed only to a routine still in the queue, timer takes it out first
+    return _engine.block_until(_waiters, deadline);
+}
+
+// See Semaphore.h
+void Semaphore::release(std::size_t permits) {
+    while (permits > 0 && _engine.unblock(_waiters) != nullptr) {
+        permits--;
+    }
+    _permits += permits;
+}
+
+} // namespace Coroutine
+} // namespace Afina
@@ -0,0 +1,142 @@
+#include <afina/coroutine/StackPool.h>
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <sstream>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Coroutine {
+
+// See StackPool.h
+StackPool::StackPool(std::size_t stack_size, std::size_t max_free, std::size_t keep_resident)
+    : _page_size(sysconf(_SC_PAGESIZE)),
+      _stack_size((std::max(stack_size, _page_size) + _page_size - 1) & ~(_page_size - 1)), _max_free(max_free),
+      _keep_resident(keep_resident), _residency(_stack_size / _page_size) {}
+
+// See StackPool.h
+StackPool::~StackPool() {
+    for (char *base : _free) {
+        Unmap(base);
+    }
+}
+
+// See StackPool.h
+StackPool::Stack StackPool::Allocate() {
+    Stack result;
+    result.size = _stack_size;
+    if (!_free.empty()) {
+        result.base = _free.back();
+        _free.pop_back();
+        _stats.reuses++;
+    } else {
+        // Whole range is reserved as guard first, only stack part becomes accessible. MAP_NORESERVE keeps
+        // untouched pages out of the commit charge
+        std::size_t length = _page_size + _stack_size;
+        void *map = mmap(nullptr, length, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+        if (map == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+
+        result.base = static_cast<char *>(map) + _page_size;
+        if (mprotect(result.base, _stack_size, PROT_READ | PROT_WRITE) != 0) {
+            munmap(map, length);
+            throw std::bad_alloc();
+        }
+        _stats.mapped++;
+    }
+
+    _stats.allocs++;
+    _stats.in_use++;
+    _stats.peak_in_use = std::max(_stats.peak_in_use, _stats.in_use);
+    return result;
+}
+
+// See StackPool.h
+void StackPool::Release(const Stack &stack) {
+    _stats.in_use--;
+    if (_free.size() >= _max_free) {
+        Unmap(stack.base);
+        return;
+    }
+
+    // Stack grows down, so the lowest resident page tells how deep it went. Pages are never committed
+    // other than by the owner coroutine touching them
+    if (mincore(stack.base, _stack_size, _residency.data()) == 0) {
+        std::size_t pages = _residency.size();
+        std::size_t lowest = pages;
+        std::size_t resident = 0;
+        for (std::size_t i = 0; i < pages; i++) {
+            if ((_residency[i] & 1) != 0) {
+                lowest = std::min(lowest, i);
+                resident++;
+            }
+        }
+        _stats.peak_used_bytes = std::max(_stats.peak_used_bytes, (pages - lowest) * _page_size);
+
+        // Everything below the hot top goes back to the OS
+        std::size_t keep_pages = std::min(pages, (_keep_resident + _page_size - 1) / _page_size);
+        std::size_t trim_pages = pages - keep_pages;
+        if (lowest < trim_pages) {
+            std::size_t trimmed = 0;
+            for (std::size_t i = lowest; i < trim_pages; i++) {
+                trimmed += _residency[i] & 1;
+            }
+            if (madvise(stack.base + lowest * _page_size, (trim_pages - lowest) * _page_size, MADV_DONTNEED) == 0) {
+                _stats.trimmed_bytes += trimmed * _page_size;
+            }
+        }
+    }
+
+    _free.push_back(stack.base);
+}
+
+// See StackPool.h
+void StackPool::Adopt(const Stack &stack) {
+    if (stack.size != _stack_size) {
+        throw std::invalid_argument("Stack of " + std::to_string(stack.size) + " bytes doesn't fit pool of " +
+                                    std::to_string(_stack_size));
+    }
+
+    _stats.mapped++;
+    _stats.in_use++;
+    _stats.peak_in_use = std::max(_stats.peak_in_use, _stats.in_use);
+}
+
+// See StackPool.h
+void StackPool::Disown(const Stack &stack) {
+    if (stack.size != _stack_size) {
+        throw std::invalid_argument("Stack of " + std::to_string(stack.size) + " bytes doesn't belong to pool of " +
+                                    std::to_string(_stack_size));
+    }
+
+    _stats.mapped--;
+    _stats.in_use--;
+}
+
+// See StackPool.h
+std::string StackPool::Dump(const std::string &prefix) const {
+    std::stringstream out;
+    out << prefix << "stack_size " << _stack_size << "\n";
+    out << prefix << "stacks_mapped " << _stats.mapped << "\n";
+    out << prefix << "stacks_in_use " << _stats.in_use << "\n";
+    out << prefix << "stacks_free " << _free.size() << "\n";
+    out << prefix << "stacks_peak_in_use " << _stats.peak_in_use << "\n";
+    out << prefix << "stack_peak_used_bytes " << _stats.peak_used_bytes << "\n";
+    out << prefix << "stack_trimmed_bytes " << _stats.trimmed_bytes << "\n";
+    out << prefix << "stack_allocs " << _stats.allocs << "\n";
+    out << prefix << "stack_reuses " << _stats.reuses;
+    return out.str();
+}
+
+// See StackPool.h
+void StackPool::Unmap(char *base) {
+    munmap(base - _page_size, _page_size + _stack_size);
+    _stats.mapped--;
+}
+
+} // namespace Coroutine
+} // namespace Afina
@@ -3,12 +3,76 @@
 
 #include <iostream>
 #include <iterator>
+#include <map>
+#include <mutex>
 #include <sstream>
 
 namespace Afina {
 namespace Execute {
 
-void Stats::Execute(Storage &storage, const std::string &args, std::string &out) { out.assign("END"); }
+namespace {
+
+std::mutex providers_lock;
+
+std::map<std::string, Stats::Provider> &providers() {
+    static std::map<std::string, Stats::Provider> instance;
+    return instance;
+}
+
+void Print(const std::string &lines, std::stringstream &out) {
+    std::stringstream in(lines);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty()) {
+            out << "STAT " << line << "\r\n";
+        }
+    }
+}
+
+} // namespace
+
+// See Stats.h
+void Stats::Execute(Storage &storage, const std::string &args, std::string &out) {
+    std::vector<Provider> selected;
+    {
+        std::lock_guard<std::mutex> lock(providers_lock);
+        if (_groups.empty()) {
+            for (auto &p : providers()) {
+                selected.push_back(p.second);
+            }
+        }
+
+        for (auto &group : _groups) {
+            auto it = providers().find(group);
+            if (it == providers().end()) {
+                out.assign("ERROR");
+                return;
+            }
+            selected.push_back(it->second);
+        }
+    }
+
+    // Providers might be slow, so they are called without global lock
+    std::stringstream outStream;
+    for (auto &provider : selected) {
+        Print(provider(), outStream);
+    }
+    outStream << "END"; // networking layer should add the last \r\n
+
+    out = outStream.str();
+}
+
+// See Stats.h
+void Stats::Register(const std::string &group, Provider provider) {
+    std::lock_guard<std::mutex> lock(providers_lock);
+    providers()[group] = provider;
+}
+
+// See Stats.h
+void Stats::Unregister(const std::string &group) {
+    std::lock_guard<std::mutex> lock(providers_lock);
+    providers().erase(group);
+}
 
 } // namespace Execute
 } // namespace Afina
@@ -11,15 +11,27 @@
 
 #include <afina/Storage.h>
 #include <afina/Version.h>
+#include <afina/allocator/Arena.h>
+#include <afina/concurrency/Topology.h>
+#include <afina/execute/Stats.h>
 #include <afina/logging/Service.h>
 #include <afina/network/Server.h>
 
 #include "logging/ServiceImpl.h"
+#ifdef AFINA_HAVE_COROUTINES
+#include "network/mt_await/ServerImpl.h"
+#endif
 #include "network/mt_blocking/ServerImpl.h"
+#include "network/mt_coroutine/ServerImpl.h"
 #include "network/mt_nonblocking/ServerImpl.h"
+#include "network/mt_reuseport/ServerImpl.h"
+#include "network/mt_uring/ServerImpl.h"
 #include "network/st_blocking/ServerImpl.h"
+#include "network/st_coroutine/ServerImpl.h"
 #include "network/st_nonblocking/ServerImpl.h"
 
+#include "storage/FlatCombineLRU.h"
+#include "storage/OptimisticCuckoo.h"
 #include "storage/SimpleLRU.h"
 #include "storage/ThreadSafeSimpleLRU.h"
 
@@ -44,21 +56,89 @@ public:
         logger.format = "[%H:%M:%S %z] [thread %t] [%n] [%l] %v";
         logService.reset(new Logging::ServiceImpl(logConfig));
 
-        // Step 1: configure storage
+        // Step 1: decide how many threads run where, memory placement depends on it
+        if (options.count("acceptors") > 0) {
+            acceptors = options["acceptors"].as<uint32_t>();
+        }
+        if (options.count("workers") > 0) {
+            workers = options["workers"].as<uint32_t>();
+        }
+        if (acceptors == 0 || workers == 0) {
+            throw std::runtime_error("Network needs at least one acceptor and one worker");
+        }
+
+        std::string affinity = "none";
+        if (options.count("affinity") > 0) {
+            affinity = options["affinity"].as<std::string>();
+        }
+
+        topology = Afina::Concurrency::Topology::Detect();
+        if (affinity == "cores") {
+            placement = Afina::Concurrency::Placement(topology, Afina::Concurrency::Placement::Policy::kCores);
+        } else if (affinity != "none") {
+            throw std::runtime_error("Unknown affinity policy");
+        }
+
+        // Step 2: configure memory arena for the storage, if requested
+        if (options.count("arena-size") > 0) {
+            auto huge_pages = Afina::Allocator::Arena::HugePages::None;
+            if (options.count("hugepages") > 0) {
+                std::string huge_pages_type = options["hugepages"].as<std::string>();
+                if (huge_pages_type == "transparent") {
+                    huge_pages = Afina::Allocator::Arena::HugePages::Transparent;
+                } else if (huge_pages_type == "explicit") {
+                    huge_pages = Afina::Allocator::Arena::HugePages::Explicit;
+                } else if (huge_pages_type != "none") {
+                    throw std::runtime_error("Unknown huge pages type");
+                }
+            }
+
+            // Storage is shared by all workers, spread it over their nodes instead of the first one
+            // to touch it
+            std::vector<unsigned> nodes = placement.Nodes(workers);
+            if (nodes.size() < 2) {
+                nodes.clear();
+            }
+
+            std::size_t arena_size = std::size_t(options["arena-size"].as<uint32_t>()) << 20;
+            arena = std::make_shared<Afina::Allocator::Arena>(arena_size, Afina::Allocator::Arena::kHugePageSize,
+                                                              huge_pages, options.count("prefault") > 0, nodes);
+        }
+
+        // Step 3: configure storage
         std::string storage_type = "st_lru";
         if (options.count("storage") > 0) {
             storage_type = options["storage"].as<std::string>();
         }
 
         if (storage_type == "st_lru") {
-            storage = std::make_shared<Afina::Backend::SimpleLRU>();
+            auto lru = std::make_shared<Afina::Backend::SimpleLRU>(1024, arena);
+            Afina::Execute::Stats::Register("slabs", [lru]() { return lru->DumpAllocator(); });
+            Afina::Execute::Stats::Register("storage", [lru]() { return lru->DumpCounters(); });
+            storage = lru;
         } else if (storage_type == "mt_lru") {
-            storage = std::make_shared<Afina::Backend::ThreadSafeSimplLRU>();
+            auto lru = std::make_shared<Afina::Backend::ThreadSafeSimplLRU>(1024, arena);
+            Afina::Execute::Stats::Register("slabs", [lru]() { return lru->DumpAllocator(); });
+            Afina::Execute::Stats::Register("storage", [lru]() { return lru->DumpCounters(); });
+            storage = lru;
+        } else if (storage_type == "fc_lru") {
+            auto lru = std::make_shared<Afina::Backend::FlatCombineLRU>(1024, arena);
+            Afina::Execute::Stats::Register("slabs", [lru]() { return lru->DumpAllocator(); });
+            Afina::Execute::Stats::Register("storage", [lru]() { return lru->DumpCounters(); });
+            Afina::Execute::Stats::Register("combine", [lru]() { return lru->DumpCombine(); });
+            storage = lru;
+        } else if (storage_type == "cuckoo") {
+            if (arena) {
+                throw std::runtime_error("Storage cuckoo allocates entries from heap, arena is not supported");
+            }
+            auto cuckoo = std::make_shared<Afina::Backend::OptimisticCuckoo>(1024);
+            Afina::Execute::Stats::Register("storage", [cuckoo]() { return cuckoo->DumpCounters(); });
+            storage = cuckoo;
         } else {
             throw std::runtime_error("Unknown storage type");
         }
 
-        // Step 2: Configure network
+        // Step 4: Configure network
         std::string network_type = "st_block";
         if (options.count("network") > 0) {
             network_type = options["network"].as<std::string>();
@@ -72,9 +152,26 @@ public:
             server = std::make_shared<Afina::Network::STnonblock::ServerImpl>(storage, logService);
         } else if (network_type == "mt_nonblock") {
             server = std::make_shared<Afina::Network::MTnonblock::ServerImpl>(storage, logService);
+        } else if (network_type == "mt_reuseport") {
+            server = std::make_shared<Afina::Network::MTreuseport::ServerImpl>(storage, logService);
+        } else if (network_type == "uring") {
+            server = std::make_shared<Afina::Network::MTuring::ServerImpl>(storage, logService);
+        } else if (network_type == "st_coroutine") {
+            server = std::make_shared<Afina::Network::STcoroutine::ServerImpl>(storage, logService);
+        } else if (network_type == "mt_coroutine") {
+            server = std::make_shared<Afina::Network::MTcoroutine::ServerImpl>(storage, logService);
+#ifdef AFINA_HAVE_COROUTINES
+        } else if (network_type == "mt_await") {
+            server = std::make_shared<Afina::Network::MTawait::ServerImpl>(storage, logService);
+#endif
         } else {
             throw std::runtime_error("Unknown network type");
         }
+
+        server->SetPlacement(placement);
+
+        auto network = server;
+        Afina::Execute::Stats::Register("network", [network]() { return network->DumpCounters(); });
     }
 
     // Start services in correct order
@@ -86,10 +183,13 @@ public:
         log->warn("Start storage");
         storage->Start();
 
+        log->warn("Topology: {} cpus, {} cores, {} nodes", topology.Cpus().size(), topology.Cores(),
+                  topology.Nodes().size());
+
         // TODO: configure network service
         const uint16_t port = 8080;
-        log->warn("Start network on {}", port);
-        server->Start(port, 2, 2);
+        log->warn("Start network on {} with {} acceptors and {} workers", port, acceptors, workers);
+        server->Start(port, acceptors, workers);
     }
 
     // Stop services in correct order
@@ -100,13 +200,25 @@ public:
         server->Join();
 
         storage->Stop();
+        Afina::Execute::Stats::Unregister("slabs");
+        Afina::Execute::Stats::Unregister("combine");
+        Afina::Execute::Stats::Unregister("storage");
+        Afina::Execute::Stats::Unregister("network");
         logService->Stop();
     }
 
 private:
+    // Network threads, modes that have no separate acceptors ignore their number
+    uint32_t acceptors = 2;
+    uint32_t workers = 2;
+
+    Afina::Concurrency::Topology topology;
+    Afina::Concurrency::Placement placement;
+
     std::shared_ptr<Afina::Logging::Config> logConfig;
     std::shared_ptr<Afina::Logging::Service> logService;
 
+    std::shared_ptr<Afina::Allocator::Arena> arena;
     std::shared_ptr<Afina::Storage> storage;
     std::shared_ptr<Afina::Network::Server> server;
 };
@@ -129,6 +241,16 @@ int main(int argc, char **argv) {
         // and simplify validation below
         options.add_options()("s,storage", "Type of storage service to use", cxxopts::value<std::string>());
         options.add_options()("n,network", "Type of network service to use", cxxopts::value<std::string>());
+        options.add_options()("acceptors", "Number of network acceptor threads, 2 by default",
+                              cxxopts::value<uint32_t>());
+        options.add_options()("workers", "Number of network worker threads, 2 by default", cxxopts::value<uint32_t>());
+        options.add_options()("arena-size", "Allocate storage from mmap arena of given size in MB",
+                              cxxopts::value<uint32_t>());
+        options.add_options()("hugepages", "Pages to back arena with: none, transparent, explicit",
+                              cxxopts::value<std::string>());
+        options.add_options()("prefault", "Fault in all arena memory on startup");
+        options.add_options()("affinity", "Pin network threads: none, cores (worker per physical core)",
+                              cxxopts::value<std::string>());
         options.add_options()("h,help", "Print usage info");
         options.parse(argc, argv);
 
@@ -0,0 +1,81 @@
+#ifndef AFINA_NETWORK_MT_AWAIT_CONNECTION_H
+#define AFINA_NETWORK_MT_AWAIT_CONNECTION_H
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include <afina/Storage.h>
+#include <afina/execute/Command.h>
+#include <afina/network/Server.h>
+#include <spdlog/logger.h>
+
+#include "protocol/Parser.h"
+
+#include "EventLoop.h"
+#include "Task.h"
+
+namespace Afina {
+namespace Network {
+namespace MTawait {
+
+/**
+ * # Client connection served by a stackless coroutine
+ * Same loop as MTcoroutine::Connection, but every read and write is co_await on the event loop of the
+ * worker, so the connection costs a coroutine frame of a few hundred bytes instead of a stack. Frame
+ * and connection stay on the worker that accepted it
+ */
+class Connection {
+public:
+    /**
+     * Registers socket in the loop, throws std::runtime_error if it fails
+     */
+    Connection(EventLoop &loop, int s, std::shared_ptr<spdlog::logger> pl, std::shared_ptr<Afina::Storage> ps,
+               Counters *pc)
+        : _descriptor(loop, s), _logger(pl), pStorage(ps), pCounters(pc), arg_remains(0), _read_bytes(0) {}
+
+    // Closes the socket
+    ~Connection();
+
+    /**
+     * Serves the client until it disconnects or loop stops, then deletes connection
+     */
+    Task Serve();
+
+protected:
+    /**
+     * Parses and executes every complete command in the buffer, replies are appended to output
+     */
+    void Process();
+
+private:
+    Descriptor _descriptor;
+
+    std::shared_ptr<spdlog::logger> _logger;
+    std::shared_ptr<Afina::Storage> pStorage;
+
+    // Owned by the server, which outlives all its connections
+    Counters *pCounters;
+
+    // Here is connection state
+    // - parser: parse state of the stream
+    // - command_to_execute: last command parsed out of stream
+    // - arg_remains: how many bytes to read from stream to get command argument
+    // - argument_for_command: buffer stores argument
+    std::size_t arg_remains;
+    Protocol::Parser parser;
+    std::string argument_for_command;
+    std::unique_ptr<Execute::Command> command_to_execute;
+
+    char client_buffer[4096];
+    std::size_t _read_bytes;
+
+    // Replies not sent yet
+    std::string _output;
+};
+
+} // namespace MTawait
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_MT_AWAIT_CONNECTION_H
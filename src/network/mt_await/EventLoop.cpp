@@ -0,0 +1,245 @@
+#include "EventLoop.h"
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Network {
+namespace MTawait {
+
+// See EventLoop.h
+bool Operation::Ready() {
+    if (_descriptor._loop.Stopped()) {
+        _result = -1;
+        _error = ECANCELED;
+        return true;
+    }
+    return Perform();
+}
+
+// See EventLoop.h
+void Operation::Suspend(std::coroutine_handle<> waiter, bool write) {
+    _waiter = waiter;
+    if (write) {
+        _descriptor._writer = this;
+    } else {
+        _descriptor._reader = this;
+    }
+    _descriptor._loop.Park(*this);
+}
+
+// See EventLoop.h
+ssize_t Operation::Resume() const {
+    if (_result < 0) {
+        errno = _error;
+    }
+    return _result;
+}
+
+// See EventLoop.h
+bool ReadOperation::Perform() {
+    for (;;) {
+        ssize_t n = read(_descriptor.fd(), _buf, _count);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return false;
+        }
+        Complete(n);
+        return true;
+    }
+}
+
+// See EventLoop.h
+bool WriteOperation::Perform() {
+    while (_written < _count) {
+        ssize_t n = write(_descriptor.fd(), _buf + _written, _count - _written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return false;
+        } else if (n < 0) {
+            Complete(n);
+            return true;
+        }
+        _written += n;
+    }
+    Complete(_written);
+    return true;
+}
+
+// See EventLoop.h
+bool AcceptOperation::Perform() {
+    for (;;) {
+        int fd = accept4(_descriptor.fd(), _addr, _len, _flags);
+        if (fd < 0 && errno == EINTR) {
+            continue;
+        } else if (fd < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return false;
+        }
+        Complete(fd);
+        return true;
+    }
+}
+
+// See EventLoop.h
+Descriptor::Descriptor(EventLoop &loop, int fd, bool exclusive)
+    : _loop(loop), _fd(fd), _reader(nullptr), _writer(nullptr) {
+    // Edge triggered, so there is nothing to change when operations come and go: each one tries the call
+    // before it waits for the next edge
+    struct epoll_event event;
+    event.events = exclusive ? (EPOLLIN | EPOLLET | EPOLLEXCLUSIVE) : (EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET);
+    event.data.ptr = this;
+    if (epoll_ctl(_loop._epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+        throw std::runtime_error("Failed to add descriptor to epoll: " + std::string(strerror(errno)));
+    }
+}
+
+// See EventLoop.h
+EventLoop::EventLoop() : _stopped(false), _parked(nullptr), _pending(0) {
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll_fd == -1) {
+        throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
+    }
+
+    _event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_event_fd == -1) {
+        close(_epoll_fd);
+        throw std::runtime_error("Failed to create eventfd: " + std::string(strerror(errno)));
+    }
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _event_fd, &event)) {
+        close(_event_fd);
+        close(_epoll_fd);
+        throw std::runtime_error("Failed to add eventfd descriptor to epoll");
+    }
+}
+
+// See EventLoop.h
+EventLoop::~EventLoop() {
+    close(_event_fd);
+    close(_epoll_fd);
+}
+
+// See EventLoop.h
+void EventLoop::Run() {
+    std::array<struct epoll_event, 64> ready;
+    std::vector<Operation *> completed;
+    completed.reserve(2 * ready.size());
+
+    while (_pending > 0) {
+        if (Stopped()) {
+            Cancel();
+            continue;
+        }
+
+        int n = epoll_wait(_epoll_fd, ready.data(), ready.size(), -1);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Failed to wait for events: " + std::string(strerror(errno)));
+        }
+
+        // Calls first, resumes next: resumed coroutine may close its descriptor and free it, but not an
+        // operation of another coroutine
+        for (int i = 0; i < n; i++) {
+            Descriptor *descriptor = static_cast<Descriptor *>(ready[i].data.ptr);
+            if (descriptor == nullptr) {
+                eventfd_t value;
+                eventfd_read(_event_fd, &value);
+                continue;
+            }
+
+            uint32_t events = ready[i].events;
+            Operation *reader = descriptor->_reader;
+            if (reader != nullptr && (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) && reader->Perform()) {
+                descriptor->_reader = nullptr;
+                Unpark(*reader);
+                completed.push_back(reader);
+            }
+
+            Operation *writer = descriptor->_writer;
+            if (writer != nullptr && (events & (EPOLLOUT | EPOLLHUP | EPOLLERR)) && writer->Perform()) {
+                descriptor->_writer = nullptr;
+                Unpark(*writer);
+                completed.push_back(writer);
+            }
+        }
+
+        for (Operation *operation : completed) {
+            operation->_waiter.resume();
+        }
+        completed.clear();
+    }
+}
+
+// See EventLoop.h
+void EventLoop::Stop() {
+    _stopped.store(true, std::memory_order_relaxed);
+    if (eventfd_write(_event_fd, 1)) {
+        throw std::runtime_error("Failed to wakeup workers");
+    }
+}
+
+// See EventLoop.h
+void EventLoop::Park(Operation &operation) {
+    operation._prev = nullptr;
+    operation._next = _parked;
+    if (_parked != nullptr) {
+        _parked->_prev = &operation;
+    }
+    _parked = &operation;
+    _pending++;
+}
+
+// See EventLoop.h
+void EventLoop::Unpark(Operation &operation) {
+    if (operation._prev != nullptr) {
+        operation._prev->_next = operation._next;
+    } else {
+        _parked = operation._next;
+    }
+    if (operation._next != nullptr) {
+        operation._next->_prev = operation._prev;
+    }
+    operation._prev = operation._next = nullptr;
+    _pending--;
+}
+
+// See EventLoop.h
+void EventLoop::Cancel() {
+    std::vector<Operation *> cancelled;
+    cancelled.reserve(_pending);
+    while (_parked != nullptr) {
+        Operation *operation = _parked;
+        Unpark(*operation);
+        if (operation->_descriptor._reader == operation) {
+            operation->_descriptor._reader = nullptr;
+        } else {
+            operation->_descriptor._writer = nullptr;
+        }
+        operation->_result = -1;
+        operation->_error = ECANCELED;
+        cancelled.push_back(operation);
+    }
+
+    // Operations started from here on are cancelled right away
+    for (Operation *operation : cancelled) {
+        operation->_waiter.resume();
+    }
+}
+
+} // namespace MTawait
+} // namespace Network
+} // namespace Afina
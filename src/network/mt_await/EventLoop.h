@@ -0,0 +1,226 @@
+#ifndef AFINA_NETWORK_MT_AWAIT_EVENT_LOOP_H
+#define AFINA_NETWORK_MT_AWAIT_EVENT_LOOP_H
+
+#include <atomic>
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+
+namespace Afina {
+namespace Network {
+namespace MTawait {
+
+class EventLoop;
+class Descriptor;
+
+/**
+ * # Pending I/O of a suspended coroutine
+ * Awaitable tries the call first and only suspends if it would block, then the loop repeats the call
+ * each time descriptor reports readiness and resumes the coroutine once it is done. Result follows the
+ * system call: -1 with error on failure, ECANCELED once loop is stopped
+ */
+class Operation {
+public:
+    explicit Operation(Descriptor &descriptor)
+        : _descriptor(descriptor), _result(-1), _error(0), _prev(nullptr), _next(nullptr) {}
+
+    virtual ~Operation() {}
+
+protected:
+    friend class EventLoop;
+
+    /**
+     * Makes the call, false if it would block
+     */
+    virtual bool Perform() = 0;
+
+    // Awaitable interface for the derived ones
+    bool Ready();
+    void Suspend(std::coroutine_handle<> waiter, bool write);
+    ssize_t Resume() const;
+
+    inline void Complete(ssize_t result) {
+        _result = result;
+        _error = result < 0 ? errno : 0;
+    }
+
+    Descriptor &_descriptor;
+
+private:
+    ssize_t _result;
+    int _error;
+    std::coroutine_handle<> _waiter;
+
+    // Pending operations of the loop, to cancel them on stop
+    Operation *_prev;
+    Operation *_next;
+};
+
+/**
+ * # Descriptor registered in the loop
+ * Added to epoll edge triggered for the life of the object, closing descriptor takes it out. At most one
+ * read-like and one write operation may be pending at a time
+ */
+class Descriptor {
+public:
+    /**
+     * Throws std::runtime_error if epoll refuses the descriptor. Exclusive is for descriptors shared by
+     * loops of several threads, like server socket: a connection wakes up only one of them
+     */
+    Descriptor(EventLoop &loop, int fd, bool exclusive = false);
+
+    inline int fd() const { return _fd; }
+
+    inline EventLoop &loop() const { return _loop; }
+
+private:
+    Descriptor(const Descriptor &) = delete;
+    Descriptor &operator=(const Descriptor &) = delete;
+
+    friend class EventLoop;
+    friend class Operation;
+
+    EventLoop &_loop;
+    int _fd;
+
+    Operation *_reader;
+    Operation *_writer;
+};
+
+/**
+ * # epoll of one worker thread
+ * Resumes coroutines whose operations have completed. Everything but Stop must be called on the thread
+ * that runs the loop
+ */
+class EventLoop {
+public:
+    EventLoop();
+    ~EventLoop();
+
+    /**
+     * Waits for events and resumes coroutines until nothing is pending. Once stopped cancels everything
+     * pending and returns, coroutines get ECANCELED from every operation after that
+     */
+    void Run();
+
+    /**
+     * Safe to call from any thread
+     */
+    void Stop();
+
+    inline bool Stopped() const { return _stopped.load(std::memory_order_relaxed); }
+
+    // Operations suspended at the moment
+    inline std::size_t Pending() const { return _pending; }
+
+private:
+    EventLoop(const EventLoop &) = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    friend class Descriptor;
+    friend class Operation;
+
+    void Park(Operation &operation);
+    void Unpark(Operation &operation);
+
+    /**
+     * Resumes everything pending with ECANCELED
+     */
+    void Cancel();
+
+    int _epoll_fd;
+
+    // Wakes up the loop on stop
+    int _event_fd;
+
+    std::atomic<bool> _stopped;
+
+    Operation *_parked;
+    std::size_t _pending;
+};
+
+// Awaitables, see Operation
+
+class ReadOperation : public Operation {
+public:
+    ReadOperation(Descriptor &descriptor, void *buf, std::size_t count)
+        : Operation(descriptor), _buf(buf), _count(count) {}
+
+    bool await_ready() { return Ready(); }
+    void await_suspend(std::coroutine_handle<> waiter) { Suspend(waiter, false); }
+    ssize_t await_resume() const { return Resume(); }
+
+protected:
+    bool Perform() override;
+
+private:
+    void *_buf;
+    std::size_t _count;
+};
+
+class WriteOperation : public Operation {
+public:
+    WriteOperation(Descriptor &descriptor, const void *buf, std::size_t count)
+        : Operation(descriptor), _buf(static_cast<const char *>(buf)), _count(count), _written(0) {}
+
+    bool await_ready() { return Ready(); }
+    void await_suspend(std::coroutine_handle<> waiter) { Suspend(waiter, true); }
+    ssize_t await_resume() const { return Resume(); }
+
+protected:
+    bool Perform() override;
+
+private:
+    const char *_buf;
+    std::size_t _count;
+    std::size_t _written;
+};
+
+class AcceptOperation : public Operation {
+public:
+    AcceptOperation(Descriptor &descriptor, struct sockaddr *addr, socklen_t *len, int flags)
+        : Operation(descriptor), _addr(addr), _len(len), _flags(flags) {}
+
+    bool await_ready() { return Ready(); }
+    void await_suspend(std::coroutine_handle<> waiter) { Suspend(waiter, false); }
+    ssize_t await_resume() const { return Resume(); }
+
+protected:
+    bool Perform() override;
+
+private:
+    struct sockaddr *_addr;
+    socklen_t *_len;
+    int _flags;
+};
+
+/**
+ * Like read(2) on blocking socket
+ */
+inline ReadOperation async_read(Descriptor &descriptor, void *buf, std::size_t count) {
+    return ReadOperation(descriptor, buf, count);
+}
+
+/**
+ * Like write(2) on blocking socket, but writes everything unless fails
+ */
+inline WriteOperation async_write(Descriptor &descriptor, const void *buf, std::size_t count) {
+    return WriteOperation(descriptor, buf, count);
+}
+
+/**
+ * Like accept4(2) on blocking socket
+ */
+inline AcceptOperation async_accept(Descriptor &descriptor, struct sockaddr *addr, socklen_t *len, int flags) {
+    return AcceptOperation(descriptor, addr, len, flags);
+}
+
+} // namespace MTawait
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_MT_AWAIT_EVENT_LOOP_H
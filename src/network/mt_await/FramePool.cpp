@@ -0,0 +1,86 @@
+#include "FramePool.h"
+
+#include <new>
+
+namespace Afina {
+namespace Network {
+namespace MTawait {
+
+namespace {
+
+// Counters have a single writer, no need for a locked increment
+inline void Add(std::atomic<uint64_t> &counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+inline void Sub(std::atomic<uint64_t> &counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) - value, std::memory_order_relaxed);
+}
+
+} // namespace
+
+constexpr std::size_t FramePool::kGranularity;
+constexpr std::size_t FramePool::kMaxFrame;
+constexpr std::size_t FramePool::kClasses;
+
+thread_local FramePool *FramePool::_current = nullptr;
+
+// See FramePool.h
+FramePool::FramePool() : _frames(0), _bytes(0), _reused(0) { _free.fill(nullptr); }
+
+// See FramePool.h
+FramePool::~FramePool() {
+    for (Block *&head : _free) {
+        while (head != nullptr) {
+            Block *next = head->next;
+            ::operator delete(head);
+            head = next;
+        }
+    }
+}
+
+// See FramePool.h
+void *FramePool::Allocate(std::size_t size) {
+    if (size == 0 || size > kMaxFrame) {
+        return ::operator new(size);
+    }
+
+    // Even without a pool block is rounded up, so it could go to a free list of any pool later
+    std::size_t cls = (size - 1) / kGranularity;
+    FramePool *pool = _current;
+    if (pool == nullptr) {
+        return ::operator new((cls + 1) * kGranularity);
+    }
+
+    Add(pool->_frames, 1);
+    Add(pool->_bytes, (cls + 1) * kGranularity);
+
+    Block *block = pool->_free[cls];
+    if (block != nullptr) {
+        pool->_free[cls] = block->next;
+        Add(pool->_reused, 1);
+        return block;
+    }
+    return ::operator new((cls + 1) * kGranularity);
+}
+
+// See FramePool.h
+void FramePool::Release(void *frame, std::size_t size) {
+    FramePool *pool = _current;
+    if (pool == nullptr || size == 0 || size > kMaxFrame) {
+        ::operator delete(frame);
+        return;
+    }
+
+    std::size_t cls = (size - 1) / kGranularity;
+    Sub(pool->_frames, 1);
+    Sub(pool->_bytes, (cls + 1) * kGranularity);
+
+    Block *block = static_cast<Block *>(frame);
+    block->next = pool->_free[cls];
+    pool->_free[cls] = block;
+}
+
+} // namespace MTawait
+} // namespace Network
+} // namespace Afina
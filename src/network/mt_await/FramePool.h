@@ -0,0 +1,87 @@
+#ifndef AFINA_NETWORK_MT_AWAIT_FRAME_POOL_H
+#define AFINA_NETWORK_MT_AWAIT_FRAME_POOL_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Afina {
+namespace Network {
+namespace MTawait {
+
+/**
+ * # Coroutine frames of one worker
+ * Free lists of blocks by size in 64 byte steps up to 4K, frames of the same coroutine function have
+ * the same size, so after warm up every frame comes from the list of its size. Bigger frames and
+ * frames of threads without a pool go to operator new.
+ *
+ * Pool is installed for the calling thread with Scope and is only touched by that thread, counters
+ * may be read from anywhere
+ */
+class FramePool {
+public:
+    static constexpr std::size_t kGranularity = 64;
+    static constexpr std::size_t kMaxFrame = 4096;
+
+    FramePool();
+
+    // Frees cached blocks, frames in use must have been released already
+    ~FramePool();
+
+    /**
+     * Frame of the given size from the pool of the calling thread
+     */
+    static void *Allocate(std::size_t size);
+
+    /**
+     * Gives frame back to the pool of the calling thread, size is the one it was allocated with
+     */
+    static void Release(void *frame, std::size_t size);
+
+    /**
+     * Makes pool the one of the calling thread while in scope
+     */
+    class Scope {
+    public:
+        explicit Scope(FramePool &pool) : _previous(_current) { _current = &pool; }
+        ~Scope() { _current = _previous; }
+
+    private:
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        FramePool *_previous;
+    };
+
+    // Frames in use and their bytes
+    inline uint64_t Frames() const { return _frames.load(std::memory_order_relaxed); }
+    inline uint64_t Bytes() const { return _bytes.load(std::memory_order_relaxed); }
+
+    // Frames taken from free lists rather than operator new
+    inline uint64_t Reused() const { return _reused.load(std::memory_order_relaxed); }
+
+private:
+    FramePool(const FramePool &) = delete;
+    FramePool &operator=(const FramePool &) = delete;
+
+    struct Block {
+        Block *next;
+    };
+
+    static constexpr std::size_t kClasses = kMaxFrame / kGranularity;
+
+    static thread_local FramePool *_current;
+
+    std::array<Block *, kClasses> _free;
+
+    std::atomic<uint64_t> _frames;
+    std::atomic<uint64_t> _bytes;
+    std::atomic<uint64_t> _reused;
+};
+
+} // namespace MTawait
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_MT_AWAIT_FRAME_POOL_H
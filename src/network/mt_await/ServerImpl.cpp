@@ -0,0 +1,234 @@
+#include "ServerImpl.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+#include <afina/concurrency/Topology.h>
+#include <afina/logging/Service.h>
+
+#include "Connection.h"
+#include "EventLoop.h"
+#include "FramePool.h"
+#include "Task.h"
+
+namespace Afina {
+namespace Network {
+namespace MTawait {
+
+namespace {
+
+// Pause before accept is tried again after it failed, e.g. when out of descriptors
+const long kAcceptRetryNs = 100 * 1000 * 1000;
+
+// Accepts connections of one worker and starts a coroutine for each until the loop stops. Timer is a
+// timerfd to wait on when accept fails
+Task Accept(Descriptor &listener, Descriptor &timer, std::shared_ptr<spdlog::logger> logger,
+            std::shared_ptr<Afina::Storage> storage, Counters *counters) {
+    for (;;) {
+        struct sockaddr in_addr;
+        socklen_t in_len = sizeof in_addr;
+        int infd = co_await async_accept(listener, &in_addr, &in_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (infd == -1) {
+            if (errno == ECONNABORTED || errno == EPROTO) {
+                // Client gave up before accept, next one may be fine
+                continue;
+            } else if (errno == ECANCELED || listener.loop().Stopped()) {
+                break;
+            }
+
+            // Connection stays in the backlog and there may be no new edge for it, so accept is retried
+            // on timer rather than on readiness
+            counters->errors.Add();
+            logger->error("Failed to accept socket, retry in {} ms: {}", kAcceptRetryNs / 1000000, strerror(errno));
+
+            struct itimerspec pause;
+            std::memset(&pause, 0, sizeof(pause));
+            pause.it_value.tv_nsec = kAcceptRetryNs;
+            if (timerfd_settime(timer.fd(), 0, &pause, nullptr) == -1) {
+                logger->error("Failed to arm accept retry timer, worker stops accepting: {}", strerror(errno));
+                break;
+            }
+
+            uint64_t expirations;
+            if (co_await async_read(timer, &expirations, sizeof(expirations)) == -1) {
+                break;
+            }
+            continue;
+        }
+
+        // Print host and service info.
+        char hbuf[NI_MAXHOST], sbuf[NI_MAXSERV];
+        int retval =
+            getnameinfo(&in_addr, in_len, hbuf, sizeof hbuf, sbuf, sizeof sbuf, NI_NUMERICHOST | NI_NUMERICSERV);
+        if (retval == 0) {
+            logger->info("Accepted connection on descriptor {} (host={}, port={})", infd, hbuf, sbuf);
+        }
+
+        counters->connections.Add();
+        Connection *pc;
+        try {
+            pc = new Connection(listener.loop(), infd, logger, storage, counters);
+        } catch (std::runtime_error &ex) {
+            counters->errors.Add();
+            logger->error("Failed to register connection on descriptor {}: {}", infd, ex.what());
+            close(infd);
+            continue;
+        }
+
+        // Runs until the first read that would block, then comes back here
+        pc->Serve();
+    }
+}
+
+} // namespace
+
+struct ServerImpl::Worker {
+    EventLoop loop;
+    FramePool frames;
+    std::thread thread;
+};
+
+// See Server.h
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl)
+    : Server(ps, pl), _server_socket(-1) {}
+
+// See Server.h
+ServerImpl::~ServerImpl() {}
+
+// See Server.h
+void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers) {
+    _logger = pLogging->select("network");
+    _logger->info("Start network service");
+
+    sigset_t sig_mask;
+    sigemptyset(&sig_mask);
+    sigaddset(&sig_mask, SIGPIPE);
+    if (pthread_sigmask(SIG_BLOCK, &sig_mask, NULL) != 0) {
+        throw std::runtime_error("Unable to mask SIGPIPE");
+    }
+
+    // Create server socket
+    struct sockaddr_in server_addr;
+    std::memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;         // IPv4
+    server_addr.sin_port = htons(port);       // TCP port number
+    server_addr.sin_addr.s_addr = INADDR_ANY; // Bind to any address
+
+    // Accepting coroutines wait in epoll, so the socket never blocks
+    _server_socket = socket(PF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+    if (_server_socket == -1) {
+        throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
+    }
+
+    int opts = 1;
+    if (setsockopt(_server_socket, SOL_SOCKET, (SO_KEEPALIVE), &opts, sizeof(opts)) == -1) {
+        close(_server_socket);
+        throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
+    }
+
+    if (bind(_server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
+        close(_server_socket);
+        throw std::runtime_error("Socket bind() failed: " + std::string(strerror(errno)));
+    }
+
+    if (listen(_server_socket, SOMAXCONN) == -1) {
+        close(_server_socket);
+        throw std::runtime_error("Socket listen() failed: " + std::string(strerror(errno)));
+    }
+
+    n_workers = std::max<uint32_t>(1, n_workers);
+    for (uint32_t i = 0; i < n_workers; i++) {
+        _workers.emplace_back(new Worker);
+    }
+    for (uint32_t i = 0; i < n_workers; i++) {
+        _workers[i]->thread = std::thread(&ServerImpl::Run, this, std::ref(*_workers[i]), i);
+    }
+}
+
+// See Server.h
+void ServerImpl::Stop() {
+    _logger->warn("Stop network service");
+    for (auto &worker : _workers) {
+        worker->loop.Stop();
+    }
+
+    // Socket is still in epoll of workers, it is closed once they are done
+    shutdown(_server_socket, SHUT_RDWR);
+}
+
+// See Server.h
+void ServerImpl::Join() {
+    for (auto &worker : _workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    _workers.clear();
+
+    if (_server_socket != -1) {
+        close(_server_socket);
+        _server_socket = -1;
+    }
+}
+
+// See Server.h
+std::string ServerImpl::DumpCounters() const {
+    uint64_t frames = 0, bytes = 0, reused = 0;
+    for (auto &worker : _workers) {
+        frames += worker->frames.Frames();
+        bytes += worker->frames.Bytes();
+        reused += worker->frames.Reused();
+    }
+
+    return Server::DumpCounters() + "\nawait_threads " + std::to_string(_workers.size()) + "\nawait_frames " +
+           std::to_string(frames) + "\nawait_frame_bytes " + std::to_string(bytes) + "\nawait_frames_reused " +
+           std::to_string(reused);
+}
+
+// See ServerImpl.h
+void ServerImpl::Run(Worker &worker, std::size_t index) {
+    _logger->info("Start worker {}", index);
+    if (!Concurrency::PinCurrentThread(_placement.Worker(index))) {
+        _logger->warn("Failed to pin worker {}", index);
+    }
+
+    FramePool::Scope scope(worker.frames);
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd == -1) {
+        _logger->error("Worker {} failed: failed to create timerfd: {}", index, strerror(errno));
+        return;
+    }
+
+    try {
+        Descriptor listener(worker.loop, _server_socket, true);
+        Descriptor timer(worker.loop, timer_fd);
+        Accept(listener, timer, _logger, pStorage, &_counters);
+        worker.loop.Run();
+        if (!worker.loop.Stopped()) {
+            // Nothing is accepted by this thread anymore, though listener still wakes it up
+            _logger->error("Worker {} loop ended before server stop", index);
+        }
+    } catch (std::runtime_error &ex) {
+        _logger->error("Worker {} failed: {}", index, ex.what());
+    }
+    close(timer_fd);
+    _logger->info("Stop worker {}", index);
+}
+
+} // namespace MTawait
+} // namespace Network
+} // namespace Afina
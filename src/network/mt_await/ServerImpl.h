@@ -0,0 +1,64 @@
+#ifndef AFINA_NETWORK_MT_AWAIT_SERVER_H
+#define AFINA_NETWORK_MT_AWAIT_SERVER_H
+
+#include <memory>
+#include <vector>
+
+#include <afina/network/Server.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+namespace Network {
+namespace MTawait {
+
+/**
+ * # Network resource manager implementation
+ * Connection per C++20 stackless coroutine. Every worker thread runs its own epoll loop and accepts from
+ * the shared server socket, registered with EPOLLEXCLUSIVE so a new connection wakes up one worker.
+ * Connection stays on the worker that accepted it, its coroutine frame comes from the frame pool of the
+ * worker. There are no separate acceptor threads, acceptors argument of Start is ignored.
+ *
+ * Built only if compiler supports C++20 coroutines, see AFINA_HAVE_COROUTINES. Header itself is C++11
+ */
+class ServerImpl : public Server {
+public:
+    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl);
+    ~ServerImpl();
+
+    // See Server.h
+    void Start(uint16_t port, uint32_t acceptors, uint32_t workers) override;
+
+    // See Server.h
+    void Stop() override;
+
+    // See Server.h
+    void Join() override;
+
+    // See Server.h
+    std::string DumpCounters() const override;
+
+private:
+    struct Worker;
+
+    /**
+     * Worker thread body: starts accepting coroutine and runs the loop until it is stopped
+     */
+    void Run(Worker &worker, std::size_t index);
+
+    // logger to use
+    std::shared_ptr<spdlog::logger> _logger;
+
+    // Socket to accept new connection on, shared between workers
+    int _server_socket;
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+};
+
+} // namespace MTawait
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_MT_AWAIT_SERVER_H
@@ -0,0 +1,43 @@
+#ifndef AFINA_NETWORK_MT_AWAIT_TASK_H
+#define AFINA_NETWORK_MT_AWAIT_TASK_H
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+
+#include "FramePool.h"
+
+namespace Afina {
+namespace Network {
+namespace MTawait {
+
+/**
+ * # Detached stackless coroutine
+ * Return type of a coroutine that starts right away and frees its frame once done, nobody waits for its
+ * result. Frame comes from FramePool of the thread that calls the coroutine, so task must finish on the
+ * same thread. Exception escaping the coroutine terminates the program, body catches what it expects
+ */
+class Task {
+public:
+    struct promise_type {
+        Task get_return_object() noexcept { return Task(); }
+
+        std::suspend_never initial_suspend() noexcept { return {}; }
+
+        std::suspend_never final_suspend() noexcept { return {}; }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() noexcept { std::terminate(); }
+
+        static void *operator new(std::size_t size) { return FramePool::Allocate(size); }
+
+        static void operator delete(void *frame, std::size_t size) { FramePool::Release(frame, size); }
+    };
+};
+
+} // namespace MTawait
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_MT_AWAIT_TASK_H
@@ -31,7 +31,8 @@ namespace Network {
 namespace MTblocking {
 
 // See Server.h
-ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl) : Server(ps, pl) {}
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl)
+    : Server(ps, pl), _executor(nullptr) {}
 
 // See Server.h
 ServerImpl::~ServerImpl() = default;
@@ -78,9 +79,17 @@ void ServerImpl::Start(uint16_t port, uint32_t n_accept, uint32_t n_workers) {
         throw std::runtime_error("Socket listen() failed");
     }
 
+    // Acceptor hands connections to the pool, so pool must be there first
+    // Pool threads own connections, so they float over worker cores while acceptor takes a sibling
+    std::vector<unsigned> cpus;
+    for (uint32_t i = 0; i < n_workers; i++) {
+        auto worker = _placement.Worker(i);
+        cpus.insert(cpus.end(), worker.begin(), worker.end());
+    }
+    _executor = new Afina::Concurrency::Executor(_max_workers, _max_workers + 1, 5, std::chrono::minutes(2),
+                                                 {{8, 4, 1}}, cpus);
     running.store(true);
     _thread = std::thread(&ServerImpl::OnRun, this);
-    _executor = new Afina::Concurrency::Executor(_max_workers, _max_workers + 1, 5, std::chrono::minutes(2));
 }
 
 // See Server.h
@@ -96,11 +105,25 @@ void ServerImpl::Join() {
     _thread.join();
     _executor->Stop(true);
     delete _executor;
+    _executor = nullptr;
     close(_server_socket);
 }
 
+// See Server.h
+std::string ServerImpl::DumpCounters() const {
+    std::string result = Server::DumpCounters();
+    if (_executor != nullptr) {
+        result += "\n" + _executor->DumpStats("worker_");
+    }
+    return result;
+}
+
 // See Server.h
 void ServerImpl::OnRun() {
+    if (!Concurrency::PinCurrentThread(_placement.Helpers(_max_workers))) {
+        _logger->warn("Failed to pin acceptor");
+    }
+
     // Here is connection state
     // - parser: parse state of the stream
     // - command_to_execute: last command parsed out of stream
@@ -121,6 +144,7 @@ void ServerImpl::OnRun() {
         if ((client_socket = accept(_server_socket, &client_addr, &client_addr_len)) == -1) {
             continue;
         }
+        _counters.connections.Add();
 
         // Got new connection
         if (_logger->should_log(spdlog::level::debug)) {
@@ -217,6 +241,7 @@ void ServerImpl::RunWorker(int client_socket) {
 
                     std::string result;
                     command_to_execute->Execute(*pStorage, argument_for_command, result);
+                    _counters.requests.Add();
 
                     // Send response
                     result += "\r\n";
@@ -238,6 +263,7 @@ void ServerImpl::RunWorker(int client_socket) {
             throw std::runtime_error(std::string(strerror(errno)));
         }
     } catch (std::runtime_error &ex) {
+        _counters.errors.Add();
         _logger->error("Failed to process connection on descriptor {}: {}", client_socket, ex.what());
     }
 
@@ -36,6 +36,9 @@ public:
     // See Server.h
     void Join() override;
 
+    // See Server.h, adds load of the worker pool
+    std::string DumpCounters() const override;
+
 protected:
     /**
      * Method is running in the connection acceptor thread
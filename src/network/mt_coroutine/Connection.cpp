@@ -0,0 +1,120 @@
+#include "Connection.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <unistd.h>
+
+namespace Afina {
+namespace Network {
+namespace MTcoroutine {
+
+// See Connection.h
+Connection::~Connection() { close(_socket); }
+
+// See Connection.h
+void Connection::Serve(Connection *connection, Coroutine::Scheduler *scheduler) {
+    connection->Run(*scheduler);
+    delete connection;
+}
+
+// See Connection.h
+void Connection::Run(const Coroutine::Scheduler &scheduler) {
+    _logger->debug("Start on descriptor {}", _socket);
+    try {
+        // Stop lets connection finish commands it has read already, but not read new ones
+        while (!scheduler.Stopped()) {
+            if (_read_bytes == sizeof(client_buffer)) {
+                throw std::runtime_error("Command doesn't fit into the buffer");
+            }
+
+            ssize_t new_bytes =
+                Coroutine::Reactor::Read(_socket, client_buffer + _read_bytes, sizeof(client_buffer) - _read_bytes);
+            if (new_bytes == 0) {
+                _logger->debug("Connection closed on descriptor {}", _socket);
+                break;
+            } else if (new_bytes < 0) {
+                if (errno != ECANCELED) {
+                    throw std::runtime_error(std::string(strerror(errno)));
+                }
+                break;
+            }
+
+            _logger->debug("Got {} bytes from socket", new_bytes);
+            _read_bytes += new_bytes;
+            Process();
+
+            if (!_output.empty()) {
+                if (Coroutine::Reactor::Write(_socket, _output.data(), _output.size()) < 0) {
+                    if (errno != ECANCELED) {
+                        throw std::runtime_error(std::string(strerror(errno)));
+                    }
+                    break;
+                }
+                _output.clear();
+            }
+        }
+    } catch (std::runtime_error &ex) {
+        pCounters->errors.Add();
+        _logger->error("Failed to process connection on descriptor {}: {}", _socket, ex.what());
+    }
+}
+
+// See Connection.h
+void Connection::Process() {
+    // Single block of data readed from the socket could trigger inside actions a multiple times,
+    // for example:
+    // - read#0: [<command1 start>]
+    // - read#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
+    while (_read_bytes > 0) {
+        // There is no command yet
+        if (!command_to_execute) {
+            std::size_t parsed = 0;
+            if (parser.Parse(client_buffer, _read_bytes, parsed)) {
+                _logger->debug("Found new command: {} in {} bytes", parser.Name(), parsed);
+                command_to_execute = parser.Build(arg_remains);
+                if (arg_remains > 0) {
+                    arg_remains += 2;
+                }
+            }
+
+            // Parser might fail to consume any bytes, the rest of the command is still on the way
+            if (parsed == 0) {
+                break;
+            }
+            std::memmove(client_buffer, client_buffer + parsed, _read_bytes - parsed);
+            _read_bytes -= parsed;
+        }
+
+        // There is command, but we still wait for argument to arrive...
+        if (command_to_execute && arg_remains > 0) {
+            std::size_t to_read = std::min(arg_remains, _read_bytes);
+            argument_for_command.append(client_buffer, to_read);
+
+            std::memmove(client_buffer, client_buffer + to_read, _read_bytes - to_read);
+            arg_remains -= to_read;
+            _read_bytes -= to_read;
+        }
+
+        // There is command & argument - RUN!
+        if (command_to_execute && arg_remains == 0) {
+            std::string result;
+            command_to_execute->Execute(*pStorage, argument_for_command, result);
+            pCounters->requests.Add();
+
+            _output += result;
+            _output += "\r\n";
+
+            // Prepare for the next command
+            command_to_execute.reset();
+            argument_for_command.resize(0);
+            parser.Reset();
+        }
+    }
+}
+
+} // namespace MTcoroutine
+} // namespace Network
+} // namespace Afina
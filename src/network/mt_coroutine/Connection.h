@@ -0,0 +1,79 @@
+#ifndef AFINA_NETWORK_MT_COROUTINE_CONNECTION_H
+#define AFINA_NETWORK_MT_COROUTINE_CONNECTION_H
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include <afina/Storage.h>
+#include <afina/coroutine/Reactor.h>
+#include <afina/coroutine/Scheduler.h>
+#include <afina/execute/Command.h>
+#include <afina/network/Server.h>
+#include <spdlog/logger.h>
+
+#include "protocol/Parser.h"
+
+namespace Afina {
+namespace Network {
+namespace MTcoroutine {
+
+/**
+ * # Client connection served by a coroutine
+ * Reads, executes and replies in a plain loop, Coroutine::Reactor turns every read or write that would
+ * block into a switch to another connection. Coroutine may continue on another worker after any of them,
+ * so connection keeps no per-thread state. Replies to all commands that came in one read go out in one
+ * write
+ */
+class Connection {
+public:
+    Connection(int s, std::shared_ptr<spdlog::logger> pl, std::shared_ptr<Afina::Storage> ps, Counters *pc)
+        : _socket(s), _logger(pl), pStorage(ps), pCounters(pc), arg_remains(0), _read_bytes(0) {}
+
+    // Closes the socket
+    ~Connection();
+
+    /**
+     * Coroutine body: serves the client until it disconnects or scheduler stops, then deletes connection
+     */
+    static void Serve(Connection *connection, Coroutine::Scheduler *scheduler);
+
+protected:
+    void Run(const Coroutine::Scheduler &scheduler);
+
+    /**
+     * Parses and executes every complete command in the buffer, replies are appended to output
+     */
+    void Process();
+
+private:
+    int _socket;
+
+    std::shared_ptr<spdlog::logger> _logger;
+    std::shared_ptr<Afina::Storage> pStorage;
+
+    // Owned by the server, which outlives all its connections
+    Counters *pCounters;
+
+    // Here is connection state
+    // - parser: parse state of the stream
+    // - command_to_execute: last command parsed out of stream
+    // - arg_remains: how many bytes to read from stream to get command argument
+    // - argument_for_command: buffer stores argument
+    std::size_t arg_remains;
+    Protocol::Parser parser;
+    std::string argument_for_command;
+    std::unique_ptr<Execute::Command> command_to_execute;
+
+    char client_buffer[4096];
+    std::size_t _read_bytes;
+
+    // Replies not sent yet
+    std::string _output;
+};
+
+} // namespace MTcoroutine
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_MT_COROUTINE_CONNECTION_H
@@ -0,0 +1,171 @@
+#include "ServerImpl.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+#include <afina/concurrency/Topology.h>
+#include <afina/coroutine/Reactor.h>
+#include <afina/logging/Service.h>
+
+#include "Connection.h"
+
+namespace Afina {
+namespace Network {
+namespace MTcoroutine {
+
+// See Server.h
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl)
+    : Server(ps, pl), _server_socket(-1) {}
+
+// See Server.h
+ServerImpl::~ServerImpl() {}
+
+// See Server.h
+void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers) {
+    _logger = pLogging->select("network");
+    _logger->info("Start network service");
+
+    sigset_t sig_mask;
+    sigemptyset(&sig_mask);
+    sigaddset(&sig_mask, SIGPIPE);
+    if (pthread_sigmask(SIG_BLOCK, &sig_mask, NULL) != 0) {
+        throw std::runtime_error("Unable to mask SIGPIPE");
+    }
+
+    // Create server socket
+    struct sockaddr_in server_addr;
+    std::memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;         // IPv4
+    server_addr.sin_port = htons(port);       // TCP port number
+    server_addr.sin_addr.s_addr = INADDR_ANY; // Bind to any address
+
+    // Accepting coroutines wait in epoll, so the socket never blocks
+    _server_socket = socket(PF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+    if (_server_socket == -1) {
+        throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
+    }
+
+    int opts = 1;
+    if (setsockopt(_server_socket, SOL_SOCKET, (SO_KEEPALIVE), &opts, sizeof(opts)) == -1) {
+        close(_server_socket);
+        throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
+    }
+
+    if (bind(_server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
+        close(_server_socket);
+        throw std::runtime_error("Socket bind() failed: " + std::string(strerror(errno)));
+    }
+
+    if (listen(_server_socket, SOMAXCONN) == -1) {
+        close(_server_socket);
+        throw std::runtime_error("Socket listen() failed: " + std::string(strerror(errno)));
+    }
+
+    _scheduler.reset(new Coroutine::Scheduler(n_workers));
+    _scheduler->Start([this](std::size_t worker) {
+        _logger->info("Start worker {}", worker);
+        if (!Concurrency::PinCurrentThread(_placement.Worker(worker))) {
+            _logger->warn("Failed to pin worker {}", worker);
+        }
+    });
+
+    // Spawned from outside they go to workers round robin, but may run anywhere later on
+    for (uint32_t i = 0; i < _scheduler->Threads(); i++) {
+        if (!_scheduler->Spawn(&ServerImpl::OnAccept, this)) {
+            throw std::runtime_error("Failed to start accepting coroutine");
+        }
+    }
+}
+
+// See Server.h
+void ServerImpl::Stop() {
+    _logger->warn("Stop network service");
+    _scheduler->Stop();
+
+    // Socket is still in use by accepting coroutines, it is closed once they are done
+    shutdown(_server_socket, SHUT_RDWR);
+}
+
+// See Server.h
+void ServerImpl::Join() {
+    if (_scheduler) {
+        _scheduler->Join();
+        _scheduler.reset();
+    }
+
+    if (_server_socket != -1) {
+        close(_server_socket);
+        _server_socket = -1;
+    }
+}
+
+// See Server.h
+std::string ServerImpl::DumpCounters() const {
+    std::string result = Server::DumpCounters();
+    if (_scheduler) {
+        result += "\n" + _scheduler->Dump("coroutine_");
+    }
+    return result;
+}
+
+// Pause before accept is tried again after it failed
+static const std::chrono::milliseconds kAcceptRetry(100);
+
+// See ServerImpl.h
+void ServerImpl::OnAccept(ServerImpl *server) {
+    for (;;) {
+        struct sockaddr in_addr;
+        socklen_t in_len = sizeof in_addr;
+        int infd = Coroutine::Reactor::Accept(server->_server_socket, &in_addr, &in_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (infd == -1) {
+            if (errno == ECONNABORTED || errno == EPROTO) {
+                // Client gave up before accept, next one may be fine
+                continue;
+            } else if (errno == ECANCELED || server->_scheduler->Stopped()) {
+                break;
+            }
+
+            // Out of descriptors or memory passes once connections close, until then accept would fail
+            // right away, so the coroutine sleeps instead of spinning
+            server->_counters.errors.Add();
+            server->_logger->error("Failed to accept socket, retry in {} ms: {}", kAcceptRetry.count(),
+                                   strerror(errno));
+            if (!Coroutine::Reactor::SleepFor(kAcceptRetry)) {
+                break;
+            }
+            continue;
+        }
+
+        // Print host and service info.
+        char hbuf[NI_MAXHOST], sbuf[NI_MAXSERV];
+        int retval =
+            getnameinfo(&in_addr, in_len, hbuf, sizeof hbuf, sbuf, sizeof sbuf, NI_NUMERICHOST | NI_NUMERICSERV);
+        if (retval == 0) {
+            server->_logger->info("Accepted connection on descriptor {} (host={}, port={})", infd, hbuf, sbuf);
+        }
+
+        server->_counters.connections.Add();
+        Connection *pc = new Connection(infd, server->_logger, server->pStorage, &server->_counters);
+        if (!server->_scheduler->Spawn(&Connection::Serve, pc, server->_scheduler.get())) {
+            server->_counters.errors.Add();
+            server->_logger->error("No memory for connection coroutine on descriptor {}", infd);
+            delete pc;
+        }
+    }
+}
+
+} // namespace MTcoroutine
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,62 @@
+#ifndef AFINA_NETWORK_MT_COROUTINE_SERVER_H
+#define AFINA_NETWORK_MT_COROUTINE_SERVER_H
+
+#include <memory>
+
+#include <afina/coroutine/Scheduler.h>
+#include <afina/network/Server.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+namespace Network {
+namespace MTcoroutine {
+
+/**
+ * # Network resource manager implementation
+ * Connection per coroutine on Coroutine::Scheduler with a thread per worker. One coroutine per worker
+ * accepts connections from the shared server socket and spawns a coroutine for each, idle workers steal
+ * ready connections from busy ones, so load spreads over all workers however unevenly clients behave.
+ * There are no separate acceptor threads, acceptors argument of Start is ignored
+ */
+class ServerImpl : public Server {
+public:
+    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl);
+    ~ServerImpl();
+
+    // See Server.h
+    void Start(uint16_t port, uint32_t acceptors, uint32_t workers) override;
+
+    // See Server.h
+    void Stop() override;
+
+    // See Server.h
+    void Join() override;
+
+    // See Server.h
+    std::string DumpCounters() const override;
+
+protected:
+    /**
+     * Coroutine body: accepts connections and starts a coroutine for each until scheduler stops
+     */
+    static void OnAccept(ServerImpl *server);
+
+private:
+    // logger to use
+    std::shared_ptr<spdlog::logger> _logger;
+
+    // Socket to accept new connection on, shared between workers
+    int _server_socket;
+
+    // Runs connections and acceptors
+    std::unique_ptr<Coroutine::Scheduler> _scheduler;
+};
+
+} // namespace MTcoroutine
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_MT_COROUTINE_SERVER_H
@@ -1,5 +1,6 @@
 #include "Connection.h"
 
+#include <cerrno>
 #include <cstring>
 #include <iostream>
 #include <memory>
@@ -106,6 +107,7 @@ void Connection::DoRead() {
 
                     std::string result;
                     command_to_execute->Execute(*pStorage, argument_for_command, result);
+                    pCounters->requests.Add();
 
                     // Send response
                     result += "\r\n";
@@ -124,6 +126,7 @@ void Connection::DoRead() {
             throw std::runtime_error(std::string(strerror(errno)));
         }
     } catch (std::runtime_error &ex) {
+        pCounters->errors.Add();
         _logger->error("Failed to process connection on descriptor {}: {}", client_socket, ex.what());
     }
 }
@@ -133,6 +136,11 @@ void Connection::DoWrite() {
     std::unique_lock<std::mutex> lock(_lock);
     _logger->debug("DoWrite on descriptor {}", _socket);
 
+    // Error and hang up events get here whether there is something to send or not
+    if (_buffers_for_write.empty()) {
+        return;
+    }
+
     auto buffers_size = _buffers_for_write.size();
     auto buffers_it = _buffers_for_write.begin();
     struct iovec buffers_iov[buffers_size];
@@ -145,14 +153,19 @@ void Connection::DoWrite() {
     buffers_iov[0].iov_len -= _written_bytes;
 
     int written = writev(_socket, buffers_iov, buffers_size);
+    if (written < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            pCounters->errors.Add();
+            _is_alive = false;
+        }
+        return;
+    }
     _written_bytes += written;
 
+    // Drop buffers sent completely, _written_bytes stays offset into the first remaining one
     auto del_it = _buffers_for_write.begin();
-    for (int del_it_ind = 0; _written_bytes > buffers_iov[del_it_ind].iov_len; ++del_it_ind) {
-        if (buffers_size > del_it_ind) {
-            break;
-        }
-        _written_bytes -= buffers_iov[del_it_ind].iov_len;
+    while (del_it != _buffers_for_write.end() && std::size_t(_written_bytes) >= del_it->size()) {
+        _written_bytes -= del_it->size();
         ++del_it;
     }
 
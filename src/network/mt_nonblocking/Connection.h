@@ -4,6 +4,7 @@
 #include "protocol/Parser.h"
 #include <afina/Storage.h>
 #include <afina/execute/Command.h>
+#include <afina/network/Server.h>
 #include <cstring>
 #include <list>
 #include <spdlog/logger.h>
@@ -15,8 +16,8 @@ namespace MTnonblock {
 
 class Connection {
 public:
-    Connection(int s, std::shared_ptr<spdlog::logger> pl, std::shared_ptr<Afina::Storage> ps)
-        : _socket(s), _logger(pl), pStorage(ps) {
+    Connection(int s, std::shared_ptr<spdlog::logger> pl, std::shared_ptr<Afina::Storage> ps, Counters *pc)
+        : _socket(s), _logger(pl), pStorage(ps), pCounters(pc) {
         std::memset(&_event, 0, sizeof(struct epoll_event));
         _event.data.ptr = this;
     }
@@ -44,6 +45,9 @@ private:
     std::shared_ptr<spdlog::logger> _logger;
     std::shared_ptr<Afina::Storage> pStorage;
 
+    // Owned by the server, which outlives all its connections
+    Counters *pCounters;
+
     // Here is connection state
     // - parser: parse state of the stream
     // - command_to_execute: last command parsed out of stream
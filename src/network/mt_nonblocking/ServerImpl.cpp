@@ -97,7 +97,7 @@ void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers)
     _workers.reserve(n_workers);
     for (int i = 0; i < n_workers; i++) {
         _workers.emplace_back(pStorage, pLogging);
-        _workers.back().Start(_data_epoll_fd);
+        _workers.back().Start(_data_epoll_fd, _placement.Worker(i));
     }
 
     // Start acceptors
@@ -137,6 +137,10 @@ void ServerImpl::Join() {
 // See ServerImpl.h
 void ServerImpl::OnRun() {
     _logger->info("Start acceptor");
+    if (!Concurrency::PinCurrentThread(_placement.Helpers(_workers.size()))) {
+        _logger->warn("Failed to pin acceptor");
+    }
+
     int acceptor_epoll = epoll_create1(0);
     if (acceptor_epoll == -1) {
         throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
@@ -195,7 +199,8 @@ void ServerImpl::OnRun() {
                 }
 
                 // Register the new FD to be monitored by epoll.
-                Connection *pc = new Connection(infd, _logger, pStorage);
+                _counters.connections.Add();
+                Connection *pc = new Connection(infd, _logger, pStorage, &_counters);
                 ;
                 if (pc == nullptr) {
                     throw std::runtime_error("Failed to allocate connection");
@@ -11,6 +11,8 @@
 
 #include <spdlog/logger.h>
 
+#include <afina/concurrency/Epoch.h>
+#include <afina/concurrency/Topology.h>
 #include <afina/logging/Service.h>
 
 #include "Connection.h"
@@ -41,16 +43,18 @@ Worker &Worker::operator=(Worker &&other) {
     _logger = std::move(other._logger);
     _thread = std::move(other._thread);
     _epoll_fd = other._epoll_fd;
+    _cpus = std::move(other._cpus);
 
     other._epoll_fd = -1;
     return *this;
 }
 
 // See Worker.h
-void Worker::Start(int epoll_fd) {
+void Worker::Start(int epoll_fd, const std::vector<unsigned> &cpus) {
     if (isRunning.exchange(true) == false) {
         assert(_epoll_fd == -1);
         _epoll_fd = epoll_fd;
+        _cpus = cpus;
         _logger = _pLogging->select("network.worker");
         _thread = std::thread(&Worker::OnRun, this);
     }
@@ -70,6 +74,12 @@ void Worker::OnRun() {
     assert(_epoll_fd >= 0);
     _logger->trace("OnRun");
 
+    // Pin before anything is allocated, so that the kernel places memory this thread touches
+    // first on the local node
+    if (!Concurrency::PinCurrentThread(_cpus)) {
+        _logger->warn("Failed to pin worker to {} cpus", _cpus.size());
+    }
+
     // Process connection events
     //
     // Do not forget to use EPOLLEXCLUSIVE flag when register socket
@@ -135,6 +145,10 @@ void Worker::OnRun() {
             }
         }
         // TODO: Select timeout...
+
+        // Commands of the batch are done, so this thread reads no storage entries now: entries
+        // replaced in the cuckoo could be freed without waiting for our next command
+        Concurrency::EpochDomain::Global().Quiescent();
     }
     _logger->warn("Worker stopped");
 }
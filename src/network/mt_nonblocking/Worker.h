@@ -4,6 +4,7 @@
 #include <atomic>
 #include <memory>
 #include <thread>
+#include <vector>
 
 namespace spdlog {
 class logger;
@@ -36,9 +37,9 @@ public:
     /**
      * Spaws new background thread that is doing epoll on the given server
      * socket. Once connection accepted it must be registered and being processed
-     * on this thread
+     * on this thread. Thread is restricted to cpus unless it is empty
      */
-    void Start(int epoll_fd);
+    void Start(int epoll_fd, const std::vector<unsigned> &cpus = {});
 
     /**
      * Signal background thread to stop. After that signal thread must stop to
@@ -81,6 +82,9 @@ private:
 
     // EPOLL descriptor using for events processing
     int _epoll_fd;
+
+    // CPUs thread is pinned to
+    std::vector<unsigned> _cpus;
 };
 
 } // namespace MTnonblock
@@ -0,0 +1,74 @@
+#include "ServerImpl.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include <signal.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+#include <afina/logging/Service.h>
+
+#include "Worker.h"
+
+namespace Afina {
+namespace Network {
+namespace MTreuseport {
+
+// See Server.h
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl) : Server(ps, pl) {}
+
+// See Server.h
+ServerImpl::~ServerImpl() {}
+
+// See Server.h
+void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers) {
+    _logger = pLogging->select("network");
+    _logger->info("Start network service");
+
+    sigset_t sig_mask;
+    sigemptyset(&sig_mask);
+    sigaddset(&sig_mask, SIGPIPE);
+    if (pthread_sigmask(SIG_BLOCK, &sig_mask, NULL) != 0) {
+        throw std::runtime_error("Unable to mask SIGPIPE");
+    }
+
+    // Listener of a worker is bound as soon as it starts, so the group only grows and the first
+    // connections go to whoever is there already
+    n_workers = std::max<uint32_t>(1, n_workers);
+    _workers.reserve(n_workers);
+    for (uint32_t i = 0; i < n_workers; i++) {
+        _workers.emplace_back(new Worker(pStorage, pLogging->select("network.worker"), &_counters));
+        _workers.back()->Start(port, _placement.Worker(i));
+    }
+}
+
+// See Server.h
+void ServerImpl::Stop() {
+    _logger->warn("Stop network service");
+    for (auto &worker : _workers) {
+        worker->Stop();
+    }
+}
+
+// See Server.h
+void ServerImpl::Join() {
+    for (auto &worker : _workers) {
+        worker->Join();
+    }
+}
+
+// See Server.h
+std::string ServerImpl::DumpCounters() const {
+    std::string result = Server::DumpCounters();
+    for (std::size_t i = 0; i < _workers.size(); i++) {
+        result += "\nworker" + std::to_string(i) + "_connections " + std::to_string(_workers[i]->Accepted());
+    }
+    return result;
+}
+
+} // namespace MTreuseport
+} // namespace Network
+} // namespace Afina
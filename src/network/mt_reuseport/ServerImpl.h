@@ -0,0 +1,54 @@
+#ifndef AFINA_NETWORK_MT_REUSEPORT_SERVER_H
+#define AFINA_NETWORK_MT_REUSEPORT_SERVER_H
+
+#include <memory>
+#include <vector>
+
+#include <afina/network/Server.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+namespace Network {
+namespace MTreuseport {
+
+// Forward declaration, see Worker.h
+class Worker;
+
+/**
+ * # Network resource manager implementation
+ * Shared nothing epoll server: every worker has its own SO_REUSEPORT listener on the port and its own
+ * epoll, connection lives on the worker whose listener the kernel gave it to, see Worker. Workers accept
+ * themselves, acceptors argument of Start is ignored
+ */
+class ServerImpl : public Server {
+public:
+    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl);
+    ~ServerImpl();
+
+    // See Server.h
+    void Start(uint16_t port, uint32_t acceptors, uint32_t workers) override;
+
+    // See Server.h
+    void Stop() override;
+
+    // See Server.h
+    void Join() override;
+
+    // See Server.h
+    std::string DumpCounters() const override;
+
+private:
+    // logger to use
+    std::shared_ptr<spdlog::logger> _logger;
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+};
+
+} // namespace MTreuseport
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_MT_REUSEPORT_SERVER_H
@@ -0,0 +1,123 @@
+#include "Worker.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <netinet/in.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+#include <afina/concurrency/Topology.h>
+
+#include "network/st_nonblocking/Loop.h"
+
+namespace Afina {
+namespace Network {
+namespace MTreuseport {
+
+// See Worker.h
+Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl, Counters *pc)
+    : _pStorage(ps), _logger(pl), _pCounters(pc), _server_socket(-1), _event_fd(-1) {}
+
+// See Worker.h
+Worker::~Worker() {
+    if (_thread.joinable()) {
+        Stop();
+        Join();
+    }
+}
+
+// See Worker.h
+void Worker::Start(uint16_t port, const std::vector<unsigned> &cpus) {
+    struct sockaddr_in server_addr;
+    std::memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;         // IPv4
+    server_addr.sin_port = htons(port);       // TCP port number
+    server_addr.sin_addr.s_addr = INADDR_ANY; // Bind to any address
+
+    _server_socket = socket(PF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+    if (_server_socket == -1) {
+        throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
+    }
+
+    // Every worker binds the same port, all sockets of the group must have SO_REUSEPORT
+    int opts = 1;
+    if (setsockopt(_server_socket, SOL_SOCKET, SO_KEEPALIVE, &opts, sizeof(opts)) == -1 ||
+        setsockopt(_server_socket, SOL_SOCKET, SO_REUSEPORT, &opts, sizeof(opts)) == -1) {
+        close(_server_socket);
+        throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
+    }
+
+    if (bind(_server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
+        close(_server_socket);
+        throw std::runtime_error("Socket bind() failed: " + std::string(strerror(errno)));
+    }
+
+    if (listen(_server_socket, SOMAXCONN) == -1) {
+        close(_server_socket);
+        throw std::runtime_error("Socket listen() failed: " + std::string(strerror(errno)));
+    }
+
+    _event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_event_fd == -1) {
+        close(_server_socket);
+        throw std::runtime_error("Failed to create eventfd: " + std::string(strerror(errno)));
+    }
+
+    try {
+        _loop.reset(new STnonblock::Loop(_server_socket, _event_fd, _pStorage, _logger, _pCounters));
+    } catch (std::runtime_error &) {
+        close(_event_fd);
+        close(_server_socket);
+        throw;
+    }
+
+    _cpus = cpus;
+    _thread = std::thread(&Worker::OnRun, this);
+}
+
+// See Worker.h
+void Worker::Stop() {
+    if (eventfd_write(_event_fd, 1)) {
+        throw std::runtime_error("Failed to wakeup worker");
+    }
+}
+
+// See Worker.h
+void Worker::Join() {
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+// See Worker.h
+void Worker::OnRun() {
+    _logger->info("Start worker");
+
+    // Pin before anything is allocated, so that the kernel places memory this thread touches
+    // first on the local node
+    if (!Concurrency::PinCurrentThread(_cpus)) {
+        _logger->warn("Failed to pin worker to {} cpus", _cpus.size());
+    }
+
+    _loop->Run();
+
+    // Connections still in the accept queue of the listener are reset by the kernel
+    close(_server_socket);
+    close(_event_fd);
+    _logger->warn("Worker stopped");
+}
+
+// See Worker.h
+uint64_t Worker::Accepted() const { return _loop ? _loop->Accepted() : 0; }
+
+} // namespace MTreuseport
+} // namespace Network
+} // namespace Afina
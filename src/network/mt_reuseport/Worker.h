@@ -0,0 +1,93 @@
+#ifndef AFINA_NETWORK_MT_REUSEPORT_WORKER_H
+#define AFINA_NETWORK_MT_REUSEPORT_WORKER_H
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <afina/network/Server.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+
+// Forward declaration, see afina/Storage.h
+class Storage;
+
+namespace Network {
+namespace STnonblock {
+class Loop;
+}
+
+namespace MTreuseport {
+
+/**
+ * # Thread with its own listener and epoll
+ * Owns a SO_REUSEPORT socket bound to the server port, kernel spreads new connections between the
+ * sockets of the group by the hash of the client address. Accepted connection is served by this thread
+ * only, so nothing about it is shared with other threads: there is no lock in the connection and no
+ * EPOLLONESHOT rearm after every event. Thread runs the loop of the single threaded server, see
+ * STnonblock::Loop
+ */
+class Worker {
+public:
+    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl, Counters *pc);
+    ~Worker();
+
+    /**
+     * Creates listener and epoll, throws std::runtime_error if any of them fails, then starts the thread.
+     * Thread is restricted to cpus unless it is empty
+     */
+    void Start(uint16_t port, const std::vector<unsigned> &cpus = {});
+
+    /**
+     * Signals thread to stop: it closes its listener and connections and exits. Safe to call from any
+     * thread
+     */
+    void Stop();
+
+    /**
+     * Waits until the thread is done
+     */
+    void Join();
+
+    // Connections accepted so far
+    uint64_t Accepted() const;
+
+protected:
+    /**
+     * Method executing by background thread
+     */
+    void OnRun();
+
+private:
+    Worker(const Worker &) = delete;
+    Worker &operator=(const Worker &) = delete;
+
+    std::shared_ptr<Afina::Storage> _pStorage;
+    std::shared_ptr<spdlog::logger> _logger;
+
+    // Owned by the server, which outlives its workers
+    Counters *_pCounters;
+
+    // Listener of this worker only
+    int _server_socket;
+
+    // Wakes the thread up on stop
+    int _event_fd;
+
+    std::thread _thread;
+    std::vector<unsigned> _cpus;
+
+    // Private epoll instance, connections belong to it
+    std::unique_ptr<STnonblock::Loop> _loop;
+};
+
+} // namespace MTreuseport
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_MT_REUSEPORT_WORKER_H
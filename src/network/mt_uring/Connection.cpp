@@ -0,0 +1,84 @@
+#include "Connection.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Afina {
+namespace Network {
+namespace MTuring {
+
+// Same limit as the read buffer of the other servers
+static const std::size_t kMaxPending = 4096;
+
+// See Connection.h
+void Connection::Consume(const char *data, std::size_t size) {
+    if (_input.empty()) {
+        std::size_t used = Process(data, size);
+        _input.assign(data + used, size - used);
+    } else {
+        _input.append(data, size);
+        std::size_t used = Process(_input.data(), _input.size());
+        _input.erase(0, used);
+    }
+
+    if (_input.size() > kMaxPending) {
+        throw std::runtime_error("Command doesn't fit into the buffer");
+    }
+}
+
+// See Connection.h
+std::size_t Connection::Process(const char *data, std::size_t size) {
+    std::size_t used = 0;
+
+    // Single block of data readed from the socket could trigger inside actions a multiple times,
+    // for example:
+    // - read#0: [<command1 start>]
+    // - read#1: [<command1 end> <argument> <command2> <argument for command 2> <command3> ... ]
+    while (used < size) {
+        // There is no command yet
+        if (!command_to_execute) {
+            std::size_t parsed = 0;
+            if (parser.Parse(data + used, size - used, parsed)) {
+                _logger->debug("Found new command: {} in {} bytes", parser.Name(), parsed);
+                command_to_execute = parser.Build(arg_remains);
+                if (arg_remains > 0) {
+                    arg_remains += 2;
+                }
+            }
+
+            // Parser might fail to consume any bytes, the rest of the command is still on the way
+            if (parsed == 0) {
+                break;
+            }
+            used += parsed;
+        }
+
+        // There is command, but we still wait for argument to arrive...
+        if (command_to_execute && arg_remains > 0) {
+            std::size_t to_read = std::min(arg_remains, size - used);
+            argument_for_command.append(data + used, to_read);
+            arg_remains -= to_read;
+            used += to_read;
+        }
+
+        // There is command & argument - RUN!
+        if (command_to_execute && arg_remains == 0) {
+            std::string result;
+            command_to_execute->Execute(*pStorage, argument_for_command, result);
+            pCounters->requests.Add();
+
+            _output += result;
+            _output += "\r\n";
+
+            // Prepare for the next command
+            command_to_execute.reset();
+            argument_for_command.resize(0);
+            parser.Reset();
+        }
+    }
+    return used;
+}
+
+} // namespace MTuring
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,85 @@
+#ifndef AFINA_NETWORK_MT_URING_CONNECTION_H
+#define AFINA_NETWORK_MT_URING_CONNECTION_H
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include <afina/Storage.h>
+#include <afina/execute/Command.h>
+#include <afina/network/Server.h>
+#include <spdlog/logger.h>
+
+#include "protocol/Parser.h"
+
+namespace Afina {
+namespace Network {
+namespace MTuring {
+
+/**
+ * # Client connection served by io_uring
+ * Holds no read buffer: data comes in buffers the kernel picks from the ring of the worker and is parsed
+ * right there, only the beginning of a command cut by the end of a buffer is copied. Which operations are
+ * in flight and when it is safe to go is tracked by Worker
+ */
+class Connection {
+public:
+    Connection(int s, std::shared_ptr<spdlog::logger> pl, std::shared_ptr<Afina::Storage> ps, Counters *pc)
+        : _socket(s), _recv_armed(false), _send_armed(false), _eof(false), _failed(false), _sent(0), _logger(pl),
+          pStorage(ps), pCounters(pc), arg_remains(0) {}
+
+    /**
+     * Parses and executes every complete command of the received data, replies are appended to output.
+     * Throws std::runtime_error if the stream is malformed
+     */
+    void Consume(const char *data, std::size_t size);
+
+protected:
+    /**
+     * Same as Consume, but returns how many bytes it used, the rest is a command yet to be completed
+     */
+    std::size_t Process(const char *data, std::size_t size);
+
+private:
+    friend class Worker;
+
+    int _socket;
+
+    // Multishot recv or send is in the ring
+    bool _recv_armed;
+    bool _send_armed;
+
+    // Client has nothing more to send / connection is to be dropped as soon as possible
+    bool _eof;
+    bool _failed;
+
+    // Replies the send in flight is made of and how much of them is sent, replies that came later
+    std::string _sending;
+    std::size_t _sent;
+    std::string _output;
+
+    std::shared_ptr<spdlog::logger> _logger;
+    std::shared_ptr<Afina::Storage> pStorage;
+
+    // Owned by the server, which outlives all its connections
+    Counters *pCounters;
+
+    // Here is connection state
+    // - parser: parse state of the stream
+    // - command_to_execute: last command parsed out of stream
+    // - arg_remains: how many bytes to read from stream to get command argument
+    // - argument_for_command: buffer stores argument
+    std::size_t arg_remains;
+    Protocol::Parser parser;
+    std::string argument_for_command;
+    std::unique_ptr<Execute::Command> command_to_execute;
+
+    // Received bytes parser could not use yet
+    std::string _input;
+};
+
+} // namespace MTuring
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_MT_URING_CONNECTION_H
@@ -0,0 +1,257 @@
+#include "Ring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Afina {
+namespace Network {
+namespace MTuring {
+
+namespace {
+
+// There is no liburing, so system calls are made by number
+int Setup(unsigned entries, struct io_uring_params *params) { return syscall(__NR_io_uring_setup, entries, params); }
+
+int Enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+}
+
+int Register(int fd, unsigned opcode, void *arg, unsigned nr_args) {
+    return syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+} // namespace
+
+// See Ring.h
+Ring::Ring(unsigned entries, unsigned cq_entries)
+    : _sq_map(MAP_FAILED), _cq_map(MAP_FAILED), _sqes(static_cast<struct io_uring_sqe *>(MAP_FAILED)),
+      _sq_local_tail(0), _sq_submitted(0), _cq_local_head(0), _cq_local_tail(0), _enters(0) {
+    // Deferred task work needs a single issuer, which is known only once the ring is enabled
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN | IORING_SETUP_SUBMIT_ALL |
+                   IORING_SETUP_CQSIZE | IORING_SETUP_R_DISABLED;
+    params.cq_entries = cq_entries;
+
+    _fd = Setup(entries, &params);
+    if (_fd == -1) {
+        throw std::runtime_error("Failed to setup io_uring: " + std::string(strerror(errno)));
+    }
+
+    _sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        _sq_map_size = _cq_map_size = std::max(_sq_map_size, _cq_map_size);
+    }
+
+    _sq_map = mmap(nullptr, _sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQ_RING);
+    if (_sq_map != MAP_FAILED) {
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            _cq_map = _sq_map;
+        } else {
+            _cq_map =
+                mmap(nullptr, _cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_CQ_RING);
+        }
+    }
+
+    _sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    if (_cq_map != MAP_FAILED) {
+        _sqes = static_cast<struct io_uring_sqe *>(
+            mmap(nullptr, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES));
+    }
+
+    if (_sqes == MAP_FAILED) {
+        int error = errno;
+        Unmap();
+        close(_fd);
+        throw std::runtime_error("Failed to map io_uring: " + std::string(strerror(error)));
+    }
+
+    char *sq = static_cast<char *>(_sq_map);
+    _sq_head = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    _sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    _sq_mask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    _sq_entries = params.sq_entries;
+
+    // Entries are always taken in order, so the indirection array maps each slot to itself
+    unsigned *array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < _sq_entries; i++) {
+        array[i] = i;
+    }
+
+    char *cq = static_cast<char *>(_cq_map);
+    _cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    _cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    _cq_mask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    _cqes = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+}
+
+// See Ring.h
+Ring::~Ring() {
+    Unmap();
+    close(_fd);
+}
+
+// See Ring.h
+void Ring::Unmap() {
+    if (_sqes != MAP_FAILED) {
+        munmap(_sqes, _sqes_size);
+    }
+    if (_cq_map != MAP_FAILED && _cq_map != _sq_map) {
+        munmap(_cq_map, _cq_map_size);
+    }
+    if (_sq_map != MAP_FAILED) {
+        munmap(_sq_map, _sq_map_size);
+    }
+}
+
+// See Ring.h
+bool Ring::Supported(std::string &reason) {
+    try {
+        // Deferred task work came in 6.1, after multishot recv in 6.0 and buffer rings in 5.19, so setup
+        // itself fails on kernels without the rest
+        Ring ring(8, 16);
+
+        std::vector<char> memory(sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op), 0);
+        struct io_uring_probe *probe = reinterpret_cast<struct io_uring_probe *>(&memory[0]);
+        if (Register(ring.fd(), IORING_REGISTER_PROBE, probe, 256) == -1) {
+            throw std::runtime_error("Failed to probe io_uring: " + std::string(strerror(errno)));
+        }
+
+        const int needed[] = {IORING_OP_ACCEPT, IORING_OP_RECV,          IORING_OP_SEND,
+                              IORING_OP_READ,   IORING_OP_ASYNC_CANCEL, IORING_OP_TIMEOUT};
+        for (int op : needed) {
+            if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+                throw std::runtime_error("io_uring has no opcode " + std::to_string(op));
+            }
+        }
+
+        BufferRing buffers(ring, 0, 2, 64);
+    } catch (std::runtime_error &ex) {
+        reason = ex.what();
+        return false;
+    }
+    return true;
+}
+
+// See Ring.h
+void Ring::Enable() {
+    if (Register(_fd, IORING_REGISTER_ENABLE_RINGS, nullptr, 0) == -1) {
+        throw std::runtime_error("Failed to enable io_uring: " + std::string(strerror(errno)));
+    }
+}
+
+// See Ring.h
+struct io_uring_sqe *Ring::Prepare() {
+    // Kernel frees queue slots only when it manages to submit, and it is the caller who could make it
+    // manage by reaping completions, so busy kernel is not waited for here
+    if (_backlog.empty() && SubmissionsFull()) {
+        Submit(0);
+    }
+    if (!_backlog.empty() || SubmissionsFull()) {
+        _backlog.emplace_back();
+        std::memset(&_backlog.back(), 0, sizeof(struct io_uring_sqe));
+        return &_backlog.back();
+    }
+
+    struct io_uring_sqe *sqe = &_sqes[_sq_local_tail & _sq_mask];
+    std::memset(sqe, 0, sizeof(*sqe));
+    _sq_local_tail++;
+    return sqe;
+}
+
+// See Ring.h
+bool Ring::Submit(unsigned wait) {
+    std::size_t moved = 0;
+    for (; moved < _backlog.size() && !SubmissionsFull(); moved++) {
+        _sqes[_sq_local_tail & _sq_mask] = _backlog[moved];
+        _sq_local_tail++;
+    }
+    _backlog.erase(_backlog.begin(), _backlog.begin() + moved);
+
+    // With backlog left the kernel only flushes completions, so that the caller could reap them and come
+    // back with the rest
+    unsigned flags = IORING_ENTER_GETEVENTS;
+    if (!_backlog.empty()) {
+        wait = 0;
+    } else if (wait == 0) {
+        flags = 0;
+    }
+
+    unsigned to_submit = _sq_local_tail - _sq_submitted;
+    if (to_submit == 0 && flags == 0) {
+        return true;
+    }
+    __atomic_store_n(_sq_tail, _sq_local_tail, __ATOMIC_RELEASE);
+
+    _enters++;
+    int submitted = Enter(_fd, to_submit, wait, flags);
+    if (submitted == -1) {
+        if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+            return false;
+        }
+        throw std::runtime_error("Failed to enter io_uring: " + std::string(strerror(errno)));
+    }
+
+    _sq_submitted += submitted;
+    return true;
+}
+
+// See Ring.h
+BufferRing::BufferRing(Ring &ring, uint16_t group, unsigned count, unsigned size)
+    : _owner(ring), _group(group), _size(size), _mask(count - 1), _local_tail(0) {
+    _ring_size = count * sizeof(struct io_uring_buf);
+    _ring = static_cast<struct io_uring_buf_ring *>(
+        mmap(nullptr, _ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (_ring == MAP_FAILED) {
+        throw std::runtime_error("Failed to map buffer ring: " + std::string(strerror(errno)));
+    }
+
+    _buffers_size = std::size_t(count) * size;
+    _buffers =
+        static_cast<char *>(mmap(nullptr, _buffers_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (_buffers == MAP_FAILED) {
+        int error = errno;
+        munmap(_ring, _ring_size);
+        throw std::runtime_error("Failed to map buffers: " + std::string(strerror(error)));
+    }
+
+    struct io_uring_buf_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(_ring);
+    reg.ring_entries = count;
+    reg.bgid = group;
+    if (Register(_owner.fd(), IORING_REGISTER_PBUF_RING, &reg, 1) == -1) {
+        int error = errno;
+        munmap(_buffers, _buffers_size);
+        munmap(_ring, _ring_size);
+        throw std::runtime_error("Failed to register buffer ring: " + std::string(strerror(error)));
+    }
+
+    for (unsigned i = 0; i < count; i++) {
+        Recycle(i);
+    }
+    Publish();
+}
+
+// See Ring.h
+BufferRing::~BufferRing() {
+    struct io_uring_buf_reg reg;
+    std::memset(&reg, 0, sizeof(reg));
+    reg.bgid = _group;
+    Register(_owner.fd(), IORING_UNREGISTER_PBUF_RING, &reg, 1);
+
+    munmap(_buffers, _buffers_size);
+    munmap(_ring, _ring_size);
+}
+
+} // namespace MTuring
+} // namespace Network
+} // namespace Afina
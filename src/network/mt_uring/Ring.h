@@ -0,0 +1,173 @@
+#ifndef AFINA_NETWORK_MT_URING_RING_H
+#define AFINA_NETWORK_MT_URING_RING_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <linux/io_uring.h>
+
+namespace Afina {
+namespace Network {
+namespace MTuring {
+
+/**
+ * # io_uring instance
+ * Submission and completion queues shared with the kernel, driven by raw io_uring_setup/io_uring_enter
+ * system calls. Ring is created disabled and is used by a single thread: the one that calls Enable.
+ * Completions are posted only while that thread waits in Submit, so requests never interrupt it
+ */
+class Ring {
+public:
+    /**
+     * Creates ring of the given queue sizes, both must be powers of two. Throws std::runtime_error if the
+     * kernel refuses
+     */
+    Ring(unsigned entries, unsigned cq_entries);
+    ~Ring();
+
+    /**
+     * Checks that the kernel has everything the server needs: single issuer rings with deferred task
+     * work, multishot accept and recv, provided buffer rings. Returns false and the reason otherwise
+     */
+    static bool Supported(std::string &reason);
+
+    /**
+     * Binds ring to the calling thread, only it could submit from now on
+     */
+    void Enable();
+
+    /**
+     * Returns zeroed submission entry to fill. If the queue is full, submits what is there first. If the
+     * kernel takes nothing, e.g. completion queue is full until the caller reaps it, entry waits in the
+     * backlog and goes to the queue on one of the next Submit calls
+     */
+    struct io_uring_sqe *Prepare();
+
+    /**
+     * Hands prepared entries to the kernel and waits until there are at least wait completions, all in one
+     * system call. Doesn't wait while there is backlog, caller comes back after reaping instead. Returns
+     * false if the kernel was busy or the wait was interrupted, throws std::runtime_error on failure
+     */
+    bool Submit(unsigned wait);
+
+    /**
+     * Next completion or nullptr if there is none yet. Entry stays valid until Seen
+     */
+    inline struct io_uring_cqe *Peek() {
+        if (_cq_local_head == _cq_local_tail) {
+            _cq_local_tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+            if (_cq_local_head == _cq_local_tail) {
+                return nullptr;
+            }
+        }
+        return &_cqes[_cq_local_head & _cq_mask];
+    }
+
+    /**
+     * Returns completion from Peek to the kernel
+     */
+    inline void Seen() { __atomic_store_n(_cq_head, ++_cq_local_head, __ATOMIC_RELEASE); }
+
+    // Descriptor of the ring for io_uring_register
+    inline int fd() const { return _fd; }
+
+    // io_uring_enter calls so far
+    inline uint64_t Enters() const { return _enters; }
+
+private:
+    Ring(const Ring &) = delete;
+    Ring &operator=(const Ring &) = delete;
+
+    // Releases whatever part of the queues is mapped
+    void Unmap();
+
+    inline bool SubmissionsFull() const {
+        return _sq_local_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) >= _sq_entries;
+    }
+
+    int _fd;
+
+    // Both queues are mapped at once with IORING_FEAT_SINGLE_MMAP, otherwise _cq_map is separate
+    void *_sq_map;
+    std::size_t _sq_map_size;
+    void *_cq_map;
+    std::size_t _cq_map_size;
+    struct io_uring_sqe *_sqes;
+    std::size_t _sqes_size;
+
+    // Submission queue, tail is only written by this side
+    unsigned *_sq_head;
+    unsigned *_sq_tail;
+    unsigned _sq_mask;
+    unsigned _sq_entries;
+    unsigned _sq_local_tail;
+    unsigned _sq_submitted;
+
+    // Prepared when queue was full and kernel busy, in submission order
+    std::vector<struct io_uring_sqe> _backlog;
+
+    // Completion queue, head is only written by this side
+    unsigned *_cq_head;
+    unsigned *_cq_tail;
+    unsigned _cq_mask;
+    struct io_uring_cqe *_cqes;
+    unsigned _cq_local_head;
+    unsigned _cq_local_tail;
+
+    uint64_t _enters;
+};
+
+/**
+ * # Provided buffer ring
+ * Buffers the kernel picks from when a recv completes instead of the recv bringing its own, so idle
+ * connections hold no read buffer at all. Buffer comes back to the ring with Recycle once the data is
+ * consumed, recycled buffers become visible to the kernel at Publish
+ */
+class BufferRing {
+public:
+    /**
+     * Registers count buffers of size bytes as group of ring, count must be a power of two. Throws
+     * std::runtime_error on failure
+     */
+    BufferRing(Ring &ring, uint16_t group, unsigned count, unsigned size);
+    ~BufferRing();
+
+    inline uint16_t Group() const { return _group; }
+
+    // Data of the buffer with the id from completion flags
+    inline const char *Buffer(uint16_t bid) const { return _buffers + std::size_t(bid) * _size; }
+
+    inline void Recycle(uint16_t bid) {
+        // Not _ring->bufs: in C++ the header puts an empty struct in front of the flexible array, which
+        // moves it by 8 bytes. Ring is just an array of entries with the tail in the first one
+        struct io_uring_buf &buf = reinterpret_cast<struct io_uring_buf *>(_ring)[_local_tail & _mask];
+        buf.addr = reinterpret_cast<uint64_t>(Buffer(bid));
+        buf.len = _size;
+        buf.bid = bid;
+        _local_tail++;
+    }
+
+    inline void Publish() { __atomic_store_n(&_ring->tail, _local_tail, __ATOMIC_RELEASE); }
+
+private:
+    BufferRing(const BufferRing &) = delete;
+    BufferRing &operator=(const BufferRing &) = delete;
+
+    Ring &_owner;
+    uint16_t _group;
+    unsigned _size;
+    unsigned _mask;
+    uint16_t _local_tail;
+
+    struct io_uring_buf_ring *_ring;
+    std::size_t _ring_size;
+    char *_buffers;
+    std::size_t _buffers_size;
+};
+
+} // namespace MTuring
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_MT_URING_RING_H
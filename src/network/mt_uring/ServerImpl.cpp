@@ -0,0 +1,106 @@
+#include "ServerImpl.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include <signal.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+#include <afina/logging/Service.h>
+
+#include "network/mt_reuseport/ServerImpl.h"
+
+#include "Ring.h"
+#include "Worker.h"
+
+namespace Afina {
+namespace Network {
+namespace MTuring {
+
+// See Server.h
+ServerImpl::ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl) : Server(ps, pl) {}
+
+// See Server.h
+ServerImpl::~ServerImpl() {}
+
+// See Server.h
+void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers) {
+    _logger = pLogging->select("network");
+
+    std::string reason;
+    if (!Ring::Supported(reason)) {
+        _logger->warn("io_uring is not usable ({}), fall back to epoll", reason);
+        _fallback.reset(new MTreuseport::ServerImpl(pStorage, pLogging));
+        _fallback->SetPlacement(_placement);
+        _fallback->Start(port, n_acceptors, n_workers);
+        return;
+    }
+
+    _logger->info("Start network service");
+
+    // Sends carry MSG_NOSIGNAL, but keep closed sockets harmless for anything else as well
+    sigset_t sig_mask;
+    sigemptyset(&sig_mask);
+    sigaddset(&sig_mask, SIGPIPE);
+    if (pthread_sigmask(SIG_BLOCK, &sig_mask, NULL) != 0) {
+        throw std::runtime_error("Unable to mask SIGPIPE");
+    }
+
+    n_workers = std::max<uint32_t>(1, n_workers);
+    _workers.reserve(n_workers);
+    for (uint32_t i = 0; i < n_workers; i++) {
+        _workers.emplace_back(new Worker(pStorage, pLogging->select("network.worker"), &_counters));
+        _workers.back()->Start(port, _placement.Worker(i));
+    }
+}
+
+// See Server.h
+void ServerImpl::Stop() {
+    if (_fallback) {
+        _fallback->Stop();
+        return;
+    }
+
+    _logger->warn("Stop network service");
+    for (auto &worker : _workers) {
+        worker->Stop();
+    }
+}
+
+// See Server.h
+void ServerImpl::Join() {
+    if (_fallback) {
+        _fallback->Join();
+        return;
+    }
+
+    for (auto &worker : _workers) {
+        worker->Join();
+    }
+}
+
+// See Server.h
+std::string ServerImpl::DumpCounters() const {
+    if (_fallback) {
+        return _fallback->DumpCounters() + "\nuring_fallback 1";
+    }
+
+    std::string result = Server::DumpCounters();
+    uint64_t enters = 0, completions = 0, nobufs = 0;
+    for (std::size_t i = 0; i < _workers.size(); i++) {
+        result += "\nworker" + std::to_string(i) + "_connections " + std::to_string(_workers[i]->Accepted());
+        enters += _workers[i]->Enters();
+        completions += _workers[i]->Completions();
+        nobufs += _workers[i]->NoBuffers();
+    }
+
+    return result + "\nuring_enters " + std::to_string(enters) + "\nuring_completions " +
+           std::to_string(completions) + "\nuring_nobufs " + std::to_string(nobufs);
+}
+
+} // namespace MTuring
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,57 @@
+#ifndef AFINA_NETWORK_MT_URING_SERVER_H
+#define AFINA_NETWORK_MT_URING_SERVER_H
+
+#include <memory>
+#include <vector>
+
+#include <afina/network/Server.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+namespace Network {
+namespace MTuring {
+
+// Forward declaration, see Worker.h
+class Worker;
+
+/**
+ * # Network resource manager implementation
+ * Shared nothing io_uring server: every worker has its own SO_REUSEPORT listener and its own ring, see
+ * Worker. If the kernel lacks something the workers need, server runs MTreuseport instead, which has the
+ * same layout on epoll. Workers accept themselves, acceptors argument of Start is ignored
+ */
+class ServerImpl : public Server {
+public:
+    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl);
+    ~ServerImpl();
+
+    // See Server.h
+    void Start(uint16_t port, uint32_t acceptors, uint32_t workers) override;
+
+    // See Server.h
+    void Stop() override;
+
+    // See Server.h
+    void Join() override;
+
+    // See Server.h
+    std::string DumpCounters() const override;
+
+private:
+    // logger to use
+    std::shared_ptr<spdlog::logger> _logger;
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    // epoll server everything is forwarded to when io_uring is not usable
+    std::unique_ptr<Server> _fallback;
+};
+
+} // namespace MTuring
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_MT_URING_SERVER_H
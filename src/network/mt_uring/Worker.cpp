@@ -0,0 +1,454 @@
+#include "Worker.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <netinet/in.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+#include <afina/concurrency/Epoch.h>
+#include <afina/concurrency/Topology.h>
+
+#include "Connection.h"
+
+namespace Afina {
+namespace Network {
+namespace MTuring {
+
+namespace {
+
+// Ring sizes: submissions are flushed whenever the queue fills up, completions of a whole batch must fit
+const unsigned kEntries = 256;
+const unsigned kCompletions = 4096;
+
+// Provided buffers, taken only for the time completion is handled
+const uint16_t kGroup = 0;
+const unsigned kBuffers = 512;
+const unsigned kBufferSize = 4096;
+
+// Pause before accepting again after the listener failed, e.g. out of descriptors
+const long kAcceptRetryNs = 100 * 1000 * 1000;
+
+// Low bits of user_data tell what completed, the rest is the connection if any
+enum Tag : uint64_t { kIgnore = 0, kAccept = 1, kWakeup = 2, kRecv = 3, kSend = 4, kAcceptRetry = 5 };
+const uint64_t kTagMask = 7;
+
+inline uint64_t Pack(Connection *pc, Tag tag) { return reinterpret_cast<uint64_t>(pc) | tag; }
+
+// Written by the worker only
+inline void Increment(std::atomic<uint64_t> &counter, uint64_t n = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+} // namespace
+
+// See Worker.h
+Worker::Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl, Counters *pc)
+    : _pStorage(ps), _logger(pl), _pCounters(pc), _server_socket(-1), _event_fd(-1), _event_value(0),
+      _accept_armed(false), _retry_armed(false), _wakeup_armed(false), _stopping(false), _accepted(0), _enters(0),
+      _completions(0), _nobufs(0) {}
+
+// See Worker.h
+Worker::~Worker() {
+    if (_thread.joinable()) {
+        Stop();
+        Join();
+    }
+}
+
+// See Worker.h
+void Worker::Start(uint16_t port, const std::vector<unsigned> &cpus) {
+    struct sockaddr_in server_addr;
+    std::memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;         // IPv4
+    server_addr.sin_port = htons(port);       // TCP port number
+    server_addr.sin_addr.s_addr = INADDR_ANY; // Bind to any address
+
+    // Ring waits for the socket itself, so it may stay blocking
+    _server_socket = socket(PF_INET, SOCK_STREAM | SOCK_CLOEXEC, IPPROTO_TCP);
+    if (_server_socket == -1) {
+        throw std::runtime_error("Failed to open socket: " + std::string(strerror(errno)));
+    }
+
+    // Every worker binds the same port, all sockets of the group must have SO_REUSEPORT
+    int opts = 1;
+    if (setsockopt(_server_socket, SOL_SOCKET, SO_KEEPALIVE, &opts, sizeof(opts)) == -1 ||
+        setsockopt(_server_socket, SOL_SOCKET, SO_REUSEPORT, &opts, sizeof(opts)) == -1) {
+        close(_server_socket);
+        throw std::runtime_error("Socket setsockopt() failed: " + std::string(strerror(errno)));
+    }
+
+    if (bind(_server_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
+        close(_server_socket);
+        throw std::runtime_error("Socket bind() failed: " + std::string(strerror(errno)));
+    }
+
+    if (listen(_server_socket, SOMAXCONN) == -1) {
+        close(_server_socket);
+        throw std::runtime_error("Socket listen() failed: " + std::string(strerror(errno)));
+    }
+
+    _event_fd = eventfd(0, EFD_CLOEXEC);
+    if (_event_fd == -1) {
+        close(_server_socket);
+        throw std::runtime_error("Failed to create eventfd: " + std::string(strerror(errno)));
+    }
+
+    try {
+        _ring.reset(new Ring(kEntries, kCompletions));
+        _buffers.reset(new BufferRing(*_ring, kGroup, kBuffers, kBufferSize));
+    } catch (std::runtime_error &ex) {
+        _buffers.reset();
+        _ring.reset();
+        close(_event_fd);
+        close(_server_socket);
+        throw;
+    }
+
+    _cpus = cpus;
+    _thread = std::thread(&Worker::OnRun, this);
+}
+
+// See Worker.h
+void Worker::Stop() {
+    if (eventfd_write(_event_fd, 1)) {
+        throw std::runtime_error("Failed to wakeup worker");
+    }
+}
+
+// See Worker.h
+void Worker::Join() {
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+// See Worker.h
+void Worker::OnRun() {
+    _logger->info("Start worker");
+
+    // Pin before anything is allocated, so that the kernel places memory this thread touches
+    // first on the local node
+    if (!Concurrency::PinCurrentThread(_cpus)) {
+        _logger->warn("Failed to pin worker to {} cpus", _cpus.size());
+    }
+
+    try {
+        _ring->Enable();
+        ArmAccept();
+        ArmWakeup();
+
+        // Ring could be left only once nothing in flight refers to connections or buffers
+        while (!_stopping || _accept_armed || _retry_armed || _wakeup_armed || !_connections.empty()) {
+            _buffers->Publish();
+            _ring->Submit(1);
+
+            uint64_t completions = 0;
+            for (struct io_uring_cqe *cqe = _ring->Peek(); cqe != nullptr; cqe = _ring->Peek()) {
+                uint64_t user_data = cqe->user_data;
+                int32_t res = cqe->res;
+                uint32_t flags = cqe->flags;
+                _ring->Seen();
+
+                OnCompletion(user_data, res, flags);
+                completions++;
+            }
+            Increment(_completions, completions);
+            _enters.store(_ring->Enters(), std::memory_order_relaxed);
+
+            // Storage entries are read only inside Consume, so between batches the worker holds none
+            Concurrency::EpochDomain::Global().Quiescent();
+        }
+    } catch (std::runtime_error &ex) {
+        _logger->error("Worker failed: {}", ex.what());
+    }
+
+    // Empty unless the ring failed, then closing it cancels whatever is left
+    for (auto connection : _connections) {
+        close(connection->_socket);
+        delete connection;
+    }
+    _connections.clear();
+
+    _buffers.reset();
+    _ring.reset();
+
+    // Connections still in the accept queue of the listener are reset by the kernel
+    close(_server_socket);
+    close(_event_fd);
+    _logger->warn("Worker stopped");
+}
+
+// See Worker.h
+void Worker::OnCompletion(uint64_t user_data, int32_t res, uint32_t flags) {
+    Connection *pc = reinterpret_cast<Connection *>(user_data & ~kTagMask);
+    switch (user_data & kTagMask) {
+    case kAccept:
+        OnAccept(res, flags);
+        break;
+
+    case kWakeup:
+        _wakeup_armed = false;
+        if (res < 0) {
+            _logger->error("Failed to read wakeup event: {}", strerror(-res));
+        }
+        OnStop();
+        break;
+
+    case kAcceptRetry:
+        _retry_armed = false;
+        if (!_accept_armed && !_stopping) {
+            ArmAccept();
+        }
+        break;
+
+    case kRecv:
+        OnRecv(pc, res, flags);
+        break;
+
+    case kSend:
+        OnSend(pc, res);
+        break;
+
+    default:
+        break;
+    }
+}
+
+// See Worker.h
+void Worker::OnAccept(int32_t res, uint32_t flags) {
+    if (!(flags & IORING_CQE_F_MORE)) {
+        _accept_armed = false;
+    }
+
+    if (res >= 0) {
+        if (_stopping) {
+            close(res);
+            return;
+        }
+
+        _logger->info("Accepted connection on descriptor {}", res);
+        _pCounters->connections.Add();
+        Increment(_accepted);
+
+        Connection *pc = new Connection(res, _logger, _pStorage, _pCounters);
+        _connections.insert(pc);
+        ArmRecv(pc);
+    } else if (res == -ECANCELED) {
+        return;
+    } else if (res != -ECONNABORTED && res != -EPROTO) {
+        // Listener keeps getting its share of connections, so out of descriptors or memory is waited
+        // out rather than given up on
+        _pCounters->errors.Add();
+        _logger->error("Failed to accept socket, retry in {} ms: {}", kAcceptRetryNs / 1000000, strerror(-res));
+        if (!_accept_armed && !_retry_armed && !_stopping) {
+            ArmAcceptRetry();
+        }
+        return;
+    }
+
+    // Multishot accept ends now and then, e.g. on client gone before accept
+    if (!_accept_armed && !_stopping) {
+        ArmAccept();
+    }
+}
+
+// See Worker.h
+void Worker::OnRecv(Connection *pc, int32_t res, uint32_t flags) {
+    if (!(flags & IORING_CQE_F_MORE)) {
+        pc->_recv_armed = false;
+    }
+
+    if (res > 0) {
+        uint16_t bid = flags >> IORING_CQE_BUFFER_SHIFT;
+        if (!_stopping && !pc->_failed) {
+            _logger->debug("Got {} bytes from descriptor {}", res, pc->_socket);
+            try {
+                pc->Consume(_buffers->Buffer(bid), res);
+            } catch (std::runtime_error &ex) {
+                _pCounters->errors.Add();
+                _logger->error("Failed to process connection on descriptor {}: {}", pc->_socket, ex.what());
+                Fail(pc);
+            }
+        }
+
+        // Buffer is free again as soon as it is parsed
+        _buffers->Recycle(bid);
+        Flush(pc);
+        ArmRecv(pc);
+    } else if (res == -ENOBUFS) {
+        Increment(_nobufs);
+        ArmRecv(pc);
+    } else if (res == 0) {
+        _logger->debug("Connection closed on descriptor {}", pc->_socket);
+        pc->_eof = true;
+    } else {
+        if (res != -ECANCELED && res != -ECONNRESET) {
+            _pCounters->errors.Add();
+            _logger->error("Failed to read from descriptor {}: {}", pc->_socket, strerror(-res));
+        }
+        Fail(pc);
+    }
+
+    Release(pc);
+}
+
+// See Worker.h
+void Worker::OnSend(Connection *pc, int32_t res) {
+    pc->_send_armed = false;
+
+    if (res >= 0) {
+        pc->_sent += res;
+        if (pc->_sent == pc->_sending.size()) {
+            pc->_sending.clear();
+            pc->_sent = 0;
+        }
+        Flush(pc);
+    } else {
+        if (res != -ECANCELED && res != -EPIPE && res != -ECONNRESET) {
+            _pCounters->errors.Add();
+            _logger->error("Failed to write to descriptor {}: {}", pc->_socket, strerror(-res));
+        }
+        Fail(pc);
+    }
+
+    Release(pc);
+}
+
+// See Worker.h
+void Worker::OnStop() {
+    _logger->debug("Stop worker due to stop signal");
+    _stopping = true;
+
+    // Accept, every recv and send complete with ECANCELED, connections go as soon as they have nothing
+    // in flight
+    struct io_uring_sqe *sqe = _ring->Prepare();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+    sqe->user_data = kIgnore;
+}
+
+// See Worker.h
+void Worker::ArmAccept() {
+    struct io_uring_sqe *sqe = _ring->Prepare();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = _server_socket;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = kAccept;
+    _accept_armed = true;
+}
+
+// See Worker.h
+void Worker::ArmAcceptRetry() {
+    _retry_timeout.tv_sec = 0;
+    _retry_timeout.tv_nsec = kAcceptRetryNs;
+
+    struct io_uring_sqe *sqe = _ring->Prepare();
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uint64_t>(&_retry_timeout);
+    sqe->len = 1;
+    sqe->user_data = kAcceptRetry;
+    _retry_armed = true;
+}
+
+// See Worker.h
+void Worker::ArmWakeup() {
+    struct io_uring_sqe *sqe = _ring->Prepare();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = _event_fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&_event_value);
+    sqe->len = sizeof(_event_value);
+    sqe->user_data = kWakeup;
+    _wakeup_armed = true;
+}
+
+// See Worker.h
+void Worker::ArmRecv(Connection *pc) {
+    if (pc->_recv_armed || pc->_eof || pc->_failed || _stopping) {
+        return;
+    }
+
+    struct io_uring_sqe *sqe = _ring->Prepare();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = pc->_socket;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = _buffers->Group();
+    sqe->user_data = Pack(pc, kRecv);
+    pc->_recv_armed = true;
+}
+
+// See Worker.h
+void Worker::Flush(Connection *pc) {
+    if (pc->_send_armed || pc->_failed || _stopping) {
+        return;
+    }
+
+    // Replies of the whole batch go in one send, the ones that come meanwhile wait for the next
+    if (pc->_sending.empty()) {
+        if (pc->_output.empty()) {
+            return;
+        }
+        pc->_sending.swap(pc->_output);
+        pc->_sent = 0;
+    }
+
+    // MSG_WAITALL makes the ring retry short sends by itself
+    struct io_uring_sqe *sqe = _ring->Prepare();
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = pc->_socket;
+    sqe->addr = reinterpret_cast<uint64_t>(pc->_sending.data() + pc->_sent);
+    sqe->len = pc->_sending.size() - pc->_sent;
+    sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+    sqe->user_data = Pack(pc, kSend);
+    pc->_send_armed = true;
+}
+
+// See Worker.h
+void Worker::Fail(Connection *pc) {
+    if (pc->_failed) {
+        return;
+    }
+    pc->_failed = true;
+
+    // Multishot recv would otherwise stay armed until client sends something or goes away
+    if (pc->_recv_armed || pc->_send_armed) {
+        struct io_uring_sqe *sqe = _ring->Prepare();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = pc->_socket;
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+        sqe->user_data = kIgnore;
+    }
+}
+
+// See Worker.h
+void Worker::Release(Connection *pc) {
+    if (pc->_recv_armed || pc->_send_armed) {
+        return;
+    }
+
+    // Client that is done sending still gets all its replies, Flush keeps send armed until then
+    if (!pc->_eof && !pc->_failed && !_stopping) {
+        return;
+    }
+
+    _logger->debug("Close descriptor {}", pc->_socket);
+    close(pc->_socket);
+    _connections.erase(pc);
+    delete pc;
+}
+
+} // namespace MTuring
+} // namespace Network
+} // namespace Afina
@@ -0,0 +1,164 @@
+#ifndef AFINA_NETWORK_MT_URING_WORKER_H
+#define AFINA_NETWORK_MT_URING_WORKER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <afina/network/Server.h>
+
+#include "Ring.h"
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+
+// Forward declaration, see afina/Storage.h
+class Storage;
+
+namespace Network {
+namespace MTuring {
+
+// Forward declaration, see Connection.h
+class Connection;
+
+/**
+ * # Thread with its own listener and io_uring
+ * Like MTreuseport::Worker owns a SO_REUSEPORT socket on the server port and every connection it accepts,
+ * but instead of waiting for readiness it keeps requests in the ring: one multishot accept on the listener
+ * and one multishot recv per connection, which take buffers from the provided buffer ring and stay armed
+ * across completions, plus a send whenever there are replies. Everything prepared while handling a batch
+ * of completions is submitted by the same io_uring_enter that waits for the next batch, so under load a
+ * request costs a fraction of a system call
+ */
+class Worker {
+public:
+    Worker(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl, Counters *pc);
+    ~Worker();
+
+    /**
+     * Creates listener and ring, throws std::runtime_error if any of them fails, then starts the thread.
+     * Thread is restricted to cpus unless it is empty
+     */
+    void Start(uint16_t port, const std::vector<unsigned> &cpus = {});
+
+    /**
+     * Signals thread to stop: requests in flight are cancelled, then it closes its listener and connections
+     * and exits. Safe to call from any thread
+     */
+    void Stop();
+
+    /**
+     * Waits until the thread is done
+     */
+    void Join();
+
+    // Connections accepted so far
+    inline uint64_t Accepted() const { return _accepted.load(std::memory_order_relaxed); }
+
+    // io_uring_enter calls made so far
+    inline uint64_t Enters() const { return _enters.load(std::memory_order_relaxed); }
+
+    // Completions handled so far
+    inline uint64_t Completions() const { return _completions.load(std::memory_order_relaxed); }
+
+    // Times multishot recv ended because buffer ring ran dry
+    inline uint64_t NoBuffers() const { return _nobufs.load(std::memory_order_relaxed); }
+
+protected:
+    /**
+     * Method executing by background thread
+     */
+    void OnRun();
+
+    /**
+     * Handles one completion
+     */
+    void OnCompletion(uint64_t user_data, int32_t res, uint32_t flags);
+
+    void OnAccept(int32_t res, uint32_t flags);
+    void OnRecv(Connection *pc, int32_t res, uint32_t flags);
+    void OnSend(Connection *pc, int32_t res);
+
+    /**
+     * Requests are cancelled, nothing new goes to the ring
+     */
+    void OnStop();
+
+    void ArmAccept();
+
+    /**
+     * Arms accept again after a pause
+     */
+    void ArmAcceptRetry();
+
+    void ArmWakeup();
+    void ArmRecv(Connection *pc);
+
+    /**
+     * Starts send of pending replies unless one is in flight already
+     */
+    void Flush(Connection *pc);
+
+    /**
+     * Drops connection: whatever it has in flight is cancelled, pending replies are not sent
+     */
+    void Fail(Connection *pc);
+
+    /**
+     * Closes and deletes connection once it is done and has nothing in flight
+     */
+    void Release(Connection *pc);
+
+private:
+    Worker(const Worker &) = delete;
+    Worker &operator=(const Worker &) = delete;
+
+    std::shared_ptr<Afina::Storage> _pStorage;
+    std::shared_ptr<spdlog::logger> _logger;
+
+    // Owned by the server, which outlives its workers
+    Counters *_pCounters;
+
+    // Listener of this worker only
+    int _server_socket;
+
+    // Wakes the thread up on stop
+    int _event_fd;
+    uint64_t _event_value;
+
+    // Timeout accept retry waits for, read by the kernel until it completes
+    struct __kernel_timespec _retry_timeout;
+
+    // Ring is created by Start and bound to the thread once it runs
+    std::unique_ptr<Ring> _ring;
+    std::unique_ptr<BufferRing> _buffers;
+
+    std::thread _thread;
+    std::vector<unsigned> _cpus;
+
+    // What is in flight besides connections
+    bool _accept_armed;
+    bool _retry_armed;
+    bool _wakeup_armed;
+    bool _stopping;
+
+    std::atomic<uint64_t> _accepted;
+    std::atomic<uint64_t> _enters;
+    std::atomic<uint64_t> _completions;
+    std::atomic<uint64_t> _nobufs;
+
+    // Belong to the thread, freed when it exits
+    std::set<Connection *> _connections;
+};
+
+} // namespace MTuring
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_MT_URING_WORKER_H
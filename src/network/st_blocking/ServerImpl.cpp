@@ -138,6 +138,7 @@ void ServerImpl::OnRun() {
         if ((client_socket = accept(_server_socket, (struct sockaddr *)&client_addr, &client_addr_len)) == -1) {
             continue;
         }
+        _counters.connections.Add();
 
         // Got new connection
         if (_logger->should_log(spdlog::level::debug)) {
@@ -217,6 +218,7 @@ void ServerImpl::OnRun() {
 
                         std::string result;
                         command_to_execute->Execute(*pStorage, argument_for_command, result);
+                        _counters.requests.Add();
 
                         // Send response
                         result += "\r\n";
@@ -238,6 +240,7 @@ void ServerImpl::OnRun() {
                 throw std::runtime_error(std::string(strerror(errno)));
             }
         } catch (std::runtime_error &ex) {
+            _counters.errors.Add();
             _logger->error("Failed to process connection on descriptor {}: {}", client_socket, ex.what());
         }
 
@@ -0,0 +1,30 @@
+#ifndef AFINA_NETWORK_ST_COROUTINE_SERVER_H
+#define AFINA_NETWORK_ST_COROUTINE_SERVER_H
+
+#include "network/mt_coroutine/ServerImpl.h"
+
+namespace Afina {
+namespace Network {
+namespace STcoroutine {
+
+/**
+ * # Network resource manager implementation
+ * Coroutine server on a single thread: the only worker of Coroutine::Scheduler accepts connections and
+ * serves all of them, see MTcoroutine::ServerImpl
+ */
+class ServerImpl : public MTcoroutine::ServerImpl {
+public:
+    ServerImpl(std::shared_ptr<Afina::Storage> ps, std::shared_ptr<Logging::Service> pl)
+        : MTcoroutine::ServerImpl(ps, pl) {}
+
+    // See Server.h
+    void Start(uint16_t port, uint32_t acceptors, uint32_t workers) override {
+        MTcoroutine::ServerImpl::Start(port, 1, 1);
+    }
+};
+
+} // namespace STcoroutine
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_ST_COROUTINE_SERVER_H
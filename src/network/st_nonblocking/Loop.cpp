@@ -0,0 +1,175 @@
+#include "Loop.h"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+
+#include <afina/Storage.h>
+#include <afina/concurrency/Epoch.h>
+
+#include "Connection.h"
+
+namespace Afina {
+namespace Network {
+namespace STnonblock {
+
+// See Loop.h
+Loop::Loop(int server_socket, int event_fd, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl,
+           Counters *pc)
+    : _pStorage(ps), _logger(pl), _pCounters(pc), _server_socket(server_socket), _event_fd(event_fd), _accepted(0) {
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll_fd == -1) {
+        throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
+    }
+
+    // Listener is told apart by the address of its descriptor, stop event by nullptr, connections
+    // point to themselves
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = &_server_socket;
+    struct epoll_event event2;
+    event2.events = EPOLLIN;
+    event2.data.ptr = nullptr;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _server_socket, &event) ||
+        epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, _event_fd, &event2)) {
+        close(_epoll_fd);
+        throw std::runtime_error("Failed to add file descriptor to epoll");
+    }
+}
+
+// See Loop.h
+Loop::~Loop() { close(_epoll_fd); }
+
+// See Loop.h
+void Loop::Run() {
+    bool run = true;
+    std::array<struct epoll_event, 64> mod_list;
+    while (run) {
+        int nmod = epoll_wait(_epoll_fd, &mod_list[0], mod_list.size(), -1);
+        _logger->debug("Loop wake up: {} events", nmod);
+
+        for (int i = 0; i < nmod; i++) {
+            struct epoll_event &current_event = mod_list[i];
+            if (current_event.data.ptr == nullptr) {
+                _logger->debug("Break loop due to stop signal");
+                run = false;
+                continue;
+            } else if (current_event.data.ptr == &_server_socket) {
+                OnNewConnection();
+                continue;
+            }
+
+            // That is some connection!
+            Connection *pc = static_cast<Connection *>(current_event.data.ptr);
+
+            auto old_mask = pc->_event.events;
+            if ((current_event.events & EPOLLERR) || (current_event.events & EPOLLHUP)) {
+                pc->DoRead();
+                pc->DoWrite();
+                pc->OnError();
+            } else if (current_event.events & EPOLLRDHUP) {
+                pc->DoRead();
+                pc->DoWrite();
+                pc->OnClose();
+            } else {
+                // Depends on what connection wants...
+                if (current_event.events & EPOLLIN) {
+                    pc->DoRead();
+                }
+                if (current_event.events & EPOLLOUT) {
+                    pc->DoWrite();
+                }
+            }
+
+            // Level triggered, so epoll only has to know when connection starts or stops writing
+            if (!pc->isAlive()) {
+                Release(pc);
+            } else if (pc->_event.events != old_mask) {
+                if (epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, pc->_socket, &pc->_event)) {
+                    _logger->error("Failed to change connection event mask");
+                    pc->OnClose();
+                    Release(pc);
+                }
+            }
+        }
+
+        // Storage entries are read only inside DoRead, so between batches the thread holds none
+        Concurrency::EpochDomain::Global().Quiescent();
+    }
+
+    // Connections belong to this thread, nobody else could free them
+    for (auto connection : _connections) {
+        close(connection->_socket);
+        delete connection;
+    }
+    _connections.clear();
+}
+
+// See Loop.h
+void Loop::OnNewConnection() {
+    for (;;) {
+        struct sockaddr in_addr;
+        socklen_t in_len;
+
+        // No need to make these sockets non blocking since accept4() takes care of it.
+        in_len = sizeof in_addr;
+        int infd = accept4(_server_socket, &in_addr, &in_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (infd == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNABORTED) {
+                _logger->error("Failed to accept socket: {}", strerror(errno));
+            }
+            break;
+        }
+
+        // Print host and service info.
+        char hbuf[NI_MAXHOST], sbuf[NI_MAXSERV];
+        int retval =
+            getnameinfo(&in_addr, in_len, hbuf, sizeof hbuf, sbuf, sizeof sbuf, NI_NUMERICHOST | NI_NUMERICSERV);
+        if (retval == 0) {
+            _logger->info("Accepted connection on descriptor {} (host={}, port={})", infd, hbuf, sbuf);
+        }
+
+        _pCounters->connections.Add();
+        _accepted.store(_accepted.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        Connection *pc = new Connection(infd, _logger, _pStorage, _pCounters);
+
+        // Register the new FD to be monitored by epoll, it never leaves this loop
+        pc->Start();
+        if (pc->isAlive()) {
+            if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, pc->_socket, &pc->_event)) {
+                pc->OnError();
+                close(pc->_socket);
+                delete pc;
+                continue;
+            }
+        }
+
+        _connections.insert(pc);
+    }
+}
+
+// See Loop.h
+void Loop::Release(Connection *pc) {
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, pc->_socket, &pc->_event)) {
+        _logger->error("Failed to delete connection from epoll");
+    }
+
+    close(pc->_socket);
+    _connections.erase(pc);
+    delete pc;
+}
+
+} // namespace STnonblock
+} // namespace Network
+} // namespace Afina
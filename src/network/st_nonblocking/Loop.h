@@ -0,0 +1,85 @@
+#ifndef AFINA_NETWORK_ST_NONBLOCKING_LOOP_H
+#define AFINA_NETWORK_ST_NONBLOCKING_LOOP_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <set>
+
+#include <afina/network/Server.h>
+
+namespace spdlog {
+class logger;
+}
+
+namespace Afina {
+
+// Forward declaration, see afina/Storage.h
+class Storage;
+
+namespace Network {
+namespace STnonblock {
+
+// Forward declaration, see Connection.h
+class Connection;
+
+/**
+ * # Single threaded epoll loop
+ * Accepts connections from a non blocking listener and serves all of them on the thread that runs it.
+ * Events are level triggered, epoll_ctl is called only when connection starts or stops waiting for
+ * EPOLLOUT. Used by the single threaded server and by every MTreuseport worker
+ */
+class Loop {
+public:
+    /**
+     * Creates epoll watching listener and stop event, throws std::runtime_error on failure. Both
+     * descriptors stay owned by the caller
+     */
+    Loop(int server_socket, int event_fd, std::shared_ptr<Afina::Storage> ps, std::shared_ptr<spdlog::logger> pl,
+         Counters *pc);
+    ~Loop();
+
+    /**
+     * Serves connections until event_fd becomes readable, then closes all of them
+     */
+    void Run();
+
+    // Connections accepted so far, safe to read from any thread
+    inline uint64_t Accepted() const { return _accepted.load(std::memory_order_relaxed); }
+
+protected:
+    /**
+     * Accepts everything pending on the listener
+     */
+    void OnNewConnection();
+
+    /**
+     * Takes connection out of epoll, closes and frees it
+     */
+    void Release(Connection *pc);
+
+private:
+    Loop(const Loop &) = delete;
+    Loop &operator=(const Loop &) = delete;
+
+    std::shared_ptr<Afina::Storage> _pStorage;
+    std::shared_ptr<spdlog::logger> _logger;
+
+    // Owned by the server, which outlives the loop
+    Counters *_pCounters;
+
+    int _server_socket;
+    int _event_fd;
+    int _epoll_fd;
+
+    std::atomic<uint64_t> _accepted;
+
+    // Belong to the thread running the loop
+    std::set<Connection *> _connections;
+};
+
+} // namespace STnonblock
+} // namespace Network
+} // namespace Afina
+
+#endif // AFINA_NETWORK_ST_NONBLOCKING_LOOP_H
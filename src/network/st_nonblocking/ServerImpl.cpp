@@ -21,7 +21,7 @@
 #include <afina/Storage.h>
 #include <afina/logging/Service.h>
 
-#include "Connection.h"
+#include "Loop.h"
 #include "Utils.h"
 
 namespace Afina {
@@ -80,6 +80,7 @@ void ServerImpl::Start(uint16_t port, uint32_t n_acceptors, uint32_t n_workers)
         throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
     }
 
+    _loop.reset(new Loop(_server_socket, _event_fd, pStorage, _logger, &_counters));
     _work_thread = std::thread(&ServerImpl::OnRun, this);
 }
 
@@ -91,13 +92,6 @@ void ServerImpl::Stop() {
     if (eventfd_write(_event_fd, 1)) {
         throw std::runtime_error("Failed to wakeup workers");
     }
-
-    for (auto connection : _connections) {
-        close(connection->_socket);
-        delete connection;
-    }
-
-    close(_server_socket);
 }
 
 // See Server.h
@@ -109,133 +103,12 @@ void ServerImpl::Join() {
 // See ServerImpl.h
 void ServerImpl::OnRun() {
     _logger->info("Start acceptor");
-    int epoll_descr = epoll_create1(0);
-    if (epoll_descr == -1) {
-        throw std::runtime_error("Failed to create epoll file descriptor: " + std::string(strerror(errno)));
-    }
-
-    struct epoll_event event;
-    event.events = EPOLLIN;
-    event.data.fd = _server_socket;
-    if (epoll_ctl(epoll_descr, EPOLL_CTL_ADD, _server_socket, &event)) {
-        throw std::runtime_error("Failed to add file descriptor to epoll");
-    }
+    _loop->Run();
 
-    struct epoll_event event2;
-    event2.events = EPOLLIN;
-    event2.data.fd = _event_fd;
-    if (epoll_ctl(epoll_descr, EPOLL_CTL_ADD, _event_fd, &event2)) {
-        throw std::runtime_error("Failed to add file descriptor to epoll");
-    }
-
-    bool run = true;
-    std::array<struct epoll_event, 64> mod_list;
-    while (run) {
-        int nmod = epoll_wait(epoll_descr, &mod_list[0], mod_list.size(), -1);
-        _logger->debug("Acceptor wake up: {} events", nmod);
-
-        for (int i = 0; i < nmod; i++) {
-            struct epoll_event &current_event = mod_list[i];
-            if (current_event.data.fd == _event_fd) {
-                _logger->debug("Break acceptor due to stop signal");
-                run = false;
-                continue;
-            } else if (current_event.data.fd == _server_socket) {
-                OnNewConnection(epoll_descr);
-                continue;
-            }
-
-            // That is some connection!
-            Connection *pc = static_cast<Connection *>(current_event.data.ptr);
-
-            auto old_mask = pc->_event.events;
-            if ((current_event.events & EPOLLERR) || (current_event.events & EPOLLHUP)) {
-                pc->DoRead();
-                pc->DoWrite();
-                pc->OnError();
-            } else if (current_event.events & EPOLLRDHUP) {
-                pc->DoRead();
-                pc->DoWrite();
-                pc->OnClose();
-            } else {
-                // Depends on what connection wants...
-                if (current_event.events & EPOLLIN) {
-                    pc->DoRead();
-                }
-                if (current_event.events & EPOLLOUT) {
-                    pc->DoWrite();
-                }
-            }
-
-            // Does it alive?
-            if (!pc->isAlive()) {
-                if (epoll_ctl(epoll_descr, EPOLL_CTL_DEL, pc->_socket, &pc->_event)) {
-                    _logger->error("Failed to delete connection from epoll");
-                }
-
-                close(pc->_socket);
-                pc->OnClose();
-                _connections.erase(pc);
-                delete pc;
-            } else if (pc->_event.events != old_mask) {
-                if (epoll_ctl(epoll_descr, EPOLL_CTL_MOD, pc->_socket, &pc->_event)) {
-                    _logger->error("Failed to change connection event mask");
-
-                    close(pc->_socket);
-                    pc->OnClose();
-                    _connections.erase(pc);
-                    delete pc;
-                }
-            }
-        }
-    }
+    close(_server_socket);
     _logger->warn("Acceptor stopped");
 }
 
-void ServerImpl::OnNewConnection(int epoll_descr) {
-    for (;;) {
-        struct sockaddr in_addr;
-        socklen_t in_len;
-
-        // No need to make these sockets non blocking since accept4() takes care of it.
-        in_len = sizeof in_addr;
-        int infd = accept4(_server_socket, &in_addr, &in_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
-        if (infd == -1) {
-            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
-                break; // We have processed all incoming connections.
-            } else {
-                _logger->error("Failed to accept socket");
-                break;
-            }
-        }
-
-        // Print host and service info.
-        char hbuf[NI_MAXHOST], sbuf[NI_MAXSERV];
-        int retval =
-            getnameinfo(&in_addr, in_len, hbuf, sizeof hbuf, sbuf, sizeof sbuf, NI_NUMERICHOST | NI_NUMERICSERV);
-        if (retval == 0) {
-            _logger->info("Accepted connection on descriptor {} (host={}, port={})\n", infd, hbuf, sbuf);
-        }
-
-        // Register the new FD to be monitored by epoll.
-        Connection *pc = new Connection(infd, _logger, pStorage);
-        if (pc == nullptr) {
-            throw std::runtime_error("Failed to allocate connection");
-        }
-
-        // Register connection in worker's epoll
-        pc->Start();
-        if (pc->isAlive()) {
-            if (epoll_ctl(epoll_descr, EPOLL_CTL_ADD, pc->_socket, &pc->_event)) {
-                pc->OnError();
-                delete pc;
-            }
-        }
-
-        _connections.insert(pc);
-    }
-}
-
 } // namespace STnonblock
 } // namespace Network
 } // namespace Afina
@@ -1,10 +1,9 @@
 #ifndef AFINA_NETWORK_ST_NONBLOCKING_SERVER_H
 #define AFINA_NETWORK_ST_NONBLOCKING_SERVER_H
 
-#include <set>
+#include <memory>
 #include <thread>
 
-#include "Connection.h"
 #include <afina/network/Server.h>
 
 namespace spdlog {
@@ -15,8 +14,8 @@ namespace Afina {
 namespace Network {
 namespace STnonblock {
 
-// Forward declaration, see Worker.h
-class Worker;
+// Forward declaration, see Loop.h
+class Loop;
 
 /**
  * # Network resource manager implementation
@@ -38,7 +37,6 @@ public:
 
 protected:
     void OnRun();
-    void OnNewConnection(int);
 
 private:
     // logger to use
@@ -58,7 +56,8 @@ private:
     // IO thread
     std::thread _work_thread;
 
-    std::set<Connection *> _connections;
+    // Runs on the IO thread, owns every connection
+    std::unique_ptr<Loop> _loop;
 };
 
 } // namespace STnonblock
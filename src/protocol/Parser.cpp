@@ -33,6 +33,11 @@ bool Parser::Parse(const char *input, const size_t size, size_t &parsed) {
                 } else if (name == "get" || name == "gets") {
                     state = State::sgKey;
                 } else if (name == "stats") {
+                    // Optional list of groups is parsed the same way as keys of get
+                    if (c == ' ') {
+                        state = State::sgKey;
+                        continue;
+                    }
                     state = State::sLF;
                     continue;
                 } else {
@@ -177,7 +182,7 @@ std::unique_ptr<Execute::Command> Parser::Build(size_t &body_size) const {
     } else if (name == "get") {
         return std::unique_ptr<Execute::Command>(new Execute::Get(keys));
     } else if (name == "stats") {
-        return std::unique_ptr<Execute::Command>(new Execute::Stats());
+        return std::unique_ptr<Execute::Command>(new Execute::Stats(keys));
     } else {
         throw std::runtime_error("Unsupported command");
     }
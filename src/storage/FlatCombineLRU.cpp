@@ -0,0 +1,96 @@
+#include "FlatCombineLRU.h"
+
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
+namespace Afina {
+namespace Backend {
+
+FlatCombineLRU::FlatCombineLRU(size_t max_size, std::shared_ptr<Allocator::Arena> arena)
+    : _lru(max_size, arena),
+      _combine([this](Operation *const *ops, std::size_t count) { Combine(ops, count); },
+               2 * std::max(1u, std::thread::hardware_concurrency())) {}
+
+// See FlatCombineLRU.h
+bool FlatCombineLRU::Put(const std::string &key, const std::string &value) {
+    return Apply(Operation::Type::kPut, &key, &value, nullptr);
+}
+
+// See FlatCombineLRU.h
+bool FlatCombineLRU::PutIfAbsent(const std::string &key, const std::string &value) {
+    return Apply(Operation::Type::kPutIfAbsent, &key, &value, nullptr);
+}
+
+// See FlatCombineLRU.h
+bool FlatCombineLRU::Set(const std::string &key, const std::string &value) {
+    return Apply(Operation::Type::kSet, &key, &value, nullptr);
+}
+
+// See FlatCombineLRU.h
+bool FlatCombineLRU::Delete(const std::string &key) { return Apply(Operation::Type::kDelete, &key, nullptr, nullptr); }
+
+// See FlatCombineLRU.h
+bool FlatCombineLRU::Get(const std::string &key, std::string &value) {
+    return Apply(Operation::Type::kGet, &key, nullptr, &value);
+}
+
+// See FlatCombineLRU.h
+std::string FlatCombineLRU::DumpAllocator() {
+    std::string out;
+    Apply(Operation::Type::kDumpAllocator, nullptr, nullptr, &out);
+    return out;
+}
+
+// See FlatCombineLRU.h
+std::string FlatCombineLRU::DumpCombine() const {
+    uint64_t batches = _combine.Batches(), combined = _combine.Combined();
+
+    std::stringstream out;
+    out << "combine_batches " << batches << "\n";
+    out << "combine_ops " << combined << "\n";
+    out << "combine_avg_batch " << (batches > 0 ? double(combined) / batches : 0);
+    return out.str();
+}
+
+bool FlatCombineLRU::Apply(Operation::Type type, const std::string *key, const std::string *value,
+                           std::string *out) {
+    Operation op{type, key, value, out, false};
+    _combine.Apply(op);
+    return op.result;
+}
+
+void FlatCombineLRU::Combine(Operation *const *ops, std::size_t count) {
+    for (std::size_t i = 0; i < count; i++) {
+        Operation &op = *ops[i];
+        try {
+            switch (op.type) {
+            case Operation::Type::kPut:
+                op.result = _lru.Put(*op.key, *op.value);
+                break;
+            case Operation::Type::kPutIfAbsent:
+                op.result = _lru.PutIfAbsent(*op.key, *op.value);
+                break;
+            case Operation::Type::kSet:
+                op.result = _lru.Set(*op.key, *op.value);
+                break;
+            case Operation::Type::kDelete:
+                op.result = _lru.Delete(*op.key);
+                break;
+            case Operation::Type::kGet:
+                op.result = _lru.Get(*op.key, *op.out);
+                break;
+            case Operation::Type::kDumpAllocator:
+                *op.out = _lru.DumpAllocator();
+                op.result = true;
+                break;
+            }
+        } catch (std::exception &) {
+            // Failure of one request must not leave others of the batch hanging
+            op.result = false;
+        }
+    }
+}
+
+} // namespace Backend
+} // namespace Afina
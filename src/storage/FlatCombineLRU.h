@@ -0,0 +1,73 @@
+#ifndef AFINA_STORAGE_FLAT_COMBINE_LRU_H
+#define AFINA_STORAGE_FLAT_COMBINE_LRU_H
+
+#include <memory>
+#include <string>
+
+#include <afina/concurrency/FlatCombine.h>
+
+#include "SimpleLRU.h"
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # SimpleLRU behind flat combining
+ * Thread safe version of SimpleLRU for high contention: instead of every thread taking the lock,
+ * threads publish their requests and one of them applies the whole batch, see FlatCombine.h
+ */
+class FlatCombineLRU : public Afina::Storage {
+public:
+    explicit FlatCombineLRU(size_t max_size = 1024, std::shared_ptr<Allocator::Arena> arena = nullptr);
+    ~FlatCombineLRU() override = default;
+
+    // see SimpleLRU.h
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // see SimpleLRU.h
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // see SimpleLRU.h
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // see SimpleLRU.h
+    bool Delete(const std::string &key) override;
+
+    // see SimpleLRU.h
+    bool Get(const std::string &key, std::string &value) override;
+
+    // see SimpleLRU.h
+    std::string DumpAllocator();
+
+    // see SimpleLRU.h, counters are read without combining
+    std::string DumpCounters() const { return _lru.DumpCounters(); }
+
+    /**
+     * Combining efficiency, one "name value" pair per line
+     */
+    std::string DumpCombine() const;
+
+private:
+    // Request published by a thread, result is filled by combiner
+    struct Operation {
+        enum class Type { kPut, kPutIfAbsent, kSet, kDelete, kGet, kDumpAllocator };
+
+        Type type;
+        const std::string *key;
+        const std::string *value;
+        std::string *out;
+        bool result;
+    };
+
+    bool Apply(Operation::Type type, const std::string *key, const std::string *value, std::string *out);
+
+    void Combine(Operation *const *ops, std::size_t count);
+
+    SimpleLRU _lru;
+    Concurrency::FlatCombine<Operation> _combine;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_FLAT_COMBINE_LRU_H
@@ -0,0 +1,374 @@
+#include "OptimisticCuckoo.h"
+
+#include <algorithm>
+#include <functional>
+#include <new>
+#include <thread>
+
+namespace Afina {
+namespace Backend {
+
+namespace {
+
+constexpr std::size_t kCacheLine = 64;
+
+std::size_t SizeOf(const std::string &key, const std::string &value) { return key.size() + value.size(); }
+
+} // namespace
+
+OptimisticCuckoo::OptimisticCuckoo(size_t max_size, size_t capacity, Concurrency::EpochDomain &epoch)
+    : _max_size(max_size), _in_use_size(0), _hand(0), _epoch(epoch) {
+    if (capacity == 0) {
+        capacity = max_size / 32;
+    }
+
+    std::size_t buckets = 1;
+    while (buckets * kSlots < capacity) {
+        buckets <<= 1;
+    }
+    _mask = buckets - 1;
+
+    // operator new only guarantees alignment of max_align_t, align buckets by hand
+    _raw = ::operator new(sizeof(Bucket) * buckets + kCacheLine);
+    std::uintptr_t aligned = (reinterpret_cast<std::uintptr_t>(_raw) + kCacheLine - 1) & ~(kCacheLine - 1);
+    _buckets = reinterpret_cast<Bucket *>(aligned);
+    for (std::size_t i = 0; i < buckets; i++) {
+        new (&_buckets[i]) Bucket();
+    }
+}
+
+OptimisticCuckoo::~OptimisticCuckoo() {
+    for (std::size_t i = 0; i <= _mask; i++) {
+        for (auto &item : _buckets[i].items) {
+            delete item.load(std::memory_order_relaxed);
+        }
+        _buckets[i].~Bucket();
+    }
+    ::operator delete(_raw);
+
+    // Replaced entries stay in _epoch until readers are done with them, they don't refer to storage
+}
+
+// See OptimisticCuckoo.h
+bool OptimisticCuckoo::Put(const std::string &key, const std::string &value) { return Store(Mode::kPut, key, value); }
+
+// See OptimisticCuckoo.h
+bool OptimisticCuckoo::PutIfAbsent(const std::string &key, const std::string &value) {
+    return Store(Mode::kPutIfAbsent, key, value);
+}
+
+// See OptimisticCuckoo.h
+bool OptimisticCuckoo::Set(const std::string &key, const std::string &value) { return Store(Mode::kSet, key, value); }
+
+// See OptimisticCuckoo.h
+bool OptimisticCuckoo::Delete(const std::string &key) {
+    Position pos = Locate(key);
+    std::size_t bucket, slot;
+
+    Lock(pos.first, pos.second);
+    Item *item = Find(pos, key, bucket, slot);
+    if (item != nullptr) {
+        _buckets[bucket].items[slot].store(nullptr, std::memory_order_release);
+    }
+    Unlock(pos.first, pos.second);
+
+    if (item == nullptr) {
+        return false;
+    }
+    _in_use_size.fetch_sub(SizeOf(item->key, item->value), std::memory_order_relaxed);
+    _epoch.Retire(item);
+    return true;
+}
+
+// See OptimisticCuckoo.h
+bool OptimisticCuckoo::Get(const std::string &key, std::string &value) {
+    // Keeps entry seen in the index alive until its value is copied
+    Concurrency::EpochDomain::Guard guard(_epoch);
+
+    Position pos = Locate(key);
+    Bucket &first = _buckets[pos.first];
+    Bucket &second = _buckets[pos.second];
+    for (;;) {
+        uint32_t first_version = first.version.load(std::memory_order_acquire);
+        uint32_t second_version = second.version.load(std::memory_order_acquire);
+        if (((first_version | second_version) & 1) != 0) {
+            // Writer is inside, it holds buckets for a few stores only
+            _get_retries.Add();
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::size_t bucket, slot;
+        Item *item = Find(pos, key, bucket, slot);
+
+        // Reads of slots above must complete before versions are checked again
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (first.version.load(std::memory_order_relaxed) != first_version ||
+            second.version.load(std::memory_order_relaxed) != second_version) {
+            _get_retries.Add();
+            continue;
+        }
+
+        if (item == nullptr) {
+            _get_misses.Add();
+            return false;
+        }
+        _get_hits.Add();
+
+        // Entry could have moved since, then bit goes to whoever took the slot, that is harmless
+        auto &ref = _buckets[bucket].refs[slot];
+        if (ref.load(std::memory_order_relaxed) == 0) {
+            ref.store(1, std::memory_order_relaxed);
+        }
+
+        value = item->value;
+        return true;
+    }
+}
+
+// See OptimisticCuckoo.h
+std::string OptimisticCuckoo::DumpCounters() const {
+    return "get_hits " + std::to_string(_get_hits.Sum()) + "\nget_misses " + std::to_string(_get_misses.Sum()) +
+           "\nevictions " + std::to_string(_evictions.Sum()) + "\ndisplacements " +
+           std::to_string(_displacements.Sum()) + "\nget_retries " + std::to_string(_get_retries.Sum());
+}
+
+OptimisticCuckoo::Position OptimisticCuckoo::Locate(const std::string &key) const {
+    std::size_t hash = std::hash<std::string>()(key);
+
+    Position pos;
+    pos.tag = static_cast<uint8_t>(hash >> (8 * sizeof(hash) - 8));
+    pos.first = hash & _mask;
+    pos.second = Alternative(pos.first, pos.tag);
+    return pos;
+}
+
+std::size_t OptimisticCuckoo::Alternative(std::size_t bucket, uint8_t tag) const {
+    // Xor is its own inverse, so either bucket of the entry gives the other one
+    return (bucket ^ ((tag + 1) * 0xc6a4a7935bd1e995ull)) & _mask;
+}
+
+bool OptimisticCuckoo::Store(Mode mode, const std::string &key, const std::string &value) {
+    std::size_t size = SizeOf(key, value);
+    if (size > _max_size) {
+        return false;
+    }
+
+    Position pos = Locate(key);
+    Item *fresh = new Item(key, value);
+    for (;;) {
+        std::size_t bucket, slot;
+        Lock(pos.first, pos.second);
+        Item *old = Find(pos, key, bucket, slot);
+        if ((old == nullptr && mode == Mode::kSet) || (old != nullptr && mode == Mode::kPutIfAbsent)) {
+            Unlock(pos.first, pos.second);
+            delete fresh;
+            return false;
+        }
+
+        // Evict before storing, so that new entry is never pushed out by its own Put. Eviction
+        // locks other buckets, so it has to be done without ours
+        std::size_t freed = old != nullptr ? SizeOf(old->key, old->value) : 0;
+        if (_in_use_size.load(std::memory_order_relaxed) + size > _max_size + freed) {
+            Unlock(pos.first, pos.second);
+            if (!EvictOne()) {
+                // Index is empty, what is in use belongs to concurrent writers
+                std::this_thread::yield();
+            }
+            continue;
+        }
+
+        if (old != nullptr) {
+            _buckets[bucket].items[slot].store(fresh, std::memory_order_release);
+            Unlock(pos.first, pos.second);
+
+            _in_use_size.fetch_add(size - freed, std::memory_order_relaxed);
+            _epoch.Retire(old);
+            return true;
+        }
+
+        for (auto b : {pos.first, pos.second}) {
+            Bucket &target = _buckets[b];
+            for (slot = 0; slot < kSlots; slot++) {
+                if (target.items[slot].load(std::memory_order_relaxed) == nullptr) {
+                    target.tags[slot].store(pos.tag, std::memory_order_relaxed);
+                    target.refs[slot].store(0, std::memory_order_relaxed);
+                    target.items[slot].store(fresh, std::memory_order_release);
+                    Unlock(pos.first, pos.second);
+
+                    _in_use_size.fetch_add(size, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+        }
+        Unlock(pos.first, pos.second);
+
+        // Both buckets are full
+        bool moved;
+        {
+            std::lock_guard<std::mutex> lock(_displace_lock);
+            moved = MakeRoom(pos);
+        }
+        if (!moved && !EvictOne()) {
+            delete fresh;
+            return false;
+        }
+    }
+}
+
+void OptimisticCuckoo::Lock(std::size_t bucket) {
+    auto &version = _buckets[bucket].version;
+    for (;;) {
+        uint32_t current = version.load(std::memory_order_relaxed);
+        if ((current & 1) == 0 &&
+            version.compare_exchange_weak(current, current + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            break;
+        }
+        std::this_thread::yield();
+    }
+
+    // Stores into slots must not become visible before version turns odd
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void OptimisticCuckoo::Unlock(std::size_t bucket) {
+    _buckets[bucket].version.fetch_add(1, std::memory_order_release);
+}
+
+void OptimisticCuckoo::Lock(std::size_t first, std::size_t second) {
+    if (first == second) {
+        Lock(first);
+        return;
+    }
+    Lock(std::min(first, second));
+    Lock(std::max(first, second));
+}
+
+void OptimisticCuckoo::Unlock(std::size_t first, std::size_t second) {
+    Unlock(first);
+    if (first != second) {
+        Unlock(second);
+    }
+}
+
+OptimisticCuckoo::Item *OptimisticCuckoo::Find(const Position &pos, const std::string &key, std::size_t &bucket,
+                                               std::size_t &slot) const {
+    for (auto b : {pos.first, pos.second}) {
+        const Bucket &target = _buckets[b];
+        for (std::size_t s = 0; s < kSlots; s++) {
+            // Tag filters out most of other keys without touching their entries
+            if (target.tags[s].load(std::memory_order_relaxed) != pos.tag) {
+                continue;
+            }
+
+            Item *item = target.items[s].load(std::memory_order_acquire);
+            if (item != nullptr && item->key == key) {
+                bucket = b;
+                slot = s;
+                return item;
+            }
+        }
+    }
+    return nullptr;
+}
+
+bool OptimisticCuckoo::MakeRoom(const Position &pos) {
+    struct Step {
+        std::size_t bucket;
+        std::size_t slot;
+    };
+    Step path[kMaxPath];
+
+    // Random walk, path is searched without locks and every move is validated while done
+    uint64_t seed = (pos.first + 1) * 0x9e3779b97f4a7c15ull;
+    for (auto start : {pos.first, pos.second}) {
+        std::size_t bucket = start;
+        for (std::size_t depth = 0; depth < kMaxPath; depth++) {
+            Bucket &current = _buckets[bucket];
+            for (std::size_t slot = 0; slot < kSlots; slot++) {
+                if (current.items[slot].load(std::memory_order_relaxed) != nullptr) {
+                    continue;
+                }
+
+                // Free slot found, shift entries into it starting from the end of path
+                std::size_t to = bucket, to_slot = slot;
+                for (std::size_t i = depth; i-- > 0;) {
+                    if (!Move(path[i].bucket, path[i].slot, to, to_slot)) {
+                        return false;
+                    }
+                    to = path[i].bucket;
+                    to_slot = path[i].slot;
+                }
+                return true;
+            }
+
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            path[depth].bucket = bucket;
+            path[depth].slot = seed % kSlots;
+            bucket = Alternative(bucket, current.tags[path[depth].slot].load(std::memory_order_relaxed));
+        }
+    }
+    return false;
+}
+
+bool OptimisticCuckoo::Move(std::size_t from, std::size_t from_slot, std::size_t to, std::size_t to_slot) {
+    Bucket &source = _buckets[from];
+    Bucket &target = _buckets[to];
+
+    Lock(from, to);
+    Item *item = source.items[from_slot].load(std::memory_order_relaxed);
+    uint8_t tag = source.tags[from_slot].load(std::memory_order_relaxed);
+    bool valid = item != nullptr && target.items[to_slot].load(std::memory_order_relaxed) == nullptr &&
+                 Alternative(from, tag) == to;
+    if (valid) {
+        target.tags[to_slot].store(tag, std::memory_order_relaxed);
+        target.refs[to_slot].store(source.refs[from_slot].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        target.items[to_slot].store(item, std::memory_order_release);
+        source.items[from_slot].store(nullptr, std::memory_order_release);
+    }
+    Unlock(from, to);
+
+    if (valid) {
+        _displacements.Add();
+    }
+    return valid;
+}
+
+bool OptimisticCuckoo::EvictOne() {
+    // Two passes are enough to clear all reference bits and get back to the first entry
+    std::size_t capacity = Capacity();
+    for (std::size_t i = 0; i <= 2 * capacity; i++) {
+        std::size_t index = _hand.fetch_add(1, std::memory_order_relaxed) % capacity;
+        std::size_t bucket = index / kSlots;
+        std::size_t slot = index % kSlots;
+
+        Bucket &target = _buckets[bucket];
+        if (target.items[slot].load(std::memory_order_relaxed) == nullptr) {
+            continue;
+        }
+        if (target.refs[slot].load(std::memory_order_relaxed) != 0) {
+            target.refs[slot].store(0, std::memory_order_relaxed);
+            continue;
+        }
+
+        Lock(bucket);
+        Item *item = target.items[slot].load(std::memory_order_relaxed);
+        if (item != nullptr) {
+            target.items[slot].store(nullptr, std::memory_order_release);
+        }
+        Unlock(bucket);
+
+        if (item != nullptr) {
+            _in_use_size.fetch_sub(SizeOf(item->key, item->value), std::memory_order_relaxed);
+            _evictions.Add();
+            _epoch.Retire(item);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace Backend
+} // namespace Afina
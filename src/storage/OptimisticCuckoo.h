@@ -0,0 +1,169 @@
+#ifndef AFINA_STORAGE_OPTIMISTIC_CUCKOO_H
+#define AFINA_STORAGE_OPTIMISTIC_CUCKOO_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include <afina/Storage.h>
+#include <afina/concurrency/CoreLocal.h>
+#include <afina/concurrency/Epoch.h>
+
+namespace Afina {
+namespace Backend {
+
+/**
+ * # Cuckoo hash with optimistic readers
+ * Thread safe storage for read mostly load, Get takes no locks and writes nothing shared but a
+ * reference bit (Fan, Andersen, Kaminsky, "MemC3: Compact and Concurrent MemCache with Dumber
+ * Caching and Smarter Hashing").
+ *
+ * Index is an array of buckets with kSlots slots each, key lives in one of two buckets: first one
+ * is chosen by hash and the second one by xor with the hash of the key tag, so entry could be
+ * moved to its other bucket knowing only the tag. When both buckets are full, writer displaces
+ * entries along a cuckoo path to free a slot.
+ *
+ * Every bucket has a version counter, odd while writer holds the bucket. Writers lock both buckets
+ * of the key, so writes to different buckets go in parallel. Reader remembers versions of both
+ * buckets, looks key up and retries if any of them has changed. Entries are immutable, replaced
+ * ones are freed through EpochDomain once no reader could copy them anymore.
+ *
+ * Eviction is CLOCK instead of LRU: Get only sets reference bit of the slot, eviction hand sweeps
+ * slots and takes the first one not referenced since the previous pass.
+ *
+ * Size limit could be exceeded for a moment by concurrent writers, each of them evicts back
+ * under the limit before returning
+ */
+class OptimisticCuckoo : public Afina::Storage {
+public:
+    /**
+     * @param max_size maximum number of bytes of keys and values, as in SimpleLRU
+     * @param capacity number of entries index could hold, max_size / 32 by default. Once index
+     * is full entries are evicted even if there is space left
+     * @param epoch domain replaced entries are retired into. Global one by default, so that threads
+     * reporting Quiescent to it, like network workers, move reclamation forward
+     */
+    explicit OptimisticCuckoo(size_t max_size = 1024, size_t capacity = 0,
+                              Concurrency::EpochDomain &epoch = Concurrency::EpochDomain::Global());
+    ~OptimisticCuckoo() override;
+
+    // see SimpleLRU.h
+    bool Put(const std::string &key, const std::string &value) override;
+
+    // see SimpleLRU.h
+    bool PutIfAbsent(const std::string &key, const std::string &value) override;
+
+    // see SimpleLRU.h
+    bool Set(const std::string &key, const std::string &value) override;
+
+    // see SimpleLRU.h
+    bool Delete(const std::string &key) override;
+
+    /**
+     * see SimpleLRU.h. Lock-free, not wait-free: reader takes no lock, but spins while a writer holds
+     * one of the key buckets and retries for as long as writers keep changing their versions
+     */
+    bool Get(const std::string &key, std::string &value) override;
+
+    /**
+     * Hits, misses, evictions, entries moved by cuckoo displacement and reads repeated because of
+     * concurrent writes, one "name value" pair per line. Safe to call from any thread
+     */
+    std::string DumpCounters() const;
+
+    /**
+     * Number of entries index could hold
+     */
+    std::size_t Capacity() const { return (_mask + 1) * kSlots; }
+
+private:
+    OptimisticCuckoo(const OptimisticCuckoo &) = delete;
+    OptimisticCuckoo &operator=(const OptimisticCuckoo &) = delete;
+
+    static constexpr std::size_t kSlots = 4;
+
+    // Longest cuckoo path tried before evicting
+    static constexpr std::size_t kMaxPath = 128;
+
+    struct Item {
+        Item(const std::string &k, const std::string &v) : key(k), value(v) {}
+
+        const std::string key;
+        const std::string value;
+    };
+
+    // Fits cache line, so reader touches one line per bucket
+    struct alignas(64) Bucket {
+        Bucket() : version(0) {
+            for (std::size_t i = 0; i < kSlots; i++) {
+                tags[i].store(0, std::memory_order_relaxed);
+                refs[i].store(0, std::memory_order_relaxed);
+                items[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        std::atomic<uint32_t> version;
+        std::atomic<uint8_t> tags[kSlots];
+        std::atomic<uint8_t> refs[kSlots];
+        std::atomic<Item *> items[kSlots];
+    };
+
+    // Location of the key in index
+    struct Position {
+        std::size_t first;
+        std::size_t second;
+        uint8_t tag;
+    };
+
+    enum class Mode { kPut, kPutIfAbsent, kSet };
+
+    Position Locate(const std::string &key) const;
+    std::size_t Alternative(std::size_t bucket, uint8_t tag) const;
+
+    bool Store(Mode mode, const std::string &key, const std::string &value);
+
+    // Writer side of version counter, pair is locked in index order to avoid deadlocks
+    void Lock(std::size_t bucket);
+    void Unlock(std::size_t bucket);
+    void Lock(std::size_t first, std::size_t second);
+    void Unlock(std::size_t first, std::size_t second);
+
+    // Finds entry with the key in its buckets, caller must lock them or validate versions after
+    Item *Find(const Position &pos, const std::string &key, std::size_t &bucket, std::size_t &slot) const;
+
+    // Moves entries along a cuckoo path so that one of buckets gets a free slot, no locks held
+    bool MakeRoom(const Position &pos);
+    bool Move(std::size_t from, std::size_t from_slot, std::size_t to, std::size_t to_slot);
+
+    // Removes one entry chosen by CLOCK, false if index is empty
+    bool EvictOne();
+
+    std::size_t _max_size;
+    std::atomic<std::size_t> _in_use_size;
+
+    // Number of buckets minus one, power of two minus one
+    std::size_t _mask;
+    void *_raw;
+    Bucket *_buckets;
+
+    // CLOCK hand, slot index modulo Capacity()
+    std::atomic<std::size_t> _hand;
+
+    // Cuckoo paths are searched by one writer at a time
+    std::mutex _displace_lock;
+
+    Concurrency::CoreCounter _get_hits;
+    Concurrency::CoreCounter _get_misses;
+    Concurrency::CoreCounter _get_retries;
+    Concurrency::CoreCounter _evictions;
+    Concurrency::CoreCounter _displacements;
+
+    // Replaced entries wait here for readers
+    Concurrency::EpochDomain &_epoch;
+};
+
+} // namespace Backend
+} // namespace Afina
+
+#endif // AFINA_STORAGE_OPTIMISTIC_CUCKOO_H
@@ -1,5 +1,9 @@
 #include "SimpleLRU.h"
 
+#include <new>
+
+#include <afina/allocator/Error.h>
+
 namespace Afina {
 namespace Backend {
 
@@ -19,7 +23,12 @@ bool SimpleLRU::Put(const std::string &key, const std::string &value) {
         return SetByIterator(it, value);
     }
 
-    auto *node = new lru_node(key, value);
+    lru_node *node;
+    try {
+        node = NewNode(key, value);
+    } catch (Allocator::AllocError &) {
+        return false;
+    }
     PutToTail(node);
 
     _in_use_size += SizeOf(key, value);
@@ -50,8 +59,10 @@ bool SimpleLRU::Set(const std::string &key, const std::string &value) {
 bool SimpleLRU::Get(const std::string &key, std::string &value) {
     auto it = _lru_index.find(key);
     if (it == _lru_index.end()) {
+        _get_misses.Add();
         return false;
     }
+    _get_hits.Add();
 
     auto &node = it->second.get();
 
@@ -72,7 +83,10 @@ bool SimpleLRU::Delete(const std::string &key) {
     _lru_index.erase(it);
     _in_use_size -= SizeOf(node.key, node.value);
 
-    if (_lru_head.get() == &node) {
+    if (_lru_head.get() == &node && _lru_head->next == nullptr) { // it was last item, head == tail
+        _lru_head.reset();
+        _lru_tail = nullptr;
+    } else if (_lru_head.get() == &node) {
         _lru_head = std::move(_lru_head->next);
         _lru_head->prev = nullptr;
     } else if (_lru_tail == &node) {
@@ -88,8 +102,43 @@ bool SimpleLRU::Delete(const std::string &key) {
     return true;
 }
 
+std::string SimpleLRU::DumpAllocator() const {
+    if (!_pool) {
+        return "allocator heap";
+    }
+    return "allocator arena\n" + _arena->dump() + "\n" + _pool->dump();
+}
+
+std::string SimpleLRU::DumpCounters() const {
+    return "get_hits " + std::to_string(_get_hits.Sum()) + "\nget_misses " + std::to_string(_get_misses.Sum()) +
+           "\nevictions " + std::to_string(_evictions.Sum());
+}
+
 std::size_t SimpleLRU::FreeSize() const { return _max_size - _in_use_size; }
 
+SimpleLRU::lru_node *SimpleLRU::NewNode(const std::string &key, const std::string &value) {
+    if (!_pool) {
+        return new lru_node(key, value, nullptr);
+    }
+
+    void *place = _pool->Alloc();
+    try {
+        return new (place) lru_node(key, value, _pool.get());
+    } catch (...) {
+        _pool->Free(place);
+        throw;
+    }
+}
+
+void SimpleLRU::lru_node_deleter::operator()(lru_node *node) const {
+    if (pool == nullptr) {
+        delete node;
+    } else {
+        node->~lru_node();
+        pool->Free(node);
+    }
+}
+
 bool SimpleLRU::SetByIterator(
     std::map<std::reference_wrapper<const std::string>, std::reference_wrapper<lru_node>>::iterator it,
     const std::string &value) {
@@ -114,7 +163,7 @@ bool SimpleLRU::SetByIterator(
 
 void SimpleLRU::PutToTail(lru_node *node) {
     if (_lru_tail == nullptr) { // empty list
-        _lru_head = std::unique_ptr<lru_node>(node);
+        _lru_head.reset(node);
         _lru_tail = node;
     } else {
         node->prev = _lru_tail;
@@ -158,6 +207,7 @@ void SimpleLRU::DeleteFromHeadForSize(const std::size_t &size) {
         }
 
         _lru_index.erase(_lru_index.find(_lru_head->key));
+        _evictions.Add();
         _in_use_size -= SizeOf(_lru_head->key, _lru_head->value);
 
         if (_lru_head->next == nullptr) { // it was last item, head == tail
@@ -7,6 +7,9 @@
 #include <string>
 
 #include <afina/Storage.h>
+#include <afina/allocator/Arena.h>
+#include <afina/allocator/Mempool.h>
+#include <afina/concurrency/CoreLocal.h>
 
 namespace Afina {
 namespace Backend {
@@ -16,14 +19,27 @@ namespace Backend {
  * That is NOT thread safe implementaiton!!
  */
 class SimpleLRU : public Afina::Storage {
+    struct lru_node;
+
+    // Returns node either back to the arena pool it was allocated from or to the heap
+    struct lru_node_deleter {
+        lru_node_deleter() : pool(nullptr) {}
+        explicit lru_node_deleter(Allocator::Mempool *p) : pool(p) {}
+        void operator()(lru_node *node) const;
+
+        Allocator::Mempool *pool;
+    };
+    using lru_node_ptr = std::unique_ptr<lru_node, lru_node_deleter>;
+
     // LRU cache node
-    using lru_node = struct lru_node {
+    struct lru_node {
         const std::string key;
         std::string value;
         lru_node *prev;
-        std::unique_ptr<lru_node> next;
+        lru_node_ptr next;
 
-        lru_node(const std::string &k, const std::string &v) : prev(nullptr), next(nullptr), key(k), value(v) {}
+        lru_node(const std::string &k, const std::string &v, Allocator::Mempool *pool)
+            : prev(nullptr), next(nullptr, lru_node_deleter(pool)), key(k), value(v) {}
     };
 
     // Maximum number of bytes could be stored in this cache.
@@ -35,16 +51,30 @@ class SimpleLRU : public Afina::Storage {
     // element that wasn't used for longest time.
     //
     // List owns all nodes
-    std::unique_ptr<lru_node> _lru_head;
+    lru_node_ptr _lru_head;
     lru_node *_lru_tail;
 
+    // Arena nodes are allocated from, nodes live on the heap if there is no arena
+    std::shared_ptr<Allocator::Arena> _arena;
+    std::unique_ptr<Allocator::Mempool> _pool;
+
     // Index of nodes from list above, allows fast random access to elements by lru_node#key
     std::map<std::reference_wrapper<const std::string>, std::reference_wrapper<lru_node>, std::less<std::string>>
         _lru_index;
 
+    // Get outcomes and nodes pushed out to free space. Could be read while storage is in use
+    Concurrency::CoreCounter _get_hits;
+    Concurrency::CoreCounter _get_misses;
+    Concurrency::CoreCounter _evictions;
+
 public:
-    explicit SimpleLRU(size_t max_size = 1024)
-        : _max_size(max_size), _in_use_size(0), _lru_head(nullptr), _lru_tail(nullptr) {}
+    explicit SimpleLRU(size_t max_size = 1024, std::shared_ptr<Allocator::Arena> arena = nullptr)
+        : _max_size(max_size), _in_use_size(0), _lru_head(nullptr), _lru_tail(nullptr), _arena(arena) {
+        if (_arena) {
+            _pool.reset(new Allocator::Mempool(*_arena, sizeof(lru_node)));
+        }
+        _lru_head = lru_node_ptr(nullptr, lru_node_deleter(_pool.get()));
+    }
 
     ~SimpleLRU() override {
         _lru_index.clear();
@@ -69,10 +99,21 @@ public:
 
     bool Get(const std::string &key, std::string &value) override;
 
+    /**
+     * State of the memory nodes are allocated from, one "name value" pair per line
+     */
+    std::string DumpAllocator() const;
+
+    /**
+     * Hits, misses and evictions, one "name value" pair per line. Safe to call from any thread
+     */
+    std::string DumpCounters() const;
+
     static std::size_t SizeOf(const std::string &key, const std::string &value) { return key.size() + value.size(); }
 
 private:
     std::size_t FreeSize() const;
+    lru_node *NewNode(const std::string &key, const std::string &value);
     bool
     SetByIterator(std::map<std::reference_wrapper<const std::string>, std::reference_wrapper<lru_node>>::iterator it,
                   const std::string &value);
@@ -17,8 +17,8 @@ namespace Backend {
  */
 class ThreadSafeSimplLRU : public Afina::Storage {
 public:
-    explicit ThreadSafeSimplLRU(size_t max_size = 1024) {
-        _simpleLRU = std::unique_ptr<SimpleLRU>(new SimpleLRU(max_size));
+    explicit ThreadSafeSimplLRU(size_t max_size = 1024, std::shared_ptr<Allocator::Arena> arena = nullptr) {
+        _simpleLRU = std::unique_ptr<SimpleLRU>(new SimpleLRU(max_size, arena));
     }
     ~ThreadSafeSimplLRU() override = default;
 
@@ -52,6 +52,15 @@ public:
         return _simpleLRU->Get(key, value);
     }
 
+    // see SimpleLRU.h
+    std::string DumpAllocator() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return _simpleLRU->DumpAllocator();
+    }
+
+    // see SimpleLRU.h, counters need no lock
+    std::string DumpCounters() const { return _simpleLRU->DumpCounters(); }
+
 private:
     std::mutex mutex;
     std::unique_ptr<SimpleLRU> _simpleLRU;
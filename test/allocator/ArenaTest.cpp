@@ -0,0 +1,124 @@
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+
+#include <afina/allocator/Arena.h>
+#include <afina/allocator/Error.h>
+#include <afina/allocator/Mempool.h>
+#include <afina/allocator/Stats.h>
+
+using namespace Afina::Allocator;
+
+const std::size_t kSlab = 64 * 1024;
+
+TEST(ArenaTest, SlabsAligned) {
+    Arena arena(4 * kSlab, kSlab);
+    EXPECT_EQ(4 * kSlab, arena.Size());
+
+    void *s1 = arena.AllocSlab();
+    void *s2 = arena.AllocSlab();
+    EXPECT_NE(s1, s2);
+    EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(s1) % kSlab);
+    EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(s2) % kSlab);
+    EXPECT_EQ(2, arena.UsedSlabs());
+
+    arena.FreeSlab(s1);
+    arena.FreeSlab(s2);
+    EXPECT_EQ(0, arena.UsedSlabs());
+}
+
+TEST(ArenaTest, Exhausted) {
+    Arena arena(2 * kSlab, kSlab);
+    void *s1 = arena.AllocSlab();
+    void *s2 = arena.AllocSlab();
+    EXPECT_THROW(arena.AllocSlab(), AllocError);
+
+    // Released slab could be handed out again
+    arena.FreeSlab(s1);
+    EXPECT_EQ(s1, arena.AllocSlab());
+
+    arena.FreeSlab(s1);
+    arena.FreeSlab(s2);
+}
+
+TEST(ArenaTest, Stats) {
+    Arena arena(4 * kSlab, kSlab);
+    void *s = arena.AllocSlab();
+
+    Stats stats = arena.stats();
+    EXPECT_EQ(4 * kSlab, stats.total_bytes);
+    EXPECT_EQ(kSlab, stats.used_bytes);
+    EXPECT_EQ(3 * kSlab, stats.free_bytes);
+    EXPECT_EQ(kSlab, stats.largest_free);
+    EXPECT_EQ(3 * kSlab, stats.free_by_class[kSlab]);
+    EXPECT_EQ(1, stats.allocs);
+    EXPECT_EQ(0, stats.frees);
+    EXPECT_EQ(0, stats.external_fragmentation);
+
+    arena.FreeSlab(s);
+    stats = arena.stats();
+    EXPECT_EQ(4 * kSlab, stats.free_bytes);
+    EXPECT_EQ(1, stats.frees);
+}
+
+TEST(ArenaTest, NumaInterleave) {
+    // Single node machine accepts interleave over node 0, kernel without NUMA keeps default policy
+    Arena arena(4 * kSlab, kSlab, Arena::HugePages::None, true, {0});
+    char *slab = static_cast<char *>(arena.AllocSlab());
+    slab[0] = 1;
+    slab[kSlab - 1] = 1;
+
+    std::string dump = arena.dump();
+    EXPECT_TRUE(dump.find("arena_numa_interleave 1\n") != std::string::npos ||
+                dump.find("arena_numa_interleave 0\n") != std::string::npos);
+    arena.FreeSlab(slab);
+}
+
+TEST(MempoolTest, AllocFree) {
+    Arena arena(4 * kSlab, kSlab);
+    Mempool pool(arena, 100);
+    EXPECT_GE(pool.ItemSize(), 100);
+
+    std::vector<void *> items;
+    for (int i = 0; i < 1000; i++) {
+        char *p = static_cast<char *>(pool.Alloc());
+        p[0] = p[99] = char(i);
+        items.push_back(p);
+    }
+    EXPECT_GT(arena.UsedSlabs(), 1);
+
+    for (std::size_t i = 0; i < items.size(); i++) {
+        EXPECT_EQ(char(i), static_cast<char *>(items[i])[99]);
+        pool.Free(items[i]);
+    }
+
+    // Empty slabs go back to the arena
+    EXPECT_EQ(0, arena.UsedSlabs());
+}
+
+TEST(MempoolTest, Stats) {
+    Arena arena(4 * kSlab, kSlab);
+    Mempool pool(arena, 100);
+
+    void *p1 = pool.Alloc();
+    void *p2 = pool.Alloc();
+
+    Stats stats = pool.stats();
+    EXPECT_EQ(kSlab, stats.total_bytes);
+    EXPECT_EQ(200, stats.live_bytes);
+    EXPECT_EQ(pool.ItemSize(), stats.largest_free);
+    EXPECT_EQ(stats.total_bytes, stats.used_bytes + stats.free_bytes);
+    EXPECT_GT(stats.internal_fragmentation, 0);
+    EXPECT_GT(stats.external_fragmentation, 0.9);
+    EXPECT_EQ(2, stats.allocs);
+
+    pool.Free(p1);
+    stats = pool.stats();
+    EXPECT_EQ(100, stats.live_bytes);
+    EXPECT_EQ(1, stats.frees);
+
+    pool.Free(p2);
+    stats = pool.stats();
+    EXPECT_EQ(0, stats.total_bytes);
+    EXPECT_EQ(0, stats.external_fragmentation);
+}
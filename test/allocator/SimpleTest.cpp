@@ -6,6 +6,7 @@
 #include <afina/allocator/Error.h>
 #include <afina/allocator/Pointer.h>
 #include <afina/allocator/Simple.h>
+#include <afina/allocator/Stats.h>
 
 using namespace std;
 using namespace Afina::Allocator;
@@ -322,3 +323,41 @@ TEST(SimpleTest, ReallocGrow) {
     a.free(p);
     a.free(p2);
 }
+
+TEST(SimpleTest, StatsLiveAndFree) {
+    Simple a(buf, sizeof(buf));
+
+    Stats empty = a.stats();
+    EXPECT_EQ(sizeof(buf), empty.total_bytes);
+    EXPECT_EQ(0, empty.live_bytes);
+    EXPECT_EQ(empty.free_bytes, empty.largest_free);
+    EXPECT_EQ(0, empty.external_fragmentation);
+
+    Pointer p1 = a.alloc(100);
+    Pointer p2 = a.alloc(101);
+    Pointer p3 = a.alloc(100);
+
+    Stats used = a.stats();
+    EXPECT_EQ(301, used.live_bytes);
+    EXPECT_GT(used.used_bytes, used.live_bytes);
+    EXPECT_GT(used.internal_fragmentation, 0);
+    EXPECT_EQ(3, used.allocs);
+    EXPECT_LT(used.free_bytes, empty.free_bytes);
+
+    // Hole in the middle makes free space fragmented
+    a.free(p2);
+    Stats holed = a.stats();
+    EXPECT_EQ(200, holed.live_bytes);
+    EXPECT_EQ(1, holed.frees);
+    EXPECT_GT(holed.external_fragmentation, 0);
+    EXPECT_GE(holed.free_by_class[128], 104);
+
+    a.defrag();
+    Stats compact = a.stats();
+    EXPECT_EQ(0, compact.external_fragmentation);
+    EXPECT_EQ(compact.free_bytes, compact.largest_free);
+    EXPECT_FALSE(a.dump().empty());
+
+    a.free(p1);
+    a.free(p3);
+}
@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/ChaseLevDeque.h>
+
+using namespace Afina::Concurrency;
+
+TEST(ChaseLevDequeTest, OwnerLIFO) {
+    ChaseLevDeque<int> deque(4);
+
+    int item;
+    EXPECT_FALSE(deque.Pop(item));
+    EXPECT_TRUE(deque.Empty());
+
+    // Goes over initial capacity, so buffer grows
+    for (int i = 0; i < 100; i++) {
+        deque.Push(i);
+    }
+    for (int i = 99; i >= 0; i--) {
+        ASSERT_TRUE(deque.Pop(item));
+        EXPECT_EQ(i, item);
+    }
+    EXPECT_FALSE(deque.Pop(item));
+}
+
+TEST(ChaseLevDequeTest, StealFIFO) {
+    ChaseLevDeque<int> deque(4);
+    for (int i = 0; i < 10; i++) {
+        deque.Push(i);
+    }
+
+    int item;
+    ASSERT_TRUE(deque.Steal(item));
+    EXPECT_EQ(0, item);
+    ASSERT_TRUE(deque.Pop(item));
+    EXPECT_EQ(9, item);
+    ASSERT_TRUE(deque.Steal(item));
+    EXPECT_EQ(1, item);
+}
+
+TEST(ChaseLevDequeTest, ConcurrentSteal) {
+    const int items = 200000;
+    const int thieves = 3;
+
+    ChaseLevDeque<int> deque(16);
+    std::vector<std::atomic<int>> seen(items);
+    for (auto &s : seen) {
+        s.store(0);
+    }
+
+    std::atomic<bool> done(false);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thieves; i++) {
+        threads.emplace_back([&]() {
+            int item;
+            while (!done.load() || !deque.Empty()) {
+                if (deque.Steal(item)) {
+                    seen[item]++;
+                }
+            }
+        });
+    }
+
+    // Owner mixes pushes with pops, so races on the last item happen often
+    int item;
+    for (int i = 0; i < items; i++) {
+        deque.Push(i);
+        if (i % 3 == 0 && deque.Pop(item)) {
+            seen[item]++;
+        }
+    }
+    while (deque.Pop(item)) {
+        seen[item]++;
+    }
+
+    done.store(true);
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    // Every item is taken exactly once
+    for (int i = 0; i < items; i++) {
+        ASSERT_EQ(1, seen[i].load()) << "item " << i;
+    }
+}
@@ -0,0 +1,51 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/CoreLocal.h>
+
+using namespace Afina::Concurrency;
+
+TEST(CoreLocalTest, CurrentCpu) {
+    // Thread could migrate between calls, so only range is checked
+    EXPECT_LT(detail::CurrentCpu(), unsigned(sysconf(_SC_NPROCESSORS_CONF)));
+}
+
+TEST(CoreLocalTest, SlotsOnSeparateLines) {
+    CoreLocal<int> local(7);
+    ASSERT_GE(local.Size(), 1);
+
+    int sum = local.Aggregate(0, [](int sum, const int &v) { return sum + v; });
+    EXPECT_EQ(7 * int(local.Size()), sum);
+
+    for (std::size_t i = 0; i < local.Size(); i++) {
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(&local.At(i)) % CoreLocal<int>::kCacheLine);
+    }
+
+    local.Local() = 1;
+    std::size_t visited = 0;
+    local.ForEach([&visited](const int &) { visited++; });
+    EXPECT_EQ(local.Size(), visited);
+}
+
+TEST(CoreLocalTest, CounterConcurrent) {
+    const int threads = 8;
+    const int ops = 100000;
+
+    CoreCounter counter;
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&counter]() {
+            for (int i = 0; i < ops; i++) {
+                counter.Add();
+            }
+        });
+    }
+    for (auto &t : pool) {
+        t.join();
+    }
+
+    EXPECT_EQ(uint64_t(threads) * ops, counter.Sum());
+}
@@ -0,0 +1,349 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/Executor.h>
+
+using namespace Afina::Concurrency;
+
+namespace {
+
+void Await(const std::atomic<int> &counter, int value) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (counter.load() < value && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+} // namespace
+
+TEST(ExecutorTest, RunsAllTasks) {
+    std::atomic<int> done(0);
+    {
+        Executor executor(2, 4, 1024, std::chrono::milliseconds(100));
+        for (int i = 0; i < 10000; i++) {
+            while (!executor.Execute([&done](int add) { done += add; }, 1)) {
+                std::this_thread::yield();
+            }
+        }
+        Await(done, 10000);
+    }
+    EXPECT_EQ(10000, done.load());
+}
+
+TEST(ExecutorTest, FIFO) {
+    std::mutex mutex;
+    std::vector<int> order;
+    Executor executor(1, 1, 100, std::chrono::milliseconds(100));
+
+    for (int i = 0; i < 50; i++) {
+        ASSERT_TRUE(executor.Execute(
+            [&](int n) {
+                std::lock_guard<std::mutex> lock(mutex);
+                order.push_back(n);
+            },
+            i));
+    }
+    executor.Stop(true);
+
+    ASSERT_EQ(50, order.size());
+    for (int i = 0; i < 50; i++) {
+        EXPECT_EQ(i, order[i]);
+    }
+}
+
+TEST(ExecutorTest, RejectsEmptyQueue) {
+    EXPECT_THROW(Executor(1, 1, 0, std::chrono::milliseconds(100)), std::invalid_argument);
+    EXPECT_THROW(Executor(1, 1, -1, std::chrono::milliseconds(100)), std::invalid_argument);
+}
+
+TEST(ExecutorTest, QueueLimit) {
+    std::atomic<int> started(0);
+    std::atomic<bool> release(false);
+    Executor executor(1, 1, 2, std::chrono::milliseconds(100));
+
+    auto blocker = [&]() {
+        started++;
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    };
+    ASSERT_TRUE(executor.Execute(blocker));
+    Await(started, 1);
+
+    // Single worker is busy, queue takes two more tasks only
+    EXPECT_TRUE(executor.Execute(blocker));
+    EXPECT_TRUE(executor.Execute(blocker));
+    EXPECT_FALSE(executor.Execute(blocker));
+
+    release.store(true);
+    executor.Stop(true);
+    EXPECT_EQ(3, started.load());
+}
+
+TEST(ExecutorTest, QueueLimitAcrossPriorities) {
+    std::atomic<int> started(0);
+    std::atomic<bool> release(false);
+    Executor executor(1, 1, 4, std::chrono::milliseconds(100));
+
+    auto blocker = [&]() {
+        started++;
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    };
+    ASSERT_TRUE(executor.Execute(blocker));
+    Await(started, 1);
+
+    // Bound is shared by all priorities: four tasks fit whatever their priorities are
+    const Executor::Priority priorities[] = {Executor::Priority::kHigh, Executor::Priority::kNormal,
+                                             Executor::Priority::kLow};
+    int accepted = 0, rejected = 0;
+    for (int i = 0; i < 12; i++) {
+        if (executor.Execute(Executor::Options(priorities[i % 3]), blocker)) {
+            accepted++;
+        } else {
+            rejected++;
+        }
+    }
+    EXPECT_EQ(4, accepted);
+    EXPECT_EQ(8, rejected);
+
+    release.store(true);
+    executor.Stop(true);
+    EXPECT_EQ(5, started.load());
+}
+
+TEST(ExecutorTest, StopCompletesQueued) {
+    std::atomic<int> done(0);
+    Executor executor(1, 2, 1000, std::chrono::milliseconds(100));
+    for (int i = 0; i < 500; i++) {
+        ASSERT_TRUE(executor.Execute([&done]() {
+            std::this_thread::sleep_for(std::chrono::microseconds(10));
+            done++;
+        }));
+    }
+
+    executor.Stop(true);
+    EXPECT_EQ(500, done.load());
+    EXPECT_FALSE(executor.Execute([]() {}));
+}
+
+TEST(ExecutorTest, IdleWorkersRetire) {
+    std::atomic<int> done(0);
+    Executor executor(0, 4, 1000, std::chrono::milliseconds(10));
+
+    ASSERT_TRUE(executor.Execute([&done]() { done++; }));
+    Await(done, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    ASSERT_TRUE(executor.Execute([&done]() { done++; }));
+    Await(done, 2);
+    EXPECT_EQ(2, done.load());
+}
+
+TEST(ExecutorTest, CompletedCount) {
+    Executor executor(2, 4, 1024, std::chrono::milliseconds(10));
+    for (int i = 0; i < 1000; i++) {
+        while (!executor.Execute([]() {})) {
+            std::this_thread::yield();
+        }
+    }
+
+    EXPECT_LE(executor.CompletedPerThread().size(), 4);
+    executor.Stop(true);
+
+    // Every thread has handed its count over before exit
+    EXPECT_EQ(1000, executor.Completed());
+}
+
+TEST(ExecutorTest, Submit) {
+    Executor executor(1, 2, 16, std::chrono::milliseconds(100));
+
+    auto length = executor.Submit([](const std::string &s) { return s.size(); }, std::string("four"));
+    auto failed = executor.Submit([]() -> int { throw std::runtime_error("task failed"); });
+    auto nothing = executor.Submit([]() {});
+    ASSERT_TRUE(length.Valid());
+    ASSERT_TRUE(failed.Valid());
+    ASSERT_TRUE(nothing.Valid());
+
+    EXPECT_EQ(4, length.Get());
+    EXPECT_THROW(failed.Get(), std::runtime_error);
+    nothing.Get();
+
+    executor.Stop(true);
+    EXPECT_FALSE(executor.Submit([]() { return 1; }).Valid());
+}
+
+TEST(ExecutorTest, SubmitBatch) {
+    const std::size_t shards = 8;
+    std::vector<int> data(shards * 100);
+    for (std::size_t i = 0; i < data.size(); i++) {
+        data[i] = int(i);
+    }
+
+    Executor executor(0, 4, 64, std::chrono::milliseconds(100));
+    auto futures = executor.SubmitBatch(shards, [&data](std::size_t shard) {
+        long sum = 0;
+        for (std::size_t i = shard * 100; i < (shard + 1) * 100; i++) {
+            sum += data[i];
+        }
+        return sum;
+    });
+    ASSERT_EQ(shards, futures.size());
+
+    std::vector<long> sums = WhenAll(std::move(futures)).Get();
+    ASSERT_EQ(shards, sums.size());
+    for (std::size_t shard = 0; shard < shards; shard++) {
+        EXPECT_EQ(long(shard * 100 * 100 + 99 * 100 / 2), sums[shard]);
+    }
+    EXPECT_LE(executor.CompletedPerThread().size(), 4);
+}
+
+TEST(ExecutorTest, SubmitBatchAllOrNothing) {
+    std::atomic<bool> release(false);
+    std::atomic<int> started(0);
+    Executor executor(1, 1, 4, std::chrono::milliseconds(100));
+
+    ASSERT_TRUE(executor.Execute([&]() {
+        started++;
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    }));
+    Await(started, 1);
+
+    // Queue has 4 slots while the only worker is busy
+    std::atomic<int> done(0);
+    EXPECT_TRUE(executor.SubmitBatch(5, [&done](std::size_t) { done++; }).empty());
+    auto accepted = executor.SubmitBatch(4, [&done](std::size_t) { done++; });
+    EXPECT_EQ(4, accepted.size());
+
+    release.store(true);
+    WhenAll(std::move(accepted)).Get();
+    EXPECT_EQ(4, done.load());
+}
+
+TEST(ExecutorTest, Stats) {
+    std::atomic<bool> release(false);
+    std::atomic<int> started(0);
+    Executor executor(1, 1, 2, std::chrono::milliseconds(100));
+
+    ASSERT_TRUE(executor.Execute([&]() {
+        started++;
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    }));
+    Await(started, 1);
+    ASSERT_TRUE(executor.Execute([]() {}));
+    ASSERT_TRUE(executor.Execute([]() {}));
+    EXPECT_FALSE(executor.Execute([]() {}));
+
+    std::string stats = executor.DumpStats("pool_");
+    EXPECT_NE(std::string::npos, stats.find("pool_threads 1\n"));
+    EXPECT_NE(std::string::npos, stats.find("pool_threads_active 1\n"));
+    EXPECT_NE(std::string::npos, stats.find("pool_threads_spawned 1\n"));
+    EXPECT_NE(std::string::npos, stats.find("pool_tasks_rejected 1"));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    release.store(true);
+    executor.Stop(true);
+
+    // Two short tasks waited behind the blocker for 20ms at least
+    stats = executor.DumpStats();
+    EXPECT_NE(std::string::npos, stats.find("tasks_completed 3\n"));
+    auto wait = stats.find("queue_wait_us_max ");
+    ASSERT_NE(std::string::npos, wait);
+    EXPECT_GE(std::stod(stats.substr(wait + 18)), 20000);
+    auto run = stats.find("run_us_max ");
+    ASSERT_NE(std::string::npos, run);
+    EXPECT_GE(std::stod(stats.substr(run + 11)), 20000);
+}
+
+TEST(ExecutorTest, WeightedPriorities) {
+    std::atomic<bool> release(false);
+    std::atomic<int> started(0);
+    Executor executor(1, 1, 128, std::chrono::milliseconds(100), {{8, 4, 1}});
+
+    ASSERT_TRUE(executor.Execute([&]() {
+        started++;
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    }));
+    Await(started, 1);
+
+    std::mutex mutex;
+    std::vector<Executor::Priority> order;
+    const Executor::Priority priorities[] = {Executor::Priority::kLow, Executor::Priority::kNormal,
+                                             Executor::Priority::kHigh};
+    for (auto priority : priorities) {
+        for (int i = 0; i < 26; i++) {
+            ASSERT_TRUE(executor.Execute(Executor::Options(priority), [&, priority]() {
+                std::lock_guard<std::mutex> lock(mutex);
+                order.push_back(priority);
+            }));
+        }
+    }
+    release.store(true);
+    executor.Stop(true);
+
+    // Every round of 13 tasks taken while all queues are busy follows the weights
+    ASSERT_EQ(78, order.size());
+    for (int round = 0; round < 2; round++) {
+        int counts[Executor::kPriorities] = {0};
+        for (int i = round * 13; i < (round + 1) * 13; i++) {
+            counts[static_cast<int>(order[i])]++;
+        }
+        EXPECT_EQ(8, counts[0]);
+        EXPECT_EQ(4, counts[1]);
+        EXPECT_EQ(1, counts[2]);
+    }
+
+    // Low priority tasks are not left for the end
+    int low_in_first_half = 0;
+    for (int i = 0; i < 39; i++) {
+        low_in_first_half += order[i] == Executor::Priority::kLow;
+    }
+    EXPECT_GE(low_in_first_half, 3);
+}
+
+TEST(ExecutorTest, Deadline) {
+    std::atomic<bool> release(false);
+    std::atomic<int> started(0);
+    Executor executor(1, 1, 16, std::chrono::milliseconds(100));
+
+    ASSERT_TRUE(executor.Execute([&]() {
+        started++;
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    }));
+    Await(started, 1);
+
+    std::atomic<int> ran(0), expired(0);
+    auto soon = Executor::Clock::now() + std::chrono::milliseconds(5);
+    auto later = Executor::Clock::now() + std::chrono::minutes(1);
+    ASSERT_TRUE(executor.Execute(Executor::Options(Executor::Priority::kHigh, soon, [&expired]() { expired++; }),
+                                 [&ran]() { ran++; }));
+    auto dropped = executor.Submit(Executor::Options(Executor::Priority::kNormal, soon), []() { return 1; });
+    auto kept = executor.Submit(Executor::Options(Executor::Priority::kLow, later), []() { return 2; });
+    ASSERT_TRUE(dropped.Valid());
+    ASSERT_TRUE(kept.Valid());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    release.store(true);
+
+    EXPECT_EQ(2, kept.Get());
+    EXPECT_THROW(dropped.Get(), std::future_error);
+    executor.Stop(true);
+    EXPECT_EQ(0, ran.load());
+    EXPECT_EQ(1, expired.load());
+    EXPECT_NE(std::string::npos, executor.DumpStats().find("tasks_expired 2\n"));
+}
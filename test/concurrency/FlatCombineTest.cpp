@@ -0,0 +1,73 @@
+#include "gtest/gtest.h"
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/FlatCombine.h>
+
+using namespace Afina::Concurrency;
+
+namespace {
+
+struct Increment {
+    int add;
+    long result;
+};
+
+} // namespace
+
+TEST(FlatCombineTest, SingleThread) {
+    long counter = 0;
+    FlatCombine<Increment> combine([&counter](Increment *const *ops, std::size_t count) {
+        for (std::size_t i = 0; i < count; i++) {
+            counter += ops[i]->add;
+            ops[i]->result = counter;
+        }
+    });
+
+    Increment op{5, 0};
+    combine.Apply(op);
+    EXPECT_EQ(5, op.result);
+    EXPECT_EQ(1, combine.Batches());
+    EXPECT_EQ(1, combine.Combined());
+}
+
+TEST(FlatCombineTest, ConcurrentApply) {
+    const int threads = 8;
+    const int ops = 20000;
+
+    // Not synchronized on purpose, combiner role is the only protection
+    long counter = 0;
+    FlatCombine<Increment> combine(
+        [&counter](Increment *const *batch, std::size_t count) {
+            for (std::size_t i = 0; i < count; i++) {
+                counter += batch[i]->add;
+                batch[i]->result = counter;
+            }
+        },
+        4);
+
+    std::vector<std::thread> pool;
+    std::vector<bool> monotonic(threads, true);
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&, t]() {
+            long last = 0;
+            for (int i = 0; i < ops; i++) {
+                Increment op{1, 0};
+                combine.Apply(op);
+                if (op.result <= last) {
+                    monotonic[t] = false;
+                }
+                last = op.result;
+            }
+        });
+    }
+    for (auto &t : pool) {
+        t.join();
+    }
+
+    EXPECT_EQ(long(threads) * ops, counter);
+    EXPECT_EQ(uint64_t(threads) * ops, combine.Combined());
+    for (int t = 0; t < threads; t++) {
+        EXPECT_TRUE(monotonic[t]);
+    }
+}
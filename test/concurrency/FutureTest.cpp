@@ -0,0 +1,128 @@
+#include "gtest/gtest.h"
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/Future.h>
+
+using namespace Afina::Concurrency;
+
+TEST(FutureTest, ValueFromOtherThread) {
+    Promise<std::string> promise;
+    Future<std::string> future = promise.GetFuture();
+    EXPECT_TRUE(future.Valid());
+    EXPECT_FALSE(future.Ready());
+    EXPECT_FALSE(future.WaitFor(std::chrono::milliseconds(10)));
+
+    std::thread producer([&promise]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        promise.SetValue("done");
+    });
+    EXPECT_EQ("done", future.Get());
+    EXPECT_FALSE(future.Valid());
+    producer.join();
+}
+
+TEST(FutureTest, MoveOnlyValue) {
+    Promise<std::unique_ptr<int>> promise;
+    Future<std::unique_ptr<int>> future = promise.GetFuture();
+    promise.SetValue(new int(42));
+
+    EXPECT_TRUE(future.Ready());
+    EXPECT_EQ(42, *future.Get());
+}
+
+TEST(FutureTest, Exception) {
+    Promise<int> promise;
+    Future<int> future = promise.GetFuture();
+    EXPECT_THROW(promise.GetFuture(), std::future_error);
+
+    promise.SetException(std::make_exception_ptr(std::runtime_error("failed")));
+    EXPECT_THROW(future.Get(), std::runtime_error);
+}
+
+TEST(FutureTest, BrokenPromise) {
+    Future<void> future;
+    EXPECT_FALSE(future.Valid());
+    {
+        Promise<void> promise;
+        future = promise.GetFuture();
+    }
+
+    try {
+        future.Get();
+        FAIL() << "broken promise must throw";
+    } catch (std::future_error &e) {
+        EXPECT_EQ(std::future_errc::broken_promise, e.code());
+    }
+}
+
+TEST(FutureTest, OnReadyBeforeAndAfter) {
+    int calls = 0;
+
+    Promise<int> pending;
+    Future<int> later = pending.GetFuture();
+    later.OnReady([&calls]() { calls++; });
+    EXPECT_EQ(0, calls);
+    pending.SetValue(1);
+    EXPECT_EQ(1, calls);
+
+    Promise<int> done;
+    Future<int> ready = done.GetFuture();
+    done.SetValue(2);
+    ready.OnReady([&calls]() { calls++; });
+    EXPECT_EQ(2, calls);
+    EXPECT_EQ(2, ready.Get());
+}
+
+TEST(FutureTest, WhenAll) {
+    const int count = 16;
+    std::vector<Promise<int>> promises(count);
+    std::vector<Future<int>> futures;
+    for (auto &promise : promises) {
+        futures.push_back(promise.GetFuture());
+    }
+    Future<std::vector<int>> all = WhenAll(std::move(futures));
+
+    // Completed in reverse order from different threads, results keep the order of futures
+    std::vector<std::thread> threads;
+    for (int i = count - 1; i >= 0; i--) {
+        threads.emplace_back([&promises, i]() { promises[i].SetValue(i * i); });
+        EXPECT_FALSE(all.Ready() && i > 0);
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    std::vector<int> result = all.Get();
+    ASSERT_EQ(count, result.size());
+    for (int i = 0; i < count; i++) {
+        EXPECT_EQ(i * i, result[i]);
+    }
+}
+
+TEST(FutureTest, WhenAllFirstException) {
+    Promise<void> first, second, third;
+    std::vector<Future<void>> futures;
+    futures.push_back(first.GetFuture());
+    futures.push_back(second.GetFuture());
+    futures.push_back(third.GetFuture());
+    Future<void> all = WhenAll(std::move(futures));
+
+    third.SetException(std::make_exception_ptr(std::logic_error("third")));
+    second.SetException(std::make_exception_ptr(std::runtime_error("second")));
+    EXPECT_FALSE(all.Ready());
+    first.SetValue();
+
+    EXPECT_THROW(all.Get(), std::runtime_error);
+}
+
+TEST(FutureTest, WhenAllEmpty) {
+    Future<std::vector<int>> all = WhenAll(std::vector<Future<int>>());
+    EXPECT_TRUE(all.Ready());
+    EXPECT_TRUE(all.Get().empty());
+}
@@ -0,0 +1,58 @@
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/Histogram.h>
+
+using namespace Afina::Concurrency;
+
+TEST(HistogramTest, Buckets) {
+    // Every value falls into a bucket whose bound is not below it and at most 25% above
+    for (uint64_t value : {0ull, 1ull, 7ull, 8ull, 9ull, 15ull, 16ull, 1000ull, 123456789ull, ~0ull}) {
+        std::size_t bucket = Histogram::BucketOf(value);
+        ASSERT_LT(bucket, std::size_t(Histogram::kBuckets));
+        EXPECT_GE(Histogram::UpperBound(bucket), value);
+        EXPECT_LE(Histogram::UpperBound(bucket) - value, value / Histogram::kSubBuckets);
+        if (bucket > 0) {
+            EXPECT_LT(Histogram::UpperBound(bucket - 1), value);
+        }
+    }
+    EXPECT_EQ(std::size_t(Histogram::kBuckets - 1), Histogram::BucketOf(~0ull));
+}
+
+TEST(HistogramTest, Percentiles) {
+    Histogram histogram;
+    for (uint64_t value = 1; value <= 1000; value++) {
+        histogram.Record(value);
+    }
+
+    auto snapshot = histogram.Take();
+    EXPECT_EQ(1000, snapshot.count);
+    EXPECT_EQ(1000, snapshot.max);
+    EXPECT_DOUBLE_EQ(500.5, snapshot.Mean());
+    EXPECT_GE(snapshot.Percentile(0.5), 500);
+    EXPECT_LE(snapshot.Percentile(0.5), 500 * 5 / 4);
+    EXPECT_GE(snapshot.Percentile(0.99), 990);
+    EXPECT_EQ(1000, snapshot.Percentile(1));
+}
+
+TEST(HistogramTest, Concurrent) {
+    Histogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&histogram]() {
+            for (int i = 0; i < 10000; i++) {
+                histogram.Record(i % 100);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    auto snapshot = histogram.Take();
+    EXPECT_EQ(40000, snapshot.count);
+    EXPECT_EQ(99, snapshot.max);
+    EXPECT_EQ(4 * 100 * 4950, snapshot.sum);
+}
@@ -0,0 +1,127 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/MPMCQueue.h>
+
+using namespace Afina::Concurrency;
+
+TEST(MPMCQueueTest, FIFO) {
+    MPMCQueue<int> queue(4);
+    EXPECT_EQ(4, queue.Capacity());
+    EXPECT_TRUE(queue.Empty());
+
+    int item;
+    EXPECT_FALSE(queue.TryPop(item));
+
+    // Several laps over the ring
+    for (int lap = 0; lap < 3; lap++) {
+        for (int i = 0; i < 4; i++) {
+            EXPECT_TRUE(queue.TryPush(lap * 10 + i));
+        }
+        EXPECT_FALSE(queue.TryPush(100));
+        EXPECT_EQ(4, queue.SizeApprox());
+
+        for (int i = 0; i < 4; i++) {
+            ASSERT_TRUE(queue.TryPop(item));
+            EXPECT_EQ(lap * 10 + i, item);
+        }
+        EXPECT_FALSE(queue.TryPop(item));
+    }
+}
+
+TEST(MPMCQueueTest, MoveOnlyAndDestroy) {
+    auto counter = std::make_shared<int>(0);
+    {
+        MPMCQueue<std::shared_ptr<int>> queue(8);
+        EXPECT_TRUE(queue.TryPush(counter));
+        EXPECT_TRUE(queue.TryEmplace(counter));
+        EXPECT_EQ(3, counter.use_count());
+
+        std::shared_ptr<int> out;
+        ASSERT_TRUE(queue.TryPop(out));
+        out.reset();
+        EXPECT_EQ(2, counter.use_count());
+    }
+
+    // Elements left in the queue are destroyed with it
+    EXPECT_EQ(1, counter.use_count());
+}
+
+TEST(MPMCQueueTest, PushBulk) {
+    MPMCQueue<int> queue(4);
+    int items[] = {1, 2, 3, 4, 5};
+    int item;
+
+    EXPECT_FALSE(queue.TryPushBulk(items, 5));
+    EXPECT_TRUE(queue.TryPush(0));
+    EXPECT_FALSE(queue.TryPushBulk(items, 4));
+    EXPECT_EQ(1, queue.SizeApprox());
+
+    // Batch wraps around the end of the ring
+    EXPECT_TRUE(queue.TryPushBulk(items, 3));
+    ASSERT_TRUE(queue.TryPop(item));
+    ASSERT_TRUE(queue.TryPop(item));
+    EXPECT_TRUE(queue.TryPushBulk(items + 3, 2));
+    for (int i = 2; i <= 5; i++) {
+        ASSERT_TRUE(queue.TryPop(item));
+        EXPECT_EQ(i, item);
+    }
+    EXPECT_FALSE(queue.TryPop(item));
+}
+
+TEST(MPMCQueueTest, ConcurrentProducersConsumers) {
+    const int producers = 4;
+    const int consumers = 3;
+    const int items = 50000;
+
+    MPMCQueue<int> queue(64);
+    std::vector<std::atomic<int>> seen(producers * items);
+    for (auto &s : seen) {
+        s.store(0);
+    }
+
+    std::atomic<int> consumed(0);
+    std::atomic<bool> ordered(true);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            for (int i = 0; i < items; i++) {
+                while (!queue.TryPush(p * items + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < consumers; c++) {
+        threads.emplace_back([&]() {
+            // Items of the same producer must come in order to every consumer
+            std::vector<int> last(producers, -1);
+            int item;
+            while (consumed.load() < producers * items) {
+                if (!queue.TryPop(item)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                int p = item / items;
+                if (item % items <= last[p]) {
+                    ordered.store(false);
+                }
+                last[p] = item % items;
+                seen[item]++;
+                consumed++;
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    EXPECT_TRUE(ordered.load());
+    for (int i = 0; i < producers * items; i++) {
+        ASSERT_EQ(1, seen[i].load()) << "item " << i;
+    }
+}
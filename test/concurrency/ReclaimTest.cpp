@@ -0,0 +1,335 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/Epoch.h>
+#include <afina/concurrency/HazardPointer.h>
+
+using namespace Afina::Concurrency;
+
+namespace {
+
+const uint32_t kAlive = 0x600df00d;
+const uint32_t kFreed = 0xdeadbeef;
+
+struct Node {
+    explicit Node(int v) : value(v), mark(kAlive), next(nullptr) {}
+
+    int value;
+    std::atomic<uint32_t> mark;
+    Node *next;
+};
+
+// Reclaimed nodes are only marked and kept until the end of test, so access after reclamation
+// shows up as a wrong mark instead of undefined behavior
+std::mutex graves_lock;
+std::vector<Node *> graves;
+
+void Bury(void *ptr) {
+    Node *node = static_cast<Node *>(ptr);
+    node->mark.store(kFreed);
+    std::lock_guard<std::mutex> lock(graves_lock);
+    graves.push_back(node);
+}
+
+void ClearGraves() {
+    std::lock_guard<std::mutex> lock(graves_lock);
+    for (auto node : graves) {
+        delete node;
+    }
+    graves.clear();
+}
+
+// Yields at random points to shake thread interleavings
+void Interleave(uint64_t &seed) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    if ((seed & 7) == 0) {
+        std::this_thread::yield();
+    }
+}
+
+// Treiber stack with nodes reclaimed through epochs
+class EpochStack {
+public:
+    explicit EpochStack(EpochDomain &domain) : _domain(domain), _head(nullptr) {}
+
+    void Push(int value) {
+        Node *node = new Node(value);
+        node->next = _head.load(std::memory_order_relaxed);
+        while (!_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    bool Pop(int &value, uint64_t &seed, std::atomic<int> &corrupted) {
+        EpochDomain::Guard guard(_domain);
+        Node *top = _head.load(std::memory_order_acquire);
+        while (top != nullptr) {
+            Interleave(seed);
+            if (top->mark.load() != kAlive) {
+                corrupted++;
+            }
+            if (_head.compare_exchange_weak(top, top->next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                break;
+            }
+        }
+
+        if (top == nullptr) {
+            return false;
+        }
+        value = top->value;
+        _domain.Retire(top, &Bury);
+        return true;
+    }
+
+    ~EpochStack() {
+        for (Node *node = _head.load(); node != nullptr;) {
+            Node *next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+private:
+    EpochDomain &_domain;
+    std::atomic<Node *> _head;
+};
+
+// Same stack, but readers protect the top with hazard pointer
+class HazardStack {
+public:
+    explicit HazardStack(HazardDomain &domain) : _domain(domain), _head(nullptr) {}
+
+    void Push(int value) {
+        Node *node = new Node(value);
+        node->next = _head.load(std::memory_order_relaxed);
+        while (!_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    bool Pop(int &value, uint64_t &seed, std::atomic<int> &corrupted) {
+        HazardDomain::Holder holder(_domain);
+        for (;;) {
+            Node *top = holder.Protect(_head);
+            if (top == nullptr) {
+                return false;
+            }
+
+            Interleave(seed);
+            if (top->mark.load() != kAlive) {
+                corrupted++;
+            }
+            if (_head.compare_exchange_strong(top, top->next, std::memory_order_acq_rel)) {
+                value = top->value;
+                holder.Reset();
+                _domain.Retire(top, &Bury);
+                return true;
+            }
+        }
+    }
+
+    ~HazardStack() {
+        for (Node *node = _head.load(); node != nullptr;) {
+            Node *next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+private:
+    HazardDomain &_domain;
+    std::atomic<Node *> _head;
+};
+
+template <typename Stack, typename Domain> void Stress(Domain &domain, int &popped, std::atomic<int> &corrupted) {
+    const int threads = 8;
+    const int ops = 20000;
+
+    Stack stack(domain);
+    std::atomic<int> total(0);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&stack, &total, &corrupted, t]() {
+            uint64_t seed = 88172645463325252ull + t;
+            int value;
+            for (int i = 0; i < ops; i++) {
+                stack.Push(i);
+                if (stack.Pop(value, seed, corrupted)) {
+                    total++;
+                }
+            }
+        });
+    }
+    for (auto &t : pool) {
+        t.join();
+    }
+    popped = total.load();
+}
+
+// Keeps reader inside critical section until released
+class Latch {
+public:
+    Latch() : _set(false) {}
+
+    void Set() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _set = true;
+        _cv.notify_all();
+    }
+
+    void Wait() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this]() { return _set; });
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _set;
+};
+
+} // namespace
+
+TEST(EpochTest, ReaderBlocksReclamation) {
+    EpochDomain domain;
+    Latch entered, release;
+
+    std::thread reader([&]() {
+        EpochDomain::Guard guard(domain);
+        entered.Set();
+        release.Wait();
+    });
+    entered.Wait();
+
+    Node *node = new Node(1);
+    domain.Retire(node, &Bury);
+    for (int i = 0; i < 10; i++) {
+        domain.Quiescent();
+    }
+    EXPECT_EQ(kAlive, node->mark.load());
+    EXPECT_EQ(0, domain.Reclaimed());
+
+    release.Set();
+    reader.join();
+    domain.Synchronize();
+    EXPECT_EQ(kFreed, node->mark.load());
+    EXPECT_EQ(1, domain.Reclaimed());
+    ClearGraves();
+}
+
+TEST(EpochTest, QuiescentInsideCriticalSection) {
+    EpochDomain domain;
+    Latch entered, release;
+
+    // Long running loop never leaves critical section but reports quiescent points
+    std::atomic<bool> stop(false);
+    std::thread worker([&]() {
+        domain.Enter();
+        entered.Set();
+        while (!stop.load()) {
+            domain.Quiescent();
+            std::this_thread::yield();
+        }
+        domain.Leave();
+    });
+    entered.Wait();
+
+    Node *node = new Node(1);
+    domain.Retire(node, &Bury);
+    while (domain.Reclaimed() == 0) {
+        domain.Quiescent();
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(kFreed, node->mark.load());
+
+    stop.store(true);
+    worker.join();
+    ClearGraves();
+}
+
+TEST(EpochTest, ExitedThreadLeftovers) {
+    EpochDomain domain;
+    std::thread worker([&domain]() {
+        for (int i = 0; i < 10; i++) {
+            domain.Retire(new Node(i), &Bury);
+        }
+    });
+    worker.join();
+
+    domain.Synchronize();
+    EXPECT_EQ(10, domain.Retired());
+    EXPECT_EQ(10, domain.Reclaimed());
+    ClearGraves();
+}
+
+TEST(EpochTest, Stress) {
+    std::atomic<int> corrupted(0);
+    int popped = 0;
+    {
+        EpochDomain domain;
+        Stress<EpochStack>(domain, popped, corrupted);
+
+        domain.Synchronize();
+        EXPECT_EQ(popped, domain.Retired());
+        EXPECT_EQ(popped, domain.Reclaimed());
+    }
+    EXPECT_EQ(0, corrupted.load());
+    ClearGraves();
+}
+
+TEST(HazardTest, ProtectedNotFreed) {
+    HazardDomain domain;
+    std::atomic<Node *> source(new Node(1));
+
+    HazardDomain::Holder holder(domain);
+    Node *node = holder.Protect(source);
+    source.store(nullptr);
+
+    std::thread writer([&domain, node]() {
+        domain.Retire(node, &Bury);
+        domain.Scan();
+    });
+    writer.join();
+    EXPECT_EQ(kAlive, node->mark.load());
+
+    holder.Reset();
+    domain.Scan();
+    EXPECT_EQ(kFreed, node->mark.load());
+    EXPECT_EQ(1, domain.Reclaimed());
+    ClearGraves();
+}
+
+TEST(HazardTest, SlotsExhausted) {
+    HazardDomain domain;
+    std::vector<std::unique_ptr<HazardDomain::Holder>> holders;
+    for (std::size_t i = 0; i < HazardDomain::kSlots; i++) {
+        holders.emplace_back(new HazardDomain::Holder(domain));
+    }
+    EXPECT_THROW(HazardDomain::Holder extra(domain), std::runtime_error);
+
+    // Released slot could be taken again
+    holders.pop_back();
+    EXPECT_NO_THROW(HazardDomain::Holder again(domain));
+}
+
+TEST(HazardTest, Stress) {
+    std::atomic<int> corrupted(0);
+    int popped = 0;
+    {
+        HazardDomain domain;
+        Stress<HazardStack>(domain, popped, corrupted);
+
+        domain.Scan();
+        EXPECT_EQ(popped, domain.Retired());
+        EXPECT_EQ(popped, domain.Reclaimed());
+    }
+    EXPECT_EQ(0, corrupted.load());
+    ClearGraves();
+}
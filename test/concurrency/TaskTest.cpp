@@ -0,0 +1,113 @@
+#include "gtest/gtest.h"
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <thread>
+
+#include <afina/concurrency/Executor.h>
+#include <afina/concurrency/Task.h>
+
+using namespace Afina::Concurrency;
+
+// Allocations made by the current thread, to check that task path doesn't touch the heap
+thread_local std::size_t allocations = 0;
+
+void *operator new(std::size_t size) {
+    allocations++;
+    if (void *ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+struct Counter {
+    void Add(int n) { value += n; }
+    int value = 0;
+};
+
+} // namespace
+
+TEST(TaskTest, SmallTaskInline) {
+    int value = 0;
+    std::size_t before = allocations;
+    Task task([&value]() { value++; });
+    Task moved(std::move(task));
+    EXPECT_EQ(before, allocations);
+
+    EXPECT_FALSE(task);
+    ASSERT_TRUE(moved);
+    moved();
+    EXPECT_EQ(1, value);
+}
+
+TEST(TaskTest, LargeTaskOnHeap) {
+    std::array<char, 2 * Task::kInlineSize> big;
+    big.fill(1);
+
+    int sum = 0;
+    std::size_t before = allocations;
+    Task task([big, &sum]() {
+        for (auto c : big) {
+            sum += c;
+        }
+    });
+    EXPECT_EQ(before + 1, allocations);
+
+    // Move just passes the pointer
+    Task moved;
+    moved = std::move(task);
+    EXPECT_EQ(before + 1, allocations);
+
+    moved();
+    EXPECT_EQ(int(big.size()), sum);
+}
+
+TEST(TaskTest, MakeTaskMoveOnlyArguments) {
+    int got = 0;
+    auto task =
+        MakeTask([&got](std::unique_ptr<int> p, int add) { got = *p + add; }, std::unique_ptr<int>(new int(40)), 2);
+    Task wrapped(std::move(task));
+    wrapped();
+    EXPECT_EQ(42, got);
+}
+
+TEST(TaskTest, MakeTaskMemberFunction) {
+    Counter counter;
+    Task task(MakeTask(&Counter::Add, &counter, 5));
+    task();
+    EXPECT_EQ(5, counter.value);
+}
+
+TEST(TaskTest, ResetDestroysCallable) {
+    auto shared = std::make_shared<int>(0);
+    Task task([shared]() {});
+    EXPECT_EQ(2, shared.use_count());
+
+    task = nullptr;
+    EXPECT_FALSE(task);
+    EXPECT_EQ(1, shared.use_count());
+}
+
+TEST(TaskTest, ExecuteWithoutAllocations) {
+    std::atomic<int> done(0);
+    Executor executor(1, 1, 1024, std::chrono::milliseconds(100));
+
+    // Executor has been built already, submission itself must not allocate
+    std::size_t before = allocations;
+    for (int i = 0; i < 1000; i++) {
+        while (!executor.Execute([&done](int n) { done += n; }, 1)) {
+            std::this_thread::yield();
+        }
+    }
+    EXPECT_EQ(before, allocations);
+
+    executor.Stop(true);
+    EXPECT_EQ(1000, done.load());
+}
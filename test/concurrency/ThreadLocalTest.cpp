@@ -0,0 +1,113 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <afina/concurrency/ThreadLocal.h>
+
+using namespace Afina::Concurrency;
+
+namespace {
+
+std::atomic<int> alive(0);
+
+struct Tracked {
+    Tracked() : value(0) { alive++; }
+    ~Tracked() { alive--; }
+    std::atomic<int> value;
+};
+
+// Keeps threads running until the test has looked at their instances
+class Gate {
+public:
+    Gate() : _open(false), _arrived(0) {}
+
+    void Arrive() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _arrived++;
+        _cv.notify_all();
+        _cv.wait(lock, [this]() { return _open; });
+    }
+
+    void AwaitArrived(int count) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cv.wait(lock, [this, count]() { return _arrived >= count; });
+    }
+
+    void Open() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _open = true;
+        _cv.notify_all();
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _open;
+    int _arrived;
+};
+
+} // namespace
+
+TEST(ThreadLocalTest, InstancePerThread) {
+    const int threads = 8;
+    ThreadLocal<Tracked> local;
+    Gate gate;
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&local, &gate, t]() {
+            local->value = t + 1;
+            EXPECT_EQ(&local.Get(), &local.Get());
+            gate.Arrive();
+        });
+    }
+
+    gate.AwaitArrived(threads);
+    EXPECT_EQ(threads, local.Size());
+    EXPECT_EQ(threads * (threads + 1) / 2,
+              local.Aggregate(0, [](int sum, const Tracked &t) { return sum + t.value.load(); }));
+
+    gate.Open();
+    for (auto &t : pool) {
+        t.join();
+    }
+
+    // Instances are reclaimed together with their threads
+    EXPECT_EQ(0, local.Size());
+    EXPECT_EQ(0, alive.load());
+}
+
+TEST(ThreadLocalTest, OwnerDestroyedFirst) {
+    Gate gate;
+    std::unique_ptr<ThreadLocal<Tracked>> local(new ThreadLocal<Tracked>());
+
+    std::thread worker([&local, &gate]() {
+        local->Get().value = 1;
+        gate.Arrive();
+    });
+
+    gate.AwaitArrived(1);
+    EXPECT_EQ(1, alive.load());
+
+    // Thread exit must notice that instance is already gone
+    local.reset();
+    EXPECT_EQ(0, alive.load());
+    gate.Open();
+    worker.join();
+    EXPECT_EQ(0, alive.load());
+}
+
+TEST(ThreadLocalTest, IdReuse) {
+    {
+        ThreadLocal<Tracked> first;
+        first->value = 42;
+    }
+
+    // New object could get the same id, calling thread must not see the stale instance
+    ThreadLocal<Tracked> second;
+    EXPECT_EQ(0, second->value.load());
+    EXPECT_EQ(1, second.Size());
+}
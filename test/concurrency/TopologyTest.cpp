@@ -0,0 +1,183 @@
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sched.h>
+#include <sys/stat.h>
+
+#include <afina/concurrency/Executor.h>
+#include <afina/concurrency/Topology.h>
+
+using namespace Afina::Concurrency;
+
+namespace {
+
+// Fake sysfs tree in a temporary directory
+class SysFs {
+public:
+    SysFs() {
+        char path[] = "/tmp/afina-topologyXXXXXX";
+        root = mkdtemp(path);
+        Mkdir("/cpu");
+        Mkdir("/node");
+    }
+
+    ~SysFs() { std::system(("rm -rf " + root).c_str()); }
+
+    void Cpu(unsigned id, unsigned package, unsigned core) {
+        std::string dir = "/cpu/cpu" + std::to_string(id);
+        Mkdir(dir);
+        Mkdir(dir + "/topology");
+        Write(dir + "/topology/physical_package_id", std::to_string(package));
+        Write(dir + "/topology/core_id", std::to_string(core));
+    }
+
+    void Node(unsigned id, const std::string &cpus) {
+        std::string dir = "/node/node" + std::to_string(id);
+        Mkdir(dir);
+        Write(dir + "/cpulist", cpus);
+    }
+
+    void Write(const std::string &path, const std::string &value) {
+        std::ofstream out(root + path);
+        out << value << "\n";
+    }
+
+    void Mkdir(const std::string &path) { mkdir((root + path).c_str(), 0700); }
+
+    std::string root;
+};
+
+// Two sockets, each a NUMA node of two cores with two hyperthreads. Siblings are numbered
+// the way Intel machines do it: second thread of every core comes after all first ones
+void TwoNodes(SysFs &fs) {
+    fs.Write("/cpu/online", "0-7");
+    for (unsigned id = 0; id < 8; id++) {
+        fs.Cpu(id, (id / 2) % 2, id % 2);
+    }
+    fs.Node(0, "0-1,4-5");
+    fs.Node(1, "2-3,6-7");
+}
+
+std::vector<unsigned> All(unsigned count) {
+    std::vector<unsigned> result;
+    for (unsigned i = 0; i < count; i++) {
+        result.push_back(i);
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(TopologyTest, ParseList) {
+    EXPECT_EQ(std::vector<unsigned>({0, 1, 2, 5, 7, 8}), Topology::ParseList("0-2,5,7-8"));
+    EXPECT_EQ(std::vector<unsigned>({3}), Topology::ParseList("3\n"));
+    EXPECT_EQ(std::vector<unsigned>({1, 2}), Topology::ParseList("2,1,2"));
+    EXPECT_TRUE(Topology::ParseList("").empty());
+    EXPECT_TRUE(Topology::ParseList("x").empty());
+}
+
+TEST(TopologyTest, Detect) {
+    SysFs fs;
+    TwoNodes(fs);
+    Topology topology = Topology::Detect(fs.root, All(8));
+
+    ASSERT_EQ(8, topology.Cpus().size());
+    EXPECT_EQ(4, topology.Cores());
+    EXPECT_EQ(std::vector<unsigned>({0, 1}), topology.Nodes());
+
+    const Topology::Cpu &cpu = topology.Cpus()[6];
+    EXPECT_EQ(6, cpu.id);
+    EXPECT_EQ(1, cpu.package);
+    EXPECT_EQ(1, cpu.node);
+    EXPECT_EQ(std::vector<unsigned>({2, 6}), topology.CoreCpus(cpu.core));
+}
+
+TEST(TopologyTest, DetectRespectsAllowedAndOnline) {
+    SysFs fs;
+    TwoNodes(fs);
+    fs.Write("/cpu/online", "0-6");
+    Topology topology = Topology::Detect(fs.root, {0, 4, 2, 7});
+
+    ASSERT_EQ(3, topology.Cpus().size());
+    EXPECT_EQ(0, topology.Cpus()[0].id);
+    EXPECT_EQ(2, topology.Cpus()[1].id);
+    EXPECT_EQ(4, topology.Cpus()[2].id);
+    EXPECT_EQ(2, topology.Cores());
+}
+
+TEST(TopologyTest, DetectWithoutSysfs) {
+    SysFs fs;
+    Topology topology = Topology::Detect(fs.root + "/missing", All(3));
+
+    ASSERT_EQ(3, topology.Cpus().size());
+    EXPECT_EQ(3, topology.Cores());
+    EXPECT_EQ(std::vector<unsigned>({0}), topology.Nodes());
+}
+
+TEST(TopologyTest, PlacementCores) {
+    SysFs fs;
+    TwoNodes(fs);
+    Placement placement(Topology::Detect(fs.root, All(8)), Placement::Policy::kCores);
+
+    // Node 0 fills first
+    EXPECT_EQ(std::vector<unsigned>({0}), placement.Worker(0));
+    EXPECT_EQ(std::vector<unsigned>({1}), placement.Worker(1));
+    EXPECT_EQ(std::vector<unsigned>({2}), placement.Worker(2));
+    EXPECT_EQ(std::vector<unsigned>({3}), placement.Worker(3));
+    EXPECT_EQ(std::vector<unsigned>({0}), placement.Worker(4));
+
+    EXPECT_EQ(std::vector<unsigned>({4, 5}), placement.Helpers(2));
+    EXPECT_EQ(std::vector<unsigned>({4, 5, 6}), placement.Helpers(3));
+    EXPECT_EQ(std::vector<unsigned>({0}), placement.Nodes(2));
+    EXPECT_EQ(std::vector<unsigned>({0, 1}), placement.Nodes(3));
+}
+
+TEST(TopologyTest, PlacementWithoutSmt) {
+    SysFs fs;
+    fs.Write("/cpu/online", "0-3");
+    for (unsigned id = 0; id < 4; id++) {
+        fs.Cpu(id, 0, id);
+    }
+    fs.Node(0, "0-3");
+    Placement placement(Topology::Detect(fs.root, All(4)), Placement::Policy::kCores);
+
+    // Helpers take cores workers left
+    EXPECT_EQ(std::vector<unsigned>({2, 3}), placement.Helpers(2));
+    EXPECT_TRUE(placement.Helpers(4).empty());
+}
+
+TEST(TopologyTest, PlacementNone) {
+    SysFs fs;
+    TwoNodes(fs);
+    Placement placement(Topology::Detect(fs.root, All(8)), Placement::Policy::kNone);
+    EXPECT_TRUE(placement.Worker(0).empty());
+    EXPECT_TRUE(placement.Helpers(1).empty());
+    EXPECT_TRUE(placement.Nodes(1).empty());
+}
+
+TEST(TopologyTest, PinCurrentThread) {
+    Topology topology = Topology::Detect();
+    ASSERT_FALSE(topology.Cpus().empty());
+    unsigned cpu = topology.Cpus().back().id;
+
+    std::thread([cpu]() {
+        ASSERT_TRUE(PinCurrentThread({cpu}));
+        EXPECT_EQ(int(cpu), sched_getcpu());
+    }).join();
+
+    EXPECT_TRUE(PinCurrentThread({}));
+}
+
+TEST(TopologyTest, ExecutorPinsThreads) {
+    Topology topology = Topology::Detect();
+    unsigned cpu = topology.Cpus().front().id;
+
+    Executor executor(1, 1, 4, std::chrono::milliseconds(100), {{8, 4, 1}}, {cpu});
+    auto where = executor.Submit([]() { return sched_getcpu(); });
+    EXPECT_EQ(int(cpu), where.Get());
+}
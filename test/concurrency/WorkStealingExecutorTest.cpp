@@ -0,0 +1,125 @@
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <afina/concurrency/WorkStealingExecutor.h>
+
+using namespace Afina::Concurrency;
+
+namespace {
+
+void Await(const std::atomic<int> &counter, int value) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (counter.load() < value && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+} // namespace
+
+TEST(WorkStealingExecutorTest, RunsAllTasks) {
+    std::atomic<int> done(0);
+    {
+        WorkStealingExecutor executor(2, 4, 100000, std::chrono::milliseconds(100));
+        for (int i = 0; i < 10000; i++) {
+            ASSERT_TRUE(executor.Execute([&done](int add) { done += add; }, 1));
+        }
+        Await(done, 10000);
+    }
+    EXPECT_EQ(10000, done.load());
+}
+
+TEST(WorkStealingExecutorTest, NestedTasks) {
+    std::atomic<int> done(0);
+    WorkStealingExecutor executor(1, 4, 100000, std::chrono::milliseconds(100));
+
+    // Tasks spawned from inside go to the worker deque and get stolen by others
+    std::function<void(int)> tree = [&](int depth) {
+        done++;
+        if (depth > 0) {
+            executor.Execute(tree, depth - 1);
+            executor.Execute(tree, depth - 1);
+        }
+    };
+    ASSERT_TRUE(executor.Execute(tree, 10));
+
+    Await(done, (1 << 11) - 1);
+    EXPECT_EQ((1 << 11) - 1, done.load());
+    executor.Stop(true);
+}
+
+TEST(WorkStealingExecutorTest, QueueLimit) {
+    std::atomic<int> started(0);
+    std::atomic<bool> release(false);
+    WorkStealingExecutor executor(1, 1, 2, std::chrono::milliseconds(100));
+
+    auto blocker = [&]() {
+        started++;
+        while (!release.load()) {
+            std::this_thread::yield();
+        }
+    };
+    ASSERT_TRUE(executor.Execute(blocker));
+    Await(started, 1);
+
+    // Single worker is busy, queue takes two more tasks only
+    EXPECT_TRUE(executor.Execute(blocker));
+    EXPECT_TRUE(executor.Execute(blocker));
+    EXPECT_FALSE(executor.Execute(blocker));
+
+    release.store(true);
+    executor.Stop(true);
+    EXPECT_EQ(3, started.load());
+    EXPECT_EQ(WorkStealingExecutor::State::kStopped, executor.GetState());
+}
+
+TEST(WorkStealingExecutorTest, StopCompletesQueued) {
+    std::atomic<int> done(0);
+    WorkStealingExecutor executor(1, 2, 1000, std::chrono::milliseconds(100));
+    for (int i = 0; i < 500; i++) {
+        ASSERT_TRUE(executor.Execute([&done]() {
+            std::this_thread::sleep_for(std::chrono::microseconds(10));
+            done++;
+        }));
+    }
+
+    executor.Stop(true);
+    EXPECT_EQ(500, done.load());
+    EXPECT_FALSE(executor.Execute([]() {}));
+}
+
+TEST(WorkStealingExecutorTest, StopRacesSubmit) {
+    // Rejected submit briefly raises the queue counter, workers must not go to sleep on it forever
+    for (int round = 0; round < 200; round++) {
+        std::atomic<int> done(0);
+        std::atomic<bool> stopped(false);
+        WorkStealingExecutor executor(2, 2, 1000, std::chrono::milliseconds(100));
+
+        std::thread submitter([&]() {
+            while (!stopped.load()) {
+                executor.Execute([&done]() { done++; });
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+
+        executor.Stop(true);
+        stopped.store(true);
+        submitter.join();
+        EXPECT_EQ(WorkStealingExecutor::State::kStopped, executor.GetState());
+    }
+}
+
+TEST(WorkStealingExecutorTest, IdleWorkersRetire) {
+    std::atomic<int> done(0);
+    WorkStealingExecutor executor(0, 4, 1000, std::chrono::milliseconds(10));
+
+    // No threads at all at low watermark 0, they come with tasks and go away after idle time
+    ASSERT_TRUE(executor.Execute([&done]() { done++; }));
+    Await(done, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    ASSERT_TRUE(executor.Execute([&done]() { done++; }));
+    Await(done, 2);
+    EXPECT_EQ(2, done.load());
+}
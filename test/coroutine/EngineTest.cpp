@@ -2,6 +2,9 @@
 
 #include <iostream>
 #include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <afina/coroutine/Engine.h>
 
@@ -62,3 +65,226 @@ TEST(CoroutineTest, Printer) {
     engine.start(_printer, engine, result);
     ASSERT_STREQ("A1 B1 A2 B2 A3 B3 END", result.c_str());
 }
+
+TEST(CoroutineTest, PrinterCopyStack) {
+    Afina::Coroutine::Engine engine(Afina::Coroutine::Engine::Mode::kCopyStack);
+
+    out.str("");
+    std::string result;
+    engine.start(_printer, engine, result);
+    ASSERT_STREQ("A1 B1 A2 B2 A3 B3 END", result.c_str());
+}
+
+// Recurses on its own stack and passes control away from the deepest frame
+void _deep(Afina::Coroutine::Engine &pe, int depth, int &sum) {
+    volatile char frame[256];
+    frame[0] = char(depth);
+    if (depth > 0) {
+        _deep(pe, depth - 1, sum);
+    } else {
+        pe.yield();
+    }
+    sum += frame[0];
+}
+
+void _deep_main(Afina::Coroutine::Engine &pe, int &first, int &second) {
+    pe.run(_deep, pe, 100, first);
+    pe.run(_deep, pe, 100, second);
+    pe.yield();
+}
+
+TEST(CoroutineTest, DeepStacks) {
+    Afina::Coroutine::Engine engine;
+
+    int first = 0, second = 0;
+    engine.start(_deep_main, engine, first, second);
+    EXPECT_EQ(5050, first);
+    EXPECT_EQ(5050, second);
+}
+
+void _keeper(const std::string &value, std::string &result) { result = value; }
+
+void _temporary_spawner(Afina::Coroutine::Engine &pe, std::string &result) {
+    ASSERT_NE(nullptr, pe.run(_keeper, std::string(64, 'x'), result));
+
+    // Temporary is gone by now, its memory goes to another string before the routine runs
+    std::string other(64, 'y');
+    pe.yield();
+    EXPECT_EQ(std::string(64, 'y'), other);
+}
+
+TEST(CoroutineTest, TemporaryArgument) {
+    Afina::Coroutine::Engine engine(Afina::Coroutine::Engine::Mode::kSeparateStack, 16 * 1024);
+
+    std::string result;
+    engine.start(_temporary_spawner, engine, result);
+    EXPECT_EQ(std::string(64, 'x'), result);
+}
+
+void _counter(Afina::Coroutine::Engine &pe, int &total, int rounds) {
+    for (int i = 0; i < rounds; i++) {
+        total++;
+        pe.yield();
+    }
+}
+
+void _spawner(Afina::Coroutine::Engine &pe, int &total, int count) {
+    for (int i = 0; i < count; i++) {
+        ASSERT_NE(nullptr, pe.run(_counter, pe, total, 10));
+    }
+}
+
+TEST(CoroutineTest, ManyRoutines) {
+    Afina::Coroutine::Engine engine(Afina::Coroutine::Engine::Mode::kSeparateStack, 16 * 1024);
+
+    int total = 0;
+    engine.start(_spawner, engine, total, 1000);
+    EXPECT_EQ(10000, total);
+
+    // Engine could be started again once all routines are done
+    total = 0;
+    engine.start(_spawner, engine, total, 10);
+    EXPECT_EQ(100, total);
+}
+
+void _waiter(Afina::Coroutine::Engine &pe, std::string &log) {
+    log += "w";
+    pe.block();
+    log += "W";
+}
+
+void _waker(Afina::Coroutine::Engine &pe, std::string &log, void *&waiter) {
+    log += "k";
+    pe.yield();
+
+    // Blocked routine isn't scheduled even by name
+    pe.sched(waiter);
+    log += "u";
+    pe.unblock(waiter);
+    pe.yield();
+    log += "K";
+}
+
+void _block_main(Afina::Coroutine::Engine &pe, std::string &log, void *&waiter) {
+    waiter = pe.run(_waiter, pe, log);
+    pe.run(_waker, pe, log, waiter);
+    pe.sched(waiter);
+}
+
+void BlockUnblock(Afina::Coroutine::Engine::Mode mode) {
+    Afina::Coroutine::Engine engine(mode);
+    std::string log;
+    void *waiter = nullptr;
+    engine.start(_block_main, engine, log, waiter);
+    EXPECT_EQ("wkuWK", log);
+}
+
+TEST(CoroutineTest, BlockUnblock) { BlockUnblock(Afina::Coroutine::Engine::Mode::kSeparateStack); }
+
+TEST(CoroutineTest, BlockUnblockCopyStack) { BlockUnblock(Afina::Coroutine::Engine::Mode::kCopyStack); }
+
+void _sleeper(Afina::Coroutine::Engine &pe, std::vector<void *> &sleeping, int &woken) {
+    sleeping.push_back(pe.current());
+    pe.block();
+    woken++;
+}
+
+void _sleepers(Afina::Coroutine::Engine &pe, std::vector<void *> &sleeping, int &woken) {
+    for (int i = 0; i < 3; i++) {
+        pe.run(_sleeper, pe, sleeping, woken);
+    }
+}
+
+TEST(CoroutineTest, IdleUnblocks) {
+    std::vector<void *> sleeping;
+    int woken = 0;
+    int idle_calls = 0;
+
+    // Idle function runs only once everybody is blocked, and wakes one routine at a time
+    Afina::Coroutine::Engine *engine = nullptr;
+    Afina::Coroutine::Engine instance(Afina::Coroutine::Engine::Mode::kSeparateStack,
+                                      Afina::Coroutine::Engine::kDefaultStackSize, [&]() {
+                                          if (sleeping.empty()) {
+                                              return false;
+                                          }
+                                          idle_calls++;
+                                          EXPECT_EQ(nullptr, engine->current());
+                                          engine->unblock(sleeping.back());
+                                          sleeping.pop_back();
+                                          return true;
+                                      });
+    engine = &instance;
+
+    instance.start(_sleepers, instance, sleeping, woken);
+    EXPECT_EQ(3, woken);
+    EXPECT_EQ(3, idle_calls);
+}
+
+TEST(CoroutineTest, BlockedDropped) {
+    Afina::Coroutine::Engine engine;
+    std::vector<void *> sleeping;
+    int woken = 0;
+
+    // Nobody can unblock them, start returns and frees them
+    engine.start(_sleepers, engine, sleeping, woken);
+    EXPECT_EQ(3, sleeping.size());
+    EXPECT_EQ(0, woken);
+    EXPECT_EQ(0, engine.StackStats().in_use);
+}
+
+void _migrant(Afina::Coroutine::Engine &pe, std::string &log) {
+    log += "m";
+    pe.yield();
+
+    // Engine it has started in is gone by now
+    log += "M";
+}
+
+void _sender(Afina::Coroutine::Engine &pe, std::string &log, void *&migrant) {
+    migrant = pe.run(_migrant, pe, log);
+    pe.sched(migrant);
+    log += "s";
+    migrant = pe.detach(migrant);
+}
+
+void _receiver() {}
+
+TEST(CoroutineTest, DetachAdopt) {
+    std::string log;
+    void *migrant = nullptr;
+
+    Afina::Coroutine::Engine sender;
+    sender.start(_sender, sender, log, migrant);
+    ASSERT_NE(nullptr, migrant);
+    EXPECT_EQ(0, sender.StackStats().in_use);
+
+    // Routine resumes on another thread with a stack that now belongs to the receiving engine
+    Afina::Coroutine::Engine *engine = nullptr;
+    Afina::Coroutine::Engine receiver(Afina::Coroutine::Engine::Mode::kSeparateStack,
+                                      Afina::Coroutine::Engine::kDefaultStackSize, [&]() {
+                                          if (migrant == nullptr) {
+                                              return false;
+                                          }
+                                          engine->adopt(migrant);
+                                          migrant = nullptr;
+                                          return true;
+                                      });
+    engine = &receiver;
+    std::thread([&]() { receiver.start(_receiver); }).join();
+
+    EXPECT_EQ("msM", log);
+    EXPECT_EQ(0, receiver.StackStats().in_use);
+    EXPECT_EQ(2, receiver.StackStats().mapped);
+    EXPECT_EQ(1, sender.StackStats().mapped);
+}
+
+TEST(CoroutineTest, DetachCopyStack) {
+    std::string log;
+    void *migrant = nullptr;
+
+    // Copied stacks belong to the thread of start() caller, routines stay where they are
+    Afina::Coroutine::Engine engine(Afina::Coroutine::Engine::Mode::kCopyStack);
+    engine.start(_sender, engine, log, migrant);
+    EXPECT_EQ(nullptr, migrant);
+    EXPECT_EQ("msM", log);
+}
@@ -0,0 +1,129 @@
+#include "gtest/gtest.h"
+
+#include <cerrno>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <afina/coroutine/Reactor.h>
+
+using namespace Afina::Coroutine;
+
+namespace {
+
+// Connected pair of non-blocking sockets
+void MakePair(int fds[2]) {
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+}
+
+} // namespace
+
+void _reader(Reactor &reactor, int fd, std::string &got) {
+    char buffer[64];
+    ssize_t n;
+    while ((n = Reactor::Read(fd, buffer, sizeof(buffer))) > 0) {
+        got.append(buffer, n);
+    }
+    EXPECT_EQ(0, n);
+}
+
+void _writer(Reactor &reactor, int fd, const std::string &data) {
+    // Reader has nothing to read yet and must have parked
+    for (char c : data) {
+        EXPECT_EQ(1, Reactor::Write(fd, &c, 1));
+        reactor.engine().yield();
+    }
+    close(fd);
+}
+
+void _ping_pong(Reactor &reactor, int *fds, std::string &got) {
+    reactor.Spawn(_reader, reactor, fds[0], got);
+    reactor.Spawn(_writer, reactor, fds[1], std::string("hello"));
+}
+
+TEST(ReactorTest, ReadParksCoroutine) {
+    int fds[2];
+    MakePair(fds);
+
+    Reactor reactor;
+    std::string got;
+    reactor.Run(_ping_pong, reactor, fds, got);
+    EXPECT_EQ("hello", got);
+    close(fds[0]);
+}
+
+void _big_write(Reactor &reactor, int fd, std::size_t size, ssize_t &written) {
+    std::string data(size, 'x');
+    written = Reactor::Write(fd, data.data(), data.size());
+    close(fd);
+}
+
+void _big_read(Reactor &reactor, int fd, std::size_t &total) {
+    char buffer[4096];
+    ssize_t n;
+    while ((n = Reactor::Read(fd, buffer, sizeof(buffer))) > 0) {
+        total += n;
+    }
+}
+
+void _big_main(Reactor &reactor, int *fds, ssize_t &written, std::size_t &total) {
+    // Much more than socket buffer holds, writer parks until reader drains it
+    reactor.Spawn(_big_write, reactor, fds[1], std::size_t(8 << 20), written);
+    reactor.Spawn(_big_read, reactor, fds[0], total);
+}
+
+TEST(ReactorTest, WriteWaitsForSpace) {
+    int fds[2];
+    MakePair(fds);
+
+    Reactor reactor;
+    ssize_t written = 0;
+    std::size_t total = 0;
+    reactor.Run(_big_main, reactor, fds, written, total);
+    EXPECT_EQ(8 << 20, written);
+    EXPECT_EQ(8 << 20, total);
+    close(fds[0]);
+}
+
+void _cancelled(Reactor &reactor, int fd, int &error) {
+    char c;
+    EXPECT_EQ(-1, Reactor::Read(fd, &c, 1));
+    error = errno;
+}
+
+TEST(ReactorTest, StopCancelsWaits) {
+    int fds[2];
+    MakePair(fds);
+
+    Reactor reactor;
+    std::thread stopper([&reactor]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        reactor.Stop();
+    });
+
+    int error = 0;
+    reactor.Run(_cancelled, reactor, fds[0], error);
+    stopper.join();
+    EXPECT_EQ(ECANCELED, error);
+    EXPECT_TRUE(reactor.Stopped());
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST(ReactorTest, WaitOutsideOfCoroutine) {
+    int fds[2];
+    MakePair(fds);
+
+    // No reactor runs on this thread
+    char c;
+    EXPECT_EQ(-1, Reactor::Read(fds[0], &c, 1));
+    EXPECT_EQ(EINVAL, errno);
+
+    close(fds[0]);
+    close(fds[1]);
+}
@@ -0,0 +1,178 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <afina/coroutine/Reactor.h>
+#include <afina/coroutine/Scheduler.h>
+
+using namespace Afina::Coroutine;
+
+namespace {
+
+// Waits until counter reaches expected value or a few seconds pass
+bool WaitFor(const std::atomic<int> &counter, int expected) {
+    for (int i = 0; i < 5000 && counter.load() < expected; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return counter.load() == expected;
+}
+
+} // namespace
+
+void _count(std::atomic<int> &done) { done++; }
+
+TEST(SchedulerTest, SpawnFromOutside) {
+    Scheduler scheduler(2);
+    scheduler.Start();
+
+    std::atomic<int> done(0);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(scheduler.Spawn(_count, done));
+    }
+    EXPECT_TRUE(WaitFor(done, 100));
+
+    scheduler.Stop();
+    scheduler.Join();
+    EXPECT_FALSE(scheduler.Spawn(_count, done));
+}
+
+void _parent(Scheduler &scheduler, std::atomic<int> &done) {
+    for (int i = 0; i < 100; i++) {
+        EXPECT_TRUE(scheduler.Spawn(_count, done));
+    }
+    done++;
+}
+
+TEST(SchedulerTest, SpawnFromRoutine) {
+    Scheduler scheduler(3);
+    scheduler.Start();
+
+    std::atomic<int> done(0);
+    ASSERT_TRUE(scheduler.Spawn(_parent, scheduler, done));
+    EXPECT_TRUE(WaitFor(done, 101));
+
+    scheduler.Stop();
+    scheduler.Join();
+}
+
+void _busy(std::mutex &mutex, std::set<std::thread::id> &threads, std::atomic<int> &done) {
+    // Long enough for the owner to get preempted even on a single CPU
+    for (int i = 0; i < 4; i++) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+        }
+        auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(500);
+        while (std::chrono::steady_clock::now() < until) {
+        }
+        Scheduler::Yield();
+    }
+    done++;
+}
+
+void _busy_parent(Scheduler &scheduler, std::mutex &mutex, std::set<std::thread::id> &threads,
+                  std::atomic<int> &done) {
+    for (int i = 0; i < 64; i++) {
+        scheduler.Spawn(_busy, mutex, threads, done);
+    }
+}
+
+TEST(SchedulerTest, IdleWorkersSteal) {
+    Scheduler scheduler(4);
+    scheduler.Start();
+
+    // All routines start on the worker of the parent, others have to take them
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    std::atomic<int> done(0);
+    ASSERT_TRUE(scheduler.Spawn(_busy_parent, scheduler, mutex, threads, done));
+    EXPECT_TRUE(WaitFor(done, 64));
+
+    scheduler.Stop();
+    scheduler.Join();
+    EXPECT_LT(1, threads.size());
+    EXPECT_NE(std::string::npos, scheduler.Dump().find("threads 4"));
+}
+
+void _pinger(int fd, int rounds, std::atomic<int> &done) {
+    for (int i = 0; i < rounds; i++) {
+        char c = char(i);
+        ASSERT_EQ(1, Reactor::Write(fd, &c, 1));
+        ASSERT_EQ(1, Reactor::Read(fd, &c, 1));
+        ASSERT_EQ(char(i + 1), c);
+    }
+    done++;
+}
+
+void _ponger(int fd, std::atomic<int> &done) {
+    char c;
+    while (Reactor::Read(fd, &c, 1) == 1) {
+        c++;
+        ASSERT_EQ(1, Reactor::Write(fd, &c, 1));
+    }
+    done++;
+}
+
+TEST(SchedulerTest, PingPongAcrossWorkers) {
+    const int pairs = 8;
+    std::vector<int> fds(2 * pairs);
+    for (int i = 0; i < pairs; i++) {
+        ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, &fds[2 * i]));
+    }
+
+    // Routines wait in epoll of whatever worker they run on at the moment
+    Scheduler scheduler(3);
+    scheduler.Start();
+    std::atomic<int> pinged(0), ponged(0);
+    for (int i = 0; i < pairs; i++) {
+        ASSERT_TRUE(scheduler.Spawn(_pinger, fds[2 * i], 1000, pinged));
+        ASSERT_TRUE(scheduler.Spawn(_ponger, fds[2 * i + 1], ponged));
+    }
+    EXPECT_TRUE(WaitFor(pinged, pairs));
+
+    for (int i = 0; i < pairs; i++) {
+        close(fds[2 * i]);
+    }
+    EXPECT_TRUE(WaitFor(ponged, pairs));
+
+    scheduler.Stop();
+    scheduler.Join();
+    for (int i = 0; i < pairs; i++) {
+        close(fds[2 * i + 1]);
+    }
+}
+
+void _stuck(int fd, std::atomic<int> &error, std::atomic<int> &done) {
+    char c;
+    EXPECT_EQ(-1, Reactor::Read(fd, &c, 1));
+    error = errno;
+    done++;
+}
+
+TEST(SchedulerTest, StopCancelsWaits) {
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+
+    Scheduler scheduler(2);
+    scheduler.Start();
+    std::atomic<int> error(0), done(0);
+    ASSERT_TRUE(scheduler.Spawn(_stuck, fds[0], error, done));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    scheduler.Stop();
+    scheduler.Join();
+    EXPECT_EQ(1, done.load());
+    EXPECT_EQ(ECANCELED, error.load());
+
+    close(fds[0]);
+    close(fds[1]);
+}
@@ -0,0 +1,126 @@
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <afina/coroutine/Engine.h>
+#include <afina/coroutine/StackPool.h>
+
+using namespace Afina::Coroutine;
+
+namespace {
+
+const std::size_t kPage = sysconf(_SC_PAGESIZE);
+
+// Number of resident pages of the stack
+std::size_t Resident(const StackPool::Stack &stack) {
+    std::vector<unsigned char> pages(stack.size / kPage);
+    EXPECT_EQ(0, mincore(stack.base, stack.size, pages.data()));
+    std::size_t result = 0;
+    for (auto page : pages) {
+        result += page & 1;
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(StackPoolTest, LazyCommit) {
+    StackPool pool(256 * 1024);
+    EXPECT_EQ(256 * 1024, pool.StackSize());
+
+    std::vector<StackPool::Stack> stacks;
+    for (int i = 0; i < 16; i++) {
+        stacks.push_back(pool.Allocate());
+        EXPECT_EQ(0, Resident(stacks.back()));
+    }
+
+    // Only touched pages get memory
+    stacks[0].base[stacks[0].size - 1] = 1;
+    EXPECT_EQ(1, Resident(stacks[0]));
+
+    for (auto &stack : stacks) {
+        pool.Release(stack);
+    }
+    EXPECT_EQ(16, pool.stats().mapped);
+    EXPECT_EQ(16, pool.stats().peak_in_use);
+    EXPECT_EQ(0, pool.stats().in_use);
+}
+
+TEST(StackPoolTest, Reuse) {
+    StackPool pool(64 * 1024, 1);
+    auto first = pool.Allocate();
+    auto second = pool.Allocate();
+    pool.Release(first);
+
+    // Only one free stack is kept, the other one is unmapped
+    pool.Release(second);
+    EXPECT_EQ(1, pool.stats().mapped);
+
+    auto again = pool.Allocate();
+    EXPECT_EQ(first.base, again.base);
+    EXPECT_EQ(1, pool.stats().reuses);
+    pool.Release(again);
+}
+
+TEST(StackPoolTest, TrimDeepPages) {
+    StackPool pool(256 * 1024, 16, 16 * 1024);
+    auto stack = pool.Allocate();
+
+    // Used 128K from the top
+    std::memset(stack.base + stack.size - 128 * 1024, 1, 128 * 1024);
+    pool.Release(stack);
+
+    EXPECT_EQ(128 * 1024, pool.stats().peak_used_bytes);
+    EXPECT_EQ(112 * 1024, pool.stats().trimmed_bytes);
+    EXPECT_EQ(16 * 1024 / kPage, Resident(stack));
+
+    // Trimmed pages read back as zero, top ones are kept
+    auto again = pool.Allocate();
+    EXPECT_EQ(0, again.base[again.size - 128 * 1024]);
+    EXPECT_EQ(1, again.base[again.size - 1]);
+    pool.Release(again);
+
+    std::string dump = pool.Dump("coroutine_");
+    EXPECT_NE(std::string::npos, dump.find("coroutine_stack_peak_used_bytes 131072\n"));
+}
+
+TEST(StackPoolTest, GuardPage) {
+    StackPool pool(64 * 1024);
+    auto stack = pool.Allocate();
+    EXPECT_DEATH(
+        {
+            volatile char *below = stack.base - 1;
+            *below = 1;
+        },
+        "");
+    pool.Release(stack);
+}
+
+void _idle(Engine &pe) { pe.yield(); }
+
+void _many_idle(Engine &pe, int count) {
+    for (int i = 0; i < count; i++) {
+        pe.run(_idle, pe);
+    }
+    pe.yield();
+}
+
+TEST(StackPoolTest, EngineRecyclesStacks) {
+    Engine engine(Engine::Mode::kSeparateStack, 256 * 1024);
+    engine.start(_many_idle, engine, 1000);
+
+    // All routines were alive at once, later ones reused stacks of completed ones only
+    auto stats = engine.StackStats();
+    EXPECT_EQ(0, stats.in_use);
+    EXPECT_EQ(1001, stats.peak_in_use);
+    EXPECT_EQ(1001, stats.mapped);
+
+    engine.start(_many_idle, engine, 10);
+    EXPECT_EQ(11, engine.StackStats().reuses);
+    EXPECT_EQ(1001, engine.StackStats().mapped);
+}
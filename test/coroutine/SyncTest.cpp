@@ -0,0 +1,209 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <afina/coroutine/Channel.h>
+#include <afina/coroutine/ConditionVariable.h>
+#include <afina/coroutine/Engine.h>
+#include <afina/coroutine/Mutex.h>
+#include <afina/coroutine/Semaphore.h>
+
+using namespace Afina::Coroutine;
+
+void _locker(Engine &pe, Mutex &mutex, std::string &log, char name) {
+    std::lock_guard<Mutex> lock(mutex);
+    log += name;
+
+    // Others run while the mutex is held, but none gets into the critical section
+    pe.yield();
+    pe.yield();
+    log += name;
+}
+
+void _lockers(Engine &pe, Mutex &mutex, std::string &log) {
+    for (char name : std::string("abc")) {
+        pe.run(_locker, pe, mutex, log, name);
+    }
+}
+
+TEST(SyncTest, MutexExcludes) {
+    Engine engine;
+    Mutex mutex(engine);
+    std::string log;
+    engine.start(_lockers, engine, mutex, log);
+
+    // Sections don't interleave, waiters get the mutex in the order they came
+    ASSERT_EQ(6, log.size());
+    for (std::size_t i = 0; i < log.size(); i += 2) {
+        EXPECT_EQ(log[i], log[i + 1]);
+    }
+    EXPECT_TRUE(mutex.try_lock());
+}
+
+void _consumer(Engine &pe, Mutex &mutex, ConditionVariable &cv, std::vector<int> &queue, std::vector<int> &got) {
+    std::unique_lock<Mutex> lock(mutex);
+    for (;;) {
+        cv.wait(lock, [&queue]() { return !queue.empty(); });
+        int value = queue.front();
+        queue.erase(queue.begin());
+        if (value < 0) {
+            return;
+        }
+        got.push_back(value);
+    }
+}
+
+void _producer(Engine &pe, Mutex &mutex, ConditionVariable &cv, std::vector<int> &queue, std::vector<int> &got) {
+    pe.run(_consumer, pe, mutex, cv, queue, got);
+    pe.yield();
+    for (int i = 0; i <= 5; i++) {
+        std::lock_guard<Mutex> lock(mutex);
+        queue.push_back(i < 5 ? i : -1);
+        cv.notify_one();
+    }
+}
+
+TEST(SyncTest, ConditionVariable) {
+    Engine engine;
+    Mutex mutex(engine);
+    ConditionVariable cv(engine);
+    std::vector<int> queue, got;
+    engine.start(_producer, engine, mutex, cv, queue, got);
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4}), got);
+}
+
+void _limited(Engine &pe, Semaphore &semaphore, int &inside, int &peak, int &done) {
+    semaphore.acquire();
+    inside++;
+    peak = std::max(peak, inside);
+    for (int i = 0; i < 3; i++) {
+        pe.yield();
+    }
+    inside--;
+    done++;
+    semaphore.release();
+}
+
+void _limited_all(Engine &pe, Semaphore &semaphore, int &inside, int &peak, int &done) {
+    for (int i = 0; i < 10; i++) {
+        pe.run(_limited, pe, semaphore, inside, peak, done);
+    }
+}
+
+TEST(SyncTest, SemaphoreLimits) {
+    Engine engine;
+    Semaphore semaphore(engine, 3);
+    int inside = 0, peak = 0, done = 0;
+    engine.start(_limited_all, engine, semaphore, inside, peak, done);
+    EXPECT_EQ(10, done);
+    EXPECT_LE(peak, 3);
+    EXPECT_GT(peak, 1);
+    EXPECT_EQ(3, semaphore.available());
+}
+
+void _permit_taker(Engine &pe, Semaphore &semaphore, std::string &log) {
+    semaphore.acquire();
+    log += "t";
+}
+
+void _permit_giver(Engine &pe, Semaphore &semaphore, std::string &log) {
+    pe.run(_permit_taker, pe, semaphore, log);
+    pe.run(_permit_taker, pe, semaphore, log);
+    pe.yield();
+    log += "r";
+
+    // Both waiters get a permit, the third one stays
+    semaphore.release(3);
+    EXPECT_EQ(1, semaphore.available());
+}
+
+TEST(SyncTest, SemaphoreHandsPermits) {
+    Engine engine;
+    Semaphore semaphore(engine, 0);
+    std::string log;
+    EXPECT_FALSE(semaphore.try_acquire());
+    engine.start(_permit_giver, engine, semaphore, log);
+    EXPECT_EQ("rtt", log);
+    EXPECT_EQ(1, semaphore.available());
+}
+
+void _sender(Channel<int> &channel, int count) {
+    for (int i = 0; i < count; i++) {
+        ASSERT_TRUE(channel.send(i));
+    }
+    channel.close();
+    EXPECT_FALSE(channel.send(count));
+}
+
+void _receiver(Channel<int> &channel, std::vector<int> &got) {
+    int value;
+    while (channel.receive(value)) {
+        got.push_back(value);
+    }
+}
+
+void _pipeline(Engine &pe, Channel<int> &channel, std::vector<int> &got) {
+    pe.run(_receiver, channel, got);
+    pe.run(_sender, channel, 100);
+}
+
+void Pipeline(Engine::Mode mode) {
+    Engine engine(mode);
+    Channel<int> channel(engine, 4);
+    std::vector<int> got;
+    engine.start(_pipeline, engine, channel, got);
+
+    ASSERT_EQ(100, got.size());
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(i, got[i]);
+    }
+    EXPECT_TRUE(channel.closed());
+}
+
+TEST(SyncTest, ChannelPipeline) { Pipeline(Engine::Mode::kSeparateStack); }
+
+TEST(SyncTest, ChannelPipelineCopyStack) { Pipeline(Engine::Mode::kCopyStack); }
+
+void _stuck(Engine &pe, Channel<int> &channel, int &done) {
+    int value;
+    channel.receive(value);
+    done++;
+}
+
+void _stuck_all(Engine &pe, Channel<int> &channel, int &done) {
+    for (int i = 0; i < 3; i++) {
+        pe.run(_stuck, pe, channel, done);
+    }
+}
+
+TEST(SyncTest, DeadlockedRoutinesDropped) {
+    Engine engine;
+    Channel<int> channel(engine, 1);
+    int done = 0;
+
+    // Nobody sends, start returns and frees the receivers, channel is left empty
+    engine.start(_stuck_all, engine, channel, done);
+    EXPECT_EQ(0, done);
+    EXPECT_EQ(0, engine.StackStats().in_use);
+    EXPECT_TRUE(channel.try_send(1));
+
+    int value = 0;
+    EXPECT_TRUE(channel.try_receive(value));
+    EXPECT_EQ(1, value);
+}
+
+TEST(SyncTest, BlockingOutsideOfCoroutine) {
+    Engine engine;
+    Mutex mutex(engine);
+    mutex.lock();
+    EXPECT_THROW(mutex.lock(), std::logic_error);
+    mutex.unlock();
+
+    Channel<int> channel(engine, 1);
+    int value;
+    EXPECT_THROW(channel.receive(value), std::logic_error);
+}
@@ -0,0 +1,279 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <afina/coroutine/Channel.h>
+#include <afina/coroutine/ConditionVariable.h>
+#include <afina/coroutine/Engine.h>
+#include <afina/coroutine/Mutex.h>
+#include <afina/coroutine/Reactor.h>
+#include <afina/coroutine/Scheduler.h>
+#include <afina/coroutine/Semaphore.h>
+
+using namespace Afina::Coroutine;
+
+namespace {
+
+std::chrono::milliseconds Since(Engine::Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Engine::Clock::now() - start);
+}
+
+} // namespace
+
+void _sleeper(Engine &pe, int ms, std::string &log, char name) {
+    EXPECT_TRUE(pe.sleep_for(std::chrono::milliseconds(ms)));
+    log += name;
+}
+
+void _sleepers(Engine &pe, std::string &log) {
+    pe.run(_sleeper, pe, 30, log, 'c');
+    pe.run(_sleeper, pe, 10, log, 'a');
+    pe.run(_sleeper, pe, 20, log, 'b');
+}
+
+TEST(TimerTest, SleepersWakeInDeadlineOrder) {
+    // No idle function, engine itself sleeps until the next deadline
+    Engine engine;
+    std::string log;
+    auto start = Engine::Clock::now();
+    engine.start(_sleepers, engine, log);
+
+    EXPECT_EQ("abc", log);
+    EXPECT_LE(30, Since(start).count());
+}
+
+void _deadline(Engine &pe, Engine::Clock::time_point deadline, std::vector<Engine::Clock::time_point> &woken) {
+    pe.sleep_until(deadline);
+    woken.push_back(Engine::Clock::now());
+}
+
+void _many_deadlines(Engine &pe, std::vector<Engine::Clock::time_point> &woken) {
+    auto now = Engine::Clock::now();
+    srand(42);
+    for (int i = 0; i < 200; i++) {
+        pe.run(_deadline, pe, now + std::chrono::microseconds(rand() % 20000), woken);
+    }
+}
+
+TEST(TimerTest, HeapKeepsOrder) {
+    Engine engine;
+    std::vector<Engine::Clock::time_point> woken;
+    engine.start(_many_deadlines, engine, woken);
+
+    ASSERT_EQ(200, woken.size());
+    for (std::size_t i = 1; i < woken.size(); i++) {
+        EXPECT_LE(woken[i - 1], woken[i]);
+    }
+}
+
+void _long_sleeper(Engine &pe, bool &slept) { slept = pe.sleep_for(std::chrono::seconds(10)); }
+
+void _waker(Engine &pe, bool &slept) {
+    void *sleeper = pe.run(_long_sleeper, pe, slept);
+    pe.yield();
+    pe.unblock(sleeper);
+}
+
+TEST(TimerTest, UnblockCancelsSleep) {
+    Engine engine;
+    bool slept = true;
+    auto start = Engine::Clock::now();
+    engine.start(_waker, engine, slept);
+
+    EXPECT_FALSE(slept);
+    EXPECT_GT(1000, Since(start).count());
+    EXPECT_EQ(Engine::Clock::time_point::max(), engine.next_timer());
+}
+
+TEST(TimerTest, SleepOutsideOfCoroutine) {
+    Engine engine;
+    EXPECT_FALSE(engine.sleep_for(std::chrono::milliseconds(1)));
+}
+
+void _holder(Engine &pe, Mutex &mutex, int ms) {
+    std::lock_guard<Mutex> lock(mutex);
+    pe.sleep_for(std::chrono::milliseconds(ms));
+}
+
+void _timed_locker(Engine &pe, Mutex &mutex, std::vector<bool> &got) {
+    pe.run(_holder, pe, mutex, 50);
+    pe.yield();
+
+    got.push_back(mutex.try_lock_for(std::chrono::milliseconds(10)));
+    got.push_back(mutex.try_lock_for(std::chrono::seconds(10)));
+    mutex.unlock();
+}
+
+TEST(TimerTest, MutexTryLockFor) {
+    Engine engine;
+    Mutex mutex(engine);
+    std::vector<bool> got;
+    engine.start(_timed_locker, engine, mutex, got);
+
+    ASSERT_EQ(2, got.size());
+    EXPECT_FALSE(got[0]);
+    EXPECT_TRUE(got[1]);
+    EXPECT_TRUE(mutex.try_lock());
+}
+
+void _notifier(Engine &pe, Mutex &mutex, ConditionVariable &cv, bool &flag) {
+    pe.sleep_for(std::chrono::milliseconds(20));
+    std::lock_guard<Mutex> lock(mutex);
+    flag = true;
+    cv.notify_one();
+}
+
+void _timed_waiter(Engine &pe, Mutex &mutex, ConditionVariable &cv, std::vector<bool> &got) {
+    bool flag = false;
+    std::unique_lock<Mutex> lock(mutex);
+    got.push_back(cv.wait_for(lock, std::chrono::milliseconds(5)) == std::cv_status::timeout);
+    got.push_back(lock.owns_lock());
+
+    pe.run(_notifier, pe, mutex, cv, flag);
+    got.push_back(cv.wait_for(lock, std::chrono::seconds(10), [&flag]() { return flag; }));
+    got.push_back(cv.wait_for(lock, std::chrono::milliseconds(5), []() { return false; }));
+}
+
+TEST(TimerTest, ConditionVariableWaitFor) {
+    Engine engine;
+    Mutex mutex(engine);
+    ConditionVariable cv(engine);
+    std::vector<bool> got;
+    engine.start(_timed_waiter, engine, mutex, cv, got);
+
+    EXPECT_EQ(std::vector<bool>({true, true, true, false}), got);
+}
+
+void _acquirer(Engine &pe, Semaphore &semaphore, std::vector<bool> &got) {
+    got.push_back(semaphore.try_acquire_for(std::chrono::milliseconds(5)));
+    got.push_back(semaphore.try_acquire_for(std::chrono::milliseconds(5)));
+}
+
+TEST(TimerTest, SemaphoreTryAcquireFor) {
+    Engine engine;
+    Semaphore semaphore(engine, 1);
+    std::vector<bool> got;
+    engine.start(_acquirer, engine, semaphore, got);
+
+    EXPECT_EQ(std::vector<bool>({true, false}), got);
+}
+
+void _channel_user(Engine &pe, Channel<int> &channel, std::vector<bool> &got) {
+    int value;
+    got.push_back(channel.receive_for(value, std::chrono::milliseconds(5)));
+    got.push_back(channel.send_for(1, std::chrono::milliseconds(5)));
+    got.push_back(channel.send_for(2, std::chrono::milliseconds(5)));
+    got.push_back(channel.receive_for(value, std::chrono::milliseconds(5)) && value == 1);
+}
+
+TEST(TimerTest, ChannelTimeouts) {
+    Engine engine;
+    Channel<int> channel(engine, 1);
+    std::vector<bool> got;
+    engine.start(_channel_user, engine, channel, got);
+
+    EXPECT_EQ(std::vector<bool>({false, true, false, true}), got);
+}
+
+void _slow_reader(int fd, int &error, std::chrono::milliseconds &elapsed) {
+    char c;
+    auto start = Engine::Clock::now();
+    EXPECT_EQ(-1, Reactor::Read(fd, &c, 1, start + std::chrono::milliseconds(20)));
+    error = errno;
+    elapsed = Since(start);
+}
+
+TEST(TimerTest, ReactorReadDeadline) {
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+
+    Reactor reactor;
+    int error = 0;
+    std::chrono::milliseconds elapsed(0);
+    reactor.Run(_slow_reader, fds[0], error, elapsed);
+
+    EXPECT_EQ(ETIMEDOUT, error);
+    EXPECT_LE(20, elapsed.count());
+    EXPECT_GT(1000, elapsed.count());
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+void _reactor_sleeper(std::vector<std::chrono::milliseconds> &elapsed) {
+    for (int i = 0; i < 5; i++) {
+        auto start = Engine::Clock::now();
+        EXPECT_TRUE(Reactor::SleepFor(std::chrono::milliseconds(10)));
+        elapsed.push_back(Since(start));
+    }
+}
+
+TEST(TimerTest, ReactorSleepFor) {
+    Reactor reactor;
+    std::vector<std::chrono::milliseconds> elapsed;
+    reactor.Run(_reactor_sleeper, elapsed);
+
+    ASSERT_EQ(5, elapsed.size());
+    for (auto &e : elapsed) {
+        EXPECT_LE(10, e.count());
+    }
+}
+
+void _scheduled_sleeper(std::atomic<int> &slept, std::atomic<int> &done) {
+    if (Reactor::SleepFor(std::chrono::milliseconds(10))) {
+        slept++;
+    }
+    done++;
+}
+
+TEST(TimerTest, SchedulerSleepFor) {
+    Scheduler scheduler(2);
+    scheduler.Start();
+
+    std::atomic<int> slept(0), done(0);
+    for (int i = 0; i < 20; i++) {
+        ASSERT_TRUE(scheduler.Spawn(_scheduled_sleeper, slept, done));
+    }
+    for (int i = 0; i < 5000 && done.load() < 20; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    scheduler.Stop();
+    scheduler.Join();
+    EXPECT_EQ(20, slept.load());
+}
+
+void _forever_sleeper(std::atomic<int> &slept, std::atomic<int> &done) {
+    if (Reactor::SleepFor(std::chrono::hours(1))) {
+        slept++;
+    }
+    done++;
+}
+
+TEST(TimerTest, SchedulerStopWakesSleepers) {
+    Scheduler scheduler(2);
+    scheduler.Start();
+
+    std::atomic<int> slept(0), done(0);
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(scheduler.Spawn(_forever_sleeper, slept, done));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    auto start = Engine::Clock::now();
+    scheduler.Stop();
+    scheduler.Join();
+    EXPECT_GT(1000, Since(start).count());
+    EXPECT_EQ(4, done.load());
+    EXPECT_EQ(0, slept.load());
+}
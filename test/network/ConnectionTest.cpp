@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+#include <memory>
+#include <string>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <spdlog/logger.h>
+#include <spdlog/sinks/null_sink.h>
+
+#include "network/mt_nonblocking/Connection.h"
+#include "network/st_nonblocking/Connection.h"
+#include "storage/SimpleLRU.h"
+
+using namespace Afina;
+
+namespace {
+
+// Events are delivered by calling handlers directly, the way server loops do
+template <typename C> class TestConnection : public C {
+public:
+    TestConnection(int s, std::shared_ptr<spdlog::logger> pl, std::shared_ptr<Afina::Storage> ps,
+                   Network::Counters *pc)
+        : C(s, pl, ps, pc) {}
+
+    using C::DoRead;
+    using C::DoWrite;
+};
+
+// Everything peer could read without blocking
+std::string Drain(int fd) {
+    std::string result;
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        result.append(buf, n);
+    }
+    return result;
+}
+
+template <typename C> void CheckRepliesSentOnce() {
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds));
+
+    auto logger = std::make_shared<spdlog::logger>("test", std::make_shared<spdlog::sinks::null_sink_st>());
+    Network::Counters counters;
+    TestConnection<C> connection(fds[0], logger, std::make_shared<Backend::SimpleLRU>(), &counters);
+    connection.Start();
+
+    // Socket stays writable, so level triggered epoll reports EPOLLOUT again after every write: each
+    // reply must come exactly once, whatever was sent before it
+    const std::string requests[] = {"set foo 0 0 3\r\nbar\r\n", "get foo\r\n", "set foo 0 0 3\r\nbaz\r\nget foo\r\n",
+                                    "get foo\r\n"};
+    const std::string replies[] = {"STORED\r\n", "bar", "baz", "baz"};
+    for (int i = 0; i < 4; i++) {
+        ASSERT_EQ(ssize_t(requests[i].size()), write(fds[1], requests[i].data(), requests[i].size()));
+        connection.DoRead();
+
+        connection.DoWrite();
+        std::string reply = Drain(fds[1]);
+        EXPECT_NE(std::string::npos, reply.find(replies[i])) << "reply " << i << ": " << reply;
+
+        connection.DoWrite();
+        connection.DoWrite();
+        EXPECT_EQ("", Drain(fds[1])) << "after reply " << i;
+        EXPECT_TRUE(connection.isAlive());
+    }
+    EXPECT_EQ(5, counters.requests.Sum());
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+} // namespace
+
+TEST(ConnectionTest, STnonblockSendsRepliesOnce) { CheckRepliesSentOnce<Network::STnonblock::Connection>(); }
+
+TEST(ConnectionTest, MTnonblockSendsRepliesOnce) { CheckRepliesSentOnce<Network::MTnonblock::Connection>(); }
@@ -98,3 +98,22 @@ TEST(MemcachedParserTest, Stats) {
     Execute::Stats *tmp = reinterpret_cast<Execute::Stats *>(cmd.get());
     ASSERT_FALSE(tmp == nullptr);
 }
+
+TEST(MemcachedParserTest, StatsGroup) {
+    Protocol::Parser parser;
+
+    size_t consumed = 0;
+    bool cmd_avail = parser.Parse("stats slabs\r\n", consumed);
+    ASSERT_TRUE(cmd_avail);
+    ASSERT_EQ(13, consumed);
+    ASSERT_EQ("stats", parser.Name());
+
+    size_t value_size;
+    std::unique_ptr<Execute::Command> cmd = parser.Build(value_size);
+    ASSERT_FALSE(cmd == nullptr);
+    ASSERT_EQ(0, value_size);
+
+    Execute::Stats *tmp = reinterpret_cast<Execute::Stats *>(cmd.get());
+    ASSERT_EQ(1, tmp->groups().size());
+    ASSERT_EQ("slabs", tmp->groups()[0]);
+}
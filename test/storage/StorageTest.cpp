@@ -1,15 +1,20 @@
 #include "gtest/gtest.h"
+#include <atomic>
 #include <iomanip>
 #include <iostream>
 #include <set>
+#include <thread>
 #include <vector>
 
+#include <afina/allocator/Arena.h>
 #include <afina/execute/Add.h>
 #include <afina/execute/Append.h>
 #include <afina/execute/Delete.h>
 #include <afina/execute/Get.h>
 #include <afina/execute/Set.h>
 
+#include "storage/FlatCombineLRU.h"
+#include "storage/OptimisticCuckoo.h"
 #include "storage/SimpleLRU.h"
 
 using namespace Afina::Backend;
@@ -118,6 +123,19 @@ TEST(StorageTest, DeleteIfAbsent)
     EXPECT_FALSE(storage.Delete("KEY3"));
 }
 
+TEST(StorageTest, DeleteLastNode) {
+    SimpleLRU storage;
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Delete("KEY1"));
+
+    std::string value;
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+    EXPECT_TRUE(storage.Get("KEY2", value));
+    EXPECT_EQ("val2", value);
+}
+
 TEST(StorageTest, DeleteHeadAndTailNode)
 {
     SimpleLRU storage;
@@ -195,3 +213,274 @@ TEST(StorageTest, MaxTest) {
         EXPECT_FALSE(storage.Get(key, res));
     }
 }
+
+TEST(StorageTest, ArenaMaxTest) {
+    const size_t length = 20;
+    auto arena = std::make_shared<Afina::Allocator::Arena>(1 << 22, 1 << 16);
+    SimpleLRU storage(2 * 1000 * length, arena);
+
+    for (long i = 0; i < 1100; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        auto val = pad_space("Val " + std::to_string(i), length);
+        EXPECT_TRUE(storage.Put(key, val));
+    }
+
+    for (long i = 100; i < 1100; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        auto val = pad_space("Val " + std::to_string(i), length);
+
+        std::string res;
+        EXPECT_TRUE(storage.Get(key, res));
+
+        EXPECT_TRUE(val == res);
+    }
+
+    for (long i = 0; i < 100; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+
+        std::string res;
+        EXPECT_FALSE(storage.Get(key, res));
+    }
+}
+
+TEST(StorageTest, ArenaExhausted) {
+    auto arena = std::make_shared<Afina::Allocator::Arena>(1 << 16, 1 << 16);
+    SimpleLRU storage(1 << 20, arena);
+
+    // Single slab fits limited number of nodes, Put must fail gracefully once it is over
+    bool failed = false;
+    for (long i = 0; i < 10000 && !failed; ++i) {
+        failed = !storage.Put("Key " + std::to_string(i), "Val");
+    }
+    EXPECT_TRUE(failed);
+
+    std::string res;
+    EXPECT_TRUE(storage.Get("Key 0", res));
+    EXPECT_EQ(1, arena->UsedSlabs());
+}
+
+TEST(StorageTest, Counters) {
+    SimpleLRU storage(10);
+
+    std::string value;
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Get("KEY2", value));
+    EXPECT_TRUE(storage.Put("KEY2", "val2"));
+
+    EXPECT_EQ("get_hits 1\nget_misses 1\nevictions 1", storage.DumpCounters());
+}
+
+TEST(StorageTest, FlatCombinePutGet) {
+    FlatCombineLRU storage;
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_FALSE(storage.PutIfAbsent("KEY1", "val2"));
+    EXPECT_TRUE(storage.Set("KEY1", "val3"));
+    EXPECT_FALSE(storage.Set("KEY2", "val2"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("val3", value);
+
+    EXPECT_TRUE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+}
+
+TEST(StorageTest, FlatCombineConcurrent) {
+    const int threads = 8;
+    const int keys = 2000;
+    FlatCombineLRU storage(1 << 22);
+
+    std::vector<std::thread> pool;
+    std::vector<int> errors(threads, 0);
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&, t]() {
+            for (int i = 0; i < keys; i++) {
+                std::string key = "Key " + std::to_string(t) + " " + std::to_string(i);
+                std::string res;
+                if (!storage.Put(key, key) || !storage.Get(key, res) || res != key) {
+                    errors[t]++;
+                }
+            }
+        });
+    }
+    for (auto &t : pool) {
+        t.join();
+    }
+
+    for (int t = 0; t < threads; t++) {
+        EXPECT_EQ(0, errors[t]);
+    }
+
+    std::string res;
+    EXPECT_TRUE(storage.Get("Key 0 0", res));
+    EXPECT_EQ("Key 0 0", res);
+}
+
+TEST(StorageTest, CuckooPutGet) {
+    OptimisticCuckoo storage;
+
+    EXPECT_TRUE(storage.Put("KEY1", "val1"));
+    EXPECT_FALSE(storage.PutIfAbsent("KEY1", "val2"));
+    EXPECT_TRUE(storage.Set("KEY1", "val3"));
+    EXPECT_FALSE(storage.Set("KEY2", "val2"));
+
+    std::string value;
+    EXPECT_TRUE(storage.Get("KEY1", value));
+    EXPECT_EQ("val3", value);
+
+    EXPECT_TRUE(storage.Delete("KEY1"));
+    EXPECT_FALSE(storage.Get("KEY1", value));
+    EXPECT_FALSE(storage.Delete("KEY1"));
+}
+
+TEST(StorageTest, CuckooDisplacement) {
+    const size_t length = 20;
+    const long count = 3800;
+
+    // Index gets 93% full, keys can only get their slots by pushing others to alternative buckets
+    OptimisticCuckoo storage(2 * count * length, 4096);
+    ASSERT_EQ(4096, storage.Capacity());
+    for (long i = 0; i < count; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        auto val = pad_space("Val " + std::to_string(i), length);
+        EXPECT_TRUE(storage.Put(key, val));
+    }
+
+    // Most of keys got into the index without eviction
+    long found = 0;
+    for (long i = 0; i < count; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        auto val = pad_space("Val " + std::to_string(i), length);
+
+        std::string res;
+        if (storage.Get(key, res)) {
+            EXPECT_EQ(val, res);
+            found++;
+        }
+    }
+    EXPECT_GT(found, 3500);
+    EXPECT_EQ(std::string::npos, storage.DumpCounters().find("displacements 0\n"));
+}
+
+TEST(StorageTest, CuckooMaxTest) {
+    const size_t length = 20;
+    OptimisticCuckoo storage(2 * 1000 * length);
+
+    for (long i = 0; i < 1100; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        auto val = pad_space("Val " + std::to_string(i), length);
+        EXPECT_TRUE(storage.Put(key, val));
+    }
+
+    // CLOCK evicts in slot order, not in the order of insertion
+    long found = 0;
+    for (long i = 0; i < 1100; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        std::string res;
+        found += storage.Get(key, res);
+    }
+    EXPECT_EQ(1000, found);
+
+    // Every key just stored survives the next Put
+    for (long i = 1100; i < 1200; ++i) {
+        auto key = pad_space("Key " + std::to_string(i), length);
+        std::string res;
+        EXPECT_TRUE(storage.Put(key, key));
+        EXPECT_TRUE(storage.Get(key, res));
+    }
+}
+
+TEST(StorageTest, CuckooClockKeepsReferenced) {
+    OptimisticCuckoo storage(100);
+
+    // Index holds 4 entries, key 0 is read after every Put
+    ASSERT_EQ(4, storage.Capacity());
+    std::string res;
+    for (long i = 0; i < 100; ++i) {
+        EXPECT_TRUE(storage.Put("Key " + std::to_string(i), "Val"));
+        if (i > 0) {
+            EXPECT_TRUE(storage.Get("Key 0", res));
+        }
+    }
+    EXPECT_TRUE(storage.Get("Key 0", res));
+}
+
+TEST(StorageTest, CuckooConcurrent) {
+    const int writers = 2;
+    const int readers = 6;
+    const int keys = 500;
+    const int rounds = 20;
+    OptimisticCuckoo storage(1 << 22);
+
+    for (int i = 0; i < keys; i++) {
+        storage.Put("Key " + std::to_string(i), "Key " + std::to_string(i) + " 0");
+    }
+
+    // Writers keep replacing values, readers must see either some complete value or nothing
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> pool;
+    std::vector<int> errors(writers + readers, 0);
+    for (int t = 0; t < writers; t++) {
+        pool.emplace_back([&, t]() {
+            for (int r = 1; r <= rounds; r++) {
+                for (int i = t; i < keys; i += writers) {
+                    std::string key = "Key " + std::to_string(i);
+                    if (!storage.Put(key, key + " " + std::to_string(r))) {
+                        errors[t]++;
+                    }
+                }
+            }
+        });
+    }
+    for (int t = writers; t < writers + readers; t++) {
+        pool.emplace_back([&, t]() {
+            uint64_t seed = 88172645463325252ull + t;
+            while (!stop.load()) {
+                seed ^= seed << 13;
+                seed ^= seed >> 7;
+                seed ^= seed << 17;
+                std::string key = "Key " + std::to_string(seed % keys);
+                std::string res;
+                if (!storage.Get(key, res) || res.compare(0, key.size() + 1, key + " ") != 0) {
+                    errors[t]++;
+                }
+            }
+        });
+    }
+    for (int t = 0; t < writers; t++) {
+        pool[t].join();
+    }
+    stop.store(true);
+    for (int t = writers; t < writers + readers; t++) {
+        pool[t].join();
+    }
+
+    for (int t = 0; t < writers + readers; t++) {
+        EXPECT_EQ(0, errors[t]);
+    }
+    for (int i = 0; i < keys; i++) {
+        std::string key = "Key " + std::to_string(i);
+        std::string res;
+        EXPECT_TRUE(storage.Get(key, res));
+        EXPECT_EQ(key + " " + std::to_string(rounds), res);
+    }
+}
+
+TEST(StorageTest, CuckooRetiresIntoDomain) {
+    Afina::Concurrency::EpochDomain domain;
+    {
+        OptimisticCuckoo storage(1 << 16, 0, domain);
+        EXPECT_TRUE(storage.Put("KEY", "val"));
+        for (int i = 0; i < 100; i++) {
+            EXPECT_TRUE(storage.Set("KEY", "val" + std::to_string(i)));
+        }
+        EXPECT_TRUE(storage.Delete("KEY"));
+    }
+
+    // Replaced and deleted entries outlive storage until the domain lets them go
+    EXPECT_EQ(101, domain.Retired());
+    domain.Synchronize();
+    EXPECT_EQ(101, domain.Reclaimed());
+}